@@ -0,0 +1,40 @@
+#!/usr/bin/env bash
+# this_file: bench/build.sh
+# Builds the parser benchmark (build/font_bench) and the font store benchmark (build/store_bench)
+# on Linux or macOS with g++ or clang++
+# Usage: bench/build.sh   (CXX and CXXFLAGS are honoured; BROTLI=1 links libbrotlidec for WOFF2)
+
+set -euo pipefail
+
+root_dir="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+cd "$root_dir"
+
+cxx="${CXX:-g++}"
+flags="${CXXFLAGS:--O2 -march=native}"
+brotli_flags=""
+brotli_libs=""
+if [[ "${BROTLI:-0}" == "1" ]]; then
+  brotli_flags="-DFONTLIFT_HAVE_BROTLI"
+  brotli_libs="-lbrotlidec"
+fi
+
+# Parser and scheduler sources only: main.cpp, font_ops.cpp and sys_utils.cpp are Windows-specific
+sources=(
+  src/font_io.cpp src/name_table.cpp src/opentype.cpp src/font_parser.cpp
+  src/checksum.cpp src/inflate.cpp src/woff.cpp src/coverage.cpp src/scheduler.cpp
+  bench/synthetic_fonts.cpp bench/font_bench.cpp
+)
+
+mkdir -p build
+# shellcheck disable=SC2086
+"$cxx" -std=c++17 -Wall -Wextra $flags $brotli_flags -Isrc -Ibench "${sources[@]}" -pthread $brotli_libs -o build/font_bench
+echo "Built build/font_bench"
+
+# Font store stand-ins and the registry decisions made over them: the registry backend lives in sys_utils.cpp
+store_sources=(
+  src/font_store.cpp src/font_registry.cpp src/content_store.cpp src/scheduler.cpp
+  bench/store_bench.cpp
+)
+# shellcheck disable=SC2086
+"$cxx" -std=c++17 -Wall -Wextra $flags -Isrc "${store_sources[@]}" -pthread -o build/store_bench
+echo "Built build/store_bench"
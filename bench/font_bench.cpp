@@ -0,0 +1,368 @@
+// this_file: bench/font_bench.cpp
+// Parser benchmark for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Measures GetFontName, GetFontsInCollection and IsCollection over a synthetic or real corpus,
+// and GetFontName on the shared CPU pool of the scheduler
+
+#include "font_parser.h"
+#include "scheduler.h"
+#include "simd.h"
+#include "synthetic_fonts.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Every allocation in the process is counted, so allocs/file includes the parser's strings
+// and vectors as well as the std::string results handed back to the caller
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+// Defaults
+constexpr uint32_t DEFAULT_FILES = 300;
+constexpr uint32_t DEFAULT_ITERATIONS = 5;
+constexpr int EXIT_OK = 0;
+constexpr int EXIT_USAGE = 1;
+
+struct Config {
+    std::string corpus;                    // Real corpus directory; empty = synthetic
+    std::string keep;                      // Directory to write and keep the synthetic corpus
+    uint32_t files = DEFAULT_FILES;
+    uint32_t iterations = DEFAULT_ITERATIONS;
+    std::vector<SyntheticFonts::Kind> kinds{SyntheticFonts::Kind::TrueType, SyntheticFonts::Kind::OpenTypeCFF,
+                                            SyntheticFonts::Kind::Collection};
+    SyntheticFonts::Options shape;
+    bool json = false;
+};
+
+// Result of one benchmark over the whole corpus
+struct Measurement {
+    const char* name;
+    double bestSeconds = 0;
+    double medianSeconds = 0;
+    double allocsPerFile = 0;
+    uint64_t results = 0;                  // Names (or collections) found per pass, as a sanity check
+};
+
+static void ShowUsage(const char* programName) {
+    std::cout << "font_bench - fontlift-win parser benchmark\n\n";
+    std::cout << "Usage:\n";
+    std::cout << "  " << programName << " [options]\n\n";
+    std::cout << "Corpus:\n";
+    std::cout << "  --corpus <dir>          Font files under dir (recursive) instead of a synthetic corpus\n";
+    std::cout << "  --files <n>             Synthetic files (default 300)\n";
+    std::cout << "  --kinds <list>          Comma-separated ttf,otf,ttc, generated in turn (default all)\n";
+    std::cout << "  --tables <n>            Tables per face (default 12)\n";
+    std::cout << "  --names <n>             Name records per face (default 16)\n";
+    std::cout << "  --string-length <n>     UTF-16 units per name string (default 24)\n";
+    std::cout << "  --collection-size <n>   Faces per TTC (default 4)\n";
+    std::cout << "  --table-bytes <n>       Bytes per filler table (default 1024)\n";
+    std::cout << "  --keep <dir>            Write the synthetic corpus to dir and keep it\n\n";
+    std::cout << "Measurement:\n";
+    std::cout << "  --iterations <n>        Timed passes per benchmark after one warm-up (default 5)\n";
+    std::cout << "  --jobs <n>              Worker threads of the parallel benchmark (default: FONTLIFT_JOBS,\n";
+    std::cout << "                          else one per CPU)\n";
+    std::cout << "  --json                  One JSON object per benchmark (JSON Lines)\n";
+}
+
+// Helper: Parse a positive integer option value
+static bool ParseCount(const char* text, uint32_t max, uint32_t& out) {
+    char* end = nullptr;
+    const unsigned long value = strtoul(text, &end, 10);
+    if (!end || *end != '\0' || value == 0 || value > max) return false;
+    out = static_cast<uint32_t>(value);
+    return true;
+}
+
+static bool ParseKinds(const char* text, std::vector<SyntheticFonts::Kind>& kinds) {
+    kinds.clear();
+    std::string list(text);
+    size_t start = 0;
+    while (start <= list.size()) {
+        const size_t comma = std::min(list.find(',', start), list.size());
+        const std::string item = list.substr(start, comma - start);
+        if (item == "ttf") kinds.push_back(SyntheticFonts::Kind::TrueType);
+        else if (item == "otf") kinds.push_back(SyntheticFonts::Kind::OpenTypeCFF);
+        else if (item == "ttc") kinds.push_back(SyntheticFonts::Kind::Collection);
+        else return false;
+        start = comma + 1;
+    }
+    return !kinds.empty();
+}
+
+static bool ParseArguments(int argc, char* argv[], Config& config) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--json") == 0) {
+            config.json = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: Unknown option or missing value: " << arg << "\n";
+            return false;
+        }
+        const char* value = argv[++i];
+        const auto count16 = [value](uint16_t& field) {
+            uint32_t n = 0;
+            if (!ParseCount(value, UINT16_MAX, n)) return false;
+            field = static_cast<uint16_t>(n);
+            return true;
+        };
+
+        bool ok = true;
+        if (strcmp(arg, "--corpus") == 0) config.corpus = value;
+        else if (strcmp(arg, "--keep") == 0) config.keep = value;
+        else if (strcmp(arg, "--kinds") == 0) ok = ParseKinds(value, config.kinds);
+        else if (strcmp(arg, "--files") == 0) ok = ParseCount(value, 10000000, config.files);
+        else if (strcmp(arg, "--iterations") == 0) ok = ParseCount(value, 1000, config.iterations);
+        else if (strcmp(arg, "--jobs") == 0) {
+            uint32_t jobs = 0;
+            ok = ParseCount(value, 1024, jobs);
+            if (ok) Scheduler::SetDefaultJobs(jobs);
+        }
+        else if (strcmp(arg, "--table-bytes") == 0) ok = ParseCount(value, 64 * 1024 * 1024, config.shape.fillerBytes);
+        else if (strcmp(arg, "--tables") == 0) ok = count16(config.shape.tableCount);
+        else if (strcmp(arg, "--names") == 0) ok = count16(config.shape.nameRecords);
+        else if (strcmp(arg, "--string-length") == 0) ok = count16(config.shape.stringLength);
+        else if (strcmp(arg, "--collection-size") == 0) ok = count16(config.shape.collectionSize);
+        else {
+            std::cerr << "Error: Unknown option: " << arg << "\n";
+            return false;
+        }
+        if (!ok) {
+            std::cerr << "Error: Invalid value for " << arg << ": " << value << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Helper: Check if path ends with a font extension (ASCII case-insensitive)
+static bool IsFontFile(const fs::path& path) {
+    std::string ext = path.extension().string();
+    for (auto& c : ext) {
+        if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+    }
+    return ext == ".ttf" || ext == ".otf" || ext == ".ttc" || ext == ".otc" || ext == ".woff" || ext == ".woff2";
+}
+
+// Helper: Font files under dir, sorted so runs visit them in the same order
+static bool CollectCorpus(const std::string& dir, std::vector<std::string>& files) {
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec) && IsFontFile(it->path())) files.push_back(it->path().string());
+    }
+    if (ec) {
+        std::cerr << "Error: Cannot read corpus directory " << dir << ": " << ec.message() << "\n";
+        return false;
+    }
+    std::sort(files.begin(), files.end());
+    return true;
+}
+
+// Helper: Write the synthetic corpus into dir
+static bool GenerateCorpus(const Config& config, const fs::path& dir, std::vector<std::string>& files) {
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) {
+        std::cerr << "Error: Cannot create corpus directory " << dir.string() << ": " << ec.message() << "\n";
+        return false;
+    }
+    for (uint32_t i = 0; i < config.files; i++) {
+        const SyntheticFonts::Kind kind = config.kinds[i % config.kinds.size()];
+        const std::vector<uint8_t> font = SyntheticFonts::Build(kind, config.shape, i);
+        char name[32];
+        snprintf(name, sizeof(name), "bench%06u%s", i, SyntheticFonts::Extension(kind));
+        const std::string path = (dir / name).string();
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(font.data()), static_cast<std::streamsize>(font.size()));
+        if (!out) {
+            std::cerr << "Error: Cannot write " << path << "\n";
+            return false;
+        }
+        files.push_back(path);
+    }
+    return true;
+}
+
+// Helper: Run op over every file once; parallel passes run on the shared CPU pool
+template <typename Op>
+static uint64_t RunPass(const std::vector<std::string>& files, const Op& op, bool parallel) {
+    if (!parallel) {
+        uint64_t results = 0;
+        for (const auto& file : files) results += op(file.c_str());
+        return results;
+    }
+    std::atomic<uint64_t> results{0};
+    Scheduler::ParallelFor(Scheduler::CpuPool(), files.size(), [&files, &op, &results](size_t i) {
+        results.fetch_add(op(files[i].c_str()), std::memory_order_relaxed);
+    });
+    return results;
+}
+
+// Helper: Run op over every file once per pass; the first pass warms caches and is not timed
+template <typename Op>
+static Measurement Measure(const char* name, const std::vector<std::string>& files, uint32_t iterations, const Op& op,
+                           bool parallel = false) {
+    Measurement m;
+    m.name = name;
+    m.results = RunPass(files, op, parallel);  // Warm-up (also starts the pool's workers)
+
+    std::vector<double> seconds;
+    uint64_t allocations = 0;
+    for (uint32_t pass = 0; pass < iterations; pass++) {
+        const uint64_t allocationsBefore = g_allocations.load(std::memory_order_relaxed);
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t results = RunPass(files, op, parallel);
+        seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        allocations += g_allocations.load(std::memory_order_relaxed) - allocationsBefore;
+        m.results = results;
+    }
+    std::sort(seconds.begin(), seconds.end());
+    m.bestSeconds = seconds.front();
+    m.medianSeconds = seconds[seconds.size() / 2];
+    m.allocsPerFile = static_cast<double>(allocations) / (static_cast<double>(files.size()) * iterations);
+    return m;
+}
+
+// Helper: Kernel set this binary was compiled with
+static const char* SimdName() noexcept {
+#if defined(FONTLIFT_SIMD_AVX2)
+    return "avx2";
+#elif defined(FONTLIFT_SIMD_SSE2)
+    return "sse2";
+#elif defined(FONTLIFT_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+// Helper: JSON string literal (quotes, backslashes and control characters escaped)
+static std::string JsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+static void Report(const Config& config, const Measurement& m, size_t fileCount, uint64_t bytes) {
+    const double filesPerSecond = m.medianSeconds > 0 ? fileCount / m.medianSeconds : 0;
+    const double megabytesPerSecond = m.medianSeconds > 0 ? bytes / m.medianSeconds / 1e6 : 0;
+    char line[512];
+    if (config.json) {
+        snprintf(line, sizeof(line),
+                 "{\"benchmark\":\"%s\",\"files\":%zu,\"bytes\":%llu,\"iterations\":%u,\"median_s\":%.6f,"
+                 "\"best_s\":%.6f,\"files_per_s\":%.1f,\"mb_per_s\":%.2f,\"allocs_per_file\":%.2f,\"results\":%llu,"
+                 "\"simd\":\"%s\",",
+                 m.name, fileCount, static_cast<unsigned long long>(bytes), config.iterations, m.medianSeconds,
+                 m.bestSeconds, filesPerSecond, megabytesPerSecond, m.allocsPerFile,
+                 static_cast<unsigned long long>(m.results), SimdName());
+        std::cout << line;
+        if (!config.corpus.empty()) {
+            std::cout << "\"corpus\":" << JsonString(config.corpus) << "}\n";
+        } else {
+            snprintf(line, sizeof(line),
+                     "\"corpus\":\"synthetic\",\"tables\":%u,\"names\":%u,\"string_length\":%u,"
+                     "\"collection_size\":%u,\"table_bytes\":%u}\n",
+                     config.shape.tableCount, config.shape.nameRecords, config.shape.stringLength,
+                     config.shape.collectionSize, config.shape.fillerBytes);
+            std::cout << line;
+        }
+        return;
+    }
+    snprintf(line, sizeof(line), "%-22s %12.1f files/s %10.2f MB/s %8.2f allocs/file  (median %.4f s, best %.4f s)\n",
+             m.name, filesPerSecond, megabytesPerSecond, m.allocsPerFile, m.medianSeconds, m.bestSeconds);
+    std::cout << line;
+}
+
+int main(int argc, char* argv[]) {
+    Config config;
+    if (argc > 1 && (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0)) {
+        ShowUsage(argv[0]);
+        return EXIT_OK;
+    }
+    if (!ParseArguments(argc, argv, config)) {
+        ShowUsage(argv[0]);
+        return EXIT_USAGE;
+    }
+
+    std::vector<std::string> files;
+    fs::path generated;
+    if (!config.corpus.empty()) {
+        if (!CollectCorpus(config.corpus, files)) return EXIT_USAGE;
+    } else {
+        std::string error;
+        if (!SyntheticFonts::Validate(config.shape, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return EXIT_USAGE;
+        }
+        const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+        generated = config.keep.empty() ? fs::temp_directory_path() / ("fontlift-bench-" + std::to_string(stamp)) : fs::path(config.keep);
+        if (!GenerateCorpus(config, generated, files)) return EXIT_USAGE;
+    }
+    if (files.empty()) {
+        std::cerr << "Error: No font files in corpus\n";
+        return EXIT_USAGE;
+    }
+
+    uint64_t bytes = 0;
+    for (const auto& file : files) {
+        std::error_code ec;
+        bytes += fs::file_size(file, ec);
+    }
+    if (!config.json) {
+        std::cout << files.size() << " file(s), " << bytes << " bytes, " << config.iterations
+                  << " pass(es), " << SimdName() << " kernels, " << Scheduler::CpuPool().ThreadCount()
+                  << " parallel worker(s)\n";
+    }
+
+    const Measurement results[] = {
+        Measure("GetFontName", files, config.iterations,
+                [](const char* path) -> uint64_t { return FontParser::GetFontName(path).empty() ? 0 : 1; }),
+        Measure("GetFontsInCollection", files, config.iterations,
+                [](const char* path) -> uint64_t { return FontParser::GetFontsInCollection(path).size(); }),
+        Measure("IsCollection", files, config.iterations,
+                [](const char* path) -> uint64_t { return FontParser::IsCollection(path) ? 1 : 0; }),
+        Measure("GetFontName/parallel", files, config.iterations,
+                [](const char* path) -> uint64_t { return FontParser::GetFontName(path).empty() ? 0 : 1; }, true),
+    };
+    for (const auto& m : results) Report(config, m, files.size(), bytes);
+
+    if (!generated.empty() && config.keep.empty()) {
+        std::error_code ec;
+        fs::remove_all(generated, ec);
+    }
+    return EXIT_OK;
+}
@@ -0,0 +1,379 @@
+// this_file: bench/store_bench.cpp
+// Font store benchmark for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Runs the registry decisions of install, uninstall and cleanup batches (font_registry.h) against
+// the in-memory and file-backed font stores, with synthetic registrations and injected latency
+
+#include "font_registry.h"
+#include "font_store.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Defaults
+constexpr uint32_t DEFAULT_ENTRIES = 100000;
+constexpr uint32_t DEFAULT_BATCH = 1000;
+constexpr uint32_t MISSING_EVERY = 10;        // Every tenth synthetic entry names a missing file
+constexpr uint32_t SYSTEM_EVERY = 4;          // Every fourth synthetic entry is a system font
+constexpr int EXIT_OK = 0;
+constexpr int EXIT_USAGE = 1;
+constexpr int EXIT_FAILED = 2;
+
+struct Config {
+    uint32_t entries = DEFAULT_ENTRIES;
+    uint32_t batch = DEFAULT_BATCH;
+    uint32_t latencyMicroseconds = 0;
+    bool memory = true;
+    bool file = true;
+    std::string filePath;                     // FileStore path; empty = temporary
+    bool json = false;
+};
+
+// Result of one phase
+struct Measurement {
+    const char* backend;
+    const char* phase;
+    double seconds = 0;
+    uint64_t items = 0;                       // Entries the phase changed or checked
+    FontStore::Stats calls;                   // Store calls the phase made
+};
+
+static void ShowUsage(const char* programName) {
+    std::cout << "store_bench - fontlift-win font store benchmark\n\n";
+    std::cout << "Usage:\n";
+    std::cout << "  " << programName << " [options]\n\n";
+    std::cout << "  --entries <n>           Synthetic registrations, a quarter of them system fonts (default 100000)\n";
+    std::cout << "  --batch <n>             Fonts per install and uninstall batch (default 1000)\n";
+    std::cout << "  --latency-us <n>        Delay added to every store call and enumerated entry (default 0;\n";
+    std::cout << "                          the OS sleep granularity is the floor)\n";
+    std::cout << "  --backend <list>        Comma-separated memory,file (default both)\n";
+    std::cout << "  --file <path>           File of the file-backed store (default: temporary, removed)\n";
+    std::cout << "  --json                  One JSON object per phase (JSON Lines)\n";
+}
+
+// Helper: Parse a non-negative integer option value
+static bool ParseCount(const char* text, uint32_t max, uint32_t& out) {
+    char* end = nullptr;
+    const unsigned long value = strtoul(text, &end, 10);
+    if (!end || *end != '\0' || value > max) return false;
+    out = static_cast<uint32_t>(value);
+    return true;
+}
+
+static bool ParseBackends(const char* text, Config& config) {
+    config.memory = config.file = false;
+    std::string list(text);
+    size_t start = 0;
+    while (start <= list.size()) {
+        const size_t comma = std::min(list.find(',', start), list.size());
+        const std::string item = list.substr(start, comma - start);
+        if (item == "memory") config.memory = true;
+        else if (item == "file") config.file = true;
+        else return false;
+        start = comma + 1;
+    }
+    return true;
+}
+
+static bool ParseArguments(int argc, char* argv[], Config& config) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--json") == 0) {
+            config.json = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: Unknown option or missing value: " << arg << "\n";
+            return false;
+        }
+        const char* value = argv[++i];
+        bool ok = true;
+        if (strcmp(arg, "--entries") == 0) ok = ParseCount(value, 100000000, config.entries) && config.entries > 0;
+        else if (strcmp(arg, "--batch") == 0) ok = ParseCount(value, 10000000, config.batch) && config.batch > 0;
+        else if (strcmp(arg, "--latency-us") == 0) ok = ParseCount(value, 1000000, config.latencyMicroseconds);
+        else if (strcmp(arg, "--backend") == 0) ok = ParseBackends(value, config);
+        else if (strcmp(arg, "--file") == 0) config.filePath = value;
+        else {
+            std::cerr << "Error: Unknown option: " << arg << "\n";
+            return false;
+        }
+        if (!ok) {
+            std::cerr << "Error: Invalid value for " << arg << ": " << value << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Helper: Registry name and file of synthetic entry i (files of missing entries say so)
+static std::string EntryName(uint32_t i) {
+    char name[64];
+    snprintf(name, sizeof(name), "Synthetic %07u Regular (TrueType)", i);
+    return name;
+}
+static std::string EntryFile(const FontStore::MemoryOptions& options, uint32_t i) {
+    char file[64];
+    snprintf(file, sizeof(file), "%s%07u.ttf", i % MISSING_EVERY == 0 ? "missing" : "synthetic", i);
+    // System entries hold a file name, user entries an absolute path, as Windows writes them
+    return i % SYSTEM_EVERY == 0 ? std::string(file) : options.fontsDirs[true] + "/" + file;
+}
+
+static FontStore::Stats Difference(const FontStore::Stats& after, const FontStore::Stats& before) {
+    FontStore::Stats d;
+    d.opens = after.opens - before.opens;
+    d.reads = after.reads - before.reads;
+    d.writes = after.writes - before.writes;
+    d.deletes = after.deletes - before.deletes;
+    d.enumerated = after.enumerated - before.enumerated;
+    return d;
+}
+
+// Helper: Time one phase; body returns the items it handled, or false through ok
+template <typename Body>
+static Measurement Measure(const char* backend, const char* phase, FontStore::MemoryStore& store, const Body& body,
+                           bool& ok) {
+    Measurement m;
+    m.backend = backend;
+    m.phase = phase;
+    const FontStore::Stats before = store.GetStats();
+    const auto start = std::chrono::steady_clock::now();
+    m.items = body(ok);
+    m.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    m.calls = Difference(store.GetStats(), before);
+    return m;
+}
+
+// populate: register every synthetic entry through one writable key per scope
+static uint64_t Populate(const Config& config, FontStore::MemoryStore& store, const FontStore::MemoryOptions& options,
+                         bool& ok) {
+    std::unique_ptr<FontStore::Key> keys[2] = {store.Open(false, true), store.Open(true, true)};
+    if (!keys[0] || !keys[1]) {
+        ok = false;
+        return 0;
+    }
+    for (uint32_t i = 0; i < config.entries; i++) {
+        ok = keys[i % SYSTEM_EVERY != 0]->Write(EntryName(i).c_str(), EntryFile(options, i).c_str()) && ok;
+    }
+    return config.entries;
+}
+
+// install: a batch of fonts, half of them already registered. As the install pipeline does,
+// each font's earlier entries (full name and family name variants, both scopes) are removed,
+// then the new one is written.
+static uint64_t Install(const Config& config, FontStore::MemoryStore& store, const FontStore::MemoryOptions& options,
+                        bool& ok) {
+    std::unique_ptr<FontStore::Key> keys[2] = {store.Open(false, true), store.Open(true, true)};
+    if (!keys[0] || !keys[1]) {
+        ok = false;
+        return 0;
+    }
+    FontStore::Key* const storeKeys[2] = {keys[0].get(), keys[1].get()};
+    const bool writable[2] = {true, true};
+    const uint32_t first = config.entries - config.batch / 2;   // The upper half of the batch is new
+    for (uint32_t i = first; i < first + config.batch; i++) {
+        const std::string name = EntryName(i);
+        const std::string fullName = FontRegistry::StripSuffix(name);
+        const std::string familyName = fullName.substr(0, fullName.rfind(' '));
+        const std::string file = EntryFile(options, i);
+        std::vector<std::string> unregistered;
+        std::vector<FontRegistry::Notice> notices;   // One note per replaced entry, not printed
+        const std::vector<FontRegistry::FontMatch> existing = FontRegistry::FindExistingEntries(
+            fullName, familyName, FontRegistry::FullPath(file, options.fontsDirs[false]), storeKeys, writable,
+            options.fontsDirs, notices);
+        FontRegistry::RemoveExistingEntries(existing, storeKeys, options.fontsDirs, unregistered, notices);
+        for (const auto& notice : notices) ok = !notice.warning && ok;
+        ok = keys[true]->Write(name.c_str(), file.c_str()) && ok;
+    }
+    return config.batch;
+}
+
+// uninstall: the batch's names selected from both scopes in one enumeration each, then
+// deleted as one batch
+static uint64_t Uninstall(const Config& config, FontStore::MemoryStore& store, bool& ok) {
+    std::unique_ptr<FontStore::Key> keys[2] = {store.Open(false, true), store.Open(true, true)};
+    std::vector<std::string> names;
+    for (uint32_t i = config.batch; i < 2 * config.batch; i++) names.push_back(EntryName(i));
+    std::vector<FontRegistry::NamePattern> patterns;
+    if (!keys[0] || !keys[1] || !FontRegistry::CompileNamePatterns(names, false, patterns)) {
+        ok = false;
+        return 0;
+    }
+    FontStore::Key* const storeKeys[2] = {keys[0].get(), keys[1].get()};
+    size_t heldBack = 0;
+    const std::vector<FontRegistry::RemovalTarget> targets =
+        FontRegistry::SelectByName(store, storeKeys, patterns, false, heldBack);
+    for (const auto& target : targets) {
+        ok = keys[target.match.perUser]->Delete(target.match.regName.c_str()) && ok;
+    }
+    for (const auto& pattern : patterns) ok = pattern.matched && ok;
+    return targets.size();
+}
+
+// cleanup: the entries of both scopes whose file is missing, then deleted through one key per
+// scope
+static uint64_t Cleanup(FontStore::MemoryStore& store, bool& ok) {
+    // Stands in for the existence check
+    const auto fileExists = [](const std::string& path) { return path.find("missing") == std::string::npos; };
+    uint64_t removed = 0;
+    for (const bool perUser : {true, false}) {
+        std::vector<FontRegistry::BrokenEntry> broken;
+        if (!FontRegistry::FindBrokenEntries(store, perUser, fileExists, broken)) {
+            ok = false;
+            return removed;
+        }
+        std::unique_ptr<FontStore::Key> key = store.Open(perUser, true);
+        if (!key) {
+            ok = false;
+            return removed;
+        }
+        for (const auto& entry : broken) {
+            ok = key->Delete(entry.regName.c_str()) && ok;
+            removed++;
+        }
+    }
+    return removed;
+}
+
+// Helper: JSON string literal (quotes, backslashes and control characters escaped)
+static std::string JsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+static void Report(const Config& config, const Measurement& m) {
+    const double itemsPerSecond = m.seconds > 0 ? m.items / m.seconds : 0;
+    char line[512];
+    if (config.json) {
+        snprintf(line, sizeof(line),
+                 "{\"backend\":%s,\"phase\":%s,\"entries\":%u,\"batch\":%u,\"latency_us\":%u,\"seconds\":%.6f,"
+                 "\"items\":%llu,\"items_per_s\":%.1f,\"opens\":%llu,\"reads\":%llu,\"writes\":%llu,\"deletes\":%llu,"
+                 "\"enumerated\":%llu}\n",
+                 JsonString(m.backend).c_str(), JsonString(m.phase).c_str(), config.entries, config.batch,
+                 config.latencyMicroseconds, m.seconds, static_cast<unsigned long long>(m.items), itemsPerSecond,
+                 static_cast<unsigned long long>(m.calls.opens), static_cast<unsigned long long>(m.calls.reads),
+                 static_cast<unsigned long long>(m.calls.writes), static_cast<unsigned long long>(m.calls.deletes),
+                 static_cast<unsigned long long>(m.calls.enumerated));
+        std::cout << line;
+        return;
+    }
+    snprintf(line, sizeof(line),
+             "%-7s %-10s %10.4f s %12.1f items/s  %8llu items  (%llu opens, %llu reads, %llu writes, %llu deletes, "
+             "%llu enumerated)\n",
+             m.backend, m.phase, m.seconds, itemsPerSecond, static_cast<unsigned long long>(m.items),
+             static_cast<unsigned long long>(m.calls.opens), static_cast<unsigned long long>(m.calls.reads),
+             static_cast<unsigned long long>(m.calls.writes), static_cast<unsigned long long>(m.calls.deletes),
+             static_cast<unsigned long long>(m.calls.enumerated));
+    std::cout << line;
+}
+
+// Helper: Run every phase on one store and check the entries left. Returns false on a failed
+// call or a wrong count.
+static bool RunPhases(const Config& config, const char* backend, FontStore::MemoryStore& store,
+                      const FontStore::MemoryOptions& options) {
+    bool ok = true;
+    Report(config, Measure(backend, "populate", store, [&](bool& phaseOk) { return Populate(config, store, options, phaseOk); }, ok));
+    Report(config, Measure(backend, "install", store, [&](bool& phaseOk) { return Install(config, store, options, phaseOk); }, ok));
+    Report(config, Measure(backend, "uninstall", store, [&](bool& phaseOk) { return Uninstall(config, store, phaseOk); }, ok));
+    Report(config, Measure(backend, "cleanup", store, [&](bool& phaseOk) { return Cleanup(store, phaseOk); }, ok));
+
+    // Every entry below entries + batch / 2 was registered once; uninstall and cleanup took theirs
+    uint64_t expected = 0;
+    const uint32_t end = config.entries - config.batch / 2 + config.batch;
+    for (uint32_t i = 0; i < end; i++) {
+        if (i % MISSING_EVERY != 0 && !(i >= config.batch && i < 2 * config.batch)) expected++;
+    }
+    const uint64_t left = store.Size(false) + store.Size(true);
+    if (left != expected) {
+        std::cerr << "Error: " << backend << " store holds " << left << " entries, expected " << expected << "\n";
+        ok = false;
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    Config config;
+    if (argc > 1 && (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0)) {
+        ShowUsage(argv[0]);
+        return EXIT_OK;
+    }
+    if (!ParseArguments(argc, argv, config)) {
+        ShowUsage(argv[0]);
+        return EXIT_USAGE;
+    }
+    if (config.batch > config.entries / 2) {
+        std::cerr << "Error: --batch must be at most half of --entries\n";
+        return EXIT_USAGE;
+    }
+
+    FontStore::MemoryOptions options;
+    options.fontsDirs[false] = "C:/Windows/Fonts";
+    options.fontsDirs[true] = "C:/Users/bench/AppData/Local/Microsoft/Windows/Fonts";
+    options.latency = std::chrono::microseconds(config.latencyMicroseconds);
+    if (!config.json) {
+        std::cout << config.entries << " synthetic entries, batches of " << config.batch << ", "
+                  << config.latencyMicroseconds << " us latency per call\n";
+    }
+
+    bool ok = true;
+    if (config.memory) {
+        FontStore::MemoryStore store(options);
+        ok = RunPhases(config, "memory", store, options) && ok;
+    }
+    if (config.file) {
+        const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+        const std::string path = config.filePath.empty()
+            ? (fs::temp_directory_path() / ("fontlift-store-bench-" + std::to_string(stamp) + ".txt")).string()
+            : config.filePath;
+        std::error_code ec;
+        fs::remove(path, ec);
+        {
+            FontStore::FileStore store(path, options);
+            std::string error;
+            if (!store.IsLoaded(&error)) {
+                std::cerr << "Error: " << error << "\n";
+                return EXIT_FAILED;
+            }
+            ok = RunPhases(config, "file", store, options) && ok;
+            Report(config, Measure("file", "compact", store, [&](bool& phaseOk) {
+                phaseOk = store.Compact() && phaseOk;
+                return store.Size(false) + store.Size(true);
+            }, ok));
+        }
+        {
+            // Reading the file back is what every command pays once
+            Measurement reload;
+            reload.backend = "file";
+            reload.phase = "load";
+            const auto start = std::chrono::steady_clock::now();
+            FontStore::FileStore store(path, options);
+            reload.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            reload.items = store.Size(false) + store.Size(true);
+            ok = store.IsLoaded() && ok;
+            Report(config, reload);
+        }
+        if (config.filePath.empty()) fs::remove(path, ec);
+    }
+    return ok ? EXIT_OK : EXIT_FAILED;
+}
@@ -0,0 +1,275 @@
+// this_file: bench/synthetic_fonts.cpp
+// Synthetic font generator implementation
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+
+#include "synthetic_fonts.h"
+#include "byte_order.h"
+#include "checksum.h"
+#include "opentype.h"
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+
+namespace SyntheticFonts {
+
+using ByteOrder::MakeTag;
+using ByteOrder::StoreBE;
+
+// Table sizes (per OpenType spec)
+constexpr size_t HEAD_SIZE = 54;
+constexpr size_t OS2_SIZE = 96;                      // OS/2 version 4
+constexpr size_t NAME_HEADER_SIZE = 6;
+constexpr size_t NAME_RECORD_SIZE = 12;
+constexpr size_t MAX_NAME_STORAGE = 65535;           // Name string offsets are uint16
+constexpr uint16_t MAX_TABLES = 1000;                // Parser limit on tables per face
+constexpr uint16_t MAX_NAME_RECORDS = 1000;          // Parser limit on name records scanned
+constexpr uint16_t MAX_STRING_LENGTH = 1024;
+constexpr uint16_t MAX_COLLECTION_SIZE = 256;        // Parser limit on faces per collection
+
+// Windows platform, Unicode BMP encoding, US English (per OpenType name table spec)
+constexpr uint16_t PLATFORM_WINDOWS = 3;
+constexpr uint16_t ENCODING_UNICODE_BMP = 1;
+constexpr uint16_t LANGUAGE_EN_US = 0x0409;
+
+// First nameIDs written to every face (family, subfamily, full name, PostScript name);
+// further records use font-specific nameIDs from 256 up
+constexpr uint16_t LEADING_NAME_IDS[] = {1, 2, 4, 6};
+constexpr uint16_t FONT_SPECIFIC_NAME_ID = 256;
+
+// Filler tags in the order a real font would have them, before numbered 'zNNN' tags
+constexpr uint32_t TRUETYPE_FILLERS[] = {MakeTag("glyf"), MakeTag("loca"), MakeTag("hmtx"), MakeTag("hhea"),
+                                         MakeTag("maxp"), MakeTag("post"), MakeTag("GSUB"), MakeTag("GPOS"),
+                                         MakeTag("GDEF"), MakeTag("gasp"), MakeTag("prep"), MakeTag("fpgm"),
+                                         MakeTag("cvt ")};
+constexpr uint32_t CFF_FILLERS[] = {MakeTag("CFF "), MakeTag("hmtx"), MakeTag("hhea"), MakeTag("maxp"),
+                                    MakeTag("post"), MakeTag("GSUB"), MakeTag("GPOS"), MakeTag("GDEF")};
+
+struct Table {
+    uint32_t tag;
+    std::vector<uint8_t> bytes;
+};
+
+bool Validate(const Options& options, std::string& error) {
+    const auto fail = [&error](const char* message) {
+        error = message;
+        return false;
+    };
+    if (options.tableCount < 4 || options.tableCount > MAX_TABLES) return fail("tables per face must be 4-1000");
+    if (options.nameRecords < 4 || options.nameRecords > MAX_NAME_RECORDS) return fail("name records must be 4-1000");
+    if (options.stringLength < 1 || options.stringLength > MAX_STRING_LENGTH) return fail("string length must be 1-1024");
+    if (options.collectionSize < 1 || options.collectionSize > MAX_COLLECTION_SIZE) return fail("collection size must be 1-256");
+    if (static_cast<size_t>(options.nameRecords) * options.stringLength * 2 > MAX_NAME_STORAGE) {
+        return fail("name records x string length x 2 must fit the 64 KB name string storage");
+    }
+    return true;
+}
+
+const char* Extension(Kind kind) noexcept {
+    switch (kind) {
+        case Kind::OpenTypeCFF: return ".otf";
+        case Kind::Collection: return ".ttc";
+        default: return ".ttf";
+    }
+}
+
+// Helper: Big-endian append
+template <typename T>
+static void Put(std::vector<uint8_t>& out, T value) {
+    const size_t at = out.size();
+    out.resize(at + sizeof(T));
+    StoreBE(out.data() + at, value);
+}
+
+// Helper: Deterministic filler bytes (xorshift32)
+static std::vector<uint8_t> Filler(uint32_t seed, size_t length) {
+    std::vector<uint8_t> bytes(length);
+    uint32_t state = seed * 2654435761u + 1;
+    for (auto& b : bytes) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        b = static_cast<uint8_t>(state);
+    }
+    return bytes;
+}
+
+static std::vector<uint8_t> BuildHead(uint32_t revision) {
+    std::vector<uint8_t> head(HEAD_SIZE, 0);
+    StoreBE<uint16_t>(head.data() + 0, 1);                       // majorVersion
+    StoreBE<uint32_t>(head.data() + OpenType::Head::FontRevision::OFFSET, revision);
+    StoreBE<uint32_t>(head.data() + OpenType::Head::MagicNumber::OFFSET, OpenType::Head::MAGIC_NUMBER);
+    StoreBE<uint16_t>(head.data() + OpenType::Head::UnitsPerEm::OFFSET, 1000);
+    StoreBE<int16_t>(head.data() + 48, 2);                       // fontDirectionHint
+    return head;
+}
+
+static std::vector<uint8_t> BuildOs2(uint16_t weightClass) {
+    std::vector<uint8_t> os2(OS2_SIZE, 0);
+    StoreBE<uint16_t>(os2.data() + 0, 4);                        // version
+    StoreBE<uint16_t>(os2.data() + OpenType::Os2::WeightClass::OFFSET, weightClass);
+    StoreBE<uint16_t>(os2.data() + OpenType::Os2::WidthClass::OFFSET, 5);
+    return os2;
+}
+
+// Helper: Format 4 cmap mapping U+0020-U+007E to glyphs 1-95
+static std::vector<uint8_t> BuildCmap() {
+    std::vector<uint8_t> cmap;
+    Put<uint16_t>(cmap, 0);                                      // version
+    Put<uint16_t>(cmap, 1);                                      // numTables
+    Put<uint16_t>(cmap, PLATFORM_WINDOWS);
+    Put<uint16_t>(cmap, ENCODING_UNICODE_BMP);
+    Put<uint32_t>(cmap, 12);                                     // Subtable offset
+    const uint16_t segCount = 2;
+    Put<uint16_t>(cmap, 4);                                      // format
+    Put<uint16_t>(cmap, 16 + 8 * segCount);                      // length
+    Put<uint16_t>(cmap, 0);                                      // language
+    Put<uint16_t>(cmap, 2 * segCount);
+    Put<uint16_t>(cmap, 4);                                      // searchRange
+    Put<uint16_t>(cmap, 1);                                      // entrySelector
+    Put<uint16_t>(cmap, 0);                                      // rangeShift
+    for (uint16_t end : {0x007E, 0xFFFF}) Put<uint16_t>(cmap, end);
+    Put<uint16_t>(cmap, 0);                                      // reservedPad
+    for (uint16_t start : {0x0020, 0xFFFF}) Put<uint16_t>(cmap, start);
+    for (uint16_t delta : {static_cast<uint16_t>(1 - 0x20), static_cast<uint16_t>(1)}) Put<uint16_t>(cmap, delta);
+    for (uint16_t rangeOffset : {0, 0}) Put<uint16_t>(cmap, rangeOffset);
+    return cmap;
+}
+
+// Helper: name table with the leading nameIDs, then font-specific ones. Every string is
+// distinct and exactly stringLength UTF-16 units, so the table size scales predictably.
+static std::vector<uint8_t> BuildName(const Options& options, uint32_t index, uint32_t face) {
+    const uint16_t count = options.nameRecords;
+    std::vector<uint8_t> name;
+    Put<uint16_t>(name, 0);                                      // format
+    Put<uint16_t>(name, count);
+    Put<uint16_t>(name, static_cast<uint16_t>(NAME_HEADER_SIZE + count * NAME_RECORD_SIZE));
+
+    const size_t stringBytes = static_cast<size_t>(options.stringLength) * 2;
+    std::vector<uint8_t> storage;
+    for (uint16_t r = 0; r < count; r++) {
+        const uint16_t nameID = r < 4 ? LEADING_NAME_IDS[r] : static_cast<uint16_t>(FONT_SPECIFIC_NAME_ID + r - 4);
+        Put<uint16_t>(name, PLATFORM_WINDOWS);
+        Put<uint16_t>(name, ENCODING_UNICODE_BMP);
+        Put<uint16_t>(name, LANGUAGE_EN_US);
+        Put<uint16_t>(name, nameID);
+        Put<uint16_t>(name, static_cast<uint16_t>(stringBytes));
+        Put<uint16_t>(name, static_cast<uint16_t>(storage.size()));
+
+        // "Bench 000042 F1 N4 " padded with letters, then cut to the requested length
+        char prefix[48];
+        snprintf(prefix, sizeof(prefix), "Bench %06u F%u N%u ", index, face, nameID);
+        std::string text(prefix);
+        while (text.size() < options.stringLength) text += static_cast<char>('a' + text.size() % 26);
+        text.resize(options.stringLength);
+        for (char ch : text) Put<uint16_t>(storage, static_cast<uint16_t>(static_cast<uint8_t>(ch)));
+    }
+    name.insert(name.end(), storage.begin(), storage.end());
+    return name;
+}
+
+// Helper: Filler tags for a face: the kind's usual tables, then 'z000', 'z001', ...
+static std::vector<uint32_t> FillerTags(Kind kind, size_t count) {
+    std::vector<uint32_t> tags;
+    const uint32_t* usual = kind == Kind::OpenTypeCFF ? CFF_FILLERS : TRUETYPE_FILLERS;
+    const size_t usualCount = kind == Kind::OpenTypeCFF ? std::size(CFF_FILLERS) : std::size(TRUETYPE_FILLERS);
+    for (size_t i = 0; i < count; i++) {
+        if (i < usualCount) {
+            tags.push_back(usual[i]);
+        } else {
+            const size_t n = i - usualCount;
+            tags.push_back(MakeTag("z000") + static_cast<uint32_t>(((n / 100) << 16) | (((n / 10) % 10) << 8) | (n % 10)));
+        }
+    }
+    return tags;
+}
+
+// Helper: Lay out a file: header (collection or sfnt), every face directory, then each
+// table once (4-byte aligned). faces[f] lists the tables of face f by index into tables.
+static std::vector<uint8_t> Assemble(uint32_t sfntVersion, std::vector<Table>& tables,
+                                     std::vector<std::vector<size_t>>& faces, bool collection) {
+    namespace Entry = OpenType::TableDirectoryEntry;
+    const size_t headerSize = collection ? OpenType::CollectionHeader::OFFSETS_START + faces.size() * OpenType::CollectionHeader::OFFSET_SIZE : 0;
+    std::vector<size_t> directoryOffsets;
+    size_t pos = headerSize;
+    for (auto& face : faces) {
+        std::sort(face.begin(), face.end(), [&tables](size_t a, size_t b) { return tables[a].tag < tables[b].tag; });
+        directoryOffsets.push_back(pos);
+        pos += OpenType::SfntHeader::SIZE + face.size() * Entry::SIZE;
+    }
+    std::vector<size_t> tableOffsets;
+    for (const auto& table : tables) {
+        pos = (pos + 3) & ~static_cast<size_t>(3);
+        tableOffsets.push_back(pos);
+        pos += table.bytes.size();
+    }
+
+    std::vector<uint8_t> file((pos + 3) & ~static_cast<size_t>(3), 0);
+    if (collection) {
+        StoreBE<uint32_t>(file.data(), OpenType::TAG_TTCF);
+        StoreBE<uint32_t>(file.data() + 4, 0x00010000);          // Version 1.0
+        StoreBE<uint32_t>(file.data() + 8, static_cast<uint32_t>(faces.size()));
+        for (size_t f = 0; f < faces.size(); f++) {
+            StoreBE<uint32_t>(file.data() + OpenType::CollectionHeader::OFFSETS_START + f * 4, static_cast<uint32_t>(directoryOffsets[f]));
+        }
+    }
+    for (size_t f = 0; f < faces.size(); f++) {
+        uint8_t* dir = file.data() + directoryOffsets[f];
+        const uint16_t numTables = static_cast<uint16_t>(faces[f].size());
+        uint16_t entrySelector = 0;
+        while ((2u << entrySelector) <= numTables) entrySelector++;
+        const uint16_t searchRange = static_cast<uint16_t>((1u << entrySelector) * 16);
+        StoreBE<uint32_t>(dir, sfntVersion);
+        StoreBE<uint16_t>(dir + 4, numTables);
+        StoreBE<uint16_t>(dir + 6, searchRange);
+        StoreBE<uint16_t>(dir + 8, entrySelector);
+        StoreBE<uint16_t>(dir + 10, static_cast<uint16_t>(numTables * 16 - searchRange));
+        for (size_t t = 0; t < faces[f].size(); t++) {
+            const Table& table = tables[faces[f][t]];
+            uint8_t* entry = dir + OpenType::SfntHeader::SIZE + t * Entry::SIZE;
+            StoreBE<uint32_t>(entry + Entry::Tag::OFFSET, table.tag);
+            StoreBE<uint32_t>(entry + Entry::Checksum::OFFSET, Checksum::SumBE32(table.bytes.data(), table.bytes.size()));
+            StoreBE<uint32_t>(entry + Entry::Offset::OFFSET, static_cast<uint32_t>(tableOffsets[faces[f][t]]));
+            StoreBE<uint32_t>(entry + Entry::Length::OFFSET, static_cast<uint32_t>(table.bytes.size()));
+        }
+    }
+    for (size_t i = 0; i < tables.size(); i++) {
+        std::copy(tables[i].bytes.begin(), tables[i].bytes.end(), file.begin() + tableOffsets[i]);
+    }
+
+    // Single fonts: head.checkSumAdjustment makes the whole-file sum CHECKSUM_MAGIC
+    if (!collection) {
+        for (size_t i = 0; i < tables.size(); i++) {
+            if (tables[i].tag != OpenType::TAG_HEAD) continue;
+            const uint32_t adjustment = Checksum::CHECKSUM_MAGIC - Checksum::SumBE32(file.data(), file.size());
+            StoreBE<uint32_t>(file.data() + tableOffsets[i] + OpenType::Head::CheckSumAdjustment::OFFSET, adjustment);
+        }
+    }
+    return file;
+}
+
+std::vector<uint8_t> Build(Kind kind, const Options& options, uint32_t index) {
+    const bool collection = kind == Kind::Collection;
+    const size_t faceCount = collection ? options.collectionSize : 1;
+
+    // Shared tables first; collections add one name table per face
+    std::vector<Table> tables;
+    tables.push_back(Table{OpenType::TAG_HEAD, BuildHead(0x00010000 + index)});
+    tables.push_back(Table{OpenType::TAG_OS2, BuildOs2(400)});
+    tables.push_back(Table{OpenType::TAG_CMAP, BuildCmap()});
+    const std::vector<uint32_t> fillers = FillerTags(kind, options.tableCount - 4u);
+    for (size_t i = 0; i < fillers.size(); i++) {
+        tables.push_back(Table{fillers[i], Filler(index * 1000 + static_cast<uint32_t>(i), options.fillerBytes)});
+    }
+    const size_t shared = tables.size();
+
+    std::vector<std::vector<size_t>> faces(faceCount);
+    for (size_t f = 0; f < faceCount; f++) {
+        tables.push_back(Table{OpenType::TAG_NAME, BuildName(options, index, static_cast<uint32_t>(f))});
+        for (size_t t = 0; t < shared; t++) faces[f].push_back(t);
+        faces[f].push_back(tables.size() - 1);
+    }
+    const uint32_t sfntVersion = kind == Kind::OpenTypeCFF ? OpenType::SFNT_VERSION_CFF : OpenType::SFNT_VERSION_TRUETYPE;
+    return Assemble(sfntVersion, tables, faces, collection);
+}
+
+} // namespace SyntheticFonts
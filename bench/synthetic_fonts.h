@@ -0,0 +1,43 @@
+// this_file: bench/synthetic_fonts.h
+// Synthetic font generator for fontlift-win-cli benchmarks
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Builds structurally valid TTF/OTF/TTC files with configurable table, name-record and collection sizes
+
+#ifndef SYNTHETIC_FONTS_H
+#define SYNTHETIC_FONTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SyntheticFonts {
+    enum class Kind : uint8_t {
+        TrueType,     // .ttf: 0x00010000 with glyf/loca filler tables
+        OpenTypeCFF,  // .otf: 'OTTO' with a CFF filler table
+        Collection    // .ttc: TrueType faces sharing every table except name
+    };
+
+    // Shape of each generated file. Filler tables hold deterministic pseudo-random bytes;
+    // cmap, head, name and OS/2 are real so every parser path runs as on a shipping font.
+    struct Options {
+        uint16_t tableCount = 12;       // Tables per face, including cmap, head, name and OS/2 (4-1000)
+        uint16_t nameRecords = 16;      // Windows Unicode name records per face (4-1000)
+        uint16_t stringLength = 24;     // UTF-16 code units per name string (1-1024)
+        uint16_t collectionSize = 4;    // Faces per collection (1-256)
+        uint32_t fillerBytes = 1024;    // Bytes per filler table
+    };
+
+    // Check option ranges (including the 64 KB name string storage limit); false with a
+    // message in error if the options cannot produce a valid font
+    bool Validate(const Options& options, std::string& error);
+
+    // One font file; index makes the family names unique within a corpus.
+    // Table checksums and (for single fonts) head.checkSumAdjustment are valid.
+    [[nodiscard]] std::vector<uint8_t> Build(Kind kind, const Options& options, uint32_t index);
+
+    // File extension for a kind (".ttf", ".otf", ".ttc")
+    [[nodiscard]] const char* Extension(Kind kind) noexcept;
+}
+
+#endif // SYNTHETIC_FONTS_H
@@ -97,10 +97,20 @@ if !ERRORLEVEL! NEQ 0 (
     goto :cleanup
 )
 
-cl.exe /std:c++17 /EHsc /W4 /O2 ^
+REM Optional WOFF2 support: set BROTLI_DIR to a Brotli install with include\ and lib\
+REM (e.g. vcpkg's installed\x64-windows-static); without it WOFF2 files report only their format
+set "BROTLI_FLAGS="
+set "BROTLI_LIBS="
+if defined BROTLI_DIR (
+    echo Building with Brotli from !BROTLI_DIR!
+    set "BROTLI_FLAGS=/DFONTLIFT_HAVE_BROTLI /I"!BROTLI_DIR!\include""
+    set "BROTLI_LIBS="!BROTLI_DIR!\lib\brotlidec.lib" "!BROTLI_DIR!\lib\brotlicommon.lib""
+)
+
+cl.exe /std:c++17 /EHsc /W4 /O2 !BROTLI_FLAGS! ^
     /Fobuild\ ^
-    src\main.cpp src\sys_utils.cpp src\font_parser.cpp src\font_ops.cpp ^
-    /link /OUT:build\fontlift-win.exe build\version.res Advapi32.lib Shlwapi.lib User32.lib Gdi32.lib
+    src\main.cpp src\sys_utils.cpp src\font_io.cpp src\name_table.cpp src\opentype.cpp src\font_parser.cpp src\font_ops.cpp src\checksum.cpp src\inflate.cpp src\woff.cpp src\coverage.cpp src\metadata_cache.cpp src\scheduler.cpp src\manifest.cpp src\journal.cpp src\zip_archive.cpp src\content_store.cpp src\font_store.cpp src\font_registry.cpp ^
+    /link /OUT:build\fontlift-win.exe build\version.res Advapi32.lib Shlwapi.lib User32.lib Gdi32.lib !BROTLI_LIBS!
 
 if !ERRORLEVEL! EQU 0 (
     echo.
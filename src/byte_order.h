@@ -0,0 +1,90 @@
+// this_file: src/byte_order.h
+// Big-endian field access for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Template loads of big-endian OpenType fields that compile to single bswap/movbe loads
+
+#ifndef BYTE_ORDER_H
+#define BYTE_ORDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#endif
+
+namespace ByteOrder {
+    // OpenType data is big-endian; every supported host (x86, x64, ARM64) is little-endian
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    constexpr bool HOST_IS_BIG_ENDIAN = true;
+#else
+    constexpr bool HOST_IS_BIG_ENDIAN = false;
+#endif
+
+    inline uint8_t ByteSwap(uint8_t v) noexcept { return v; }
+    inline uint16_t ByteSwap(uint16_t v) noexcept {
+#if defined(_MSC_VER)
+        return _byteswap_ushort(v);
+#else
+        return __builtin_bswap16(v);
+#endif
+    }
+    inline uint32_t ByteSwap(uint32_t v) noexcept {
+#if defined(_MSC_VER)
+        return _byteswap_ulong(v);
+#else
+        return __builtin_bswap32(v);
+#endif
+    }
+    inline uint64_t ByteSwap(uint64_t v) noexcept {
+#if defined(_MSC_VER)
+        return _byteswap_uint64(v);
+#else
+        return __builtin_bswap64(v);
+#endif
+    }
+
+    // Load a big-endian integer from unaligned memory (caller guarantees sizeof(T) bytes)
+    template <typename T>
+    inline T LoadBE(const uint8_t* p) noexcept {
+        static_assert(std::is_integral<T>::value, "LoadBE requires an integer type");
+        using U = typename std::make_unsigned<T>::type;
+        U raw;
+        std::memcpy(&raw, p, sizeof(U));
+        if (!HOST_IS_BIG_ENDIAN) raw = ByteSwap(raw);
+        return static_cast<T>(raw);
+    }
+
+    // Load a little-endian integer from unaligned memory (content hash input words)
+    template <typename T>
+    inline T LoadLE(const uint8_t* p) noexcept {
+        static_assert(std::is_integral<T>::value, "LoadLE requires an integer type");
+        using U = typename std::make_unsigned<T>::type;
+        U raw;
+        std::memcpy(&raw, p, sizeof(U));
+        if (HOST_IS_BIG_ENDIAN) raw = ByteSwap(raw);
+        return static_cast<T>(raw);
+    }
+
+    // Store an integer big-endian into unaligned memory
+    template <typename T>
+    inline void StoreBE(uint8_t* p, T value) noexcept {
+        static_assert(std::is_integral<T>::value, "StoreBE requires an integer type");
+        using U = typename std::make_unsigned<T>::type;
+        U raw = static_cast<U>(value);
+        if (!HOST_IS_BIG_ENDIAN) raw = ByteSwap(raw);
+        std::memcpy(p, &raw, sizeof(U));
+    }
+
+    // Four-character OpenType tag as its big-endian uint32 value, e.g. MakeTag("name")
+    constexpr uint32_t MakeTag(const char (&tag)[5]) noexcept {
+        return (static_cast<uint32_t>(static_cast<uint8_t>(tag[0])) << 24) |
+               (static_cast<uint32_t>(static_cast<uint8_t>(tag[1])) << 16) |
+               (static_cast<uint32_t>(static_cast<uint8_t>(tag[2])) << 8) |
+               static_cast<uint32_t>(static_cast<uint8_t>(tag[3]));
+    }
+}
+
+#endif // BYTE_ORDER_H
@@ -0,0 +1,228 @@
+// this_file: src/checksum.cpp
+// OpenType checksum kernel implementation
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+
+#include "checksum.h"
+#include "byte_order.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Checksum {
+// Big-endian word sums: vector blocks byte-swap each 32-bit lane and add with wraparound,
+// which matches the scalar sum exactly because addition modulo 2^32 is associative
+
+#if defined(FONTLIFT_SIMD_AVX2)
+
+constexpr size_t BLOCK_SIZE = 64;                    // Bytes per loop iteration (two vectors)
+
+// Helper: Sum of the big-endian words in length / BLOCK_SIZE whole blocks
+static inline uint32_t SumBlocks(const uint8_t* data, size_t blocks) noexcept {
+    const __m256i swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                          3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    for (size_t b = 0; b < blocks; b++) {
+        const uint8_t* p = data + b * BLOCK_SIZE;
+        acc0 = _mm256_add_epi32(acc0, _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), swap));
+        acc1 = _mm256_add_epi32(acc1, _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)), swap));
+    }
+    const __m256i acc = _mm256_add_epi32(acc0, acc1);
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(sum));
+}
+
+#elif defined(FONTLIFT_SIMD_SSE2)
+
+constexpr size_t BLOCK_SIZE = 32;                    // Bytes per loop iteration (two vectors)
+
+// Helper: Byte-swap each 32-bit lane (SSE2 has no byte shuffle: swap halves, then bytes)
+static inline __m128i SwapWords(__m128i v) noexcept {
+    v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+// Helper: Sum of the big-endian words in length / BLOCK_SIZE whole blocks
+static inline uint32_t SumBlocks(const uint8_t* data, size_t blocks) noexcept {
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+    for (size_t b = 0; b < blocks; b++) {
+        const uint8_t* p = data + b * BLOCK_SIZE;
+        acc0 = _mm_add_epi32(acc0, SwapWords(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))));
+        acc1 = _mm_add_epi32(acc1, SwapWords(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16))));
+    }
+    __m128i sum = _mm_add_epi32(acc0, acc1);
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(sum));
+}
+
+#elif defined(FONTLIFT_SIMD_NEON)
+
+constexpr size_t BLOCK_SIZE = 32;                    // Bytes per loop iteration (two vectors)
+
+// Helper: Sum of the big-endian words in length / BLOCK_SIZE whole blocks
+static inline uint32_t SumBlocks(const uint8_t* data, size_t blocks) noexcept {
+    uint32x4_t acc0 = vdupq_n_u32(0);
+    uint32x4_t acc1 = vdupq_n_u32(0);
+    for (size_t b = 0; b < blocks; b++) {
+        const uint8_t* p = data + b * BLOCK_SIZE;
+        acc0 = vaddq_u32(acc0, vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(p))));
+        acc1 = vaddq_u32(acc1, vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(p + 16))));
+    }
+    const uint32x4_t sum = vaddq_u32(acc0, acc1);
+    return vgetq_lane_u32(sum, 0) + vgetq_lane_u32(sum, 1) + vgetq_lane_u32(sum, 2) + vgetq_lane_u32(sum, 3);
+}
+
+#endif
+
+uint32_t SumBE32(const uint8_t* data, size_t length) noexcept {
+    uint32_t sum = 0;
+    size_t i = 0;
+#if defined(FONTLIFT_SIMD_AVX2) || defined(FONTLIFT_SIMD_SSE2) || defined(FONTLIFT_SIMD_NEON)
+    const size_t blocks = length / BLOCK_SIZE;
+    sum = SumBlocks(data, blocks);
+    i = blocks * BLOCK_SIZE;
+#endif
+    for (; i + 4 <= length; i += 4) {
+        sum += ByteOrder::LoadBE<uint32_t>(data + i);
+    }
+    // Trailing partial word is padded with zeros
+    return sum + BytesContribution(data + i, length - i, 0);
+}
+
+uint32_t BytesContribution(const uint8_t* bytes, size_t length, size_t offset) noexcept {
+    uint32_t sum = 0;
+    for (size_t k = 0; k < length; k++) {
+        sum += static_cast<uint32_t>(bytes[k]) << (24 - 8 * ((offset + k) & 3));
+    }
+    return sum;
+}
+
+// XXH64 primes
+constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ull;
+constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5ull;
+constexpr size_t STRIPE_SIZE = 32;                   // Four 64-bit lanes
+
+static inline uint64_t RotateLeft(uint64_t v, int bits) noexcept {
+    return (v << bits) | (v >> (64 - bits));
+}
+
+// Helper: Mix one input word into a lane
+static inline uint64_t HashRound(uint64_t acc, uint64_t input) noexcept {
+    acc += input * PRIME64_2;
+    return RotateLeft(acc, 31) * PRIME64_1;
+}
+
+static inline uint64_t MergeLane(uint64_t hash, uint64_t lane) noexcept {
+    hash ^= HashRound(0, lane);
+    return hash * PRIME64_1 + PRIME64_4;
+}
+
+// Helper: Consume whole stripes; returns the bytes used
+static size_t HashStripes(uint64_t* acc, const uint8_t* data, size_t length) noexcept {
+    size_t i = 0;
+    for (; i + STRIPE_SIZE <= length; i += STRIPE_SIZE) {
+        acc[0] = HashRound(acc[0], ByteOrder::LoadLE<uint64_t>(data + i));
+        acc[1] = HashRound(acc[1], ByteOrder::LoadLE<uint64_t>(data + i + 8));
+        acc[2] = HashRound(acc[2], ByteOrder::LoadLE<uint64_t>(data + i + 16));
+        acc[3] = HashRound(acc[3], ByteOrder::LoadLE<uint64_t>(data + i + 24));
+    }
+    return i;
+}
+
+void ContentHasher::Update(const uint8_t* data, size_t length) noexcept {
+    total_ += length;
+    if (buffered_ > 0) {
+        const size_t fill = std::min(STRIPE_SIZE - buffered_, length);
+        std::memcpy(buffer_ + buffered_, data, fill);
+        buffered_ += fill;
+        data += fill;
+        length -= fill;
+        if (buffered_ < STRIPE_SIZE) return;
+        HashStripes(acc_, buffer_, STRIPE_SIZE);
+        buffered_ = 0;
+    }
+    const size_t used = HashStripes(acc_, data, length);
+    std::memcpy(buffer_, data + used, length - used);
+    buffered_ = length - used;
+}
+
+uint64_t ContentHasher::Final() const noexcept {
+    uint64_t hash;
+    if (total_ >= STRIPE_SIZE) {
+        hash = RotateLeft(acc_[0], 1) + RotateLeft(acc_[1], 7) + RotateLeft(acc_[2], 12) + RotateLeft(acc_[3], 18);
+        for (const uint64_t lane : acc_) hash = MergeLane(hash, lane);
+    } else {
+        hash = PRIME64_5;  // Seed 0
+    }
+    hash += total_;
+
+    size_t i = 0;
+    for (; i + 8 <= buffered_; i += 8) {
+        hash ^= HashRound(0, ByteOrder::LoadLE<uint64_t>(buffer_ + i));
+        hash = RotateLeft(hash, 27) * PRIME64_1 + PRIME64_4;
+    }
+    if (i + 4 <= buffered_) {
+        hash ^= static_cast<uint64_t>(ByteOrder::LoadLE<uint32_t>(buffer_ + i)) * PRIME64_1;
+        hash = RotateLeft(hash, 23) * PRIME64_2 + PRIME64_3;
+        i += 4;
+    }
+    for (; i < buffered_; i++) {
+        hash ^= buffer_[i] * PRIME64_5;
+        hash = RotateLeft(hash, 11) * PRIME64_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+    return hash != 0 ? hash : 1;
+}
+
+uint64_t Hash64(const uint8_t* data, size_t length) noexcept {
+    ContentHasher hasher;
+    hasher.Update(data, length);
+    return hasher.Final();
+}
+
+// CRC-32 (reflected polynomial 0xEDB88320), eight bytes per step: table k maps a byte to its
+// CRC contribution k bytes further on, so eight lookups replace eight dependent shifts
+constexpr uint32_t CRC32_POLYNOMIAL = 0xEDB88320u;
+
+struct Crc32Tables {
+    uint32_t t[8][256];
+    Crc32Tables() noexcept {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? (c >> 1) ^ CRC32_POLYNOMIAL : c >> 1;
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int k = 1; k < 8; k++) t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+        }
+    }
+};
+
+uint32_t Crc32(const uint8_t* data, size_t length, uint32_t crc) noexcept {
+    static const Crc32Tables tables;
+    const auto& t = tables.t;
+    crc = ~crc;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        const uint32_t lo = ByteOrder::LoadLE<uint32_t>(data + i) ^ crc;
+        const uint32_t hi = ByteOrder::LoadLE<uint32_t>(data + i + 4);
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    }
+    for (; i < length; i++) crc = (crc >> 8) ^ t[0][(crc ^ data[i]) & 0xFF];
+    return ~crc;
+}
+
+} // namespace Checksum
@@ -0,0 +1,49 @@
+// this_file: src/checksum.h
+// OpenType checksum kernel for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Vectorized big-endian uint32 sums for table checksums and head.checkSumAdjustment, a
+// 64-bit content hash that identifies whole files, and the CRC-32 of ZIP archive entries
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Checksum {
+    // OpenType CalcTableChecksum: sum of big-endian uint32 words modulo 2^32, with a
+    // trailing partial word padded with zero bytes. Words are counted from data.
+    [[nodiscard]] uint32_t SumBE32(const uint8_t* data, size_t length) noexcept;
+
+    // Contribution of `length` bytes at file offset `offset` to a SumBE32 of the whole file
+    // (used to take a field such as checkSumAdjustment out of the file sum)
+    [[nodiscard]] uint32_t BytesContribution(const uint8_t* bytes, size_t length, size_t offset) noexcept;
+
+    // head.checkSumAdjustment target: adjustment = CHECKSUM_MAGIC - file sum (per OpenType spec)
+    constexpr uint32_t CHECKSUM_MAGIC = 0xB1B0AFBA;
+
+    // XXH64 (seed 0) of a byte stream fed in chunks of any size, so a file can be hashed while
+    // it is read or copied. Two files with the same hash are taken to have the same contents.
+    class ContentHasher {
+    public:
+        void Update(const uint8_t* data, size_t length) noexcept;
+
+        // Hash of the bytes so far; never 0, which callers use for "not known"
+        [[nodiscard]] uint64_t Final() const noexcept;
+
+    private:
+        uint64_t acc_[4] = {0x60EA27EEADC0B5D6ull, 0xC2B2AE3D27D4EB4Full, 0, 0x61C8864E7A143579ull};  // Seed 0
+        uint8_t buffer_[32] = {};   // Bytes of an incomplete stripe
+        size_t buffered_ = 0;
+        uint64_t total_ = 0;
+    };
+
+    // ContentHasher over one buffer
+    [[nodiscard]] uint64_t Hash64(const uint8_t* data, size_t length) noexcept;
+
+    // CRC-32 (ISO-HDLC, as in ZIP and zlib's crc32()); pass the previous result as crc to
+    // continue over the next chunk
+    [[nodiscard]] uint32_t Crc32(const uint8_t* data, size_t length, uint32_t crc = 0) noexcept;
+}
+
+#endif // CHECKSUM_H
@@ -0,0 +1,142 @@
+// this_file: src/content_store.cpp
+// Content-addressed font store implementation
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+
+#include "content_store.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <system_error>
+#include <thread>
+
+namespace ContentStore {
+
+constexpr size_t OBJECT_HASH_DIGITS = 16;
+constexpr const char* MARKER_TEXT = "fontlift content store: files are named by their content hash\n";
+
+static std::atomic<uint32_t> g_tempCounter{0};
+
+// Helper: Directory and file name of a path ('\\' or '/' separated)
+static void SplitPath(const std::string& path, std::string& dir, std::string& name) {
+    const size_t slash = path.find_last_of("\\/");
+    dir = slash == std::string::npos ? std::string() : path.substr(0, slash);
+    name = slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// Helper: Temporary name next to an object, unique across threads and processes
+static std::string TempPath(const std::string& objectPath) {
+    const uint64_t stamp = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    const uint64_t thread = std::hash<std::thread::id>()(std::this_thread::get_id());
+    char suffix[64];
+    std::snprintf(suffix, sizeof(suffix), ".partial-%llx-%llx-%x", static_cast<unsigned long long>(stamp),
+                  static_cast<unsigned long long>(thread), static_cast<unsigned>(g_tempCounter++));
+    return objectPath + suffix;
+}
+
+// Helper: Rename a complete temporary file to its object name. Another installer may have
+// put the same contents first, and an object in use cannot be replaced: either way the
+// object is there and the temporary copy is dropped.
+static bool Commit(const std::string& tempPath, const std::string& objectPath, bool& added, std::string& error) {
+    std::error_code ec;
+    std::filesystem::rename(tempPath, objectPath, ec);
+    if (!ec) {
+        added = true;
+        return true;
+    }
+    std::error_code existsEc;
+    const bool present = std::filesystem::exists(objectPath, existsEc);
+    std::remove(tempPath.c_str());
+    if (present) {
+        added = false;
+        return true;
+    }
+    error = "Cannot add to content store: " + ec.message();
+    return false;
+}
+
+std::string Resolve(const std::string& option) {
+    std::string dir = option;
+    if (dir.empty()) {
+        const char* value = std::getenv(STORE_ENVIRONMENT_VARIABLE);
+        if (value) dir = value;
+    }
+    if (dir.empty()) return "";
+    std::error_code ec;
+    const std::filesystem::path absolute = std::filesystem::absolute(dir, ec);
+    if (!ec) dir = absolute.string();
+    while (dir.size() > 3 && (dir.back() == '\\' || dir.back() == '/')) dir.pop_back();
+    return dir;
+}
+
+bool Prepare(const std::string& storeDir, std::string& error) {
+    std::error_code ec;
+    std::filesystem::create_directories(storeDir, ec);
+    if (ec) {
+        error = "Cannot create content store " + storeDir + ": " + ec.message();
+        return false;
+    }
+    const std::string markerPath = storeDir + "\\" + MARKER_FILE;
+    if (std::filesystem::exists(markerPath, ec)) return true;
+    std::FILE* marker = std::fopen(markerPath.c_str(), "wb");
+    const bool written = marker && std::fputs(MARKER_TEXT, marker) >= 0;
+    if (!marker || std::fclose(marker) != 0 || !written) {
+        error = "Cannot write content store marker: " + markerPath;
+        return false;
+    }
+    return true;
+}
+
+std::string ObjectPath(const std::string& storeDir, uint64_t hash, const std::string& fileName) {
+    char digits[OBJECT_HASH_DIGITS + 1];
+    std::snprintf(digits, sizeof(digits), "%016llx", static_cast<unsigned long long>(hash));
+    std::string path = storeDir + "\\" + digits;
+    const size_t dot = fileName.find_last_of('.');
+    if (dot != std::string::npos && fileName.find_first_of("\\/", dot) == std::string::npos) {
+        for (size_t i = dot; i < fileName.size(); i++) {
+            const char c = fileName[i];
+            path += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+    }
+    return path;
+}
+
+bool IsObject(const std::string& path) {
+    std::string dir, name;
+    SplitPath(path, dir, name);
+    if (dir.empty() || name.size() <= OBJECT_HASH_DIGITS || name[OBJECT_HASH_DIGITS] != '.') return false;
+    for (size_t i = 0; i < OBJECT_HASH_DIGITS; i++) {
+        const char c = name[i];
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) return false;
+    }
+    std::error_code ec;
+    return std::filesystem::is_regular_file(dir + "\\" + MARKER_FILE, ec);
+}
+
+bool Put(const std::string& objectPath, const ContentWriter& write, bool& added, std::string& error) {
+    added = false;
+    std::error_code ec;
+    if (std::filesystem::exists(objectPath, ec)) return true;
+    const std::string tempPath = TempPath(objectPath);
+    if (!write(tempPath, error)) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return Commit(tempPath, objectPath, added, error);
+}
+
+bool Put(const std::string& objectPath, const uint8_t* data, size_t size, bool& added, std::string& error) {
+    return Put(objectPath, [data, size](const std::string& tempPath, std::string& writeError) {
+        std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+        const bool written = file && std::fwrite(data, 1, size, file) == size;
+        if (!file || std::fclose(file) != 0 || !written) {
+            writeError = "Failed to write font file: " + tempPath;
+            return false;
+        }
+        return true;
+    }, added, error);
+}
+
+} // namespace ContentStore
@@ -0,0 +1,51 @@
+// this_file: src/content_store.h
+// Content-addressed font store for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Font files named by their content hash, shared by every install that registers them
+
+#ifndef CONTENT_STORE_H
+#define CONTENT_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace ContentStore {
+    // Environment variable naming the store directory when --store is not given
+    constexpr const char* STORE_ENVIRONMENT_VARIABLE = "FONTLIFT_STORE";
+
+    // File that marks a directory as a store; files next to it are never deleted by remove
+    constexpr const char* MARKER_FILE = "fontlift.store";
+
+    // A store is one directory of objects named <16 hex digits of Checksum::Hash64><.ext>,
+    // e.g. 9f86d081884c7d65.otf. An object's name is its contents: once an object exists it is
+    // never rewritten, so registry entries of any user or scope can point at it.
+
+    // Store directory to use: option (from --store), else FONTLIFT_STORE, as an absolute path
+    // without a trailing separator; empty if neither is set
+    [[nodiscard]] std::string Resolve(const std::string& option);
+
+    // Create the store directory and its marker file if missing; error says why not
+    bool Prepare(const std::string& storeDir, std::string& error);
+
+    // Path of the object with this hash; the extension is taken from fileName (lowercase)
+    [[nodiscard]] std::string ObjectPath(const std::string& storeDir, uint64_t hash, const std::string& fileName);
+
+    // True if the path names an object of a store (its name has the object form and its
+    // directory has the marker file)
+    [[nodiscard]] bool IsObject(const std::string& path);
+
+    // Put a buffer into the store under objectPath unless the object is already there. The
+    // contents are written to a temporary name and renamed, so an object name never holds
+    // partial contents, and concurrent installers of the same contents agree.
+    // added: false if the object was already present and nothing was written
+    bool Put(const std::string& objectPath, const uint8_t* data, size_t size, bool& added, std::string& error);
+
+    // Put with the caller's own way of writing the contents: write creates the temporary file
+    // it is given, complete, or says why not (a failed write's file is removed)
+    using ContentWriter = std::function<bool(const std::string& tempPath, std::string& error)>;
+    bool Put(const std::string& objectPath, const ContentWriter& write, bool& added, std::string& error);
+}
+
+#endif // CONTENT_STORE_H
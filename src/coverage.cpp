@@ -0,0 +1,489 @@
+// this_file: src/coverage.cpp
+// Unicode coverage implementation
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+
+#include "coverage.h"
+#include "byte_order.h"
+#include "opentype.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+namespace Coverage {
+
+namespace Cmap = OpenType::Cmap;
+using OpenType::Field;
+
+// cmap subtable preference (higher wins)
+constexpr int SUBTABLE_FULL_UNICODE = 3;    // Format 12, Windows UCS-4 (3,10) or Unicode platform
+constexpr int SUBTABLE_BMP = 2;             // Format 4, Windows BMP (3,1) or Unicode platform
+constexpr int SUBTABLE_SYMBOL = 1;          // Format 4, Windows Symbol (3,0)
+constexpr uint32_t FORMAT4_LAST = 0xFFFE;   // U+FFFF terminates format 4 segment lists
+
+// Index file layout (big-endian, like the font data it is built from)
+constexpr uint32_t INDEX_MAGIC = ByteOrder::MakeTag("FLCV");
+constexpr uint16_t INDEX_VERSION = 1;
+namespace IndexHeader {
+    using Magic = Field<uint32_t, 0>;
+    using Version = Field<uint16_t, 4>;
+    using EntryCount = Field<uint32_t, 8>;
+    constexpr size_t SIZE = 12;
+}
+namespace IndexRecord {
+    using PathLength = Field<uint16_t, 0>;
+    using FamilyLength = Field<uint16_t, 2>;
+    using FaceIndex = Field<uint32_t, 4>;
+    using FileSize = Field<uint64_t, 8>;
+    using Modified = Field<uint64_t, 16>;
+    constexpr size_t SIZE = 24;              // Followed by path, family name, and codepoint set
+}
+constexpr size_t MIN_SERIALIZED_SET = 2;     // Block count of an empty set
+
+void NormalizeRanges(std::vector<CodepointRange>& ranges) {
+    std::sort(ranges.begin(), ranges.end(), [](const CodepointRange& a, const CodepointRange& b) {
+        return a.first != b.first ? a.first < b.first : a.last < b.last;
+    });
+    size_t out = 0;
+    for (size_t i = 0; i < ranges.size(); i++) {
+        if (out > 0 && ranges[i].first <= ranges[out - 1].last + 1) {
+            ranges[out - 1].last = std::max(ranges[out - 1].last, ranges[i].last);
+        } else {
+            ranges[out++] = ranges[i];
+        }
+    }
+    ranges.resize(out);
+}
+
+// Helper: Append [first, last] to ranges, extending the previous range when contiguous
+static void AddRange(std::vector<CodepointRange>& ranges, uint32_t first, uint32_t last) {
+    if (first > last) return;
+    if (!ranges.empty() && ranges.back().last + 1 == first) {
+        ranges.back().last = last;
+    } else {
+        ranges.push_back(CodepointRange{first, last});
+    }
+}
+
+// Helper: Decode a format 4 subtable (segment mapping to delta values).
+// Segments without idRangeOffset map every codepoint by delta; the one codepoint whose glyph
+// wraps to 0 is excluded. Other segments look each codepoint up in glyphIdArray.
+static bool ReadFormat4(ByteSpan subtable, std::vector<CodepointRange>& ranges) {
+    const size_t segCountX2 = Cmap::Format4::SegCountX2::Get(subtable);
+    const size_t endCodes = Cmap::Format4::END_CODES;
+    const size_t startCodes = endCodes + segCountX2 + 2;  // Skip reservedPad
+    const size_t idDeltas = startCodes + segCountX2;
+    const size_t idRangeOffsets = idDeltas + segCountX2;
+    if (segCountX2 == 0 || !subtable.Contains(idRangeOffsets, segCountX2)) return false;
+
+    for (size_t seg = 0; seg < segCountX2; seg += 2) {
+        uint16_t end = 0, start = 0, delta = 0, rangeOffset = 0;
+        subtable.Read(endCodes + seg, end);
+        subtable.Read(startCodes + seg, start);
+        subtable.Read(idDeltas + seg, delta);
+        subtable.Read(idRangeOffsets + seg, rangeOffset);
+        const uint32_t last = std::min<uint32_t>(end, FORMAT4_LAST);
+        if (start > last) continue;
+
+        if (rangeOffset == 0) {
+            const uint32_t unmapped = (0x10000u - delta) & 0xFFFF;  // (c + delta) mod 65536 == 0
+            if (unmapped >= start && unmapped <= last) {
+                if (unmapped > start) AddRange(ranges, start, unmapped - 1);
+                AddRange(ranges, unmapped + 1, last);
+            } else {
+                AddRange(ranges, start, last);
+            }
+            continue;
+        }
+
+        // idRangeOffset is relative to its own position in the idRangeOffset array
+        const size_t glyphIds = idRangeOffsets + seg + rangeOffset;
+        for (uint32_t c = start; c <= last; c++) {
+            uint16_t glyph = 0;
+            if (!subtable.Read(glyphIds + 2 * (c - start), glyph)) break;  // Past the table
+            if (glyph != 0 && static_cast<uint16_t>(glyph + delta) != 0) AddRange(ranges, c, c);
+        }
+    }
+    return true;
+}
+
+// Helper: Decode a format 12 subtable (segmented coverage); a group starting at glyph 0 maps
+// only its first codepoint to .notdef
+static bool ReadFormat12(ByteSpan subtable, std::vector<CodepointRange>& ranges) {
+    namespace Group = Cmap::Format12::Group;
+    if (subtable.size() < Cmap::Format12::GROUPS) return false;
+    const size_t available = (subtable.size() - Cmap::Format12::GROUPS) / Group::SIZE;
+    const size_t groupCount = std::min<size_t>(Cmap::Format12::NumGroups::Get(subtable), available);
+
+    for (size_t g = 0; g < groupCount; g++) {
+        const ByteSpan group = subtable.Subspan(Cmap::Format12::GROUPS + g * Group::SIZE, Group::SIZE);
+        uint32_t first = Group::StartCharCode::Get(group);
+        const uint32_t last = std::min(Group::EndCharCode::Get(group), MAX_CODEPOINT);
+        if (Group::StartGlyphID::Get(group) == 0) first++;
+        if (first <= last) ranges.push_back(CodepointRange{first, last});
+    }
+    return true;
+}
+
+// Helper: Preference of a cmap subtable for Unicode coverage (0 = not usable)
+static int SubtableRank(uint16_t platformID, uint16_t encodingID, uint16_t format) noexcept {
+    const bool unicodePlatform = platformID == 0;
+    if (format == 12 && (unicodePlatform || (platformID == 3 && encodingID == 10))) return SUBTABLE_FULL_UNICODE;
+    if (format == 4 && (unicodePlatform || (platformID == 3 && encodingID == 1))) return SUBTABLE_BMP;
+    if (format == 4 && platformID == 3 && encodingID == 0) return SUBTABLE_SYMBOL;
+    return 0;
+}
+
+bool ReadCmap(ByteSpan cmap, std::vector<CodepointRange>& ranges) {
+    namespace EncodingRecord = Cmap::EncodingRecord;
+    ranges.clear();
+    if (cmap.size() < Cmap::HEADER_SIZE) return false;
+    const size_t available = (cmap.size() - Cmap::HEADER_SIZE) / EncodingRecord::SIZE;
+    const size_t recordCount = std::min<size_t>(Cmap::NumTables::Get(cmap), available);
+
+    // First record of the highest rank wins
+    int bestRank = 0;
+    ByteSpan best;
+    uint16_t bestFormat = 0;
+    for (size_t r = 0; r < recordCount; r++) {
+        const ByteSpan record = cmap.Subspan(Cmap::HEADER_SIZE + r * EncodingRecord::SIZE, EncodingRecord::SIZE);
+        const uint32_t offset = EncodingRecord::SubtableOffset::Get(record);
+        if (offset >= cmap.size()) continue;
+        // Subtable length fields are unreliable (format 4 tables over 64 KB wrap them), so
+        // each subtable is bounded by the end of the cmap table instead
+        const ByteSpan subtable = cmap.Subspan(offset, cmap.size() - offset);
+        const uint16_t format = Cmap::SubtableFormat::Get(subtable);
+        const int rank = SubtableRank(EncodingRecord::PlatformID::Get(record), EncodingRecord::EncodingID::Get(record), format);
+        if (rank > bestRank) {
+            bestRank = rank;
+            best = subtable;
+            bestFormat = format;
+        }
+    }
+    if (bestRank == 0) return false;
+
+    const bool ok = bestFormat == 12 ? ReadFormat12(best, ranges) : ReadFormat4(best, ranges);
+    NormalizeRanges(ranges);
+    return ok;
+}
+
+// Population count of (a AND b) over one BLOCK_BYTES bitmap pair
+
+#if defined(FONTLIFT_SIMD_AVX2)
+
+// Helper: One 256-bit AND, nibble-table popcount (pshufb), and horizontal byte sum (psadbw)
+static inline uint32_t AndCount(const uint8_t* a, const uint8_t* b) noexcept {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowNibble = _mm256_set1_epi8(0x0F);
+    const __m256i v = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a)),
+                                       _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)));
+    const __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(v, lowNibble)),
+                                           _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibble)));
+    const __m256i sums = _mm256_sad_epu8(counts, _mm256_setzero_si256());
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(sum));
+}
+
+#elif defined(FONTLIFT_SIMD_SSE2)
+
+// Helper: Per-byte population counts (SSE2 has no byte shuffle: bit-slice with 16-bit shifts)
+static inline __m128i ByteCounts(__m128i v) noexcept {
+    const __m128i m1 = _mm_set1_epi8(0x55);
+    const __m128i m2 = _mm_set1_epi8(0x33);
+    const __m128i m4 = _mm_set1_epi8(0x0F);
+    v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi16(v, 1), m1));
+    v = _mm_add_epi8(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi16(v, 2), m2));
+    return _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi16(v, 4)), m4);
+}
+
+// Helper: Two 128-bit ANDs, byte popcounts, and horizontal byte sum (psadbw)
+static inline uint32_t AndCount(const uint8_t* a, const uint8_t* b) noexcept {
+    const __m128i v0 = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+    const __m128i v1 = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 16)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 16)));
+    const __m128i sums = _mm_sad_epu8(_mm_add_epi8(ByteCounts(v0), ByteCounts(v1)), _mm_setzero_si128());
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_add_epi64(sums, _mm_unpackhi_epi64(sums, sums))));
+}
+
+#elif defined(FONTLIFT_SIMD_NEON)
+
+// Helper: Two 128-bit ANDs, vcnt byte popcounts, and pairwise widening sums
+static inline uint32_t AndCount(const uint8_t* a, const uint8_t* b) noexcept {
+    const uint8x16_t counts = vaddq_u8(vcntq_u8(vandq_u8(vld1q_u8(a), vld1q_u8(b))),
+                                       vcntq_u8(vandq_u8(vld1q_u8(a + 16), vld1q_u8(b + 16))));
+    const uint64x2_t sums = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(counts)));
+    return static_cast<uint32_t>(vgetq_lane_u64(sums, 0) + vgetq_lane_u64(sums, 1));
+}
+
+#else
+
+// Helper: Population count of a 64-bit word (SWAR)
+static inline uint32_t PopCount64(uint64_t v) noexcept {
+    v = v - ((v >> 1) & 0x5555555555555555ull);
+    v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return static_cast<uint32_t>((v * 0x0101010101010101ull) >> 56);
+}
+
+// Helper: Four 64-bit ANDs and popcounts
+static inline uint32_t AndCount(const uint8_t* a, const uint8_t* b) noexcept {
+    uint32_t count = 0;
+    for (size_t i = 0; i < BLOCK_BYTES; i += sizeof(uint64_t)) {
+        uint64_t wa, wb;
+        std::memcpy(&wa, a + i, sizeof(wa));
+        std::memcpy(&wb, b + i, sizeof(wb));
+        count += PopCount64(wa & wb);
+    }
+    return count;
+}
+
+#endif
+
+// Helper: Set bits lo..hi (inclusive, both within one block) of a block bitmap
+static void SetBits(uint8_t* bitmap, uint32_t lo, uint32_t hi) noexcept {
+    for (; lo <= hi && (lo & 7) != 0; lo++) bitmap[lo >> 3] |= static_cast<uint8_t>(1u << (lo & 7));
+    if (lo + 7 <= hi) {
+        const uint32_t bytes = (hi + 1 - lo) >> 3;
+        std::memset(bitmap + (lo >> 3), 0xFF, bytes);
+        lo += bytes << 3;
+    }
+    for (; lo <= hi; lo++) bitmap[lo >> 3] |= static_cast<uint8_t>(1u << (lo & 7));
+}
+
+CodepointSet::CodepointSet(std::vector<CodepointRange> ranges) {
+    NormalizeRanges(ranges);
+    for (const CodepointRange& range : ranges) {
+        if (range.first > MAX_CODEPOINT) break;
+        const uint32_t last = std::min(range.last, MAX_CODEPOINT);
+        for (uint32_t block = range.first / BLOCK_CODEPOINTS; block <= last / BLOCK_CODEPOINTS; block++) {
+            if (blocks_.empty() || blocks_.back() != block) {
+                blocks_.push_back(static_cast<uint16_t>(block));
+                bits_.resize(bits_.size() + BLOCK_BYTES, 0);
+            }
+            const uint32_t base = block * BLOCK_CODEPOINTS;
+            const uint32_t lo = std::max(range.first, base) - base;
+            const uint32_t hi = std::min(last, base + BLOCK_CODEPOINTS - 1) - base;
+            SetBits(bits_.data() + bits_.size() - BLOCK_BYTES, lo, hi);
+            count_ += hi - lo + 1;  // Normalized ranges never overlap
+        }
+    }
+}
+
+bool CodepointSet::Contains(uint32_t codepoint) const noexcept {
+    const uint32_t block = codepoint / BLOCK_CODEPOINTS;
+    const auto it = std::lower_bound(blocks_.begin(), blocks_.end(), block);
+    if (it == blocks_.end() || *it != block) return false;
+    const uint32_t bit = codepoint % BLOCK_CODEPOINTS;
+    return (bits_[static_cast<size_t>(it - blocks_.begin()) * BLOCK_BYTES + bit / 8] >> (bit & 7)) & 1;
+}
+
+uint32_t CodepointSet::CountShared(const CodepointSet& other) const noexcept {
+    // Walk the smaller set's blocks and binary-search the larger one for each (both sorted,
+    // so every search starts where the previous one ended)
+    const CodepointSet& small = blocks_.size() <= other.blocks_.size() ? *this : other;
+    const CodepointSet& large = blocks_.size() <= other.blocks_.size() ? other : *this;
+    uint32_t shared = 0;
+    auto from = large.blocks_.begin();
+    for (size_t i = 0; i < small.blocks_.size() && from != large.blocks_.end(); i++) {
+        from = std::lower_bound(from, large.blocks_.end(), small.blocks_[i]);
+        if (from == large.blocks_.end() || *from != small.blocks_[i]) continue;
+        const size_t j = static_cast<size_t>(from - large.blocks_.begin());
+        shared += AndCount(small.bits_.data() + i * BLOCK_BYTES, large.bits_.data() + j * BLOCK_BYTES);
+    }
+    return shared;
+}
+
+// Helper: Append a big-endian integer
+template <typename T>
+static void Append(std::vector<uint8_t>& out, T value) {
+    const size_t at = out.size();
+    out.resize(at + sizeof(T));
+    ByteOrder::StoreBE(out.data() + at, value);
+}
+
+void CodepointSet::Serialize(std::vector<uint8_t>& out) const {
+    Append(out, static_cast<uint16_t>(blocks_.size()));
+    for (uint16_t block : blocks_) Append(out, block);
+    out.insert(out.end(), bits_.begin(), bits_.end());
+}
+
+bool CodepointSet::Deserialize(ByteSpan data, size_t& pos) {
+    constexpr uint32_t MAX_BLOCK = MAX_CODEPOINT / BLOCK_CODEPOINTS;
+    uint16_t blockCount = 0;
+    if (!data.Read(pos, blockCount) || blockCount > MAX_BLOCK + 1) return false;
+    const size_t blocksAt = pos + sizeof(uint16_t);
+    const size_t bitsAt = blocksAt + static_cast<size_t>(blockCount) * sizeof(uint16_t);
+    const ByteSpan bits = data.Subspan(bitsAt, static_cast<size_t>(blockCount) * BLOCK_BYTES);
+    if (blockCount != 0 && bits.empty()) return false;
+
+    blocks_.resize(blockCount);
+    for (size_t i = 0; i < blockCount; i++) {
+        blocks_[i] = ByteOrder::LoadBE<uint16_t>(data.data() + blocksAt + i * sizeof(uint16_t));
+        if (blocks_[i] > MAX_BLOCK || (i > 0 && blocks_[i] <= blocks_[i - 1])) return false;  // Must ascend
+    }
+    bits_.assign(bits.data(), bits.data() + bits.size());
+    count_ = 0;
+    for (size_t i = 0; i < blockCount; i++) {
+        const uint8_t* bitmap = bits_.data() + i * BLOCK_BYTES;
+        count_ += AndCount(bitmap, bitmap);
+    }
+    pos = bitsAt + bits.size();
+    return true;
+}
+
+// Helper: Parse 1-6 hexadecimal digits at p, advancing p
+static bool ParseHex(const char*& p, uint32_t& value) noexcept {
+    value = 0;
+    size_t digits = 0;
+    for (;; p++, digits++) {
+        const char c = *p;
+        uint32_t digit;
+        if (c >= '0' && c <= '9') digit = static_cast<uint32_t>(c - '0');
+        else if (c >= 'a' && c <= 'f') digit = static_cast<uint32_t>(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') digit = static_cast<uint32_t>(c - 'A' + 10);
+        else break;
+        if (digits == 6) return false;
+        value = value * 16 + digit;
+    }
+    return digits > 0 && value <= MAX_CODEPOINT;
+}
+
+// Helper: Skip an optional "U+" prefix
+static void SkipUnicodePrefix(const char*& p) noexcept {
+    if ((p[0] == 'U' || p[0] == 'u') && p[1] == '+') p += 2;
+}
+
+bool ParseCodepoints(const char* spec, std::vector<CodepointRange>& ranges) {
+    // Items are separated by commas or spaces, so "U+41,U+42" and "41 42" both work
+    const char* p = spec;
+    bool any = false;
+    while (*p) {
+        if (*p == ',' || *p == ' ') {
+            p++;
+            continue;
+        }
+        uint32_t first = 0, last = 0;
+        SkipUnicodePrefix(p);
+        if (!ParseHex(p, first)) return false;
+        last = first;
+        if (*p == '-' || (p[0] == '.' && p[1] == '.')) {
+            p += *p == '-' ? 1 : 2;
+            SkipUnicodePrefix(p);
+            if (!ParseHex(p, last) || last < first) return false;
+        }
+        if (*p && *p != ',' && *p != ' ') return false;
+        ranges.push_back(CodepointRange{first, last});
+        any = true;
+    }
+    return any;
+}
+
+bool DecodeUtf8(const char* text, std::vector<CodepointRange>& ranges) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(text);
+    while (*p) {
+        const uint8_t lead = *p++;
+        uint32_t codepoint;
+        size_t trailing;
+        if (lead < 0x80) { codepoint = lead; trailing = 0; }
+        else if (lead >= 0xC2 && lead < 0xE0) { codepoint = lead & 0x1F; trailing = 1; }
+        else if (lead >= 0xE0 && lead < 0xF0) { codepoint = lead & 0x0F; trailing = 2; }
+        else if (lead >= 0xF0 && lead < 0xF5) { codepoint = lead & 0x07; trailing = 3; }
+        else return false;  // Continuation byte, overlong C0/C1 lead, or past U+10FFFF
+
+        for (size_t i = 0; i < trailing; i++, p++) {
+            if ((*p & 0xC0) != 0x80) return false;  // Also stops at the terminator
+            codepoint = (codepoint << 6) | (*p & 0x3F);
+        }
+        static const uint32_t minimum[] = {0, 0x80, 0x800, 0x10000};
+        if (codepoint < minimum[trailing] || codepoint > MAX_CODEPOINT) return false;  // Overlong or too large
+        if (codepoint >= 0xD800 && codepoint <= 0xDFFF) return false;                 // Surrogate
+        ranges.push_back(CodepointRange{codepoint, codepoint});
+    }
+    return true;
+}
+
+bool LoadIndex(const char* path, std::vector<IndexEntry>& entries) {
+    entries.clear();
+    FontIO::MappedFile file(path);
+    if (!file.IsOpen()) return false;
+    const ByteSpan data = file.Bytes();
+    if (data.size() < IndexHeader::SIZE || IndexHeader::Magic::Get(data) != INDEX_MAGIC ||
+        IndexHeader::Version::Get(data) != INDEX_VERSION) {
+        return false;
+    }
+
+    // Every entry takes at least a record and an empty set, which bounds a damaged count
+    const uint32_t count = IndexHeader::EntryCount::Get(data);
+    if (count > (data.size() - IndexHeader::SIZE) / (IndexRecord::SIZE + MIN_SERIALIZED_SET)) return false;
+
+    entries.resize(count);
+    size_t pos = IndexHeader::SIZE;
+    for (IndexEntry& entry : entries) {
+        const ByteSpan record = data.Subspan(pos, IndexRecord::SIZE);
+        const size_t pathLength = IndexRecord::PathLength::Get(record);
+        const size_t familyLength = IndexRecord::FamilyLength::Get(record);
+        const ByteSpan strings = data.Subspan(pos + IndexRecord::SIZE, pathLength + familyLength);
+        if (record.empty() || strings.size() != pathLength + familyLength || pathLength == 0) {
+            entries.clear();
+            return false;
+        }
+        entry.path.assign(reinterpret_cast<const char*>(strings.data()), pathLength);
+        entry.familyName.assign(reinterpret_cast<const char*>(strings.data()) + pathLength, familyLength);
+        entry.faceIndex = IndexRecord::FaceIndex::Get(record);
+        entry.fileSize = IndexRecord::FileSize::Get(record);
+        entry.modified = static_cast<int64_t>(IndexRecord::Modified::Get(record));
+        pos += IndexRecord::SIZE + strings.size();
+        if (!entry.coverage.Deserialize(data, pos)) {
+            entries.clear();
+            return false;
+        }
+    }
+    if (pos != data.size()) {  // Trailing bytes: not an index this version wrote
+        entries.clear();
+        return false;
+    }
+    return true;
+}
+
+bool SaveIndex(const char* path, const std::vector<IndexEntry>& entries) {
+    std::vector<uint8_t> out;
+    Append(out, INDEX_MAGIC);
+    Append(out, INDEX_VERSION);
+    Append(out, static_cast<uint16_t>(0));  // Reserved
+    Append(out, static_cast<uint32_t>(entries.size()));
+    for (const IndexEntry& entry : entries) {
+        if (entry.path.empty() || entry.path.size() > UINT16_MAX || entry.familyName.size() > UINT16_MAX) return false;
+        Append(out, static_cast<uint16_t>(entry.path.size()));
+        Append(out, static_cast<uint16_t>(entry.familyName.size()));
+        Append(out, entry.faceIndex);
+        Append(out, entry.fileSize);
+        Append(out, static_cast<uint64_t>(entry.modified));
+        out.insert(out.end(), entry.path.begin(), entry.path.end());
+        out.insert(out.end(), entry.familyName.begin(), entry.familyName.end());
+        entry.coverage.Serialize(out);
+    }
+
+    const std::string tempPath = std::string(path) + ".tmp";
+    std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) return false;
+    const bool written = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    if (std::fclose(file) != 0 || !written) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);  // Replaces an existing index
+    if (ec) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace Coverage
@@ -0,0 +1,89 @@
+// this_file: src/coverage.h
+// Unicode coverage for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// cmap decoding into codepoint ranges, sparse codepoint bitsets with vectorized intersection, and the persistent coverage index
+
+#ifndef COVERAGE_H
+#define COVERAGE_H
+
+#include "font_io.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Coverage {
+    using FontIO::ByteSpan;
+
+    constexpr uint32_t MAX_CODEPOINT = 0x10FFFF;     // Last Unicode scalar value
+    constexpr uint32_t BLOCK_CODEPOINTS = 256;       // Codepoints per bitmap block
+    constexpr size_t BLOCK_BYTES = BLOCK_CODEPOINTS / 8;
+
+    // Inclusive codepoint range
+    struct CodepointRange {
+        uint32_t first;
+        uint32_t last;
+    };
+
+    // Sort ranges and merge overlapping or adjacent ones
+    void NormalizeRanges(std::vector<CodepointRange>& ranges);
+
+    // Codepoints mapped by the best Unicode subtable of a cmap table: format 12 (3,10)/(0,*)
+    // before format 4 (3,1)/(0,*) before format 4 (3,0). Codepoints mapped to glyph 0 are left
+    // out. Ranges come out normalized; returns false if there is no usable subtable.
+    bool ReadCmap(ByteSpan cmap, std::vector<CodepointRange>& ranges);
+
+    // Set of codepoints stored as the 256-codepoint blocks that have members: sorted block
+    // numbers plus one 32-byte bitmap per block. Scripts cluster, so a font's set is a few
+    // kilobytes even for CJK, and intersections touch only blocks both sets have.
+    class CodepointSet {
+    public:
+        CodepointSet() = default;
+        explicit CodepointSet(std::vector<CodepointRange> ranges);
+
+        [[nodiscard]] bool Empty() const noexcept { return blocks_.empty(); }
+        [[nodiscard]] uint32_t Count() const noexcept { return count_; }
+        [[nodiscard]] size_t BlockCount() const noexcept { return blocks_.size(); }
+        [[nodiscard]] bool Contains(uint32_t codepoint) const noexcept;
+
+        // Number of codepoints in both sets (vectorized AND + popcount per shared block)
+        [[nodiscard]] uint32_t CountShared(const CodepointSet& other) const noexcept;
+
+        // Append the set to out; Deserialize reads it back from data at pos (advancing pos)
+        // and returns false on truncated or inconsistent data
+        void Serialize(std::vector<uint8_t>& out) const;
+        bool Deserialize(ByteSpan data, size_t& pos);
+
+    private:
+        std::vector<uint16_t> blocks_;  // Block numbers (codepoint / BLOCK_CODEPOINTS), ascending
+        std::vector<uint8_t> bits_;     // BLOCK_BYTES per block; bit (cp & 7) of byte (cp % 256) / 8
+        uint32_t count_ = 0;
+    };
+
+    // Parse one codepoint item: "U+0041", "0041", or a range "U+4E00-9FFF" / "4E00..9FFF"
+    // (hexadecimal). Returns false for malformed items, reversed ranges, or values past U+10FFFF.
+    bool ParseCodepoints(const char* spec, std::vector<CodepointRange>& ranges);
+
+    // Codepoints of UTF-8 text; returns false on invalid UTF-8
+    bool DecodeUtf8(const char* text, std::vector<CodepointRange>& ranges);
+
+    // One face in the coverage index, with the file state it was read from
+    struct IndexEntry {
+        std::string path;
+        std::string familyName;    // Empty for a file that could not be read (kept so it is not reread)
+        uint32_t faceIndex = 0;    // Face within a TTC/OTC
+        uint64_t fileSize = 0;
+        int64_t modified = 0;      // Last write time in file clock ticks
+        CodepointSet coverage;
+    };
+
+    // Load the index file; returns false (entries left empty) if it is missing, written by
+    // another index version, or damaged
+    bool LoadIndex(const char* path, std::vector<IndexEntry>& entries);
+
+    // Write the index to a temporary file and rename it over path, so readers never see a
+    // partial index
+    bool SaveIndex(const char* path, const std::vector<IndexEntry>& entries);
+}
+
+#endif // COVERAGE_H
@@ -0,0 +1,464 @@
+// this_file: src/font_io.cpp
+// Font file I/O implementation
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+
+#include "font_io.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace FontIO {
+// Memory-mapped and planned positional file access shared by the font parser
+
+constexpr size_t SKIP_CHUNK = 16 * 1024;             // Discard buffer when skipping in a pipe
+
+#ifdef _WIN32
+constexpr DWORD MAX_READ_CHUNK = 0x40000000;         // Largest single ReadFile request (1 GB)
+#else
+constexpr size_t MAX_READ_CHUNK = 0x40000000;        // Largest single pread request (1 GB)
+
+// statfs f_type values of network filesystems (linux/magic.h)
+constexpr unsigned long NFS_SUPER_MAGIC = 0x6969;
+constexpr unsigned long SMB_SUPER_MAGIC = 0x517B;
+constexpr unsigned long CIFS_SUPER_MAGIC = 0xFF534D42;
+constexpr unsigned long SMB2_SUPER_MAGIC = 0xFE534D42;
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const char* path) noexcept {
+    Close();
+    if (!path || path[0] == '\0') return false;
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0 ||
+        static_cast<unsigned long long>(fileSize.QuadPart) > SIZE_MAX) {
+        CloseHandle(file);
+        return false;  // Empty files cannot be mapped
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);  // Mapping object keeps the file open
+    if (!mapping) return false;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);  // View keeps the mapping alive
+    if (!view) return false;
+
+    data_ = static_cast<const uint8_t*>(view);
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::Close() noexcept {
+    if (data_) UnmapViewOfFile(data_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+#else
+
+bool MappedFile::Open(const char* path) noexcept {
+    Close();
+    if (!path || path[0] == '\0') return false;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        close(fd);
+        return false;  // Empty files and non-regular files cannot be mapped
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // Mapping stays valid after the descriptor is closed
+    if (view == MAP_FAILED) return false;
+
+    data_ = static_cast<const uint8_t*>(view);
+    size_ = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::Close() noexcept {
+    if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+#endif
+
+#ifdef _WIN32
+
+bool FileReader::Open(const char* path) noexcept {
+    Close();
+    if (!path || path[0] == '\0') return false;
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < 0) {
+        CloseHandle(file);
+        return false;
+    }
+    handle_ = file;
+    size_ = static_cast<uint64_t>(fileSize.QuadPart);
+    stats_ = IoStats{};
+    return true;
+}
+
+void FileReader::Close() noexcept {
+    if (handle_) CloseHandle(static_cast<HANDLE>(handle_));
+    handle_ = nullptr;
+    size_ = 0;
+}
+
+bool FileReader::IsOpen() const noexcept {
+    return handle_ != nullptr;
+}
+
+bool FileReader::ReadAt(uint64_t offset, uint8_t* dst, size_t length) noexcept {
+    if (!handle_ || offset > size_ || length > size_ - offset) return false;
+    while (length > 0) {
+        // Positional read: the OVERLAPPED offset is honoured on synchronous handles
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFu);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        const DWORD request = length > MAX_READ_CHUNK ? MAX_READ_CHUNK : static_cast<DWORD>(length);
+        DWORD got = 0;
+        stats_.readCalls++;
+        if (!ReadFile(static_cast<HANDLE>(handle_), dst, request, &got, &overlapped) || got == 0) return false;
+        stats_.bytesRead += got;
+        offset += got;
+        dst += got;
+        length -= got;
+    }
+    return true;
+}
+
+bool StreamReader::Open(const char* path) noexcept {
+    Close();
+    if (!path || path[0] == '\0') return false;
+
+    if (strcmp(path, STDIN_PATH) == 0) {
+        HANDLE input = GetStdHandle(STD_INPUT_HANDLE);
+        if (input == NULL || input == INVALID_HANDLE_VALUE) return false;
+        handle_ = input;
+        ownsHandle_ = false;
+        seekable_ = GetFileType(input) == FILE_TYPE_DISK;  // Redirected file, not a pipe
+    } else {
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        handle_ = file;
+        ownsHandle_ = true;
+        seekable_ = true;
+    }
+    stats_ = IoStats{};
+    return true;
+}
+
+void StreamReader::Close() noexcept {
+    if (handle_ && ownsHandle_) CloseHandle(static_cast<HANDLE>(handle_));
+    handle_ = nullptr;
+    ownsHandle_ = false;
+}
+
+bool StreamReader::IsOpen() const noexcept {
+    return handle_ != nullptr;
+}
+
+size_t StreamReader::Read(uint8_t* dst, size_t length) noexcept {
+    if (!handle_ || length == 0) return 0;
+    const DWORD request = length > MAX_READ_CHUNK ? MAX_READ_CHUNK : static_cast<DWORD>(length);
+    DWORD got = 0;
+    stats_.readCalls++;
+    // A closed pipe reports ERROR_BROKEN_PIPE, which is the end of the stream
+    if (!ReadFile(static_cast<HANDLE>(handle_), dst, request, &got, NULL)) return 0;
+    stats_.bytesRead += got;
+    return got;
+}
+
+bool StreamReader::Skip(uint64_t length) noexcept {
+    if (!handle_) return false;
+    if (seekable_) {
+        LARGE_INTEGER distance{};
+        distance.QuadPart = static_cast<LONGLONG>(length);
+        return SetFilePointerEx(static_cast<HANDLE>(handle_), distance, NULL, FILE_CURRENT) != 0;
+    }
+    uint8_t scratch[SKIP_CHUNK];
+    while (length > 0) {
+        const size_t got = Read(scratch, length < SKIP_CHUNK ? static_cast<size_t>(length) : SKIP_CHUNK);
+        if (got == 0) return true;  // End of stream
+        length -= got;
+    }
+    return true;
+}
+
+bool IsRemotePath(const char* path) noexcept {
+    if (!path || path[0] == '\0') return false;
+    // UNC paths (\\server\share) are always remote
+    if ((path[0] == '\\' || path[0] == '/') && (path[1] == '\\' || path[1] == '/')) return true;
+
+    char fullPath[MAX_PATH];
+    DWORD length = GetFullPathNameA(path, MAX_PATH, fullPath, NULL);
+    if (length == 0 || length >= MAX_PATH || fullPath[1] != ':') return false;
+    const char root[] = {fullPath[0], ':', '\\', '\0'};
+    return GetDriveTypeA(root) == DRIVE_REMOTE;
+}
+
+#else
+
+bool FileReader::Open(const char* path) noexcept {
+    Close();
+    if (!path || path[0] == '\0') return false;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return false;
+    }
+    fd_ = fd;
+    size_ = static_cast<uint64_t>(st.st_size);
+    stats_ = IoStats{};
+    return true;
+}
+
+void FileReader::Close() noexcept {
+    if (fd_ >= 0) close(fd_);
+    fd_ = -1;
+    size_ = 0;
+}
+
+bool FileReader::IsOpen() const noexcept {
+    return fd_ >= 0;
+}
+
+bool FileReader::ReadAt(uint64_t offset, uint8_t* dst, size_t length) noexcept {
+    if (fd_ < 0 || offset > size_ || length > size_ - offset) return false;
+    while (length > 0) {
+        const size_t request = length > MAX_READ_CHUNK ? MAX_READ_CHUNK : length;
+        stats_.readCalls++;
+        const ssize_t got = pread(fd_, dst, request, static_cast<off_t>(offset));
+        if (got <= 0) return false;
+        stats_.bytesRead += static_cast<uint64_t>(got);
+        offset += static_cast<uint64_t>(got);
+        dst += got;
+        length -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+bool StreamReader::Open(const char* path) noexcept {
+    Close();
+    if (!path || path[0] == '\0') return false;
+
+    int fd = STDIN_FILENO;
+    if (strcmp(path, STDIN_PATH) != 0) {
+        fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+    }
+    struct stat st {};
+    fd_ = fd;
+    ownsHandle_ = fd != STDIN_FILENO;
+    seekable_ = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);  // Pipes and terminals are read through
+    stats_ = IoStats{};
+    return true;
+}
+
+void StreamReader::Close() noexcept {
+    if (fd_ >= 0 && ownsHandle_) close(fd_);
+    fd_ = -1;
+    ownsHandle_ = false;
+}
+
+bool StreamReader::IsOpen() const noexcept {
+    return fd_ >= 0;
+}
+
+size_t StreamReader::Read(uint8_t* dst, size_t length) noexcept {
+    if (fd_ < 0 || length == 0) return 0;
+    const size_t request = length > MAX_READ_CHUNK ? MAX_READ_CHUNK : length;
+    ssize_t got;
+    do {
+        stats_.readCalls++;
+        got = read(fd_, dst, request);
+    } while (got < 0 && errno == EINTR);
+    if (got <= 0) return 0;
+    stats_.bytesRead += static_cast<uint64_t>(got);
+    return static_cast<size_t>(got);
+}
+
+bool StreamReader::Skip(uint64_t length) noexcept {
+    if (fd_ < 0) return false;
+    if (seekable_) return lseek(fd_, static_cast<off_t>(length), SEEK_CUR) != static_cast<off_t>(-1);
+    uint8_t scratch[SKIP_CHUNK];
+    while (length > 0) {
+        const size_t got = Read(scratch, length < SKIP_CHUNK ? static_cast<size_t>(length) : SKIP_CHUNK);
+        if (got == 0) return true;  // End of stream
+        length -= got;
+    }
+    return true;
+}
+
+bool IsRemotePath(const char* path) noexcept {
+    if (!path || path[0] == '\0') return false;
+    struct statfs fs {};
+    if (statfs(path, &fs) != 0) return false;
+    const unsigned long type = static_cast<unsigned long>(fs.f_type) & 0xFFFFFFFFul;
+    return type == NFS_SUPER_MAGIC || type == SMB_SUPER_MAGIC || type == CIFS_SUPER_MAGIC || type == SMB2_SUPER_MAGIC;
+}
+
+#endif
+
+ByteSpan SparseImage::Slice(uint64_t offset, size_t length) const noexcept {
+    for (const auto& segment : segments_) {
+        if (offset < segment.offset) continue;
+        const uint64_t relative = offset - segment.offset;
+        if (relative > segment.bytes.size()) continue;
+        const ByteSpan bytes(segment.bytes.data(), segment.bytes.size());
+        if (bytes.Contains(static_cast<size_t>(relative), length)) {
+            return bytes.Subspan(static_cast<size_t>(relative), length);
+        }
+    }
+    return ByteSpan();
+}
+
+uint8_t* SparseImage::Reserve(uint64_t begin, uint64_t end, uint64_t& readFrom, uint64_t& readTo) {
+    // Segments overlapping or touching [begin, end) form one contiguous run
+    const auto first = std::find_if(segments_.begin(), segments_.end(), [begin](const Segment& segment) {
+        return segment.offset + segment.bytes.size() >= begin;
+    });
+    auto last = first;
+    while (last != segments_.end() && last->offset <= end) ++last;
+
+    readFrom = begin;
+    readTo = end;
+    if (first == last) {
+        const auto inserted = segments_.insert(first, Segment{begin, std::vector<uint8_t>(static_cast<size_t>(end - begin))});
+        return inserted->bytes.data();
+    }
+
+    // Skip bytes loaded at the start and end of the range
+    const Segment& tail = *(last - 1);
+    const uint64_t tailEnd = tail.offset + tail.bytes.size();
+    if (first->offset <= begin) readFrom = std::min(end, first->offset + first->bytes.size());
+    if (tail.offset > readFrom && tailEnd >= end) readTo = tail.offset;
+    readTo = std::max(readFrom, readTo);
+
+    // The first segment's buffer is grown in place when it starts the merged run
+    const uint64_t mergedBegin = std::min(begin, first->offset);
+    const uint64_t mergedEnd = std::max(end, tailEnd);
+    Segment merged{mergedBegin, {}};
+    auto next = first;
+    if (first->offset == mergedBegin) {
+        merged.bytes = std::move(first->bytes);
+        ++next;
+    }
+    merged.bytes.resize(static_cast<size_t>(mergedEnd - mergedBegin));
+    for (auto it = next; it != last; ++it) {
+        std::copy(it->bytes.begin(), it->bytes.end(), merged.bytes.begin() + static_cast<ptrdiff_t>(it->offset - mergedBegin));
+    }
+
+    const auto position = segments_.erase(first, last);
+    const auto inserted = segments_.insert(position, std::move(merged));
+    return inserted->bytes.data() + (readFrom - mergedBegin);
+}
+
+ByteSpan StreamWindow::Fetch(uint64_t offset, size_t length) noexcept {
+    if (offset < start_ || length > buffer_.size()) return ByteSpan();
+
+    const uint64_t end = start_ + filled_;
+    if (offset + length <= end) {
+        return ByteSpan(buffer_.data() + (offset - start_), length);
+    }
+
+    // Drop the bytes before offset: keep the loaded tail, or skip the gap in the stream
+    if (offset < end) {
+        const size_t drop = static_cast<size_t>(offset - start_);
+        std::copy(buffer_.begin() + static_cast<ptrdiff_t>(drop), buffer_.begin() + static_cast<ptrdiff_t>(filled_), buffer_.begin());
+        filled_ -= drop;
+    } else {
+        if (!reader_.Skip(offset - end)) return ByteSpan();
+        filled_ = 0;
+    }
+    start_ = offset;
+
+    // Read ahead as far as the window allows, stopping once the range is complete
+    while (filled_ < length) {
+        const size_t got = reader_.Read(buffer_.data() + filled_, buffer_.size() - filled_);
+        if (got == 0) return ByteSpan();  // Stream ended inside the range
+        filled_ += got;
+    }
+    return ByteSpan(buffer_.data(), length);
+}
+
+void ReadPlan::Add(uint64_t offset, uint64_t length) {
+    if (length == 0 || offset > UINT64_MAX - length) return;
+    ranges_.push_back(Range{offset, offset + length});
+}
+
+bool ReadPlan::Execute(FileReader& reader, SparseImage& image) {
+    std::vector<Range> pending;
+    pending.reserve(ranges_.size());
+    for (const auto& range : ranges_) {
+        // Clip to the file and drop ranges that are already loaded
+        const uint64_t end = std::min(range.end, reader.Size());
+        if (range.begin >= end) continue;
+        if (image.Covers(range.begin, static_cast<size_t>(end - range.begin))) continue;
+        pending.push_back(Range{range.begin, end});
+    }
+    ranges_.clear();
+
+    std::sort(pending.begin(), pending.end(), [](const Range& a, const Range& b) { return a.begin < b.begin; });
+
+    // Merge overlapping ranges and ranges separated by less than the coalescing gap
+    size_t i = 0;
+    while (i < pending.size()) {
+        Range merged = pending[i++];
+        while (i < pending.size() && pending[i].begin <= merged.end + coalesceGap_) {
+            merged.end = std::max(merged.end, pending[i].end);
+            i++;
+        }
+        // Bytes already loaded at either end of the range are not read again
+        uint64_t readFrom = 0, readTo = 0;
+        uint8_t* buffer = image.Reserve(merged.begin, merged.end, readFrom, readTo);
+        if (readTo > readFrom && !reader.ReadAt(readFrom, buffer, static_cast<size_t>(readTo - readFrom))) return false;
+    }
+    return true;
+}
+
+} // namespace FontIO
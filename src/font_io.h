@@ -0,0 +1,211 @@
+// this_file: src/font_io.h
+// Font file I/O for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Memory mapping, planned positional reads, forward-only streaming with I/O accounting, and bounds-checked byte views
+
+#ifndef FONT_IO_H
+#define FONT_IO_H
+
+#include "byte_order.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace FontIO {
+    constexpr const char* STDIN_PATH = "-";  // Path that selects standard input for streaming
+
+    // Non-owning, bounds-checked view over a contiguous byte range.
+    // Out-of-range requests yield an empty span or false instead of reading past the end.
+    class ByteSpan {
+    public:
+        constexpr ByteSpan() noexcept = default;
+        constexpr ByteSpan(const uint8_t* data, size_t size) noexcept
+            : data_(size ? data : nullptr), size_(data ? size : 0) {}
+
+        [[nodiscard]] constexpr const uint8_t* data() const noexcept { return data_; }
+        [[nodiscard]] constexpr size_t size() const noexcept { return size_; }
+        [[nodiscard]] constexpr bool empty() const noexcept { return size_ == 0; }
+
+        // True if [offset, offset + length) lies inside the span (overflow-safe)
+        [[nodiscard]] constexpr bool Contains(size_t offset, size_t length) const noexcept {
+            return offset <= size_ && length <= size_ - offset;
+        }
+
+        // Sub-range view; empty span if the range is out of bounds
+        [[nodiscard]] constexpr ByteSpan Subspan(size_t offset, size_t length) const noexcept {
+            return Contains(offset, length) ? ByteSpan(data_ + offset, length) : ByteSpan();
+        }
+
+        // Big-endian field reads; return false (leaving out unchanged) if the field is out of bounds
+        template <typename T>
+        bool Read(size_t offset, T& out) const noexcept {
+            if (!Contains(offset, sizeof(T))) return false;
+            out = ByteOrder::LoadBE<T>(data_ + offset);
+            return true;
+        }
+        bool ReadU16(size_t offset, uint16_t& out) const noexcept { return Read(offset, out); }
+        bool ReadU32(size_t offset, uint32_t& out) const noexcept { return Read(offset, out); }
+
+    private:
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    // Read-only memory mapping of a whole file (file mapping on Windows, mmap elsewhere).
+    // The mapping is released on destruction; views obtained from Bytes() must not outlive it.
+    class MappedFile {
+    public:
+        MappedFile() noexcept = default;
+        explicit MappedFile(const char* path) noexcept { Open(path); }
+        ~MappedFile() { Close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        // Map the file; returns false if it cannot be opened, is empty, or cannot be mapped
+        bool Open(const char* path) noexcept;
+        void Close() noexcept;
+
+        [[nodiscard]] bool IsOpen() const noexcept { return data_ != nullptr; }
+        [[nodiscard]] ByteSpan Bytes() const noexcept { return ByteSpan(data_, size_); }
+
+    private:
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    // I/O performed while parsing one file
+    struct IoStats {
+        uint64_t bytesRead = 0;    // Bytes returned by read calls
+        uint32_t readCalls = 0;    // Number of read syscalls (ReadFile/pread)
+        uint64_t bytesMapped = 0;  // Bytes mapped instead of read (mapped mode)
+    };
+
+    // Positional reader over an open file; every read is counted in Stats()
+    class FileReader {
+    public:
+        FileReader() noexcept = default;
+        ~FileReader() { Close(); }
+
+        FileReader(const FileReader&) = delete;
+        FileReader& operator=(const FileReader&) = delete;
+
+        bool Open(const char* path) noexcept;
+        void Close() noexcept;
+
+        [[nodiscard]] bool IsOpen() const noexcept;
+        [[nodiscard]] uint64_t Size() const noexcept { return size_; }
+        [[nodiscard]] const IoStats& Stats() const noexcept { return stats_; }
+
+        // Read exactly length bytes at offset; returns false on error or short file
+        bool ReadAt(uint64_t offset, uint8_t* dst, size_t length) noexcept;
+
+    private:
+#ifdef _WIN32
+        void* handle_ = nullptr;
+#else
+        int fd_ = -1;
+#endif
+        uint64_t size_ = 0;
+        IoStats stats_;
+    };
+
+    // Disjoint file ranges that have been read into memory, kept sorted by offset
+    class SparseImage {
+    public:
+        // View of [offset, offset + length) if it lies inside one loaded segment, else empty
+        [[nodiscard]] ByteSpan Slice(uint64_t offset, size_t length) const noexcept;
+        [[nodiscard]] bool Covers(uint64_t offset, size_t length) const noexcept { return !Slice(offset, length).empty() || length == 0; }
+
+        // Make [begin, end) part of one segment, absorbing the segments it overlaps or touches.
+        // Bytes already loaded at either end are kept; the caller reads [readFrom, readTo) into
+        // the returned buffer (nothing to read when readFrom == readTo).
+        // Invalidates views previously returned by Slice().
+        uint8_t* Reserve(uint64_t begin, uint64_t end, uint64_t& readFrom, uint64_t& readTo);
+
+    private:
+        struct Segment {
+            uint64_t offset;
+            std::vector<uint8_t> bytes;
+        };
+        std::vector<Segment> segments_;
+    };
+
+    // Collects the ranges a parse needs and fetches the missing ones with as few reads as
+    // possible: sorted ranges closer than the coalescing gap are merged into one read.
+    class ReadPlan {
+    public:
+        explicit ReadPlan(uint64_t coalesceGap) noexcept : coalesceGap_(coalesceGap) {}
+
+        void Add(uint64_t offset, uint64_t length);
+        // Read every planned range not already in image; clears the plan.
+        // Ranges past the end of the file are clipped. Returns false on a read error.
+        bool Execute(FileReader& reader, SparseImage& image);
+
+    private:
+        struct Range {
+            uint64_t begin;
+            uint64_t end;
+        };
+        uint64_t coalesceGap_;
+        std::vector<Range> ranges_;
+    };
+
+    // Forward-only reader over a file, or standard input when the path is "-".
+    // Seekable inputs skip by seeking; pipes skip by reading and discarding.
+    class StreamReader {
+    public:
+        StreamReader() noexcept = default;
+        ~StreamReader() { Close(); }
+
+        StreamReader(const StreamReader&) = delete;
+        StreamReader& operator=(const StreamReader&) = delete;
+
+        bool Open(const char* path) noexcept;
+        void Close() noexcept;
+
+        [[nodiscard]] bool IsOpen() const noexcept;
+        [[nodiscard]] const IoStats& Stats() const noexcept { return stats_; }
+
+        // Read up to length bytes; returns the count read, 0 at end of input or on error
+        size_t Read(uint8_t* dst, size_t length) noexcept;
+        // Advance length bytes; returns false on error (skipping past the end is not an error)
+        bool Skip(uint64_t length) noexcept;
+
+    private:
+#ifdef _WIN32
+        void* handle_ = nullptr;
+#else
+        int fd_ = -1;
+#endif
+        bool ownsHandle_ = false;
+        bool seekable_ = false;
+        IoStats stats_;
+    };
+
+    // Fixed-capacity read-ahead window over a StreamReader. Ranges must be requested in
+    // ascending order; bytes before a requested range are dropped, so memory stays at the
+    // window capacity whatever the stream length.
+    class StreamWindow {
+    public:
+        StreamWindow(StreamReader& reader, size_t capacity) : reader_(reader), buffer_(capacity) {}
+
+        // View of stream bytes [offset, offset + length), valid until the next Fetch. Empty if
+        // the range starts before the window, exceeds the capacity, or runs past the end.
+        [[nodiscard]] ByteSpan Fetch(uint64_t offset, size_t length) noexcept;
+
+    private:
+        StreamReader& reader_;
+        std::vector<uint8_t> buffer_;
+        uint64_t start_ = 0;    // Stream offset of buffer_[0]
+        size_t filled_ = 0;     // Valid bytes in buffer_
+    };
+
+    // True for UNC paths and files on network drives (SMB/NFS mounts elsewhere), where
+    // each read is a round trip and planned reads beat page-faulting a mapping
+    [[nodiscard]] bool IsRemotePath(const char* path) noexcept;
+}
+
+#endif // FONT_IO_H
@@ -6,23 +6,53 @@
 #include "font_ops.h"
 #include "sys_utils.h"
 #include "font_parser.h"
+#include "font_registry.h"
+#include "coverage.h"
+#include "metadata_cache.h"
+#include "manifest.h"
+#include "journal.h"
+#include "scheduler.h"
+#include "zip_archive.h"
+#include "content_store.h"
+#include "checksum.h"
 #include <windows.h>
 #include <iostream>
 #include <vector>
 #include <string>
+#include <cstdio>
 #include <cstring>
 #include <set>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <system_error>
+#include <unordered_map>
 
-// Font registry suffix constants (per Windows font registry naming convention)
-constexpr const char* FONT_SUFFIX_TRUETYPE = " (TrueType)";
-constexpr const char* FONT_SUFFIX_OPENTYPE = " (OpenType)";
+// Coverage index and metadata cache files, in the data directory
+constexpr const char* COVERAGE_INDEX_FILE = "coverage.idx";
+constexpr const char* METADATA_CACHE_FILE = "metadata.cache";
+constexpr const char* JOURNAL_FILE = "batch.journal";       // Batch in progress (see journal.h)
 
 namespace FontOps {
 // Font installation, uninstallation, and registry management operations
 
+// Which registry entries to touch is decided in font_registry.cpp
+using FontRegistry::FONT_SUFFIX_OPENTYPE;
+using FontRegistry::FONT_SUFFIX_TRUETYPE;
+using FontRegistry::FontMatch;
+using FontRegistry::MatchesWildcard;
+using FontRegistry::NamePattern;
+using FontRegistry::PathKey;
+using FontRegistry::RemovalTarget;
+
 // Global context for registry enumeration callback
-// Windows RegEnumValueA requires a C-style callback function that cannot capture state.
+// Windows RegEnumValueW requires a C-style callback function that cannot capture state.
 // This global struct holds the configuration and output destination for the ListCallback function,
 // enabling stateful enumeration of registry font entries across both system and user registries.
 static struct {
@@ -34,17 +64,52 @@ static struct {
 } g_listContext;
 
 static struct {
-    int removedCount;
-    bool changed;
-    std::string fontsDir;
-    std::string userFontsDir;
-} g_cleanupContext;
+    std::vector<std::string>* files;  // Resolved paths of registered font files
+} g_coverageContext;
 
-struct FontMatch {
-    std::string file;
-    std::string regName;
-    bool perUser;
-};
+// Helper: Metadata cache of this run, opened from the data directory on first use.
+// saveable is false when there is no data directory: the cache then stays empty.
+static MetadataCache::Cache& GetMetadataCache(bool* saveable = nullptr) {
+    static MetadataCache::Cache cache;
+    static const bool located = [] {
+        const std::string dataDir = SysUtils::GetDataDirectory();
+        if (dataDir.empty()) return false;
+        cache.Open((dataDir + "\\" + METADATA_CACHE_FILE).c_str());  // A damaged cache is rebuilt on save
+        return true;
+    }();
+    if (saveable) *saveable = located;
+    return cache;
+}
+
+// Helper: Write the metadata cache back if this run stored or dropped entries
+static void SaveMetadataCache() {
+    bool saveable = false;
+    MetadataCache::Cache& cache = GetMetadataCache(&saveable);
+    if (saveable && cache.IsDirty() && !cache.Save()) {
+        std::cerr << "Warning: Failed to save metadata cache\n";
+    }
+}
+
+// Helper: Record a batch's intent in the journal before it changes anything. Refuses to start
+// while an interrupted batch awaits resume (unless this is the resume), since a new journal
+// would replace the record of the unfinished items. Without a data directory, or if the
+// journal cannot be written, the batch runs unjournaled after a warning.
+static bool BeginJournal(Journal::Writer& journal, const Journal::Batch& batch, bool resuming) {
+    const std::string dataDir = SysUtils::GetDataDirectory();
+    if (dataDir.empty()) return true;
+    const std::string journalPath = dataDir + "\\" + JOURNAL_FILE;
+    Journal::Batch pending;
+    if (!resuming && Journal::Read(journalPath, pending) &&
+        std::any_of(pending.items.begin(), pending.items.end(), [](const Journal::Item& item) { return !item.done; })) {
+        std::cerr << "Error: An interrupted batch has unfinished items\n";
+        std::cerr << "Solution: Run 'fontlift-win resume' to finish it (or 'resume --rollback' to undo it)\n";
+        return false;
+    }
+    if (!journal.Begin(journalPath, batch)) {
+        std::cerr << "Warning: Cannot write the batch journal; an interrupted batch could not be resumed\n";
+    }
+    return true;
+}
 
 // Helper: Resolve relative or absolute font file path
 static std::string ResolveFullPath(const char* file, bool perUser) {
@@ -64,7 +129,7 @@ static std::string FormatOutput(const std::string& path, const char* name) {
     return path;
 }
 
-// Windows registry enumeration callback (C-style function pointer required by RegEnumValueA API)
+// Windows registry enumeration callback (C-style function pointer required by RegEnumValueW API)
 // Called once for each font entry found in the registry (system or user fonts)
 // Processes each entry according to g_listContext configuration (paths, names) and stores
 // it in a set for sorted, deduplicated output
@@ -82,65 +147,62 @@ static void OutputSorted(const std::set<std::string>& outputSet) {
     }
 }
 
-// Registry cleanup callback: remove entries pointing to missing files
-static void CleanupCallback(const char* name, const char* file, bool perUser) {
-    if (!file || file[0] == '\0') return;
-    size_t len = strlen(file);
-    bool isAbsolute = (len > 1 && file[1] == ':') || (len > 0 && (file[0] == '\\' || file[0] == '/'));
-    const std::string& baseDir = perUser ? g_cleanupContext.userFontsDir : g_cleanupContext.fontsDir;
-    if (!isAbsolute && baseDir.empty()) {
-        std::cerr << "    Warning: Skipping registry entry '" << name << "' (unknown base directory).\n";
-        return;
-    }
-    std::string fullPath = isAbsolute ? std::string(file) : baseDir + "\\" + file;
-    if (SysUtils::FileExists(fullPath.c_str())) return;
-
-    std::cout << "  - Removing broken entry: " << name << "\n";
-    std::cout << "    File not found: " << fullPath << "\n";
-    if (SysUtils::RegDeleteFontEntry(name, perUser)) {
-        g_cleanupContext.removedCount++;
-        g_cleanupContext.changed = true;
-    } else {
-        std::cerr << "    Warning: Failed to remove registry entry.\n";
+// Helper: Remove the registry entries of one scope whose files are missing, one by one in
+// registry order through one key (FontRegistry::FindBrokenEntries checks the files on the I/O
+// pool)
+static bool CleanupScope(bool perUser, int& removedCount, bool& changed) {
+    std::vector<FontRegistry::BrokenEntry> broken;
+    const auto fileExists = [](const std::string& path) { return SysUtils::FileExists(path.c_str()); };
+    if (!FontRegistry::FindBrokenEntries(SysUtils::GetFontStore(), perUser, fileExists, broken)) return false;
+    SysUtils::FontRegistryKey key;
+    if (!broken.empty()) key.Open(perUser, true);
+    for (const auto& entry : broken) {
+        std::cout << "  - Removing broken entry: " << entry.regName << "\n";
+        std::cout << "    File not found: " << entry.fullPath << "\n";
+        if (key.Delete(entry.regName.c_str())) {
+            GetMetadataCache().Remove(entry.fullPath.c_str());
+            removedCount++;
+            changed = true;
+        } else {
+            std::cerr << "    Warning: Failed to remove registry entry.\n";
+        }
     }
+    return true;
 }
 
-// Registry cleanup orchestrator: enumerate system and/or user fonts
+// Registry cleanup orchestrator: check system and/or user fonts
 static int CleanupRegistry(bool includeSystem, bool includeUser) {
-    g_cleanupContext.removedCount = 0;
-    g_cleanupContext.changed = false;
-    g_cleanupContext.fontsDir.clear();
-    g_cleanupContext.userFontsDir.clear();
-
+    int removedCount = 0;
+    bool changed = false;
     bool success = true;
 
     if (includeSystem) {
-        g_cleanupContext.fontsDir = SysUtils::GetFontsDirectory();
-        if (g_cleanupContext.fontsDir.empty()) {
+        const std::string fontsDir = SysUtils::GetFontsDirectory();
+        if (fontsDir.empty()) {
             std::cerr << "Error: Could not determine system fonts directory.\n";
             success = false;
-        } else if (!SysUtils::RegEnumerateFonts(CleanupCallback, false)) {
+        } else if (!CleanupScope(false, removedCount, changed)) {
             std::cerr << "Error: Failed to enumerate system fonts.\n";
             success = false;
         }
     }
 
     if (includeUser) {
-        g_cleanupContext.userFontsDir = SysUtils::GetUserFontsDirectory();
-        if (g_cleanupContext.userFontsDir.empty()) {
+        const std::string userFontsDir = SysUtils::GetUserFontsDirectory();
+        if (userFontsDir.empty()) {
             std::cerr << "    Warning: Could not determine user fonts directory.\n";
             success = false;
-        } else if (!SysUtils::RegEnumerateFonts(CleanupCallback, true)) {
+        } else if (!CleanupScope(true, removedCount, changed)) {
             std::cerr << "    Warning: Failed to enumerate user fonts.\n";
             success = false;
         }
     }
 
-    if (g_cleanupContext.changed) {
+    if (changed) {
         SysUtils::NotifyFontChange();
     }
 
-    return success ? g_cleanupContext.removedCount : -1;
+    return success ? removedCount : -1;
 }
 
 int ListFonts(bool showPaths, bool showNames) {
@@ -168,15 +230,15 @@ int ListFonts(bool showPaths, bool showNames) {
     return EXIT_SUCCESS_CODE;
 }
 
-// Helper: Check if file has valid font extension (.ttf, .otf, .ttc, .otc)
-static bool HasValidFontExtension(const char* path) noexcept {
-    constexpr const char* validExts[] = {".ttf", ".otf", ".ttc", ".otc"};
+// Helper: Check if path ends with one of the given extensions (ASCII case-insensitive)
+template <size_t N>
+static bool HasExtension(const char* path, const char* const (&exts)[N]) noexcept {
     std::string pathStr(path);
     // Locale-independent ASCII lowercase conversion
     for (auto& c : pathStr) {
         if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
     }
-    for (const char* ext : validExts) {
+    for (const char* ext : exts) {
         if (pathStr.length() >= strlen(ext) &&
             pathStr.compare(pathStr.length() - strlen(ext), strlen(ext), ext) == 0) {
             return true;
@@ -185,87 +247,136 @@ static bool HasValidFontExtension(const char* path) noexcept {
     return false;
 }
 
-static std::vector<std::string> BuildFontRegistryVariants(const char* fontName) {
-    return {
-        std::string(fontName) + FONT_SUFFIX_TRUETYPE,
-        std::string(fontName) + FONT_SUFFIX_OPENTYPE,
-        std::string(fontName)
-    };
+// Helper: Check if file is a web font (.woff, .woff2), which Windows cannot install
+static bool IsWebFontExtension(const char* path) noexcept {
+    constexpr const char* webExts[] = {".woff", ".woff2"};
+    return HasExtension(path, webExts);
 }
 
-// Helper: Validate font file exists and has valid extension before installation
-static int ValidateInstallPrerequisites(const char* fontPath) {
-    if (!HasValidFontExtension(fontPath)) {
-        std::cerr << "Error: Invalid font file extension\n";
-        std::cerr << "Solution: Use a valid font file (.ttf, .otf, .ttc, .otc)\n";
-        return EXIT_ERROR;
+// Helper: Check if file has valid font extension (.ttf, .otf, .ttc, .otc, .woff, .woff2)
+static bool HasValidFontExtension(const char* path) noexcept {
+    constexpr const char* validExts[] = {".ttf", ".otf", ".ttc", ".otc", ".woff", ".woff2"};
+    return HasExtension(path, validExts);
+}
+
+// Helper: Check if file has a collection extension (.ttc, .otc)
+static bool IsCollectionExtension(const char* path) noexcept {
+    constexpr const char* collectionExts[] = {".ttc", ".otc"};
+    return HasExtension(path, collectionExts);
+}
+
+// Helper: Path in the ANSI code page the parser opens files with; false if a character has no
+// equivalent there (std::filesystem::path::string() would throw instead)
+static bool NarrowPath(const std::filesystem::path& path, std::string& narrow) {
+    const std::wstring& wide = path.native();
+    BOOL usedDefault = FALSE;
+    const int wideLength = static_cast<int>(wide.size());
+    const int length = WideCharToMultiByte(CP_ACP, WC_NO_BEST_FIT_CHARS, wide.data(), wideLength, NULL, 0, NULL, &usedDefault);
+    if (length <= 0 || usedDefault) return false;
+    narrow.resize(static_cast<size_t>(length));
+    WideCharToMultiByte(CP_ACP, WC_NO_BEST_FIT_CHARS, wide.data(), wideLength, &narrow[0], length, NULL, NULL);
+    return true;
+}
+
+// Helper: Member references (see zip_archive.h) of the font entries of an archive, in archive
+// order. Directories and macOS resource forks (__MACOSX/, "._" files) are skipped.
+static bool ListArchiveFonts(const std::string& archivePath, std::vector<std::string>& files) {
+    ZipArchive::Archive archive;
+    std::string error;
+    if (!archive.Open(archivePath.c_str(), error)) {
+        std::cerr << "Error: " << error << ": " << archivePath << "\n";
+        return false;
     }
-    if (!SysUtils::FileExists(fontPath)) {
-        std::cerr << "Error: Font file not found: " << fontPath << "\n";
-        std::cerr << "Solution: Check the file path and ensure the font file exists\n";
-        return EXIT_ERROR;
+    size_t found = 0;
+    for (const auto& entry : archive.Entries()) {
+        if (entry.IsDirectory() || entry.name.rfind("__MACOSX/", 0) == 0) continue;
+        const size_t slash = entry.name.find_last_of("/\\");
+        const std::string leaf = slash == std::string::npos ? entry.name : entry.name.substr(slash + 1);
+        if (leaf.rfind("._", 0) == 0 || !HasValidFontExtension(leaf.c_str())) continue;
+        files.push_back(ZipArchive::MemberPath(archivePath, entry.name));
+        found++;
     }
-    return EXIT_SUCCESS_CODE;
+    if (found == 0) {
+        std::cerr << "Error: No font files in archive " << archivePath << "\n";
+        return false;
+    }
+    return true;
 }
 
-// Helper: Extract font name from font file
-static int ExtractFontName(const char* fontPath, std::string& outName) {
-    if (FontParser::IsCollection(fontPath)) {
-        std::vector<std::string> names = FontParser::GetFontsInCollection(fontPath);
-        if (names.empty()) {
-            std::cerr << "Error: Failed to parse font collection\n";
-            return EXIT_ERROR;
+// Helper: Expand inputs into font files. Directories contribute their font files (sorted);
+// a wildcard in the last path component (C:\Fonts\Foo*.otf) selects the matching font files
+// of its directory. With expandArchives, .zip inputs (named or matched) contribute the member
+// references of their font entries. Other inputs pass through unchanged.
+static bool ExpandFontPaths(const std::vector<std::string>& inputs, std::vector<std::string>& files,
+                            bool expandArchives = false) {
+    namespace fs = std::filesystem;
+    bool ok = true;
+    for (const auto& input : inputs) {
+        std::error_code ec;
+        const size_t slash = input.find_last_of("\\/");
+        const std::string name = slash == std::string::npos ? input : input.substr(slash + 1);
+        const bool isPattern = name.find_first_of("*?") != std::string::npos;
+        if (!isPattern && expandArchives && ZipArchive::IsArchivePath(input.c_str()) && fs::is_regular_file(input, ec)) {
+            if (!ListArchiveFonts(input, files)) ok = false;
+            continue;
         }
-        outName = names[0];
-        if (names.size() > 1) std::cout << "Note: Collection contains " << names.size() << " fonts\n";
-    } else {
-        outName = FontParser::GetFontName(fontPath);
-        if (outName.empty()) {
-            std::cerr << "Error: Failed to parse font name\n";
-            return EXIT_ERROR;
+        if (!isPattern && !fs::is_directory(input, ec)) {
+            files.push_back(input);
+            continue;
+        }
+        const std::string dir = !isPattern ? input : (slash == std::string::npos ? "." : input.substr(0, slash + 1));
+        std::vector<std::string> found, archives;
+        for (fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+            std::error_code entryEc;
+            std::string path;
+            if (!it->is_regular_file(entryEc) || !NarrowPath(it->path(), path)) continue;
+            const bool isArchive = isPattern && expandArchives && ZipArchive::IsArchivePath(path.c_str());
+            if (!isArchive && !HasValidFontExtension(path.c_str())) continue;
+            if (isPattern && !MatchesWildcard(SysUtils::GetFileName(path.c_str()).c_str(), name.c_str())) continue;
+            (isArchive ? archives : found).push_back(path);
+        }
+        if (ec) {
+            std::cerr << "Error: Cannot read directory " << dir << ": " << ec.message() << "\n";
+            ok = false;
+        } else if (isPattern && found.empty() && archives.empty()) {
+            std::cerr << "Error: No font files match " << input << "\n";
+            ok = false;
+        }
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+        std::sort(archives.begin(), archives.end());
+        for (const auto& archive : archives) {
+            if (!ListArchiveFonts(archive, files)) ok = false;
         }
     }
-    return EXIT_SUCCESS_CODE;
+    return ok;
 }
 
-// Helper: Search registry for font by name with automatic suffix matching (TrueType/OpenType)
-static bool FindFontInRegistry(const char* fontName, std::string& outFile, std::string& outRegName, bool& outPerUser, bool forceSystemOnly = false) {
-    const std::vector<std::string> variants = BuildFontRegistryVariants(fontName);
-
-    // If not forcing system-only, first check user registry (HKEY_CURRENT_USER)
-    if (!forceSystemOnly) {
-        for (const auto& variant : variants) {
-            if (SysUtils::RegReadFontEntry(variant.c_str(), outFile, true)) {
-                outRegName = variant;
-                outPerUser = true;
-                return true;
-            }
-        }
+// Helper: Why a file name cannot be installed (extension); empty if it can
+static std::string CheckInstallableName(const char* fontPath) {
+    if (IsWebFontExtension(fontPath)) {
+        return "Web fonts (.woff, .woff2) cannot be installed on Windows; convert the font to .ttf or .otf first";
     }
+    if (!HasValidFontExtension(fontPath)) return "Invalid font file extension (use .ttf, .otf, .ttc, .otc)";
+    return "";
+}
 
-    // Then check system registry (HKEY_LOCAL_MACHINE)
-    for (const auto& variant : variants) {
-        if (SysUtils::RegReadFontEntry(variant.c_str(), outFile, false)) {
-            outRegName = variant;
-            outPerUser = false;
-            return true;
-        }
-    }
-    return false;
+// Helper: Why a file cannot be installed (extension, existence); empty if it can
+static std::string CheckInstallable(const char* fontPath) {
+    std::string reason = CheckInstallableName(fontPath);
+    if (reason.empty() && !SysUtils::FileExists(fontPath)) reason = "Font file not found";
+    return reason;
+}
+
+// Helper: Name a font is registered under: its full name (nameID 4), so the styles of one
+// family get one registry entry each; the family name if the face has no full name
+static std::string RegistryFontName(const FontParser::FontMetadata& face) {
+    return face.fullName.empty() ? face.familyName : face.fullName;
 }
 
 static bool FindFontInScope(const char* fontName, bool perUser, FontMatch& match) {
-    const std::vector<std::string> variants = BuildFontRegistryVariants(fontName);
-    for (const auto& variant : variants) {
-        std::string fontFile;
-        if (SysUtils::RegReadFontEntry(variant.c_str(), fontFile, perUser)) {
-            match.file = fontFile;
-            match.regName = variant;
-            match.perUser = perUser;
-            return true;
-        }
-    }
-    return false;
+    const std::unique_ptr<FontStore::Key> key = SysUtils::GetFontStore().Open(perUser, false);
+    return key && FontRegistry::FindVariant(*key, fontName, perUser, match);
 }
 
 static void CollectFontMatches(const char* fontName, std::vector<FontMatch>& matches) {
@@ -275,248 +386,1196 @@ static void CollectFontMatches(const char* fontName, std::vector<FontMatch>& mat
     if (FindFontInScope(fontName, false, systemMatch)) matches.push_back(systemMatch);
 }
 
-// Helper: Write font to registry and load into system via AddFontResourceEx
-static int RegisterAndLoadFont(const std::string& destPath, const std::string& fontName, bool perUser) {
-    std::string regValue = perUser ? destPath : SysUtils::GetFileName(destPath.c_str());
-    std::string regName = fontName + FONT_SUFFIX_TRUETYPE;
-    std::string existingFile;
-    if (SysUtils::RegReadFontEntry(regName.c_str(), existingFile, perUser)) {
-        std::cerr << "Warning: Font '" << fontName << "' already installed, overwriting...\n";
-    }
-    if (!SysUtils::RegWriteFontEntry(regName.c_str(), regValue.c_str(), perUser)) {
-        std::cerr << "Error: Failed to register font in registry: " << SysUtils::GetLastErrorMessage() << "\n";
-        SysUtils::DeleteFromFontsFolder(SysUtils::GetFileName(destPath.c_str()).c_str());
+// Helper: Name a font file is registered under, from the metadata cache or one parse of the
+// file: its registry name (full name) if the registry has it, else its family name, which
+// earlier versions registered fonts under
+static int ExtractFontName(const char* fontPath, std::string& outName) {
+    const std::vector<FontParser::FontMetadata> faces = MetadataCache::GetFontMetadata(GetMetadataCache(), fontPath);
+    if (faces.empty()) {
+        std::cerr << "Error: Failed to parse font " << (FontParser::IsCollection(fontPath) ? "collection" : "name") << "\n";
         return EXIT_ERROR;
     }
-    if (AddFontResourceExA(destPath.c_str(), FR_PRIVATE, 0) == 0) {
-        std::cerr << "Error: Failed to load font resource: " << SysUtils::GetLastErrorMessage() << "\n";
-        SysUtils::RegDeleteFontEntry(regName.c_str(), perUser);
-        SysUtils::DeleteFromFontsFolder(SysUtils::GetFileName(destPath.c_str()).c_str());
-        return EXIT_ERROR;
+    const std::string registryName = RegistryFontName(faces.front());
+    std::vector<FontMatch> matches;
+    CollectFontMatches(registryName.c_str(), matches);
+    outName = matches.empty() ? faces.front().familyName : registryName;
+    if (faces.front().isCollection && faces.size() > 1) {
+        std::cout << "Note: Collection contains " << faces.size() << " fonts\n";
     }
     return EXIT_SUCCESS_CODE;
 }
 
-// Forward declaration: shared uninstall/remove logic
-static int UnloadAndCleanupFont(const std::string& fontFile, const std::string& matchedName, const std::string& fontName, bool deleteFile, bool perUser);
+// Helper: Unload one entry's font, delete its registry value and, for remove, its file
+static bool RemoveRegisteredFont(const RemovalTarget& target, SysUtils::FontRegistryKey& key, bool deleteFile,
+                                 const std::string& fontsDir) {
+    const FontMatch& match = target.match;
+    // For per-user fonts, the file is already an absolute path; system fonts are relative to the fonts dir
+    const bool isAbsolute = (match.file.length() > 1 && match.file[1] == ':');
+    const std::string fullPath = isAbsolute ? match.file : fontsDir + "\\" + match.file;
 
-// Helper: Best-effort removal of existing font with matching family name before installation
-static void TryUninstallExistingFont(const std::string& fontName, bool forceAdmin) {
-    for (unsigned int attempt = 0; attempt < 4; ++attempt) {
-        std::string fontFile;
-        std::string matchedName;
-        bool perUser = false;
-        if (!FindFontInRegistry(fontName.c_str(), fontFile, matchedName, perUser, forceAdmin)) return;
-        if (!perUser && !SysUtils::IsAdmin()) {
-            std::cerr << "Warning: Found older font '" << fontName << "' but cannot remove it without admin privileges.\n";
-            return;
-        }
-        if (!SysUtils::IsValidFontPath(fontFile.c_str())) {
-            std::cerr << "Warning: Found invalid registry path for '" << fontName << "', skipping automatic uninstall.\n";
-            return;
-        }
-        if (UnloadAndCleanupFont(fontFile, matchedName, fontName, false, perUser) != EXIT_SUCCESS_CODE) {
-            std::cerr << "Warning: Failed to remove existing font '" << fontName << "' before installation.\n";
-            return;
+    // RemoveFontResourceExA failure is non-fatal: font may not be loaded in current process
+    // Warning message informs user, but we proceed with registry/file cleanup
+    if (RemoveFontResourceExA(fullPath.c_str(), FR_PRIVATE, 0) == 0) {
+        std::cerr << "Warning: Failed to unload font resource: " << target.fontName << "\n";
+    }
+    if (!key.Delete(match.regName.c_str())) {
+        std::cerr << "Error: Failed to remove font from registry: " << match.regName << "\n";
+        return false;
+    }
+    // Other registrations, of any user, may share a content store object
+    const bool inStore = ContentStore::IsObject(fullPath);
+    if (deleteFile && !inStore) {
+        if (DeleteFileA(fullPath.c_str()) == 0) {
+            std::cerr << "Error: Failed to delete font file: " << fullPath << "\n";
+            std::cerr << "Font has been uninstalled but file remains\n";
+            return false;
         }
-        std::cout << "Note: Automatically uninstalled older version of: " << fontName << "\n";
+        GetMetadataCache().Remove(fullPath.c_str());
     }
-    std::cerr << "Warning: Stopping automatic uninstall for '" << fontName << "' after multiple attempts.\n";
+    std::cout << "Successfully " << (deleteFile ? "removed" : "uninstalled") << ": " << target.fontName << "\n";
+    if (deleteFile && inStore) std::cout << "Note: File kept in content store: " << fullPath << "\n";
+    else if (!deleteFile) std::cout << "Font file remains at: " << fullPath << "\n";
+    else std::cout << "File deleted: " << fullPath << "\n";
+    return true;
 }
 
-static int RemoveFontFromAllScopes(const char* fontName, bool deleteFile, bool forceAdmin) {
-    std::vector<FontMatch> matches;
-    CollectFontMatches(fontName, matches);
+// Helper: Journal the registry entries a removal batch is about to delete
+static bool BeginRemovalJournal(Journal::Writer& journal, const std::vector<RemovalTarget>& targets, bool deleteFile,
+                                const std::string& fontsDir) {
+    Journal::Batch intent;
+    intent.op = deleteFile ? Journal::Operation::Remove : Journal::Operation::Uninstall;
+    for (const auto& target : targets) {
+        const std::string& file = target.match.file;
+        const bool isAbsolute = file.length() > 1 && file[1] == ':';
+        intent.items.push_back({target.match.regName, isAbsolute ? file : fontsDir + "\\" + file, target.match.perUser});
+    }
+    return BeginJournal(journal, intent, false);
+}
 
-    if (matches.empty()) {
-        std::cerr << "Error: Font not found in registry: " << fontName << "\n";
+int RemoveFontsByName(const std::vector<std::string>& names, bool deleteFile, bool forceAdmin, bool useRegex,
+                      bool includeSystem, bool dryRun) {
+    std::vector<NamePattern> patterns;
+    if (!FontRegistry::CompileNamePatterns(names, useRegex, patterns)) return EXIT_ERROR;
+    if (patterns.empty()) {
+        std::cerr << "Error: No font names given\n";
         return EXIT_ERROR;
     }
 
+    // Each scope is enumerated once and every pattern is tested against its entries; the
+    // values are deleted only after the enumeration, which deleting would disturb
     const bool isAdmin = SysUtils::IsAdmin();
-    bool permissionBlocked = false;
-    bool removedAny = false;
-    bool sawSystemMatch = false;
+    SysUtils::FontRegistryKey keys[2];      // Indexed by perUser
+    keys[true].Open(true, !dryRun);
+    keys[false].Open(false, isAdmin && !dryRun);
+    FontStore::Key* const storeKeys[2] = {keys[false].Get(), keys[true].Get()};
+    size_t heldBack = 0;
+    const std::vector<RemovalTarget> targets =
+        FontRegistry::SelectByName(SysUtils::GetFontStore(), storeKeys, patterns, includeSystem, heldBack);
+
     bool hadFailure = false;
-    int lastError = EXIT_SUCCESS_CODE;
+    for (const auto& pattern : patterns) {
+        if (pattern.matched) continue;
+        std::cerr << "Error: Font not found in registry: " << pattern.text << "\n";
+        hadFailure = true;
+    }
+    if (heldBack > 0) {
+        std::cerr << "Note: " << heldBack << " system font entr" << (heldBack == 1 ? "y" : "ies")
+                  << " matched a pattern and " << (heldBack == 1 ? "was" : "were") << " left alone.\n";
+        std::cerr << "Tip: Rerun with --system to include them (with --dry-run to list them first).\n";
+    }
 
-    for (const auto& match : matches) {
-        if (!match.perUser) sawSystemMatch = true;
-        if (!match.perUser && !isAdmin) {
-            permissionBlocked = true;
-            continue;
-        }
-        if (!SysUtils::IsValidFontPath(match.file.c_str())) {
-            std::cerr << "Error: Invalid font path in registry: " << match.file << "\n";
-            return EXIT_ERROR;
+    const std::string fontsDir = SysUtils::GetFontsDirectory();
+    if (dryRun) {
+        for (const auto& target : targets) {
+            const FontMatch& match = target.match;
+            const bool isAbsolute = match.file.length() > 1 && match.file[1] == ':';
+            std::cout << (deleteFile ? "remove     " : "uninstall  ") << target.fontName << "  ("
+                      << (match.perUser ? "user" : "system") << ")  " << (isAbsolute ? match.file : fontsDir + "\\" + match.file);
+            if (!match.perUser && !isAdmin) std::cout << "  [requires admin]";
+            std::cout << "\n";
         }
-        int result = UnloadAndCleanupFont(match.file, match.regName, fontName, deleteFile, match.perUser);
-        if (result == EXIT_SUCCESS_CODE) {
-            removedAny = true;
+        std::cout << "Plan: " << targets.size() << " font entr" << (targets.size() == 1 ? "y" : "ies") << " to "
+                  << (deleteFile ? "remove" : "uninstall") << "\n";
+        return hadFailure ? EXIT_ERROR : EXIT_SUCCESS_CODE;
+    }
+
+    Journal::Writer journal;
+    if (!targets.empty() && !BeginRemovalJournal(journal, targets, deleteFile, fontsDir)) return EXIT_ERROR;
+    size_t removed = 0;
+    size_t blocked = 0;
+    bool removedUser = false;
+    for (size_t t = 0; t < targets.size(); t++) {
+        const RemovalTarget& target = targets[t];
+        const bool perUser = target.match.perUser;
+        // A per-user entry may point anywhere (in-place installs); uninstalling it keeps the file
+        const bool checkPath = deleteFile || !perUser;
+        if (!perUser && !(isAdmin && keys[false].IsOpen())) {
+            blocked++;
+        } else if (checkPath && !SysUtils::IsValidFontPath(target.match.file.c_str())) {
+            std::cerr << "Error: Invalid font path in registry: " << target.match.file << "\n";
+            hadFailure = true;
+        } else if (RemoveRegisteredFont(target, keys[perUser], deleteFile, fontsDir)) {
+            removed++;
+            removedUser |= perUser;
         } else {
             hadFailure = true;
-            lastError = result;
         }
+        journal.Done(t);
+    }
+    journal.Finish();
+
+    // One broadcast for the whole batch
+    if (removed > 0) SysUtils::NotifyFontChange();
+    SaveMetadataCache();
+    if (patterns.size() > 1 || targets.size() > 1) {
+        std::cout << (deleteFile ? "Removed " : "Uninstalled ") << removed << " of " << targets.size() << " font entr"
+                  << (targets.size() == 1 ? "y" : "ies") << "\n";
     }
 
-    if (permissionBlocked) {
-        std::cerr << "Error: Administrator privileges required for system fonts\n";
+    if (blocked > 0) {
+        std::cerr << "Error: Administrator privileges required for system fonts (" << blocked << " entr"
+                  << (blocked == 1 ? "y" : "ies") << ")\n";
         std::cerr << "Solution: Right-click Command Prompt and select 'Run as administrator'.\n";
-        if (removedAny) {
+        if (removedUser) {
             std::cerr << "Note: User-level copy was removed; system copy remains.\n";
-        } else if (!forceAdmin && sawSystemMatch) {
+        } else if (!forceAdmin) {
             std::cerr << "Tip: Rerun with --admin after elevating to remove system fonts.\n";
         }
         return EXIT_PERMISSION_DENIED;
     }
+    return hadFailure ? EXIT_ERROR : EXIT_SUCCESS_CODE;
+}
+
+// Capacity of each queue between install stages: enough to keep every stage busy while one
+// waits on the disk, small enough that a batch of any size holds only this many files in flight
+constexpr size_t INSTALL_QUEUE_CAPACITY = 64;
+
+// Largest source file install reads whole to parse and copy from one read; larger files are
+// parsed and copied separately, so the files in flight stay small
+constexpr uint64_t MAX_READ_ONCE_SIZE = 64u * 1024 * 1024;
 
-    if (hadFailure) return lastError;
-    if (removedAny) return EXIT_SUCCESS_CODE;
+// Largest archive entry install inflates into memory: twice a read-once source, room for the
+// largest pan-CJK collections
+constexpr size_t MAX_ARCHIVE_FONT_SIZE = 2 * MAX_READ_ONCE_SIZE;
 
-    std::cerr << "Error: Failed to uninstall font: " << fontName << "\n";
-    return EXIT_ERROR;
+// Most bytes of inflated members and read-once sources an install batch holds at once, from
+// the read (or, for content store installs, the hash before the batch) until the copy stage
+// wrote them
+constexpr uint64_t MAX_BATCH_BUFFER_SIZE = 1024u * 1024 * 1024;
+
+// Bytes of file contents an install batch holds in memory (see MAX_BATCH_BUFFER_SIZE). Buffers
+// kept from hashing are pending until the parse stage reaches their item; all others are in
+// flight and are released without waiting on another item, by the copy stage or after a hash.
+class InstallBudget {
+public:
+    explicit InstallBudget(uint64_t limit) : limit_(limit) {}
+
+    // Charge a pending buffer if it fits; false otherwise (the caller keeps nothing)
+    bool TryKeep(uint64_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (held_ + bytes > limit_) return false;
+        held_ += bytes;
+        return true;
+    }
+
+    // Charge a buffer in flight, waiting while buffers in flight fill the budget. Pending ones
+    // never make it wait, as they are released only after later items; a batch they fill goes
+    // over the budget by at most one buffer per thread.
+    void Acquire(uint64_t bytes) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        released_.wait(lock, [this, bytes]() { return held_ + bytes <= limit_ || inFlight_ == 0; });
+        held_ += bytes;
+        inFlight_ += bytes;
+    }
+
+    // The parse stage reached an item with a pending buffer
+    void Start(uint64_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inFlight_ += bytes;
+    }
+
+    // A pending buffer was dropped before the parse stage reached its item
+    void Drop(uint64_t bytes) {
+        Start(bytes);
+        Release(bytes);
+    }
+
+    // A buffer in flight was written or dropped
+    void Release(uint64_t bytes) {
+        if (bytes == 0) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            held_ -= bytes;
+            inFlight_ -= bytes;
+        }
+        released_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable released_;
+    const uint64_t limit_;
+    uint64_t held_ = 0;
+    uint64_t inFlight_ = 0;
+};
+
+// One file of an install batch
+struct InstallItem {
+    std::string path;                               // Source file, or member reference (zip_archive.h)
+    std::string fileName;                           // Name of the installed copy
+    std::string error;                              // Why it was not installed; empty while it is on track
+    const ZipArchive::Archive* archive = nullptr;   // Archive members only
+    const ZipArchive::Entry* entry = nullptr;
+    std::vector<uint8_t> data;                      // Inflated member or read-once source, released once it is written
+    uint64_t heldBytes = 0;                         // Charged to the batch's InstallBudget for data
+    bool readOnce = false;                          // data holds the whole source file
+    MetadataCache::FileKey sourceKey;               // Source as it was read (read-once files)
+    uint64_t hash = 0;                              // Content hash (store installs, and copies written from memory)
+    bool unchanged = false;                         // Already registered to the same store object
+    SysUtils::CopyMethod copyMethod = SysUtils::CopyMethod::Auto;  // How it was copied; Auto if it was not
+    std::vector<FontParser::FontMetadata> faces;    // Released once the file is registered
+    std::string name;                               // RegistryFontName of the first face
+    std::string destPath;                           // Installed copy
+    bool isCollection = false;
+    size_t faceCount = 0;
+};
+
+// Helper: Fonts-folder file name for an archive entry: its last path component, in the ANSI code
+// page; false if it has characters Windows file names cannot hold
+static bool ArchiveEntryFileName(const ZipArchive::Entry& entry, std::string& fileName) {
+    const size_t slash = entry.name.find_last_of("/\\");
+    const std::string leaf = slash == std::string::npos ? entry.name : entry.name.substr(slash + 1);
+    if (leaf.empty() || leaf.find_first_of("<>:\"|?*") != std::string::npos) return false;
+    bool ascii = true;
+    for (const char c : leaf) {
+        if (static_cast<unsigned char>(c) < 0x20) return false;
+        if (static_cast<unsigned char>(c) >= 0x80) ascii = false;
+    }
+    if (ascii) {
+        fileName = leaf;
+        return true;
+    }
+    // Code page 437 names are not converted: archivers that write non-ASCII names set the UTF-8 flag
+    return entry.utf8Name && NarrowPath(std::filesystem::u8path(leaf), fileName);
 }
 
-// Helper: Remove font from system memory and registry, optionally delete file
-static int UnloadAndCleanupFont(const std::string& fontFile, const std::string& matchedName, const std::string& fontName, bool deleteFile, bool perUser) {
-    // For per-user fonts, fontFile is already an absolute path
-    // For system fonts, fontFile is relative and needs to be combined with system fonts dir
-    std::string fullPath;
-    bool isAbsolute = (fontFile.length() > 1 && fontFile[1] == ':');
-    if (isAbsolute) {
-        fullPath = fontFile;
-    } else {
-        std::string fontsDir = SysUtils::GetFontsDirectory();
-        fullPath = fontsDir + "\\" + fontFile;
+// Helper: Point the archive members of a batch at their entries, opening each archive once
+// (archives keeps them open for the batch); plain files keep their own file name
+static void ResolveInstallItems(std::vector<InstallItem>& items,
+                                std::unordered_map<std::string, std::unique_ptr<ZipArchive::Archive>>& archives) {
+    std::unordered_map<std::string, std::string> openErrors;
+    for (auto& item : items) {
+        std::string archivePath, entryName;
+        if (!ZipArchive::SplitMemberPath(item.path, archivePath, entryName)) {
+            item.fileName = SysUtils::GetFileName(item.path.c_str());
+            continue;
+        }
+        item.fileName = SysUtils::GetFileName(entryName.c_str());
+        auto archive = archives.find(archivePath);
+        if (archive == archives.end() && openErrors.count(archivePath) == 0) {
+            auto opened = std::make_unique<ZipArchive::Archive>();
+            std::string error;
+            if (opened->Open(archivePath.c_str(), error)) {
+                archive = archives.emplace(archivePath, std::move(opened)).first;
+            } else {
+                openErrors.emplace(archivePath, error);
+            }
+        }
+        if (archive == archives.end()) {
+            item.error = openErrors[archivePath];
+            continue;
+        }
+        item.archive = archive->second.get();
+        item.entry = item.archive->Find(entryName);
+        if (!item.entry) {
+            item.error = "Entry not found in archive";
+        } else if (!ArchiveEntryFileName(*item.entry, item.fileName)) {
+            item.error = "Unsupported characters in archive entry name";
+        }
     }
+}
 
-    // RemoveFontResourceExA failure is non-fatal: font may not be loaded in current process
-    // Warning message informs user, but we proceed with registry/file cleanup
-    if (RemoveFontResourceExA(fullPath.c_str(), FR_PRIVATE, 0) == 0) {
-        std::cerr << "Warning: Failed to unload font resource\n";
+// Helper: True if the parse stage should read a source whole, so that it is parsed and copied
+// from the same bytes: remote sources, where every read is a round trip and the copy would
+// fetch the whole file again (unless another copy method is forced), and every source with
+// --copy buffered. In-place installs copy nothing.
+static bool ReadsOnce(const std::string& path, const InstallOptions& options) {
+    if (options.inPlace) return false;
+    if (options.copyMethod == SysUtils::CopyMethod::Buffered) return true;
+    return options.copyMethod == SysUtils::CopyMethod::Auto && FontIO::IsRemotePath(path.c_str());
+}
+
+// Helper: Read a whole source file into item.data with as few reads as the file allows,
+// charged to budget (kept: a pending buffer if it fits, else in flight, waiting for room);
+// false (nothing kept or charged) if it cannot be read, is too large or, kept, does not fit,
+// and the item takes the usual path
+static bool ReadInstallSource(InstallItem& item, InstallBudget& budget, bool kept) {
+    if (!MetadataCache::StatFile(item.path.c_str(), item.sourceKey)) return false;
+    FontIO::FileReader reader;
+    if (!reader.Open(item.path.c_str()) || reader.Size() == 0 || reader.Size() > MAX_READ_ONCE_SIZE) return false;
+    if (!kept) {
+        budget.Acquire(reader.Size());
+    } else if (!budget.TryKeep(reader.Size())) {
+        return false;
     }
-    if (!SysUtils::RegDeleteFontEntry(matchedName.c_str(), perUser)) {
-        std::cerr << "Error: Failed to remove font from registry\n";
-        return EXIT_ERROR;
+    item.heldBytes = reader.Size();
+    item.data.resize(static_cast<size_t>(reader.Size()));
+    if (!reader.ReadAt(0, item.data.data(), item.data.size())) {
+        std::vector<uint8_t>().swap(item.data);
+        if (kept) budget.Drop(item.heldBytes);
+        else budget.Release(item.heldBytes);
+        item.heldBytes = 0;
+        return false;
     }
-    if (deleteFile) {
-        if (isAbsolute) {
-            if (DeleteFileA(fullPath.c_str()) == 0) {
-                std::cerr << "Error: Failed to delete font file: " << fullPath << "\n";
-                std::cerr << "Font has been uninstalled but file remains\n";
-                SysUtils::NotifyFontChange();
-                return EXIT_ERROR;
+    item.readOnce = true;
+    return true;
+}
+
+// Helper: Content hash of every item of a content store install, in parallel before the batch
+// starts (the journal names the objects). Plain files are hashed through the metadata cache, so
+// an unchanged source is not read again; archive members are inflated to hash them. Inflated
+// members and sources the parse stage would read once are kept for it while they fit in the
+// batch's budget; members that do not are inflated again by the parse stage.
+static void HashInstallItems(std::vector<InstallItem>& items, const InstallOptions& options, InstallBudget& budget) {
+    Scheduler::ParallelFor(Scheduler::CpuPool(), items.size(), [&items, &options, &budget](size_t i) {
+        InstallItem& item = items[i];
+        if (!item.error.empty()) return;
+        if (item.archive) {
+            if (!CheckInstallableName(item.fileName.c_str()).empty()) return;  // Reported by the parse stage
+            const uint64_t size = std::min<uint64_t>(item.entry->size, MAX_ARCHIVE_FONT_SIZE);  // Extract refuses larger
+            const bool kept = budget.TryKeep(size);
+            if (!kept) budget.Acquire(size);
+            std::vector<uint8_t> data;
+            if (item.archive->Extract(*item.entry, data, MAX_ARCHIVE_FONT_SIZE, item.error)) {
+                item.hash = Checksum::Hash64(data.data(), data.size());
+                if (kept) {
+                    item.data = std::move(data);
+                    item.heldBytes = size;
+                    return;
+                }
+            }
+            if (kept) budget.Drop(size);
+            else budget.Release(size);
+        } else if (!CheckInstallable(item.path.c_str()).empty()) {
+            return;  // Reported by the parse stage
+        } else if (ReadsOnce(item.path, options) && ReadInstallSource(item, budget, true)) {
+            item.hash = Checksum::Hash64(item.data.data(), item.data.size());
+        } else if (!MetadataCache::GetContentHash(GetMetadataCache(), item.path.c_str(), item.hash)) {
+            item.error = "Failed to read font file";
+        }
+    });
+}
+
+// Helper: Parse stage: validate one file and read its faces through the metadata cache. Archive
+// members are inflated into memory and parsed there, and so are read-once sources; buffers kept
+// from hashing are parsed as they are. New buffers are charged to budget, waiting for room,
+// and released by the copy stage.
+static void ParseInstallItem(InstallItem& item, const InstallOptions& options, InstallBudget& budget) {
+    budget.Start(item.heldBytes);
+    if (!item.error.empty()) return;
+    if (item.archive) {
+        item.error = CheckInstallableName(item.fileName.c_str());
+        if (!item.error.empty()) return;
+        if (item.heldBytes == 0) {
+            item.heldBytes = std::min<uint64_t>(item.entry->size, MAX_ARCHIVE_FONT_SIZE);  // Extract refuses larger
+            budget.Acquire(item.heldBytes);
+            std::string error;
+            if (!item.archive->Extract(*item.entry, item.data, MAX_ARCHIVE_FONT_SIZE, error)) {
+                item.error = error;
+                return;
             }
+        }
+        item.faces = FontParser::GetFontMetadata(item.data.data(), item.data.size());
+    } else {
+        item.error = CheckInstallable(item.path.c_str());
+        if (!item.error.empty()) return;
+        if (item.readOnce || (ReadsOnce(item.path, options) && ReadInstallSource(item, budget, false))) {
+            item.faces = FontParser::GetFontMetadata(item.data.data(), item.data.size());
         } else {
-            if (!SysUtils::DeleteFromFontsFolder(fontFile.c_str())) {
-                std::cerr << "Error: Failed to delete font file: " << fullPath << "\n";
-                std::cerr << "Font has been uninstalled but file remains\n";
-                SysUtils::NotifyFontChange();
-                return EXIT_ERROR;
+            item.faces = MetadataCache::GetFontMetadata(GetMetadataCache(), item.path.c_str());
+        }
+    }
+    if (item.faces.empty()) {
+        item.error = "Failed to parse font";
+        return;
+    }
+    item.name = RegistryFontName(item.faces.front());
+    item.isCollection = item.faces.front().isCollection;
+    item.faceCount = item.faces.size();
+}
+
+// Helper: Copy stage: refuse a file that would share a registry name or a fonts-folder file name
+// with one already taken from this batch (both maps belong to the single copy thread), then copy
+// it with the batch's copy method, put it into the content store unless the store already has
+// its contents, or, in place, take the source itself. Archive members and read-once sources are
+// written from memory and hashed as they are written; a read-once source whose bytes no longer
+// match the hash of its store object is refused. The journal's start record for item index
+// precedes any change.
+static void CopyInstallItem(InstallItem& item, bool perUser, const InstallOptions& options,
+                            std::unordered_map<std::string, std::string>& byName,
+                            std::unordered_map<std::string, std::string>& byFile, Journal::Writer& journal, size_t index) {
+    if (!item.error.empty()) {
+        std::vector<uint8_t>().swap(item.data);
+        return;
+    }
+    const std::string& storeDir = options.storeDir;
+    const std::string objectPath = storeDir.empty() ? "" : ContentStore::ObjectPath(storeDir, item.hash, item.fileName);
+    const std::string fileKey = PathKey(options.inPlace ? item.path : storeDir.empty() ? item.fileName : objectPath);
+    const auto name = byName.find(PathKey(item.name));
+    const auto file = byFile.find(fileKey);
+    if (name != byName.end()) {
+        item.error = "Same font name as " + name->second;
+    } else if (file != byFile.end()) {
+        item.error = "Same file name as " + file->second;
+    }
+    if (!item.error.empty()) {
+        std::vector<uint8_t>().swap(item.data);
+        return;
+    }
+    byName.emplace(PathKey(item.name), item.path);
+    byFile.emplace(fileKey, item.path);
+    journal.Started(index, item.name + FONT_SUFFIX_TRUETYPE);
+    if (options.inPlace) {
+        item.destPath = item.path;
+    } else if (!storeDir.empty()) {
+        bool added = false;
+        item.destPath = objectPath;
+        // The hash naming the object came from the metadata cache or from a read before the
+        // batch: the copy is hashed again before it takes the name, since a wrong object would be
+        // registered by every later install of the contents it is named for
+        const auto copy = [&item, &options](const std::string& tempPath, std::string& error) {
+            if (!SysUtils::CopyFontFile(item.path.c_str(), tempPath.c_str(), options.copyMethod, false, &item.copyMethod)) {
+                error = "Failed to copy font file: " + SysUtils::GetLastErrorMessage();
+                return false;
+            }
+            const FontIO::MappedFile copied(tempPath.c_str());
+            if (!copied.IsOpen() || Checksum::Hash64(copied.Bytes().data(), copied.Bytes().size()) != item.hash) {
+                GetMetadataCache().Remove(item.path.c_str());  // The recorded hash is stale
+                error = "Font file changed while it was being installed";
+                return false;
             }
+            return true;
+        };
+        const auto write = [&item](const std::string& tempPath, std::string& error) {
+            Checksum::ContentHasher hasher;
+            if (!SysUtils::WriteFontFile(tempPath.c_str(), item.data.data(), item.data.size(), &hasher)) {
+                error = "Failed to write font file: " + SysUtils::GetLastErrorMessage();
+                return false;
+            }
+            if (hasher.Final() != item.hash) {
+                error = "Font file changed while it was being installed";
+                return false;
+            }
+            item.copyMethod = SysUtils::CopyMethod::Buffered;
+            return true;
+        };
+        const bool stored = item.archive ? ContentStore::Put(objectPath, item.data.data(), item.data.size(), added, item.error)
+                          : item.readOnce ? ContentStore::Put(objectPath, write, added, item.error)
+                                          : ContentStore::Put(objectPath, copy, added, item.error);
+        if (!stored && item.error.empty()) item.error = "Failed to add font file to content store";
+        std::vector<uint8_t>().swap(item.data);
+    } else if (item.archive || item.readOnce) {
+        // Straight from memory to the fonts folder: the archive is never extracted to disk, and
+        // a read-once source is not read again
+        Checksum::ContentHasher hasher;
+        if (!SysUtils::WriteToFontsFolder(item.fileName.c_str(), item.data.data(), item.data.size(), item.destPath,
+                                          perUser, &hasher)) {
+            item.error = "Failed to write font file: " + SysUtils::GetLastErrorMessage();
+        } else {
+            item.hash = hasher.Final();
+            if (item.readOnce) item.copyMethod = SysUtils::CopyMethod::Buffered;
         }
+        std::vector<uint8_t>().swap(item.data);
+    } else if (!SysUtils::CopyToFontsFolder(item.path.c_str(), item.destPath, perUser, options.copyMethod, &item.copyMethod)) {
+        item.error = "Failed to copy font file: " + SysUtils::GetLastErrorMessage();
     }
-    SysUtils::NotifyFontChange();
-    std::cout << "Successfully " << (deleteFile ? "removed" : "uninstalled") << ": " << fontName << "\n";
-    if (!deleteFile) std::cout << "Font file remains at: " << fullPath << "\n";
-    else std::cout << "File deleted: " << fullPath << "\n";
-    return EXIT_SUCCESS_CODE;
 }
 
-int InstallFont(const char* fontPath, bool forceAdmin) {
-    int result = ValidateInstallPrerequisites(fontPath);
-    if (result != EXIT_SUCCESS_CODE) return result;
+// Helper: Register stage (the single registry writer): replace earlier entries of the name,
+// journaled first so a rollback can register them again, then register and load the copy; on
+// failure the entry and the copy are undone. Store objects
+// are registered by absolute path in either scope and are never deleted (others may use them);
+// an entry that already points at the object is left as it is. In-place sources are never
+// deleted either.
+static bool RegisterInstallItem(InstallItem& item, SysUtils::FontRegistryKey* keys, const bool* writable,
+                                const std::string* fontsDirs, bool perUser, const InstallOptions& options,
+                                Journal::Writer& journal, size_t index, bool& changed) {
+    if (!item.error.empty()) return false;
+    const bool inStore = !options.storeDir.empty();
+    const bool ownsFile = !inStore && !options.inPlace;
+    SysUtils::FontRegistryKey& key = keys[perUser];
+    const std::string regValue = (perUser || inStore) ? item.destPath : SysUtils::GetFileName(item.destPath.c_str());
+    const std::string regName = item.name + FONT_SUFFIX_TRUETYPE;
+    std::string current;
+    if (inStore && key.Read(regName.c_str(), current) && PathKey(current) == PathKey(regValue)) {
+        item.unchanged = true;
+        return true;
+    }
+    // Earlier installs of the name are unregistered (files kept) and unloaded, as install has
+    // always done; user entries are skipped when the install is forced to system scope
+    FontStore::Key* const storeKeys[2] = {keys[false].Get(), keys[true].Get()};
+    std::vector<std::string> unregistered;
+    std::vector<FontRegistry::Notice> notices;
+    const std::vector<FontMatch> existing = FontRegistry::FindExistingEntries(
+        item.name, item.faces.front().familyName, item.destPath, storeKeys, writable, fontsDirs, notices);
+    if (!existing.empty()) {
+        std::vector<Journal::RegistryEntry> replaced;
+        for (const auto& entry : existing) replaced.push_back({entry.regName, entry.file, entry.perUser});
+        journal.Started(index, regName, replaced);
+    }
+    changed |= FontRegistry::RemoveExistingEntries(existing, storeKeys, fontsDirs, unregistered, notices);
+    for (const auto& notice : notices) {
+        (notice.warning ? std::cerr << "Warning: " : std::cout << "Note: ") << notice.text << "\n";
+    }
+    for (const auto& path : unregistered) {
+        RemoveFontResourceExA(path.c_str(), FR_PRIVATE, 0);  // Not loaded in this process: not an error
+    }
+    if (!key.Write(regName.c_str(), regValue.c_str())) {
+        item.error = "Failed to register font in registry: " + SysUtils::GetLastErrorMessage();
+        if (ownsFile) DeleteFileA(item.destPath.c_str());  // Either scope's folder
+        return false;
+    }
+    if (AddFontResourceExA(item.destPath.c_str(), FR_PRIVATE, 0) == 0) {
+        item.error = "Failed to load font resource: " + SysUtils::GetLastErrorMessage();
+        key.Delete(regName.c_str());
+        if (ownsFile) DeleteFileA(item.destPath.c_str());
+        return false;
+    }
+    changed = true;
+    // The installed copy has the parsed faces; record them under its own path and write time
+    MetadataCache::FileKey installedKey;
+    if (MetadataCache::StatFile(item.destPath.c_str(), installedKey)) {
+        installedKey.contentHash = item.hash;
+        GetMetadataCache().Store(installedKey, item.faces);
+    }
+    // So does a read-once source, which the cache would otherwise fetch again to hash or parse it
+    if (item.readOnce) {
+        item.sourceKey.contentHash = item.hash;
+        GetMetadataCache().Store(item.sourceKey, item.faces);
+    }
+    return true;
+}
 
-    // Determine installation type
-    bool isAdmin = SysUtils::IsAdmin();
-    bool perUser;
+// Helper: Install expanded font files into one scope (the install pipeline). systemOnly: leave
+// per-user entries of the same names alone (install --admin); options: copy method, content
+// store (already resolved) and in-place registration (files must then be absolute); resumed:
+// the interrupted batch's journal items for files (same order), whose journal this batch
+// replaces. Returns the exit code.
+static int InstallFileBatch(const std::vector<std::string>& files, bool perUser, bool systemOnly,
+                            const InstallOptions& options, const Journal::Batch* resumed = nullptr) {
+    const bool isAdmin = SysUtils::IsAdmin();
+    // One key handle per scope for the whole batch. The user key is not consulted when the
+    // install is forced to system scope; the system key is writable only with admin rights.
+    SysUtils::FontRegistryKey keys[2];      // Indexed by perUser
+    bool writable[2] = {isAdmin, true};
+    const std::string fontsDirs[2] = {SysUtils::GetFontsDirectory(), SysUtils::GetUserFontsDirectory()};
+    if (!systemOnly) keys[true].Open(true, true);
+    if (!keys[false].Open(false, isAdmin) && isAdmin) {
+        writable[false] = false;
+        keys[false].Open(false, false);
+    }
+    if (!keys[perUser].IsOpen() || (!perUser && !writable[false])) {
+        std::cerr << "Error: Cannot open the font registry key: " << SysUtils::GetLastErrorMessage() << "\n";
+        return EXIT_ERROR;
+    }
+    std::vector<InstallItem> items(files.size());
+    for (size_t i = 0; i < files.size(); i++) items[i].path = files[i];
+    InstallBudget budget(MAX_BATCH_BUFFER_SIZE);
+    std::unordered_map<std::string, std::unique_ptr<ZipArchive::Archive>> archives;
+    ResolveInstallItems(items, archives);
+    const std::string& storeDir = options.storeDir;
+    const bool inStore = !storeDir.empty();
+    if (options.inPlace) {
+        for (auto& item : items) {
+            if (item.archive && item.error.empty()) item.error = "Archive entries cannot be installed in place";
+        }
+    }
+    if (inStore) {
+        std::string error;
+        if (!ContentStore::Prepare(storeDir, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return EXIT_ERROR;
+        }
+        HashInstallItems(items, options, budget);
+    }
 
-    if (forceAdmin) {
-        // User explicitly requested system-level installation
-        if (!isAdmin) {
-            std::cerr << "Error: Administrator privileges required for system-level installation\n";
-            std::cerr << "Solution: Right-click Command Prompt and select 'Run as administrator'\n";
-            return EXIT_PERMISSION_DENIED;
+    Journal::Batch intent;
+    intent.op = Journal::Operation::Install;
+    intent.systemOnly = systemOnly;
+    for (size_t i = 0; i < items.size(); i++) {
+        const InstallItem& item = items[i];
+        const std::string dest = options.inPlace ? item.path
+                                 : inStore ? ContentStore::ObjectPath(storeDir, item.hash, item.fileName)
+                                 : fontsDirs[perUser] + "\\" + item.fileName;
+        Journal::Item entry{item.path, dest, perUser};
+        // Rollback deletes only destinations the batch created; a destination the interrupted
+        // batch may have created keeps the state recorded before it
+        MetadataCache::FileKey existing;
+        if (resumed && resumed->items[i].started) {
+            entry.existed = resumed->items[i].existed;
+            entry.size = resumed->items[i].size;
+            entry.modified = resumed->items[i].modified;
+        } else if (item.error.empty() && MetadataCache::StatFile(dest.c_str(), existing)) {
+            entry.existed = true;
+            entry.size = existing.size;
+            entry.modified = existing.modified;
         }
-        perUser = false;
-    } else {
-        // Auto-detect based on admin privileges (current behavior)
-        perUser = !isAdmin;
-        if (perUser) {
-            std::cout << "Installing font for current user only (no admin privileges)...\n";
+        intent.items.push_back(std::move(entry));
+    }
+    Journal::Writer journal;
+    if (!BeginJournal(journal, intent, resumed != nullptr)) return EXIT_ERROR;
+    // Entries the interrupted batch unregistered are gone from the registry now: the new journal
+    // keeps them, so rolling back the replay still registers them again
+    for (size_t i = 0; resumed && i < items.size(); i++) {
+        const Journal::Item& earlier = resumed->items[i];
+        if (!earlier.replaced.empty()) journal.Started(i, earlier.valueName, earlier.replaced);
+    }
+
+    // Three stages run at once: parse tasks on the CPU pool claim files through a shared index,
+    // one task on the I/O pool copies, and this thread is the only registry writer. Bounded
+    // queues between them hold back the faster stage, so memory stays flat however many files
+    // the batch has, and budget caps the bytes of file contents they hold, however large the
+    // files are. The copier waits on the parsers, so it must not share their pool.
+    Scheduler::BoundedQueue<InstallItem*> parsed(INSTALL_QUEUE_CAPACITY);
+    Scheduler::BoundedQueue<InstallItem*> copied(INSTALL_QUEUE_CAPACITY);
+
+    Scheduler::TaskGroup stages;
+    const size_t parserCount = std::min<size_t>(Scheduler::CpuPool().ThreadCount(), files.size());
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> parsersLeft{parserCount};
+    if (parserCount == 0) parsed.Close();
+    for (size_t t = 0; t < parserCount; t++) {
+        stages.Run(Scheduler::CpuPool(), [&items, &next, &parsed, &parsersLeft, &options, &budget]() {
+            for (size_t i = next++; i < items.size(); i = next++) {
+                ParseInstallItem(items[i], options, budget);
+                parsed.Push(&items[i]);
+            }
+            if (--parsersLeft == 0) parsed.Close();
+        });
+    }
+    stages.Run(Scheduler::IoPool(), [&items, &parsed, &copied, perUser, &options, &journal, &budget]() {
+        std::unordered_map<std::string, std::string> byName, byFile;
+        InstallItem* item = nullptr;
+        while (parsed.Pop(item)) {
+            CopyInstallItem(*item, perUser, options, byName, byFile, journal, static_cast<size_t>(item - items.data()));
+            budget.Release(item->heldBytes);  // CopyInstallItem wrote or dropped the buffer
+            item->heldBytes = 0;
+            copied.Push(item);
+        }
+        copied.Close();
+    });
+
+    // Files are reported as they finish, in completion order
+    bool changed = false;
+    size_t installed = 0;
+    size_t unchanged = 0;
+    size_t copiesBy[5] = {};        // Indexed by SysUtils::CopyMethod
+    InstallItem* item = nullptr;
+    while (copied.Pop(item)) {
+        if (RegisterInstallItem(*item, keys, writable, fontsDirs, perUser, options, journal,
+                                static_cast<size_t>(item - items.data()), changed)) {
+            installed++;
         }
+        if (item->unchanged) unchanged++;
+        if (item->error.empty()) copiesBy[static_cast<size_t>(item->copyMethod)]++;
+        if (!item->error.empty()) {
+            std::cerr << "Error: " << item->error << (items.size() == 1 ? "" : ": " + item->path) << "\n";
+        } else if (item->unchanged) {
+            std::cout << "Already installed: " << item->name << " -> " << item->destPath << "\n";
+        } else if (items.size() == 1) {
+            if (item->isCollection && item->faceCount > 1) {
+                std::cout << "Note: Collection contains " << item->faceCount << " fonts\n";
+            }
+            std::cout << "Successfully installed: " << item->name << "\n";
+            std::cout << "Location: " << item->destPath << "\n";
+        } else {
+            std::cout << "Installed: " << item->name << " -> " << item->destPath << "\n";
+        }
+        std::vector<FontParser::FontMetadata>().swap(item->faces);
+        journal.Done(static_cast<size_t>(item - items.data()));
     }
+    stages.Wait();
+    journal.Finish();
 
-    std::string fontName;
-    result = ExtractFontName(fontPath, fontName);
-    if (result != EXIT_SUCCESS_CODE) return result;
-    TryUninstallExistingFont(fontName, forceAdmin);
-    std::string destPath;
-    if (!SysUtils::CopyToFontsFolder(fontPath, destPath, perUser)) {
-        std::cerr << "Error: Failed to copy font file: " << SysUtils::GetLastErrorMessage() << "\n";
-        return EXIT_ERROR;
+    // One broadcast for the whole batch
+    if (changed) SysUtils::NotifyFontChange();
+    SaveMetadataCache();
+    if (items.size() > 1) {
+        std::cout << "Installed " << installed << " of " << items.size() << " font file(s)";
+        if (unchanged > 0) std::cout << " (" << unchanged << " already installed)";
+        if (installed < items.size()) std::cout << ", " << items.size() - installed << " failed";
+        std::cout << "\n";
+        // Which copy methods worked, when any did better than a plain copy
+        if (copiesBy[static_cast<size_t>(SysUtils::CopyMethod::Clone)] + copiesBy[static_cast<size_t>(SysUtils::CopyMethod::Hardlink)] > 0) {
+            std::cout << "Copies:";
+            for (size_t m = 1; m < 5; m++) {
+                if (copiesBy[m] > 0) std::cout << " " << copiesBy[m] << " " << SysUtils::CopyMethodName(static_cast<SysUtils::CopyMethod>(m));
+            }
+            std::cout << "\n";
+        }
     }
-    result = RegisterAndLoadFont(destPath, fontName, perUser);
-    if (result != EXIT_SUCCESS_CODE) return result;
-    SysUtils::NotifyFontChange();
-    std::cout << "Successfully installed: " << fontName << "\n";
-    std::cout << "Location: " << destPath << "\n";
-    if (perUser) {
-        std::cout << "Note: Font installed for current user only\n";
+    if (perUser && installed > 0) {
+        std::cout << "Note: " << (installed == 1 ? "Font" : "Fonts") << " installed for current user only\n";
     }
-    return EXIT_SUCCESS_CODE;
+    return installed == items.size() ? EXIT_SUCCESS_CODE : EXIT_ERROR;
 }
 
-int UninstallFontByPath(const char* fontPath, bool forceAdmin) {
-    // Parse font name
-    std::string fontName = FontParser::GetFontName(fontPath);
-    if (fontName.empty()) {
-        std::cerr << "Error: Failed to parse font name\n";
+int InstallFonts(const std::vector<std::string>& inputs, const InstallOptions& options) {
+    const bool forceAdmin = options.forceAdmin;
+    if (options.inPlace && (forceAdmin || !options.storeDir.empty())) {
+        std::cerr << "Error: --in-place cannot be combined with " << (forceAdmin ? "--admin" : "--store") << "\n";
+        std::cerr << "Solution: In-place fonts are registered for the current user, from where they are; drop the option\n";
+        return EXIT_ERROR;
+    }
+    // Determine installation type
+    const bool isAdmin = SysUtils::IsAdmin();
+    if (forceAdmin && !isAdmin) {
+        // User explicitly requested system-level installation
+        std::cerr << "Error: Administrator privileges required for system-level installation\n";
+        std::cerr << "Solution: Right-click Command Prompt and select 'Run as administrator'\n";
+        return EXIT_PERMISSION_DENIED;
+    }
+    // Without --admin, the scope follows the privileges; in-place fonts are always per user
+    const bool perUser = options.inPlace || (!forceAdmin && !isAdmin);
+    InstallOptions batchOptions = options;
+    batchOptions.storeDir = ContentStore::Resolve(options.storeDir);
+    if (options.copyMethod == SysUtils::CopyMethod::Hardlink && (!perUser || !batchOptions.storeDir.empty())) {
+        std::cerr << "Error: Hard links are only made for per-user installs outside a content store\n";
+        std::cerr << "Solution: A system font linked to a user's file would keep that file's permissions, and a store\n"
+                  << "object must not change with its source; use another --copy method\n";
         return EXIT_ERROR;
     }
 
-    return UninstallFontByName(fontName.c_str(), forceAdmin);
-}
+    std::vector<std::string> files;
+    const bool expanded = ExpandFontPaths(inputs, files, true);
+    if (files.empty()) {
+        std::cerr << "Error: No font files to install\n";
+        return EXIT_ERROR;
+    }
+    if (options.inPlace) {
+        // The registry keeps the path for good: make it absolute
+        for (auto& file : files) {
+            std::error_code ec;
+            std::string absolute;
+            if (!ZipArchive::IsArchivePath(file.c_str()) && NarrowPath(std::filesystem::absolute(file, ec), absolute) && !ec) {
+                file = absolute;
+            }
+        }
+    }
 
-// Helper: Check if string is empty or contains only whitespace characters
-static bool IsEmptyOrWhitespace(const char* str) noexcept {
-    if (!str || *str == '\0') return true;
-    for (const char* p = str; *p; ++p) {
-        if (*p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') return false;
+    if (options.inPlace) {
+        std::cout << "Registering " << (files.size() == 1 ? "font" : "fonts") << " in place for current user only...\n";
+    } else if (perUser) {
+        std::cout << "Installing " << (files.size() == 1 ? "font" : "fonts") << " for current user only (no admin privileges)...\n";
     }
-    return true;
+    const int result = InstallFileBatch(files, perUser, forceAdmin, batchOptions);
+    return (result == EXIT_SUCCESS_CODE && !expanded) ? EXIT_ERROR : result;
+}
+
+int InstallFont(const char* fontPath, bool forceAdmin) {
+    InstallOptions options;
+    options.forceAdmin = forceAdmin;
+    return InstallFonts({fontPath}, options);
+}
+
+int UninstallFontByPath(const char* fontPath, bool forceAdmin) {
+    // Parse font name
+    std::string fontName;
+    int result = ExtractFontName(fontPath, fontName);
+    if (result == EXIT_SUCCESS_CODE) result = UninstallFontByName(fontName.c_str(), forceAdmin);
+    SaveMetadataCache();
+    return result;
 }
 
 int UninstallFontByName(const char* fontName, bool forceAdmin) {
-    if (IsEmptyOrWhitespace(fontName)) {
-        std::cerr << "Error: Font name cannot be empty\n";
-        return EXIT_ERROR;
-    }
-    return RemoveFontFromAllScopes(fontName, false, forceAdmin);
+    return RemoveFontsByName({fontName ? fontName : ""}, false, forceAdmin);
 }
 
 int RemoveFontByPath(const char* fontPath, bool forceAdmin) {
     // Parse font name
-    std::string fontName = FontParser::GetFontName(fontPath);
-    if (fontName.empty()) {
-        std::cerr << "Error: Failed to parse font name\n";
-        return EXIT_ERROR;
+    std::string fontName;
+    int result = ExtractFontName(fontPath, fontName);
+    if (result == EXIT_SUCCESS_CODE) result = RemoveFontByName(fontName.c_str(), forceAdmin);
+    SaveMetadataCache();
+    return result;
+}
+
+int RemoveFontByName(const char* fontName, bool forceAdmin) {
+    return RemoveFontsByName({fontName ? fontName : ""}, true, forceAdmin);
+}
+
+// One font of a sync: a manifest file, an installed registry entry, or both
+struct SyncFont {
+    std::string key;            // PathKey of the registry name (merge order)
+    std::string name;           // Registry name without type suffix
+    std::string path;           // Manifest file, or installed file (full path)
+    std::string regName;        // Installed entries only
+    bool perUser = false;       // Installed entries only
+    uint64_t hash = 0;          // Manifest files: content hash
+};
+
+// Helper: Name and content hash of every manifest file, parsed in parallel through the cache.
+// Any file that cannot be read or parsed fails the whole sync: an incomplete desired set would
+// make installed fonts look unwanted, so the first failure cancels the files not yet started.
+static bool ReadDesiredFonts(const std::vector<std::string>& files, std::vector<SyncFont>& desired) {
+    desired.assign(files.size(), SyncFont());
+    std::vector<std::string> errors(files.size());
+    Scheduler::TaskGroup group;
+    Scheduler::ParallelFor(group, Scheduler::CpuPool(), files.size(), [&files, &desired, &errors, &group](size_t i) {
+        SyncFont& font = desired[i];
+        font.path = files[i];
+        errors[i] = CheckInstallable(font.path.c_str());
+        if (errors[i].empty()) {
+            const std::vector<FontParser::FontMetadata> faces = MetadataCache::GetFontMetadata(GetMetadataCache(), font.path.c_str());
+            if (faces.empty() || !MetadataCache::GetContentHash(GetMetadataCache(), font.path.c_str(), font.hash)) {
+                errors[i] = "Failed to parse font";
+            } else {
+                font.name = RegistryFontName(faces.front());
+                font.key = PathKey(font.name);
+            }
+        }
+        if (!errors[i].empty()) group.Cancel();
+    });
+
+    bool ok = true;
+    for (size_t i = 0; i < files.size(); i++) {
+        if (errors[i].empty()) continue;
+        std::cerr << "Error: " << errors[i] << ": " << files[i] << "\n";
+        ok = false;
     }
+    if (!ok) return false;
+    std::sort(desired.begin(), desired.end(), [](const SyncFont& a, const SyncFont& b) { return a.key < b.key; });
+    for (size_t i = 1; i < desired.size(); i++) {
+        if (desired[i].key != desired[i - 1].key) continue;
+        std::cerr << "Error: " << desired[i - 1].path << " and " << desired[i].path << " are both named '" << desired[i].name << "'\n";
+        ok = false;
+    }
+    return ok;
+}
 
-    return RemoveFontByName(fontName.c_str(), forceAdmin);
+// Helper: Every registry entry of both scopes, sorted by name
+static void SnapshotInstalledFonts(std::vector<SyncFont>& installed) {
+    const std::string fontsDir = SysUtils::GetFontsDirectory();
+    for (const bool perUser : {true, false}) {
+        SysUtils::FontRegistryKey key;
+        std::vector<std::pair<std::string, std::string>> entries;
+        if (!key.Open(perUser, false) || !key.Enumerate(entries)) continue;
+        for (const auto& entry : entries) {
+            SyncFont font;
+            font.regName = entry.first;
+            font.name = FontRegistry::StripSuffix(entry.first);
+            font.key = PathKey(font.name);
+            const bool isAbsolute = entry.second.length() > 1 && entry.second[1] == ':';
+            font.path = isAbsolute ? entry.second : fontsDir + "\\" + entry.second;
+            font.perUser = perUser;
+            installed.push_back(std::move(font));
+        }
+    }
+    std::sort(installed.begin(), installed.end(), [](const SyncFont& a, const SyncFont& b) { return a.key < b.key; });
 }
 
-int RemoveFontByName(const char* fontName, bool forceAdmin) {
-    if (IsEmptyOrWhitespace(fontName)) {
-        std::cerr << "Error: Font name cannot be empty\n";
+int SyncFonts(const char* manifestPath, bool dryRun) {
+    Manifest::FontManifest manifest;
+    std::string error;
+    if (!Manifest::Load(manifestPath, manifest, error)) {
+        std::cerr << "Error: Invalid manifest " << manifestPath << ": " << error << "\n";
+        return EXIT_ERROR;
+    }
+    const bool isAdmin = SysUtils::IsAdmin();
+    const bool perUser = manifest.scope == Manifest::Scope::User || (manifest.scope == Manifest::Scope::Auto && !isAdmin);
+    if (!perUser && !isAdmin && !dryRun) {
+        std::cerr << "Error: Administrator privileges required for a system-scope manifest\n";
+        std::cerr << "Solution: Right-click Command Prompt and select 'Run as administrator'\n";
+        return EXIT_PERMISSION_DENIED;
+    }
+
+    // The desired set must be complete before anything is compared against it
+    std::vector<std::string> files;
+    if (!ExpandFontPaths(manifest.fonts, files)) return EXIT_ERROR;
+    std::vector<SyncFont> desired;
+    if (!files.empty() && !ReadDesiredFonts(files, desired)) return EXIT_ERROR;
+    std::vector<SyncFont> installed;
+    SnapshotInstalledFonts(installed);
+
+    // Sorted merge by name. A desired font is untouched if an entry of that name in either scope
+    // has its contents, an upgrade if only other contents are installed, an install if nothing
+    // is. Entries the manifest does not name are uninstalled if they are in the manifest's scope
+    // and match "manage"; without it nothing is uninstalled.
+    std::vector<NamePattern> managed;
+    if (!FontRegistry::CompileNamePatterns(manifest.manage, false, managed)) return EXIT_ERROR;
+    std::vector<const SyncFont*> toInstall, toUpgrade;
+    std::vector<RemovalTarget> toUninstall;
+    size_t untouched = 0;
+    size_t unmanaged = 0;
+    size_t d = 0, i = 0;
+    while (d < desired.size() || i < installed.size()) {
+        const int order = d == desired.size() ? 1 : i == installed.size() ? -1 : desired[d].key.compare(installed[i].key);
+        if (order < 0) {
+            toInstall.push_back(&desired[d++]);
+            continue;
+        }
+        size_t end = i;
+        while (end < installed.size() && installed[end].key == installed[i].key) end++;
+        if (order == 0) {
+            bool current = false;
+            for (size_t k = i; k < end && !current; k++) {
+                uint64_t hash = 0;
+                current = MetadataCache::GetContentHash(GetMetadataCache(), installed[k].path.c_str(), hash) && hash == desired[d].hash;
+            }
+            if (current) untouched++;
+            else toUpgrade.push_back(&desired[d]);
+            d++;
+        } else {
+            for (size_t k = i; k < end; k++) {
+                const SyncFont& font = installed[k];
+                if (font.perUser != perUser) continue;
+                bool selected = false;
+                for (const auto& pattern : managed) selected |= FontRegistry::MatchesNamePattern(pattern, font.regName, font.name);
+                if (selected) toUninstall.push_back({{font.path, font.regName, font.perUser}, font.name});
+                else if (managed.empty()) unmanaged++;
+            }
+        }
+        i = end;
+    }
+
+    // A manifest whose fonts all went missing (a mistyped or empty directory) would uninstall
+    // every managed font
+    if (desired.empty() && !toUninstall.empty()) {
+        std::cerr << "Error: The manifest's fonts matched no files; refusing to uninstall " << toUninstall.size()
+                  << " managed font" << (toUninstall.size() == 1 ? "" : "s") << "\n";
+        std::cerr << "Solution: Check the \"fonts\" paths, or use 'uninstall -n' to retire fonts on purpose\n";
         return EXIT_ERROR;
     }
-    return RemoveFontFromAllScopes(fontName, true, forceAdmin);
+
+    const char* scopeName = perUser ? "user" : "system";
+    for (const SyncFont* font : toInstall) std::cout << "install    " << font->name << "  <- " << font->path << "\n";
+    for (const SyncFont* font : toUpgrade) std::cout << "upgrade    " << font->name << "  <- " << font->path << "\n";
+    for (const auto& target : toUninstall) std::cout << "uninstall  " << target.fontName << "\n";
+    std::cout << "Plan (" << scopeName << " scope): " << toInstall.size() << " to install, " << toUpgrade.size()
+              << " to upgrade, " << toUninstall.size() << " to uninstall, " << untouched << " untouched\n";
+    if (unmanaged > 0) {
+        std::cout << "Note: " << unmanaged << " installed font" << (unmanaged == 1 ? " is" : "s are")
+                  << " not in the manifest and left alone; add \"manage\" patterns to let sync uninstall them\n";
+    }
+    if (dryRun || (toInstall.empty() && toUpgrade.empty() && toUninstall.empty())) {
+        SaveMetadataCache();  // Hashes computed for the comparison
+        return EXIT_SUCCESS_CODE;
+    }
+
+    // Uninstall first, so a font that moved to a new name does not briefly exist twice
+    bool failed = false;
+    if (!toUninstall.empty()) {
+        SysUtils::FontRegistryKey key;
+        if (!key.Open(perUser, true)) {
+            std::cerr << "Error: Cannot open the font registry key: " << SysUtils::GetLastErrorMessage() << "\n";
+            return EXIT_ERROR;
+        }
+        const std::string fontsDir = SysUtils::GetFontsDirectory();
+        Journal::Writer journal;
+        if (!BeginRemovalJournal(journal, toUninstall, false, fontsDir)) return EXIT_ERROR;
+        size_t removed = 0;
+        for (size_t t = 0; t < toUninstall.size(); t++) {
+            if (RemoveRegisteredFont(toUninstall[t], key, false, fontsDir)) removed++;
+            else failed = true;
+            journal.Done(t);
+        }
+        journal.Finish();
+        if (removed > 0) SysUtils::NotifyFontChange();
+    }
+
+    // Installs and upgrades go through the install pipeline; it replaces the older entries
+    std::vector<std::string> installFiles;
+    for (const SyncFont* font : toInstall) installFiles.push_back(font->path);
+    for (const SyncFont* font : toUpgrade) installFiles.push_back(font->path);
+    InstallOptions installOptions;
+    installOptions.storeDir = ContentStore::Resolve("");
+    if (!installFiles.empty() && InstallFileBatch(installFiles, perUser, !perUser, installOptions) != EXIT_SUCCESS_CODE) failed = true;
+    SaveMetadataCache();
+    return failed ? EXIT_ERROR : EXIT_SUCCESS_CODE;
+}
+
+// Helper: Undo an install that did not finish. Only an item with a start record can have
+// changed anything; its registry entry is removed if it points at the destination, and the
+// destination is deleted if the batch created it. A destination that existed before the batch
+// (a font the copy replaced, a store object, an in-place source) is kept with its entries. The
+// earlier entries the item unregistered (files kept) are registered again where their value
+// name is free, through keys (indexed by perUser).
+static bool RollBackInstall(const Journal::Item& item, SysUtils::FontRegistryKey* keys, const std::string& fontsDir) {
+    if (!item.started) {
+        std::cout << "Not started, nothing to roll back: " << item.first << "\n";
+        return true;
+    }
+    SysUtils::FontRegistryKey& key = keys[item.perUser];
+    MetadataCache::FileKey current;
+    const bool exists = MetadataCache::StatFile(item.second.c_str(), current);
+    bool ok = true;
+    if (item.existed) {
+        if (exists && (current.size != item.size || current.modified != item.modified)) {
+            std::cerr << "Warning: Kept " << item.second << ": the batch replaced a file that was there before it\n";
+        } else {
+            std::cout << "Kept " << item.second << ": it was there before the batch\n";
+        }
+    } else {
+        std::string fontFile;
+        if (key.Read(item.valueName.c_str(), fontFile)) {
+            const bool isAbsolute = fontFile.length() > 1 && fontFile[1] == ':';
+            if (PathKey(isAbsolute ? fontFile : fontsDir + "\\" + fontFile) == PathKey(item.second)) {
+                RemoveFontResourceExA(item.second.c_str(), FR_PRIVATE, 0);  // Not loaded in this process: not an error
+                ok = key.Delete(item.valueName.c_str());
+            }
+        }
+        // Others may have registered a store object since the batch added it
+        if (exists && !ContentStore::IsObject(item.second) && DeleteFileA(item.second.c_str()) == 0) {
+            std::cerr << "Error: Failed to delete font file: " << item.second << "\n";
+            ok = false;
+        }
+        if (ok) std::cout << "Rolled back: " << item.second << "\n";
+    }
+    for (const auto& entry : item.replaced) {
+        SysUtils::FontRegistryKey& entryKey = keys[entry.perUser];
+        std::string registered;
+        if (!entryKey.IsOpen()) {
+            std::cerr << "Error: Cannot restore " << entry.valueName << ": administrator privileges required\n";
+            ok = false;
+        } else if (entryKey.Read(entry.valueName.c_str(), registered)) {
+            std::cerr << "Warning: Not restoring " << entry.valueName << ": the name is registered again\n";
+        } else if (!entryKey.Write(entry.valueName.c_str(), entry.file.c_str())) {
+            std::cerr << "Error: Failed to register font in registry: " << entry.valueName << "\n";
+            ok = false;
+        } else {
+            std::cout << "Restored: " << FontRegistry::StripSuffix(entry.valueName) << "\n";
+        }
+    }
+    return ok;
+}
+
+// Helper: Finish (or, with rollback, undo) a removal that did not finish. Finishing deletes
+// the entry if it is still there and, for remove, the file; undoing registers the file again
+// if it still exists.
+static bool ResumeRemoval(const Journal::Item& item, bool deleteFile, bool rollback, SysUtils::FontRegistryKey& key) {
+    std::string current;
+    const bool registered = key.Read(item.first.c_str(), current);
+    if (rollback) {
+        if (registered) return true;
+        if (!SysUtils::FileExists(item.second.c_str())) {
+            std::cerr << "Error: Cannot restore " << item.first << ": file is gone: " << item.second << "\n";
+            return false;
+        }
+        const bool absolute = item.perUser || ContentStore::IsObject(item.second);
+        const std::string value = absolute ? item.second : SysUtils::GetFileName(item.second.c_str());
+        if (!key.Write(item.first.c_str(), value.c_str())) {
+            std::cerr << "Error: Failed to register font in registry: " << item.first << "\n";
+            return false;
+        }
+        std::cout << "Restored: " << FontRegistry::StripSuffix(item.first) << "\n";
+        return true;
+    }
+    if (registered) {
+        RemoveFontResourceExA(item.second.c_str(), FR_PRIVATE, 0);  // Not loaded in this process: not an error
+        if (!key.Delete(item.first.c_str())) {
+            std::cerr << "Error: Failed to remove font from registry: " << item.first << "\n";
+            return false;
+        }
+    }
+    if (deleteFile && !ContentStore::IsObject(item.second) && SysUtils::FileExists(item.second.c_str())) {
+        if (DeleteFileA(item.second.c_str()) == 0) {
+            std::cerr << "Error: Failed to delete font file: " << item.second << "\n";
+            return false;
+        }
+        GetMetadataCache().Remove(item.second.c_str());
+    }
+    std::cout << "Successfully " << (deleteFile ? "removed" : "uninstalled") << ": " << FontRegistry::StripSuffix(item.first) << "\n";
+    return true;
+}
+
+int ResumeBatch(bool rollback) {
+    const std::string dataDir = SysUtils::GetDataDirectory();
+    const std::string journalPath = dataDir + "\\" + JOURNAL_FILE;
+    Journal::Batch batch;
+    if (dataDir.empty() || !Journal::Read(journalPath, batch)) {
+        std::cout << "No interrupted batch to resume\n";
+        return EXIT_SUCCESS_CODE;
+    }
+    std::vector<size_t> unfinished;
+    for (size_t i = 0; i < batch.items.size(); i++) {
+        if (!batch.items[i].done) unfinished.push_back(i);
+    }
+    Journal::Writer journal;
+    journal.Reopen(journalPath);
+    if (unfinished.empty()) {
+        std::cout << "Interrupted batch had already finished every item\n";
+        journal.Finish();
+        return EXIT_SUCCESS_CODE;
+    }
+    static const char* const OPERATION_NAMES[] = {"", "install", "uninstall", "remove"};
+    std::cout << (rollback ? "Rolling back" : "Resuming") << " interrupted " << OPERATION_NAMES[static_cast<int>(batch.op)]
+              << " batch: " << unfinished.size() << " of " << batch.items.size() << " item(s) unfinished\n";
+
+    // Items of the system scope need admin rights, as they did in the original batch
+    const bool isAdmin = SysUtils::IsAdmin();
+    for (const size_t i : unfinished) {
+        if (!batch.items[i].perUser && !isAdmin) {
+            std::cerr << "Error: Administrator privileges required to resume a batch of system fonts\n";
+            std::cerr << "Solution: Right-click Command Prompt and select 'Run as administrator'\n";
+            return EXIT_PERMISSION_DENIED;
+        }
+    }
+    SysUtils::FontRegistryKey keys[2];      // Indexed by perUser
+    const std::string fontsDirs[2] = {SysUtils::GetFontsDirectory(), SysUtils::GetUserFontsDirectory()};
+    keys[true].Open(true, true);
+    if (isAdmin) keys[false].Open(false, true);
+
+    bool failed = false;
+    bool changed = false;
+    std::vector<std::string> replay;
+    Journal::Batch replayed;        // Their journal items
+    bool replayPerUser = true;
+    InstallOptions replayOptions;   // Content store or in-place registration of the batch
+    for (const size_t i : unfinished) {
+        const Journal::Item& item = batch.items[i];
+        SysUtils::FontRegistryKey& key = keys[item.perUser];
+        if (!key.IsOpen()) {
+            std::cerr << "Error: Cannot open the font registry key: " << SysUtils::GetLastErrorMessage() << "\n";
+            return EXIT_ERROR;
+        }
+        if (batch.op == Journal::Operation::Install) {
+            // Replay from the source (or its archive) when it is still there; roll back otherwise
+            std::string archivePath, entryName;
+            const bool isMember = ZipArchive::SplitMemberPath(item.first, archivePath, entryName);
+            if (!rollback && SysUtils::FileExists(isMember ? archivePath.c_str() : item.first.c_str())) {
+                replay.push_back(item.first);
+                replayed.items.push_back(item);
+                replayPerUser = item.perUser;
+                if (ContentStore::IsObject(item.second)) replayOptions.storeDir = item.second.substr(0, item.second.find_last_of('\\'));
+                if (PathKey(item.first) == PathKey(item.second)) replayOptions.inPlace = true;
+                continue;
+            }
+            if (RollBackInstall(item, keys, fontsDirs[false])) changed = true;
+            else failed = true;
+        } else if (ResumeRemoval(item, batch.op == Journal::Operation::Remove, rollback, key)) {
+            changed = true;
+        } else {
+            failed = true;
+        }
+        journal.Done(i);
+    }
+    if (changed) SysUtils::NotifyFontChange();
+
+    // Installs are replayed through the install pipeline, whose journal replaces this one
+    if (!replay.empty()) {
+        journal.Close();
+        if (InstallFileBatch(replay, replayPerUser, batch.systemOnly, replayOptions, &replayed) != EXIT_SUCCESS_CODE) failed = true;
+    } else {
+        journal.Finish();
+    }
+    SaveMetadataCache();
+    return failed ? EXIT_ERROR : EXIT_SUCCESS_CODE;
 }
 
 int Cleanup(bool includeSystem) {
     std::cout << "Scanning font registry for broken entries...\n";
     int brokenEntries = CleanupRegistry(includeSystem, true);
+    SaveMetadataCache();
     bool registryOk = brokenEntries >= 0;
     if (registryOk) {
         std::cout << "Found and removed " << brokenEntries << " broken font entries.\n";
@@ -546,4 +1605,642 @@ int Cleanup(bool includeSystem) {
     return EXIT_SUCCESS_CODE;
 }
 
+// Helper: Human-readable outline format
+static const char* FormatName(FontParser::FontFormat format) noexcept {
+    switch (format) {
+        case FontParser::FontFormat::TrueType: return "TrueType";
+        case FontParser::FontFormat::OpenTypeCFF: return "OpenType (CFF)";
+        default: return "Unknown";
+    }
+}
+
+int ShowFontInfo(const char* fontPath, bool showIo, bool planned) {
+    const bool isStdin = strcmp(fontPath, FontIO::STDIN_PATH) == 0;
+    if (!isStdin && !SysUtils::FileExists(fontPath)) {
+        std::cerr << "Error: Font file not found: " << fontPath << "\n";
+        return EXIT_ERROR;
+    }
+
+    FontIO::IoStats stats;
+    const FontParser::IoMode mode = planned && !isStdin ? FontParser::IoMode::Planned : FontParser::IoMode::Auto;
+    std::vector<FontParser::FontMetadata> faces = FontParser::GetFontMetadata(fontPath, &stats, mode);
+    if (faces.empty()) {
+        std::cerr << "Error: Failed to parse font file: " << fontPath << "\n";
+        return EXIT_ERROR;
+    }
+
+    for (const auto& face : faces) {
+        if (face.isCollection) std::cout << "Face " << face.collectionIndex << ":\n";
+        std::cout << "  Family:      " << face.familyName << "\n";
+        std::cout << "  Subfamily:   " << face.subfamilyName << "\n";
+        std::cout << "  Full name:   " << face.fullName << "\n";
+        std::cout << "  PostScript:  " << face.postScriptName << "\n";
+        if (!face.typographicFamily.empty()) {
+            std::cout << "  Typographic: " << face.typographicFamily << " " << face.typographicSubfamily << "\n";
+        }
+        std::cout << "  Format:      " << FormatName(face.format) << "\n";
+        if (face.container != FontParser::FontContainer::Sfnt) {
+            std::cout << "  Container:   " << (face.container == FontParser::FontContainer::Woff2 ? "WOFF2" : "WOFF") << "\n";
+        }
+        std::cout << "  Weight:      " << face.weightClass << "  Width: " << face.widthClass
+                  << "  fsType: " << face.fsType << "\n";
+        char revision[16];
+        snprintf(revision, sizeof(revision), "%.3f", face.fontRevision / 65536.0);  // 16.16 fixed
+        std::cout << "  Revision:    " << revision << "\n";
+    }
+
+    if (showIo) {
+        if (stats.readCalls > 0) {
+            std::cout << "I/O: " << stats.readCalls << " read(s), " << stats.bytesRead << " bytes read\n";
+        } else {
+            std::cout << "I/O: memory-mapped, " << stats.bytesMapped << " bytes mapped\n";
+        }
+    }
+    return EXIT_SUCCESS_CODE;
+}
+
+int VerifyFonts(const std::vector<std::string>& inputs, bool quiet) {
+    std::vector<std::string> files;
+    const bool expanded = ExpandFontPaths(inputs, files);
+    if (files.empty()) {
+        std::cerr << "Error: No font files to verify\n";
+        return EXIT_ERROR;
+    }
+
+    // Files are independent: the CPU pool's workers claim them through a shared index
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<FontParser::VerifyReport> reports(files.size());
+    Scheduler::ParallelFor(Scheduler::CpuPool(), files.size(), [&files, &reports](size_t i) {
+        reports[i] = FontParser::VerifyChecksums(files[i].c_str());
+    });
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Reports are printed in input order
+    size_t failed = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        const FontParser::VerifyReport& report = reports[i];
+        if (report.Passed()) {
+            if (!quiet) std::cout << "OK    " << files[i] << " (" << report.tableCount << " tables)\n";
+            continue;
+        }
+        failed++;
+        std::cout << "FAIL  " << files[i] << "\n";
+        for (const auto& issue : report.issues) {
+            std::cout << "      " << issue << "\n";
+        }
+    }
+
+    char elapsed[32];
+    snprintf(elapsed, sizeof(elapsed), "%.2f", seconds);
+    std::cout << "Verified " << files.size() << " file(s) in " << elapsed << " s: "
+              << files.size() - failed << " passed, " << failed << " failed\n";
+    return (failed == 0 && expanded) ? EXIT_SUCCESS_CODE : EXIT_ERROR;
+}
+
+// Helper: Append a name to a record; tabs and line breaks would split the record
+static void AppendField(std::string& out, const std::string& value) {
+    out += '\t';
+    for (const char c : value) {
+        out += (static_cast<unsigned char>(c) < 0x20) ? ' ' : c;
+    }
+}
+
+// Helper: One tab-separated scan record per face (see ScanFonts for the columns)
+static void AppendScanRecords(const std::string& path, const std::vector<FontParser::FontMetadata>& faces, std::string& out) {
+    for (const auto& face : faces) {
+        out += path;
+        out += '\t';
+        out += std::to_string(face.collectionIndex);
+        AppendField(out, face.familyName);
+        AppendField(out, face.subfamilyName);
+        AppendField(out, face.fullName);
+        AppendField(out, face.postScriptName);
+        out += face.format == FontParser::FontFormat::OpenTypeCFF ? "\tCFF" : (face.format == FontParser::FontFormat::TrueType ? "\tTrueType" : "\tUnknown");
+        out += face.container == FontParser::FontContainer::Woff2 ? "\twoff2" : (face.container == FontParser::FontContainer::Woff ? "\twoff" : "\tsfnt");
+        char numbers[64];
+        snprintf(numbers, sizeof(numbers), "\t%u\t%u\t%u\t%.3f\n", face.weightClass, face.widthClass, face.fsType,
+                 face.fontRevision / 65536.0);  // 16.16 fixed
+        out += numbers;
+    }
+}
+
+// Counters shared by the scan tasks
+struct ScanTotals {
+    std::atomic<size_t> directories{0};
+    std::atomic<size_t> files{0};
+    std::atomic<size_t> fonts{0};
+    std::atomic<size_t> faces{0};
+    std::atomic<size_t> cached{0};    // Font files answered by the metadata cache
+    std::atomic<size_t> skipped{0};   // No font signature
+    std::atomic<size_t> failed{0};    // Font signature but no parsable face, or unusable path
+    std::atomic<size_t> unreadable{0};
+};
+
+int ScanFonts(const std::vector<std::string>& roots, bool useCache) {
+    namespace fs = std::filesystem;
+    for (const auto& root : roots) {
+        std::error_code ec;
+        if (!fs::is_directory(root, ec) && !fs::is_regular_file(root, ec)) {
+            std::cerr << "Error: Path not found: " << root << "\n";
+            return EXIT_ERROR;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    Scheduler::WorkStealingPool& cpu = Scheduler::CpuPool();
+    Scheduler::WorkStealingPool& io = Scheduler::IoPool();
+    ScanTotals totals;
+    std::mutex outputMutex;
+    MetadataCache::Cache* cache = useCache ? &GetMetadataCache() : nullptr;
+
+    // File task: a current cache entry answers without opening the file; otherwise sniff the
+    // signature and parse every face. The records are written in one piece.
+    // key.path is empty when the directory listing did not provide the size and write time.
+    const auto scanFile = [&totals, &outputMutex, cache](const std::string& path, MetadataCache::FileKey key) {
+        totals.files++;
+        std::vector<FontParser::FontMetadata> faces;
+        const bool keyed = cache && (!key.path.empty() || MetadataCache::StatFile(path.c_str(), key));
+        if (keyed && cache->Lookup(key, faces)) {
+            totals.cached++;
+        } else if (!FontParser::HasFontSignature(path.c_str())) {
+            totals.skipped++;
+            return;
+        } else {
+            faces = FontParser::GetFontMetadata(path.c_str());
+            if (keyed && !faces.empty()) cache->Store(key, faces);
+        }
+        if (faces.empty()) {
+            totals.failed++;
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cerr << "Warning: Failed to parse font file: " << path << "\n";
+            return;
+        }
+        totals.fonts++;
+        totals.faces += faces.size();
+        std::string records;
+        AppendScanRecords(path, faces, records);
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cout.write(records.data(), static_cast<std::streamsize>(records.size()));
+    };
+
+    // Directory task (I/O pool): one task per subdirectory, queued on this worker for others to
+    // steal, and one parse task per file on the CPU pool. Symbolic links and junctions to
+    // directories are not followed, so the walk cannot loop.
+    Scheduler::TaskGroup group;
+    std::function<void(const fs::path&)> scanDirectory;
+    scanDirectory = [&cpu, &io, &group, &totals, &outputMutex, &scanFile, &scanDirectory](const fs::path& dir) {
+        totals.directories++;
+        std::error_code ec;
+        for (fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+            std::error_code entryEc;
+            const fs::file_status linkStatus = it->symlink_status(entryEc);
+            if (entryEc) continue;
+            if (fs::is_directory(linkStatus)) {
+                group.Run(io, [&scanDirectory, sub = it->path()]() { scanDirectory(sub); });
+                continue;
+            }
+            if (!it->is_regular_file(entryEc)) continue;
+            // Windows returns size and write time with each directory entry, so no file is opened
+            MetadataCache::FileKey key;
+            const uint64_t size = it->file_size(entryEc);
+            const auto modified = it->last_write_time(entryEc);
+            std::string path;
+            if (!NarrowPath(it->path(), path)) {
+                totals.files++;
+                totals.failed++;
+                std::string narrowDir;
+                std::lock_guard<std::mutex> lock(outputMutex);
+                std::cerr << "Warning: Skipping a file whose name has characters outside the ANSI code page in "
+                          << (NarrowPath(dir, narrowDir) ? narrowDir : "(unprintable path)") << "\n";
+                continue;
+            }
+            if (!entryEc) {
+                key.path = MetadataCache::NormalizePath(path.c_str());
+                key.size = size;
+                key.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+            }
+            group.Run(cpu, [&scanFile, path = std::move(path), key = std::move(key)]() { scanFile(path, key); });
+        }
+        if (ec) {
+            totals.unreadable++;
+            std::string narrow;
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cerr << "Warning: Cannot read directory " << (NarrowPath(dir, narrow) ? narrow : "(unprintable path)") << ": " << ec.message() << "\n";
+        }
+    };
+
+    for (const auto& root : roots) {
+        std::error_code ec;
+        if (fs::is_directory(root, ec)) {
+            group.Run(io, [&scanDirectory, dir = fs::path(root)]() { scanDirectory(dir); });
+        } else {
+            group.Run(cpu, [&scanFile, root]() { scanFile(root, MetadataCache::FileKey{}); });
+        }
+    }
+    group.Wait();
+    std::cout.flush();
+    if (useCache) SaveMetadataCache();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    char elapsed[32];
+    snprintf(elapsed, sizeof(elapsed), "%.2f", seconds);
+    std::cerr << "Scanned " << totals.files << " file(s) in " << totals.directories << " director(ies) in " << elapsed
+              << " s with " << cpu.ThreadCount() << " parse thread(s): " << totals.fonts << " font file(s), " << totals.faces
+              << " face(s) (" << totals.cached << " file(s) from cache), " << totals.skipped << " skipped (not a font), " << totals.failed << " failed\n";
+    return (totals.failed == 0 && totals.unreadable == 0) ? EXIT_SUCCESS_CODE : EXIT_ERROR;
+}
+
+// Size of the head block and of the tail block the dupes partial hash reads
+constexpr size_t DUPES_BLOCK_SIZE = 16 * 1024;
+
+// One file of a duplicate search
+struct DupeFile {
+    std::string path;
+    std::vector<std::string> entries;   // Registry entries that name it ("system: Foo Bold (TrueType)")
+    uint64_t size = 0;
+    uint64_t partialHash = 0;           // Stage 2: head and tail blocks
+    uint64_t fullHash = 0;              // Stage 3: every byte
+    std::string family;                 // Family of the first face (duplicates only)
+};
+
+// Helper: Runs of files with the same key (the files are sorted by it); runs of one are dropped
+template <typename Key>
+static std::vector<std::vector<DupeFile*>> GroupDupeFiles(std::vector<DupeFile*> files, Key key) {
+    std::sort(files.begin(), files.end(), [&key](const DupeFile* a, const DupeFile* b) {
+        return key(*a) != key(*b) ? key(*a) < key(*b) : PathKey(a->path) < PathKey(b->path);
+    });
+    std::vector<std::vector<DupeFile*>> groups;
+    for (size_t i = 0; i < files.size();) {
+        size_t end = i + 1;
+        while (end < files.size() && key(*files[end]) == key(*files[i])) end++;
+        if (end - i > 1) groups.emplace_back(files.begin() + i, files.begin() + end);
+        i = end;
+    }
+    return groups;
+}
+
+// Helper: Hash of a file's first and last DUPES_BLOCK_SIZE bytes, read with two positional
+// reads; a file of up to two blocks is read whole, so its partial hash is its full hash
+static bool HashHeadAndTail(const DupeFile& file, uint64_t& hash) {
+    FontIO::FileReader reader;
+    if (!reader.Open(file.path.c_str())) return false;
+    std::vector<uint8_t> block(static_cast<size_t>(std::min<uint64_t>(file.size, DUPES_BLOCK_SIZE)));
+    Checksum::ContentHasher hasher;
+    if (!reader.ReadAt(0, block.data(), block.size())) return false;
+    hasher.Update(block.data(), block.size());
+    if (file.size > DUPES_BLOCK_SIZE) {
+        const size_t tail = static_cast<size_t>(std::min<uint64_t>(file.size - DUPES_BLOCK_SIZE, DUPES_BLOCK_SIZE));
+        if (!reader.ReadAt(file.size - tail, block.data(), tail)) return false;
+        hasher.Update(block.data(), tail);
+    }
+    hash = hasher.Final();
+    return true;
+}
+
+int FindDuplicates(const std::vector<std::string>& roots, bool includeInstalled) {
+    namespace fs = std::filesystem;
+    for (const auto& root : roots) {
+        std::error_code ec;
+        if (!fs::is_directory(root, ec) && !fs::is_regular_file(root, ec)) {
+            std::cerr << "Error: Path not found: " << root << "\n";
+            return EXIT_ERROR;
+        }
+    }
+
+    // Stage 0: the files. Registry entries of both scopes name installed files (several may
+    // name one file); directories are walked recursively on the I/O pool, one task each.
+    std::vector<DupeFile> files;
+    std::unordered_map<std::string, size_t> byPath;
+    std::mutex filesMutex;
+    std::atomic<bool> unreadable{false};
+    const auto addFile = [&files, &byPath](const std::string& path, uint64_t size) -> DupeFile& {
+        const auto found = byPath.emplace(PathKey(path), files.size());
+        if (found.second) {
+            files.emplace_back();
+            files.back().path = path;
+            files.back().size = size;
+        }
+        return files[found.first->second];
+    };
+    if (includeInstalled) {
+        std::vector<SyncFont> installed;
+        SnapshotInstalledFonts(installed);
+        for (const auto& font : installed) {
+            addFile(font.path, 0).entries.push_back(std::string(font.perUser ? "user: " : "system: ") + font.regName);
+        }
+        // Registry entries carry no sizes: stat the files on the I/O pool
+        Scheduler::ParallelFor(Scheduler::IoPool(), files.size(), [&files](size_t i) {
+            std::error_code ec;
+            const uint64_t size = fs::file_size(files[i].path, ec);
+            files[i].size = ec ? 0 : size;
+        });
+    }
+
+    Scheduler::TaskGroup group;
+    std::function<void(const fs::path&)> walk;
+    walk = [&group, &walk, &filesMutex, &addFile, &unreadable](const fs::path& dir) {
+        std::error_code ec;
+        for (fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+            std::error_code entryEc;
+            const fs::file_status linkStatus = it->symlink_status(entryEc);
+            if (entryEc) continue;
+            if (fs::is_directory(linkStatus)) {
+                group.Run(Scheduler::IoPool(), [&walk, sub = it->path()]() { walk(sub); });
+                continue;
+            }
+            std::string path;
+            if (!it->is_regular_file(entryEc) || !NarrowPath(it->path(), path)) continue;
+            if (!HasValidFontExtension(path.c_str()) && !IsWebFontExtension(path.c_str())) continue;
+            const uint64_t size = it->file_size(entryEc);  // From the directory entry on Windows
+            if (entryEc) continue;
+            std::lock_guard<std::mutex> lock(filesMutex);
+            addFile(path, size);
+        }
+        if (ec) {
+            unreadable = true;
+            std::string narrow;
+            std::lock_guard<std::mutex> lock(filesMutex);
+            std::cerr << "Warning: Cannot read directory " << (NarrowPath(dir, narrow) ? narrow : "(unprintable path)") << ": " << ec.message() << "\n";
+        }
+    };
+    for (const auto& root : roots) {
+        std::error_code ec;
+        if (fs::is_directory(root, ec)) {
+            group.Run(Scheduler::IoPool(), [&walk, dir = fs::path(root)]() { walk(dir); });
+        } else {
+            const uint64_t size = fs::file_size(root, ec);
+            std::lock_guard<std::mutex> lock(filesMutex);
+            addFile(root, ec ? 0 : size);
+        }
+    }
+    group.Wait();
+
+    // Stage 1: only files that share their size with another can be duplicates. Empty and
+    // missing files (size 0) are left out.
+    std::vector<DupeFile*> candidates;
+    for (auto& file : files) {
+        if (file.size > 0) candidates.push_back(&file);
+    }
+    std::vector<DupeFile*> sameSize;
+    for (const auto& run : GroupDupeFiles(candidates, [](const DupeFile& f) { return f.size; })) {
+        sameSize.insert(sameSize.end(), run.begin(), run.end());
+    }
+
+    // Stage 2: hash the head and tail blocks of those files (I/O pool: two reads per file)
+    std::atomic<size_t> failed{0};
+    Scheduler::ParallelFor(Scheduler::IoPool(), sameSize.size(), [&sameSize, &failed](size_t i) {
+        if (!HashHeadAndTail(*sameSize[i], sameSize[i]->partialHash)) {
+            sameSize[i]->size = 0;  // Left out of the later stages
+            failed++;
+        }
+    });
+    std::vector<DupeFile*> samePartial;
+    for (const auto& run : GroupDupeFiles(sameSize, [](const DupeFile& f) { return std::make_pair(f.size, f.partialHash); })) {
+        if (run.front()->size == 0) continue;
+        samePartial.insert(samePartial.end(), run.begin(), run.end());
+    }
+
+    // Stage 3: hash the remaining collisions whole (CPU pool, through the metadata cache, which
+    // also parses them for the report); files read whole in stage 2 are not read again
+    Scheduler::ParallelFor(Scheduler::CpuPool(), samePartial.size(), [&samePartial, &failed](size_t i) {
+        DupeFile& file = *samePartial[i];
+        if (file.size <= 2 * DUPES_BLOCK_SIZE) {
+            file.fullHash = file.partialHash;
+        } else if (!MetadataCache::GetContentHash(GetMetadataCache(), file.path.c_str(), file.fullHash)) {
+            file.size = 0;
+            failed++;
+            return;
+        }
+        const std::vector<FontParser::FontMetadata> faces = MetadataCache::GetFontMetadata(GetMetadataCache(), file.path.c_str());
+        if (!faces.empty()) file.family = faces.front().familyName;
+    });
+    std::vector<std::vector<DupeFile*>> duplicates;
+    for (auto& run : GroupDupeFiles(samePartial, [](const DupeFile& f) { return std::make_pair(f.size, f.fullHash); })) {
+        if (run.front()->size > 0) duplicates.push_back(std::move(run));
+    }
+    SaveMetadataCache();
+
+    // Largest waste first
+    const auto waste = [](const std::vector<DupeFile*>& run) { return run.front()->size * (run.size() - 1); };
+    std::stable_sort(duplicates.begin(), duplicates.end(), [&waste](const auto& a, const auto& b) { return waste(a) > waste(b); });
+    uint64_t reclaimable = 0;
+    size_t duplicateFiles = 0;
+    for (const auto& run : duplicates) {
+        const DupeFile& first = *run.front();
+        std::cout << run.size() << " identical files of " << first.size << " bytes";
+        if (!first.family.empty()) std::cout << ", family \"" << first.family << "\"";
+        std::cout << "\n";
+        for (const DupeFile* file : run) {
+            std::cout << "  " << file->path;
+            for (size_t e = 0; e < file->entries.size(); e++) std::cout << (e == 0 ? "  [" : ", ") << file->entries[e];
+            std::cout << (file->entries.empty() ? "" : "]") << "\n";
+        }
+        reclaimable += waste(run);
+        duplicateFiles += run.size();
+    }
+    std::cerr << "Compared " << files.size() << " file(s): " << sameSize.size() << " share a size, " << samePartial.size()
+              << " also their first and last blocks; " << duplicates.size() << " duplicate group(s) of " << duplicateFiles
+              << " file(s), " << reclaimable << " bytes reclaimable";
+    if (failed > 0) std::cerr << ", " << failed << " unreadable";
+    std::cerr << "\n";
+    return (failed == 0 && !unreadable) ? EXIT_SUCCESS_CODE : EXIT_ERROR;
+}
+
+// Registry enumeration callback for the coverage index: collect every registered font file
+static void CoverageCallback(const char* name, const char* file, bool perUser) {
+    (void)name;  // Every registered file is indexed, whatever its registry name
+    if (!file || file[0] == '\0') return;
+    g_coverageContext.files->push_back(ResolveFullPath(file, perUser));
+}
+
+// Size and last write time of a font file, compared against the index
+struct FileState {
+    uint64_t size;
+    int64_t modified;
+};
+
+// Helper: States of every file in a directory. One listing answers for all the fonts in it:
+// Windows returns size and write time with each directory entry, so no file is opened.
+static void ListFileStates(const std::string& dir, std::unordered_map<std::string, FileState>& states) {
+    namespace fs = std::filesystem;
+    if (dir.empty()) return;
+    std::error_code ec;
+    for (fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code entryEc;
+        const uint64_t size = it->file_size(entryEc);
+        const auto modified = it->last_write_time(entryEc);
+        if (entryEc) continue;
+        states[PathKey(dir + "\\" + it->path().filename().string())] = FileState{size, static_cast<int64_t>(modified.time_since_epoch().count())};
+    }
+}
+
+// Helper: State of one file outside the fonts directories; false if it is missing
+static bool StatFile(const std::string& path, FileState& state) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const uint64_t size = fs::file_size(path, ec);
+    if (ec) return false;
+    const auto modified = fs::last_write_time(path, ec);
+    if (ec) return false;
+    state = FileState{size, static_cast<int64_t>(modified.time_since_epoch().count())};
+    return true;
+}
+
+// Helper: Registered font files, resolved, sorted, and without case-insensitive duplicates
+static bool CollectInstalledFiles(std::vector<std::string>& files) {
+    g_listContext.fontsDir = SysUtils::GetFontsDirectory();
+    g_listContext.userFontsDir = SysUtils::GetUserFontsDirectory();
+    if (g_listContext.fontsDir.empty()) {
+        std::cerr << "Error: Cannot determine fonts directory\n";
+        return false;
+    }
+    g_coverageContext.files = &files;
+    if (!SysUtils::RegEnumerateFonts(CoverageCallback, false)) {
+        std::cerr << "Error: Failed to enumerate system fonts\n";
+        return false;
+    }
+    SysUtils::RegEnumerateFonts(CoverageCallback, true);  // Don't fail if user fonts missing
+
+    const auto byKey = [](const std::string& a, const std::string& b) { return PathKey(a) < PathKey(b); };
+    const auto sameKey = [](const std::string& a, const std::string& b) { return PathKey(a) == PathKey(b); };
+    std::sort(files.begin(), files.end(), byKey);
+    files.erase(std::unique(files.begin(), files.end(), sameKey), files.end());
+    return true;
+}
+
+// Helper: Bring the coverage index up to date with the installed fonts. Entries whose file
+// size and write time are unchanged are kept; new and changed files are reread in parallel;
+// entries of uninstalled files are dropped. The index is saved only if something changed.
+static void RefreshCoverageIndex(const std::vector<std::string>& files, bool rebuild,
+                                 std::vector<Coverage::IndexEntry>& entries, size_t& reread) {
+    const std::string dataDir = SysUtils::GetDataDirectory();
+    const std::string indexPath = dataDir.empty() ? "" : dataDir + "\\" + COVERAGE_INDEX_FILE;
+    std::vector<Coverage::IndexEntry> loaded;
+    if (!rebuild && !indexPath.empty()) Coverage::LoadIndex(indexPath.c_str(), loaded);
+
+    std::unordered_map<std::string, std::vector<size_t>> loadedByPath;
+    for (size_t i = 0; i < loaded.size(); i++) loadedByPath[PathKey(loaded[i].path)].push_back(i);
+
+    std::unordered_map<std::string, FileState> states;
+    ListFileStates(g_listContext.fontsDir, states);
+    ListFileStates(g_listContext.userFontsDir, states);
+
+    // Keep the entries of unchanged files; collect the files to reread
+    std::vector<size_t> stale;
+    std::vector<FileState> staleStates;
+    size_t kept = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        const std::string key = PathKey(files[i]);
+        FileState state;
+        const auto known = states.find(key);
+        if (known != states.end()) state = known->second;
+        else if (!StatFile(files[i], state)) continue;  // Registered but missing: not indexed
+
+        const auto cached = loadedByPath.find(key);
+        const bool current = cached != loadedByPath.end() &&
+            std::all_of(cached->second.begin(), cached->second.end(), [&loaded, &state](size_t e) {
+                return loaded[e].fileSize == state.size && loaded[e].modified == state.modified;
+            });
+        if (!current) {
+            stale.push_back(i);
+            staleStates.push_back(state);
+            continue;
+        }
+        for (size_t e : cached->second) entries.push_back(std::move(loaded[e]));
+        kept += cached->second.size();
+    }
+
+    // Reread new and changed files on the CPU pool
+    std::vector<std::vector<FontParser::FaceCoverage>> parsed(stale.size());
+    Scheduler::ParallelFor(Scheduler::CpuPool(), stale.size(), [&files, &stale, &parsed](size_t i) {
+        parsed[i] = FontParser::GetFontCoverage(files[stale[i]].c_str());
+    });
+
+    for (size_t i = 0; i < stale.size(); i++) {
+        Coverage::IndexEntry entry;
+        entry.path = files[stale[i]];
+        entry.fileSize = staleStates[i].size;
+        entry.modified = staleStates[i].modified;
+        if (parsed[i].empty()) {
+            entries.push_back(std::move(entry));  // Unreadable: remembered so it is not reread
+            continue;
+        }
+        for (auto& face : parsed[i]) {
+            entry.faceIndex = face.collectionIndex;
+            entry.familyName = std::move(face.familyName);
+            entry.coverage = Coverage::CodepointSet(std::move(face.ranges));
+            entries.push_back(entry);
+        }
+    }
+    reread = stale.size();
+
+    if (indexPath.empty()) {
+        std::cerr << "Warning: Cannot determine data directory; coverage index not saved\n";
+    } else if ((!stale.empty() || kept != loaded.size() || rebuild) &&
+               !Coverage::SaveIndex(indexPath.c_str(), entries)) {
+        std::cerr << "Warning: Failed to save coverage index: " << indexPath << "\n";
+    }
+}
+
+int ShowCoverage(const std::vector<std::string>& codepoints, const std::string& text, bool any, bool rebuild) {
+    std::vector<Coverage::CodepointRange> ranges;
+    for (const auto& spec : codepoints) {
+        if (!Coverage::ParseCodepoints(spec.c_str(), ranges)) {
+            std::cerr << "Error: Invalid codepoint: " << spec << "\n";
+            std::cerr << "Solution: Use hexadecimal codepoints such as U+0041 or ranges such as U+4E00-9FFF\n";
+            return EXIT_ERROR;
+        }
+    }
+    if (!Coverage::DecodeUtf8(text.c_str(), ranges)) {
+        std::cerr << "Error: Text is not valid UTF-8\n";
+        return EXIT_ERROR;
+    }
+    const Coverage::CodepointSet query(std::move(ranges));
+    if (query.Empty()) {
+        std::cerr << "Error: No codepoints specified\n";
+        return EXIT_ERROR;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> files;
+    if (!CollectInstalledFiles(files)) return EXIT_ERROR;
+    std::vector<Coverage::IndexEntry> entries;
+    size_t reread = 0;
+    RefreshCoverageIndex(files, rebuild, entries, reread);
+
+    struct Match {
+        const Coverage::IndexEntry* entry;
+        uint32_t shared;
+    };
+    std::vector<Match> matches;
+    size_t faceCount = 0;
+    for (const auto& entry : entries) {
+        if (entry.familyName.empty()) continue;  // Unreadable file or nameless collection face
+        faceCount++;
+        const uint32_t shared = entry.coverage.CountShared(query);
+        if (any ? shared > 0 : shared == query.Count()) matches.push_back(Match{&entry, shared});
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Best coverage first, then by family and path
+    std::sort(matches.begin(), matches.end(), [](const Match& a, const Match& b) {
+        if (a.shared != b.shared) return a.shared > b.shared;
+        if (a.entry->familyName != b.entry->familyName) return a.entry->familyName < b.entry->familyName;
+        if (a.entry->path != b.entry->path) return a.entry->path < b.entry->path;
+        return a.entry->faceIndex < b.entry->faceIndex;
+    });
+    for (const auto& match : matches) {
+        if (any) std::cout << match.shared << "/" << query.Count() << "  ";
+        std::cout << match.entry->familyName << "  (" << match.entry->path;
+        if (IsCollectionExtension(match.entry->path.c_str())) std::cout << ", face " << match.entry->faceIndex;
+        std::cout << ")\n";
+    }
+
+    char elapsed[32];
+    snprintf(elapsed, sizeof(elapsed), "%.3f", seconds);
+    std::cout << matches.size() << " of " << faceCount << " face(s) cover " << (any ? "some" : "all")
+              << " of " << query.Count() << " codepoint(s) (" << reread << " file(s) indexed, " << elapsed << " s)\n";
+    return matches.empty() ? EXIT_ERROR : EXIT_SUCCESS_CODE;
+}
+
 } // namespace FontOps
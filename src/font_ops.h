@@ -6,6 +6,10 @@
 #ifndef FONT_OPS_H
 #define FONT_OPS_H
 
+#include "sys_utils.h"
+#include <string>
+#include <vector>
+
 namespace FontOps {
     // List installed fonts
     // showPaths: display file paths
@@ -13,11 +17,47 @@ namespace FontOps {
     // Output is always sorted; path-only mode removes duplicate paths
     int ListFonts(bool showPaths, bool showNames);
 
+    // Operations on many files run on the shared pools of scheduler.h, sized by the global
+    // --jobs option (Scheduler::SetDefaultJobs) or FONTLIFT_JOBS: parsing and checksums on the
+    // CPU pool, copies, directory listings and existence checks on the I/O pool.
+
+    // install, uninstall -p, remove -p and scan read font metadata through a persistent cache
+    // (%LOCALAPPDATA%\fontlift\metadata.cache) keyed by path, size and write time; install
+    // records the installed copy, and remove and cleanup drop the entries of deleted files.
+
     // Install font from file path
     // forceAdmin: if true, force system-level installation (requires admin)
     // Returns: 0=success, 1=error, 2=permission denied
     int InstallFont(const char* fontPath, bool forceAdmin = false);
 
+    // How a batch install places its files
+    struct InstallOptions {
+        bool forceAdmin = false;    // Force system-level installation (requires admin)
+        // Content store (content_store.h) to install into instead of the fonts folder; empty
+        // uses FONTLIFT_STORE, if set. Files are hashed first; contents the store already has
+        // are not copied, and fonts already registered to their object are left untouched.
+        std::string storeDir;
+        // How files are copied into the fonts folder or the store (SysUtils::CopyFontFile);
+        // Hardlink is refused for system-level installs and content stores. With Buffered, and
+        // with Auto for remote sources, each source is read once: parsed from memory and
+        // written from the same bytes, hashed as they are written.
+        SysUtils::CopyMethod copyMethod = SysUtils::CopyMethod::Auto;
+        // Register each source file by its absolute path, without copying (per-user only;
+        // the source must stay where it is)
+        bool inPlace = false;
+    };
+
+    // Install many fonts as one batch
+    // inputs: font files, directories (each directory's font files, non-recursive) and
+    // wildcard patterns in the last path component (e.g. C:\fonts\*.otf); .zip archives
+    // contribute their font entries, which are inflated in memory and never extracted to disk
+    // Files flow through a pipeline: parse tasks validate and parse, one task copies, and
+    // one registry writer registers and loads, all at once, connected by bounded queues. The
+    // registry keys are opened once and fonts are announced with a single WM_FONTCHANGE
+    // broadcast. A file that fails is reported and the rest are still installed.
+    // Returns: 0 if every file was installed, 1 otherwise, 2=permission denied
+    int InstallFonts(const std::vector<std::string>& inputs, const InstallOptions& options);
+
     // Uninstall font by path (keeps file)
     // forceAdmin: request system-scope removal; user fonts are still removed when found
     int UninstallFontByPath(const char* fontPath, bool forceAdmin = false);
@@ -34,8 +74,78 @@ namespace FontOps {
     // forceAdmin: request system-scope removal; user fonts are still removed when found
     int RemoveFontByName(const char* fontName, bool forceAdmin = false);
 
+    // Uninstall (deleteFile false) or remove every font entry selected by the names, as one batch
+    // names: exact names (with or without the " (TrueType)" suffix) and wildcard patterns
+    // ("Foo*"); with useRegex every name is a regular expression instead. Matching is
+    // case-insensitive and covers the whole name. The user and system registries are
+    // enumerated once each, and a single WM_FONTCHANGE is broadcast after the deletions.
+    // System entries matched only by a wildcard or regular expression are left alone unless
+    // includeSystem is set; dryRun prints the entries that would be removed and changes nothing.
+    // Returns: 0=every name matched and every entry was removed, 1=error, 2=permission denied
+    int RemoveFontsByName(const std::vector<std::string>& names, bool deleteFile, bool forceAdmin = false,
+                          bool useRegex = false, bool includeSystem = false, bool dryRun = false);
+
+    // Make the installed fonts match a manifest (see manifest.h)
+    // Both registry scopes are read once and merged with the manifest's fonts by registry name
+    // and content hash into a plan of installs, upgrades, uninstalls and untouched fonts; only
+    // the changes are carried out (installs and upgrades through the install pipeline). Names
+    // and hashes come from the metadata cache, so an unchanged manifest reads no font files.
+    // dryRun: print the plan only
+    // Returns: 0=in sync or every change made, 1=error, 2=permission denied
+    int SyncFonts(const char* manifestPath, bool dryRun);
+
+    // Batch installs, uninstalls, removals and sync write a journal (%LOCALAPPDATA%\fontlift\batch.journal)
+    // of the items they are about to change, then mark each finished item. A new batch refuses
+    // to start while an interrupted one has unfinished items.
+
+    // Finish the unfinished items of an interrupted batch: installs are replayed from their
+    // source (rolled back if it is gone), uninstalls and removals are completed.
+    // rollback: undo the unfinished items instead (installs: delete the copy and its entries;
+    // uninstall/remove: register files that still exist again)
+    // Returns: 0=nothing to do or every item finished, 1=error, 2=permission denied
+    int ResumeBatch(bool rollback);
+
     // Cleanup font registry and caches. includeSystem toggles system-wide scope (requires admin when true)
+    // The files of all registry entries are checked at once; the cache locations are cleared at once
     int Cleanup(bool includeSystem);
+
+    // Print the metadata of every face in a font file (read-only, no registry access)
+    // fontPath "-" streams the font from standard input
+    // showIo: also print the bytes read and read calls the parse needed
+    // planned: force planned positional reads instead of choosing by path (remote paths use them)
+    int ShowFontInfo(const char* fontPath, bool showIo, bool planned = false);
+
+    // Verify table bounds, overlaps and checksums of font files (read-only)
+    // inputs: font files and directories (each directory's font files, non-recursive)
+    // quiet: print failures only
+    // Returns: 0 if every file passed, 1 otherwise
+    int VerifyFonts(const std::vector<std::string>& inputs, bool quiet);
+
+    // Catalogue every font under the given directories (recursive) or files (read-only)
+    // Files are recognized by their signature, not their extension; directories are listed on
+    // the I/O pool and files parsed on the CPU pool; each face is printed as soon as its file is parsed, as one line:
+    // path, face index, family, subfamily, full name, PostScript name, outline format
+    // (TrueType/CFF), container (sfnt/woff/woff2), weight, width, fsType, revision (tab-separated).
+    // Records arrive in completion order; the summary goes to stderr.
+    // useCache: answer unchanged files from the metadata cache and record newly parsed ones
+    // Returns: 0 if every font parsed and every directory was read, 1 otherwise
+    int ScanFonts(const std::vector<std::string>& roots, bool useCache = true);
+
+    // Report groups of identical font files among the installed fonts and/or under directories
+    // roots: font files and directories (recursive, font extensions only); includeInstalled:
+    // also every file the registry of either scope names. Files are compared in stages, each in
+    // parallel: files of a unique size are dropped, then files whose first and last 16 KB
+    // differ, and only the remaining collisions are hashed whole (through the metadata cache).
+    // Each group lists its files with the registry entries that name them and the family name.
+    // Returns: 0 if every directory and candidate file was read, 1 otherwise
+    int FindDuplicates(const std::vector<std::string>& roots, bool includeInstalled);
+
+    // List installed fonts whose cmap maps every queried codepoint (any: at least one)
+    // codepoints: items such as "U+0041", "0041", "U+4E00-9FFF"; text: UTF-8 characters to add
+    // Reads the coverage index in the data directory and rereads only fonts added or changed
+    // since it was written; rebuild: reread every font
+    // Returns: 0 if at least one font matched, 1 otherwise
+    int ShowCoverage(const std::vector<std::string>& codepoints, const std::string& text, bool any, bool rebuild);
 }
 
 #endif // FONT_OPS_H
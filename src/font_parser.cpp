@@ -3,11 +3,25 @@
 // Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
 
 #include "font_parser.h"
-#include <fstream>
+#include "checksum.h"
+#include "font_io.h"
+#include "name_table.h"
+#include "opentype.h"
+#include "scheduler.h"
+#include "woff.h"
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
+#include <queue>
+#include <utility>
 
 namespace FontParser {
-// Font file parsing for TTF, OTF, TTC, and OTC formats
+// Font file parsing for TTF, OTF, TTC, and OTC formats, and WOFF/WOFF2 web fonts
+// All parsing walks a bounds-checked view of a mapped file or caller-supplied buffer
+
+using FontIO::ByteSpan;
+using OpenType::OpenTypeFace;
+namespace Name = OpenType::Name;
 
 // File size validation constants
 constexpr size_t MIN_FONT_FILE_SIZE = 100;           // Minimum valid font file size (bytes)
@@ -16,182 +30,139 @@ constexpr size_t MAX_FONT_FILE_SIZE = 50 * 1024 * 1024;  // Maximum font file si
 // Font parsing constants
 constexpr size_t MAX_NAME_TABLE_SIZE = 1024 * 1024;  // Maximum name table size (1 MB)
 constexpr uint32_t MAX_FONTS_IN_COLLECTION = 256;    // Maximum fonts to process in TTC/OTC
+constexpr uint16_t MAX_NAME_RECORDS = 1000;          // Maximum name records to scan per name table
 constexpr uint16_t MAX_FONT_TABLES = 1000;           // Maximum number of tables in font file
 
-// Font structure constants
-constexpr uint32_t NAME_RECORD_SIZE = 12;            // Size of name table record (bytes)
-constexpr uint32_t NAME_TABLE_HEADER_SIZE = 6;       // Size of name table header (format + count + stringOffset)
-constexpr uint32_t FONT_HEADER_SIZE = 12;            // Size of font header (bytes)
-constexpr uint32_t TABLE_RECORD_SIZE = 16;           // Size of table directory record (bytes)
-constexpr uint32_t OFFSET_SIZE = 4;                  // Size of TTC offset table entry (bytes)
-
-// Font header field offsets (per OpenType spec)
-constexpr uint32_t FONT_NUM_TABLES_OFFSET = 4;      // numTables field offset
-
-// TTC header field offsets (per OpenType spec)
-constexpr uint32_t TTC_NUM_FONTS_OFFSET = 8;        // numFonts field offset
-
-// Name table header field offsets (per OpenType spec)
-constexpr uint32_t NAME_COUNT_OFFSET = 2;           // count field offset
-constexpr uint32_t NAME_STRING_OFFSET = 4;          // stringOffset field offset
-
-// Table directory record field offsets (per OpenType spec)
-constexpr uint32_t TABLE_TAG_OFFSET = 0;            // tag field offset
-constexpr uint32_t TABLE_CHECKSUM_OFFSET = 4;       // checksum field offset
-constexpr uint32_t TABLE_OFFSET_OFFSET = 8;         // offset field offset
-constexpr uint32_t TABLE_LENGTH_OFFSET = 12;        // length field offset
-
-// Name record field offsets (per OpenType spec)
-constexpr uint32_t NAME_PLATFORM_ID_OFFSET = 0;      // platformID field offset
-constexpr uint32_t NAME_ENCODING_ID_OFFSET = 2;      // encodingID field offset
-constexpr uint32_t NAME_LANGUAGE_ID_OFFSET = 4;      // languageID field offset
-constexpr uint32_t NAME_NAME_ID_OFFSET = 6;          // nameID field offset
-constexpr uint32_t NAME_LENGTH_OFFSET = 8;           // length field offset
-constexpr uint32_t NAME_OFFSET_OFFSET = 10;          // offset field offset
-
-// Font format signatures (per OpenType spec)
-constexpr uint32_t TRUETYPE_SIGNATURE = 0x00010000;  // TrueType font signature
-constexpr uint32_t OPENTYPE_SIGNATURE = 0x4F54544F;  // OpenType font signature ('OTTO')
-
-// Font table tags (per OpenType spec)
-constexpr uint32_t NAME_TABLE_TAG = 0x6E616D65;      // 'name' table tag
-constexpr uint32_t TTC_HEADER_TAG = 0x74746366;      // 'ttcf' TrueType Collection tag
+// Collection parsing constants
+constexpr size_t PARALLEL_NAME_TABLES = 32;          // Distinct name tables before decoding in parallel
+constexpr size_t NAME_TABLES_PER_THREAD = 8;         // Minimum tables per worker thread
 
-// Name table nameID values (per OpenType spec)
-constexpr uint16_t NAME_ID_FONT_FAMILY = 1;          // Font Family name
+// Planned I/O constants
+constexpr size_t PLANNED_HEAD_READ = 64 * 1024;      // First read: header, directories, and early tables
+constexpr uint64_t PLANNED_COALESCE_GAP = 64 * 1024; // Merge table reads closer than this (bytes)
+constexpr size_t PLANNED_DIRECTORY_PROBE = 1024;     // Read for a face directory outside the first read
 
-// Helper: Read big-endian uint16
-static uint16_t ReadUInt16BE(const uint8_t* const data) noexcept {
-    return (data[0] << 8) | data[1];
-}
+// Streaming constants
+constexpr size_t STREAM_WINDOW_SIZE = MAX_NAME_TABLE_SIZE;  // Read-ahead window; fits the largest accepted name table
 
-// Helper: Read big-endian uint32
-static uint32_t ReadUInt32BE(const uint8_t* const data) noexcept {
-    return (data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
-}
+// Web font constants
+constexpr size_t WOFF_DIRECTORY_READ = 64 * 1024;    // Header and directories must lie in the first 64 KB
+constexpr size_t WOFF2_INPUT_CHUNK = 64 * 1024;      // Compressed bytes fed to the Brotli decoder at a time
+constexpr uint32_t WOFF_TABLE_NOT_DECODED = UINT32_MAX;  // Buffer slot of a table that is not decoded
 
-// Helper: Convert UTF-16BE to ASCII (basic conversion)
-static std::string UTF16BEToString(const uint8_t* const data, const uint16_t length) noexcept {
-    std::string result;
-    for (uint16_t i = 0; i < length; i += 2) {
-        uint16_t ch = ReadUInt16BE(data + i);
-        if (ch < 128) result += static_cast<char>(ch);
+// Name table nameID values (per OpenType spec)
+constexpr uint16_t NAME_ID_FONT_FAMILY = 1;          // Font Family name
+constexpr uint16_t NAME_ID_FONT_SUBFAMILY = 2;       // Font Subfamily name
+constexpr uint16_t NAME_ID_FULL_NAME = 4;            // Full font name
+constexpr uint16_t NAME_ID_POSTSCRIPT_NAME = 6;      // PostScript name
+constexpr uint16_t NAME_ID_TYPOGRAPHIC_FAMILY = 16;  // Typographic Family name
+constexpr uint16_t NAME_ID_TYPOGRAPHIC_SUBFAMILY = 17;  // Typographic Subfamily name
+
+// Helper: Map a nameID to its FontMetadata field (nullptr for names we do not collect)
+static std::string* NameFieldFor(FontMetadata& meta, uint16_t nameID) noexcept {
+    switch (nameID) {
+        case NAME_ID_FONT_FAMILY: return &meta.familyName;
+        case NAME_ID_FONT_SUBFAMILY: return &meta.subfamilyName;
+        case NAME_ID_FULL_NAME: return &meta.fullName;
+        case NAME_ID_POSTSCRIPT_NAME: return &meta.postScriptName;
+        case NAME_ID_TYPOGRAPHIC_FAMILY: return &meta.typographicFamily;
+        case NAME_ID_TYPOGRAPHIC_SUBFAMILY: return &meta.typographicSubfamily;
+        default: return nullptr;
     }
-    return result;
 }
 
-// Helper: Parse name table to extract font family name (nameID=1)
-static std::string ExtractNameFromTable(const uint8_t* const nameTable, const uint32_t tableSize) {
-    if (tableSize < NAME_TABLE_HEADER_SIZE) return "";
+// nameIDs collected into FontMetadata, as a FindRecords mask (bit n = nameID n)
+constexpr uint32_t COLLECTED_NAME_IDS =
+    (1u << NAME_ID_FONT_FAMILY) | (1u << NAME_ID_FONT_SUBFAMILY) | (1u << NAME_ID_FULL_NAME) |
+    (1u << NAME_ID_POSTSCRIPT_NAME) | (1u << NAME_ID_TYPOGRAPHIC_FAMILY) | (1u << NAME_ID_TYPOGRAPHIC_SUBFAMILY);
+
+// Helper: Parse name table and fill every collected nameID in a single pass over the records.
+// For each nameID the first usable Windows Unicode (3,1 or 3,10) or Mac (1,*) record wins.
+static bool ExtractNamesFromTable(const ByteSpan nameTable, FontMetadata& meta) {
+    if (nameTable.size() < Name::HEADER_SIZE) return false;
 
-    uint16_t format = ReadUInt16BE(nameTable);
-    uint16_t count = ReadUInt16BE(nameTable + NAME_COUNT_OFFSET);
-    uint16_t stringOffset = ReadUInt16BE(nameTable + NAME_STRING_OFFSET);
+    const uint16_t count = Name::Count::Get(nameTable);
+    const uint16_t stringOffset = Name::StringOffset::Get(nameTable);
 
     // Validate count is reasonable (prevent excessive iteration with corrupted files)
-    constexpr uint16_t MAX_NAME_RECORDS = 1000;
-    if (count > MAX_NAME_RECORDS) return "";
+    if (count > MAX_NAME_RECORDS) return false;
 
     // Validate stringOffset is within table bounds
-    if (stringOffset >= tableSize) return "";
-
-    // Search for family name (nameID = 1)
-    for (uint16_t i = 0; i < count; i++) {
-        uint32_t recordOffset = NAME_TABLE_HEADER_SIZE + i * NAME_RECORD_SIZE;
-        if (recordOffset + NAME_RECORD_SIZE > tableSize) break;
-
-        const uint8_t* record = nameTable + recordOffset;
-        uint16_t platformID = ReadUInt16BE(record + NAME_PLATFORM_ID_OFFSET);
-        uint16_t encodingID = ReadUInt16BE(record + NAME_ENCODING_ID_OFFSET);
-        uint16_t languageID = ReadUInt16BE(record + NAME_LANGUAGE_ID_OFFSET);
-        uint16_t nameID = ReadUInt16BE(record + NAME_NAME_ID_OFFSET);
-        uint16_t length = ReadUInt16BE(record + NAME_LENGTH_OFFSET);
-        uint16_t offset = ReadUInt16BE(record + NAME_OFFSET_OFFSET);
-
-        // Looking for Font Family name
-        if (nameID != NAME_ID_FONT_FAMILY) continue;
-
-        // Prefer Windows platform (3) with Unicode encoding (1)
-        if (platformID == 3 && encodingID == 1) {
-            // Check for overflow in offset arithmetic
-            if (offset > tableSize || stringOffset > tableSize - offset) continue;
-            uint32_t strOffset = stringOffset + offset;
-            // Check for overflow in length arithmetic
-            if (length > tableSize - strOffset) continue;
-            if (strOffset + length <= tableSize) {
-                return UTF16BEToString(nameTable + strOffset, length);
-            }
+    if (stringOffset >= nameTable.size()) return false;
+
+    // Records past the end of a truncated table are ignored
+    const size_t available = (nameTable.size() - Name::HEADER_SIZE) / Name::Record::SIZE;
+    const size_t recordCount = count < available ? count : available;
+    const ByteSpan records = nameTable.Subspan(Name::HEADER_SIZE, recordCount * Name::Record::SIZE);
+
+    // Vectorized pre-filter: only records with a collected nameID are decoded
+    uint16_t matches[MAX_NAME_RECORDS];
+    const size_t matchCount = NameTable::FindRecords(records.data(), recordCount, COLLECTED_NAME_IDS, matches);
+
+    for (size_t m = 0; m < matchCount; m++) {
+        const ByteSpan record = records.Subspan(static_cast<size_t>(matches[m]) * Name::Record::SIZE, Name::Record::SIZE);
+        const uint16_t platformID = Name::Record::PlatformID::Get(record);
+        const uint16_t encodingID = Name::Record::EncodingID::Get(record);
+        const uint16_t nameID = Name::Record::NameID::Get(record);
+        const uint16_t length = Name::Record::Length::Get(record);
+        const uint16_t offset = Name::Record::StringOffset::Get(record);
+
+        std::string* field = NameFieldFor(meta, nameID);
+        if (!field || !field->empty()) continue;  // Not collected, or already filled
+
+        // Subspan rejects strings that overflow the table
+        const ByteSpan str = nameTable.Subspan(static_cast<size_t>(stringOffset) + offset, length);
+        if (str.empty()) continue;
+
+        // Prefer Windows platform (3) with Unicode encodings (1 = BMP, 10 = full repertoire)
+        if (platformID == 3 && (encodingID == 1 || encodingID == 10)) {
+            *field = NameTable::Utf16BEToUtf8(str.data(), str.size());
         }
-        // Fallback to Mac platform (1)
+        // Fallback to Mac platform (1): Roman is transcoded, other scripts only when plain ASCII
         else if (platformID == 1) {
-            // Check for overflow in offset arithmetic
-            if (offset > tableSize || stringOffset > tableSize - offset) continue;
-            uint32_t strOffset = stringOffset + offset;
-            // Check for overflow in length arithmetic
-            if (length > tableSize - strOffset) continue;
-            if (strOffset + length <= tableSize) {
-                return std::string(reinterpret_cast<const char*>(nameTable + strOffset), length);
+            if (encodingID == 0) {
+                *field = NameTable::MacRomanToUtf8(str.data(), str.size());
+            } else if (NameTable::IsAscii(str.data(), str.size())) {
+                field->assign(reinterpret_cast<const char*>(str.data()), str.size());
             }
         }
     }
-    return "";
+    return true;
 }
 
-// Helper: Read font tables starting at file offset and extract name
-static std::string ParseFontAtOffset(std::ifstream& file, uint32_t offset) {
-    // Get file size to validate offset
-    file.seekg(0, std::ios::end);
-    std::streampos fileSize = file.tellg();
-    if (offset >= static_cast<uint32_t>(fileSize)) return "";  // Offset beyond file size
-
-    file.seekg(offset);
-
-    uint8_t header[FONT_HEADER_SIZE];
-    if (!file.read(reinterpret_cast<char*>(header), FONT_HEADER_SIZE)) return "";
-
-    // Validate font signature (TrueType or OpenType)
-    uint32_t signature = ReadUInt32BE(header);
-    if (signature != TRUETYPE_SIGNATURE && signature != OPENTYPE_SIGNATURE) return "";
-
-    uint16_t numTables = ReadUInt16BE(header + FONT_NUM_TABLES_OFFSET);
-
-    // Validate numTables is reasonable (prevent excessive iteration with corrupted files)
-    if (numTables > MAX_FONT_TABLES) return "";
-
-    // Find 'name' table
-    for (uint16_t i = 0; i < numTables; i++) {
-        uint8_t tableRecord[TABLE_RECORD_SIZE];
-        if (!file.read(reinterpret_cast<char*>(tableRecord), TABLE_RECORD_SIZE)) return "";
-
-        uint32_t tag = ReadUInt32BE(tableRecord + TABLE_TAG_OFFSET);
-        uint32_t tableOffset = ReadUInt32BE(tableRecord + TABLE_OFFSET_OFFSET);
-        uint32_t tableLength = ReadUInt32BE(tableRecord + TABLE_LENGTH_OFFSET);
+// Helper: Check file size is within the valid range for a font
+static bool HasValidFontSize(uint64_t size) noexcept {
+    return size >= MIN_FONT_FILE_SIZE && size <= MAX_FONT_FILE_SIZE;
+}
 
-        // Check if this is the 'name' table
-        if (tag == NAME_TABLE_TAG) {
-            // Sanity check: name table shouldn't exceed maximum size
-            if (tableLength == 0 || tableLength > MAX_NAME_TABLE_SIZE) return "";
+bool HasFontSignature(const uint8_t* data, size_t size) {
+    const ByteSpan file(data, size);
+    if (Woff::Detect(file) != Woff::Container::None) return true;
+    const uint32_t version = OpenType::SfntHeader::SfntVersion::Get(file);
+    return version == OpenType::SFNT_VERSION_TRUETYPE || version == OpenType::SFNT_VERSION_CFF ||
+           version == OpenType::TAG_TTCF;
+}
 
-            std::vector<uint8_t> nameTable(tableLength);
-            file.seekg(tableOffset);
-            if (!file.read(reinterpret_cast<char*>(nameTable.data()), tableLength)) return "";
+bool HasFontSignature(const char* fontPath) {
+    FontIO::FileReader reader;
+    if (!reader.Open(fontPath) || reader.Size() < MIN_FONT_FILE_SIZE) return false;
+    uint8_t signature[4];
+    if (!reader.ReadAt(0, signature, sizeof(signature))) return false;
+    return HasFontSignature(signature, sizeof(signature));
+}
 
-            std::string name = ExtractNameFromTable(nameTable.data(), tableLength);
-            if (!name.empty()) return name;
-        }
+bool IsCollection(const uint8_t* data, size_t size) {
+    const ByteSpan file(data, size);
+    if (Woff::Detect(file) == Woff::Container::Woff2) {
+        return Woff::Header::Flavor::Get(file) == OpenType::TAG_TTCF;  // WOFF2-wrapped collection
     }
-    return "";
+    return OpenType::IsCollection(file); // Check for 'ttcf' TrueType Collection
 }
 
 bool IsCollection(const char* fontPath) {
-    std::ifstream file(fontPath, std::ios::binary);
-    if (!file) return false;
-
-    uint8_t header[4];
-    if (!file.read(reinterpret_cast<char*>(header), 4)) return false;
-
-    uint32_t tag = ReadUInt32BE(header);
-    return tag == TTC_HEADER_TAG; // Check for 'ttcf' TrueType Collection
+    FontIO::MappedFile file(fontPath);
+    if (!file.IsOpen()) return false;
+    return IsCollection(file.Bytes().data(), file.Bytes().size());
 }
 
 // Helper: Extract filename without path or extension for fallback font naming
@@ -210,77 +181,736 @@ static std::string ExtractFilenameWithoutExtension(const char* fontPath) {
     }
 }
 
-std::string GetFontName(const char* fontPath) {
-    std::ifstream file(fontPath, std::ios::binary);
-    if (!file) return "";
+// Name strings decoded from one distinct name table (by file offset and length)
+struct DecodedNames {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+    bool ok = false;        // Table present and structurally valid
+    FontMetadata names;     // Only the name fields are filled
+};
+
+// Helper: Copy the collected name fields
+static void CopyNames(const FontMetadata& from, FontMetadata& to) {
+    to.familyName = from.familyName;
+    to.subfamilyName = from.subfamilyName;
+    to.fullName = from.fullName;
+    to.postScriptName = from.postScriptName;
+    to.typographicFamily = from.typographicFamily;
+    to.typographicSubfamily = from.typographicSubfamily;
+}
 
-    // Validate file size: must be within valid range
-    file.seekg(0, std::ios::end);
-    std::streampos fileSize = file.tellg();
-    file.seekg(0, std::ios::beg);
+// Helper: Decode each distinct name table. Large collections spread the tables over the shared
+// CPU pool (a worker parsing several files helps out instead of oversubscribing the cores);
+// each task writes only its own entries.
+template <typename TableSource>
+static void DecodeNameTables(std::vector<DecodedNames>& tables, const TableSource& tableAt) {
+    const auto decode = [&tables, &tableAt](size_t i) {
+        DecodedNames& entry = tables[i];
+        const OpenType::TableRecord record{OpenType::TAG_NAME, 0, entry.offset, entry.length};
+        const ByteSpan nameTable = tableAt(&record);
+        entry.ok = !nameTable.empty() && ExtractNamesFromTable(nameTable, entry.names);
+    };
+
+    const size_t threadCount = std::min<size_t>(Scheduler::DefaultJobs(), tables.size() / NAME_TABLES_PER_THREAD);
+    if (tables.size() < PARALLEL_NAME_TABLES || threadCount < 2) {
+        for (size_t i = 0; i < tables.size(); i++) decode(i);
+        return;
+    }
+    Scheduler::ParallelFor(Scheduler::CpuPool(), tables.size(), decode);
+}
+
+// Helper: Order decoded name tables by file range
+static bool NameRangeLess(const DecodedNames& a, const DecodedNames& b) noexcept {
+    return a.offset != b.offset ? a.offset < b.offset : a.length < b.length;
+}
+
+static bool SameNameRange(const DecodedNames& a, const DecodedNames& b) noexcept {
+    return a.offset == b.offset && a.length == b.length;
+}
+
+// Helper: Check a name table is worth decoding (present, non-empty, not oversized)
+static bool IsUsableNameTable(const OpenType::TableRecord* name) noexcept {
+    return name && name->length != 0 && name->length <= MAX_NAME_TABLE_SIZE;
+}
+
+// Helper: Distinct usable name tables of decoded directories, sorted by (offset, length)
+static std::vector<DecodedNames> CollectNameTables(const std::vector<OpenTypeFace>& directories) {
+    std::vector<DecodedNames> nameTables;
+    nameTables.reserve(directories.size());
+    for (const auto& face : directories) {
+        const OpenType::TableRecord* name = face.Find(OpenType::TAG_NAME);
+        if (!IsUsableNameTable(name)) continue;
+        nameTables.emplace_back();
+        nameTables.back().offset = name->offset;
+        nameTables.back().length = name->length;
+    }
+    std::sort(nameTables.begin(), nameTables.end(), NameRangeLess);
+    nameTables.erase(std::unique(nameTables.begin(), nameTables.end(), SameNameRange), nameTables.end());
+    return nameTables;
+}
+
+// Helper: Build metadata for decoded face directories from their decoded name tables (sorted by
+// range). tableAt(record) returns a table's bytes, or an empty span if they are unavailable.
+// Faces that share a name table reuse its decode. Named faces go to faces in index order;
+// single receives a single font's metadata even without a family name.
+template <typename TableSource>
+static void AssembleFaces(const std::vector<OpenTypeFace>& directories, bool isCollection,
+                          const std::vector<DecodedNames>& nameTables, const TableSource& tableAt,
+                          std::vector<FontMetadata>& faces, FontMetadata& single) {
+    // Reserve capacity to avoid reallocations during iteration
+    faces.reserve(directories.size());
+
+    for (uint32_t i = 0; i < directories.size(); i++) {
+        const OpenTypeFace& face = directories[i];
+        FontMetadata meta;
+        meta.isCollection = isCollection;
+        meta.collectionIndex = isCollection ? i : 0;
+
+        bool named = false;
+        if (face.SfntVersion() != 0) {  // Directory decoded
+            meta.format = face.SfntVersion() == OpenType::SFNT_VERSION_CFF ? FontFormat::OpenTypeCFF : FontFormat::TrueType;
+
+            // Missing or truncated OS/2 and head fields are left at zero
+            const ByteSpan os2Table = tableAt(face.Find(OpenType::TAG_OS2));
+            meta.weightClass = OpenType::Os2::WeightClass::Get(os2Table);
+            meta.widthClass = OpenType::Os2::WidthClass::Get(os2Table);
+            meta.fsType = OpenType::Os2::FsType::Get(os2Table);
+            meta.fontRevision = OpenType::Head::FontRevision::Get(tableAt(face.Find(OpenType::TAG_HEAD)));
+
+            const OpenType::TableRecord* name = face.Find(OpenType::TAG_NAME);
+            if (IsUsableNameTable(name)) {
+                DecodedNames key;
+                key.offset = name->offset;
+                key.length = name->length;
+                const auto it = std::lower_bound(nameTables.begin(), nameTables.end(), key, NameRangeLess);
+                if (it != nameTables.end() && SameNameRange(*it, key) && it->ok) {
+                    CopyNames(it->names, meta);
+                    named = !meta.familyName.empty();
+                }
+            }
+        }
+
+        if (!isCollection) single = meta;
+        if (named) faces.push_back(std::move(meta));
+    }
+}
+
+// Helper: Decode each distinct name table of the directories once, then assemble the faces
+template <typename TableSource>
+static void BuildFaces(const std::vector<OpenTypeFace>& directories, bool isCollection, const TableSource& tableAt,
+                       std::vector<FontMetadata>& faces, FontMetadata& single) {
+    std::vector<DecodedNames> nameTables = CollectNameTables(directories);
+    DecodeNameTables(nameTables, tableAt);
+    AssembleFaces(directories, isCollection, nameTables, tableAt, faces, single);
+}
 
-    if (fileSize < MIN_FONT_FILE_SIZE || fileSize > MAX_FONT_FILE_SIZE) {
-        return "";  // File too small or too large to be valid font
+// Helper: Parse a WOFF/WOFF2 file whose bytes come from fetch(offset, length), called with
+// ascending offsets; prefetch(offset, length) announces a range fetch will ask for soon.
+// Only the OS/2, head and name tables are decompressed, each once, into one buffer sized to
+// exactly those tables. WOFF tables are inflated individually; the WOFF2 stream is decoded
+// chunk by chunk, dropping other tables' bytes, and stops after the last needed table.
+template <typename Fetch, typename Prefetch>
+static bool ParseWebFont(const Fetch& fetch, const Prefetch& prefetch, std::vector<FontMetadata>& faces, FontMetadata& single) {
+    const ByteSpan header = fetch(0, Woff::Header::SIZE);
+    const size_t prefixSize = std::min<size_t>(Woff::Header::Length::Get(header), WOFF_DIRECTORY_READ);
+    Woff::WoffDirectory directory;
+    if (header.empty() || !directory.Parse(fetch(0, prefixSize))) return false;
+
+    const FontContainer container = directory.Kind() == Woff::Container::Woff2 ? FontContainer::Woff2 : FontContainer::Woff;
+    const bool isCollection = directory.IsCollection();
+    single.isCollection = isCollection;
+
+    // Assign each needed table a slot in the buffer; shared collection tables get one slot
+    const std::vector<Woff::WoffTable>& tables = directory.Tables();
+    const size_t faceCount = std::min<size_t>(directory.Faces().size(), MAX_FONTS_IN_COLLECTION);
+    std::vector<uint32_t> slots(tables.size(), WOFF_TABLE_NOT_DECODED);
+    std::vector<uint16_t> needed;
+    size_t bufferSize = 0;
+    for (size_t f = 0; f < faceCount; f++) {
+        for (uint16_t index : directory.Faces()[f].tables) {
+            const Woff::WoffTable& table = tables[index];
+            const bool wanted = table.tag == OpenType::TAG_OS2 || table.tag == OpenType::TAG_HEAD || table.tag == OpenType::TAG_NAME;
+            if (!wanted || table.transformed || table.origLength > MAX_NAME_TABLE_SIZE || slots[index] != WOFF_TABLE_NOT_DECODED) continue;
+            if (bufferSize + table.origLength > MAX_FONT_FILE_SIZE) continue;  // Keep the buffer within the in-memory limit
+            slots[index] = static_cast<uint32_t>(bufferSize);
+            bufferSize += table.origLength;
+            needed.push_back(index);
+        }
+    }
+
+    std::vector<uint8_t> buffer(bufferSize);
+    std::vector<bool> decoded(tables.size(), false);
+    if (directory.Kind() == Woff::Container::Woff) {
+        std::sort(needed.begin(), needed.end(), [&tables](uint16_t a, uint16_t b) { return tables[a].offset < tables[b].offset; });
+        for (uint16_t index : needed) prefetch(tables[index].offset, tables[index].storedLength);
+        for (uint16_t index : needed) {
+            const Woff::WoffTable& table = tables[index];
+            const ByteSpan stored = fetch(table.offset, table.storedLength);
+            decoded[index] = Woff::DecompressTable(table, stored, buffer.data() + slots[index]);
+        }
+    } else if (!needed.empty() && Woff::CanDecodeWoff2()) {
+        Woff::Woff2Stream stream;
+        for (uint16_t index : needed) stream.Want(tables[index].offset, tables[index].origLength, buffer.data() + slots[index]);
+        for (uint64_t pos = 0; !stream.Done() && pos < directory.CompressedSize(); pos += WOFF2_INPUT_CHUNK) {
+            const size_t chunk = static_cast<size_t>(std::min<uint64_t>(WOFF2_INPUT_CHUNK, directory.CompressedSize() - pos));
+            const ByteSpan input = fetch(directory.DataOffset() + pos, chunk);
+            if (input.empty() || !stream.Feed(input)) break;
+        }
+        for (size_t i = 0; i < needed.size(); i++) decoded[needed[i]] = stream.Complete(i);
     }
 
-    std::string name = ParseFontAtOffset(file, 0);
-    if (name.empty()) {
-        name = ExtractFilenameWithoutExtension(fontPath);
+    // Face directories over the decoded tables; record offsets are buffer slots
+    std::vector<OpenTypeFace> directories(faceCount);
+    for (size_t f = 0; f < faceCount; f++) {
+        const Woff::WoffFace& face = directory.Faces()[f];
+        std::vector<OpenType::TableRecord> records;
+        for (uint16_t index : face.tables) {
+            if (!decoded[index]) continue;
+            records.push_back(OpenType::TableRecord{tables[index].tag, tables[index].checksum, slots[index], tables[index].origLength});
+        }
+        directories[f].Assign(face.flavor, std::move(records));
     }
 
-    return name;
+    const ByteSpan decodedTables(buffer.data(), buffer.size());
+    const auto tableAt = [decodedTables](const OpenType::TableRecord* record) {
+        return record ? decodedTables.Subspan(record->offset, record->length) : ByteSpan();
+    };
+    BuildFaces(directories, isCollection, tableAt, faces, single);
+    for (auto& face : faces) face.container = container;
+    single.container = container;
+    return true;
 }
 
-std::vector<std::string> GetFontsInCollection(const char* fontPath) {
-    std::vector<std::string> names;
-    std::ifstream file(fontPath, std::ios::binary);
-    if (!file) return names;
+// Helper: No-op prefetch for sources that read on demand
+static void NoPrefetch(uint64_t, uint64_t) noexcept {}
 
+// Helper: Parse every face of an in-memory file. Faces with a family name go to faces;
+// single receives a single font's (possibly nameless) metadata, or isCollection for a TTC/OTC.
+// Returns false if the data has an invalid size for a font.
+static bool ParseFaces(const ByteSpan file, std::vector<FontMetadata>& faces, FontMetadata& single) {
     // Validate file size: must be within valid range
-    file.seekg(0, std::ios::end);
-    std::streampos fileSize = file.tellg();
-    file.seekg(0, std::ios::beg);
+    if (!HasValidFontSize(file.size())) {
+        return false;  // File too small or too large to be valid font
+    }
 
-    if (fileSize < MIN_FONT_FILE_SIZE || fileSize > MAX_FONT_FILE_SIZE) {
-        return names;  // File too small or too large to be valid font
+    if (Woff::Detect(file) != Woff::Container::None) {
+        const auto fetch = [file](uint64_t offset, size_t length) { return file.Subspan(static_cast<size_t>(offset), length); };
+        return ParseWebFont(fetch, NoPrefetch, faces, single);
     }
 
-    uint8_t header[FONT_HEADER_SIZE];
-    if (!file.read(reinterpret_cast<char*>(header), FONT_HEADER_SIZE)) return names;
+    // Table directory offsets: 0 for a single font, from the header for a collection
+    const bool isCollection = OpenType::IsCollection(file);
+    single.isCollection = isCollection;
+    std::vector<uint32_t> offsets{0};
+    if (isCollection && !OpenType::ReadCollectionOffsets(file, MAX_FONTS_IN_COLLECTION, offsets)) {
+        return true;  // Collection without usable faces
+    }
 
-    uint32_t tag = ReadUInt32BE(header);
-    if (tag != TTC_HEADER_TAG) return names; // Not a TrueType Collection
+    std::vector<OpenTypeFace> directories(offsets.size());
+    for (size_t i = 0; i < offsets.size(); i++) {
+        directories[i].Parse(file, offsets[i]);
+    }
 
-    uint32_t numFonts = ReadUInt32BE(header + TTC_NUM_FONTS_OFFSET);
+    const auto tableAt = [file](const OpenType::TableRecord* record) {
+        return record ? file.Subspan(record->offset, record->length) : ByteSpan();
+    };
+    BuildFaces(directories, isCollection, tableAt, faces, single);
+    return true;
+}
 
-    // Validate numFonts is reasonable (0 or suspiciously large values indicate corruption)
-    if (numFonts == 0 || numFonts > MAX_FONTS_IN_COLLECTION) return names;
+// Helper: ParseFaces over positional reads. Reads the start of the file, then any face
+// directories it does not cover, then the name/OS/2/head tables of all faces as one
+// coalesced plan - typically two reads for a single font.
+static bool ParseFacesPlanned(const char* fontPath, std::vector<FontMetadata>& faces, FontMetadata& single,
+                              FontIO::IoStats* stats) {
+    FontIO::FileReader reader;
+    if (!reader.Open(fontPath)) return false;
+
+    // Only the needed ranges are read, so files over the in-memory limit are accepted
+    const uint64_t fileSize = reader.Size();
+    if (fileSize < MIN_FONT_FILE_SIZE) {
+        return false;  // File too small to be valid font
+    }
 
-    // Reserve capacity to avoid reallocations during iteration
-    names.reserve(numFonts);
+    FontIO::SparseImage image;
+    FontIO::ReadPlan plan(PLANNED_COALESCE_GAP);
+    const size_t headSize = static_cast<size_t>(fileSize < PLANNED_HEAD_READ ? fileSize : PLANNED_HEAD_READ);
+    plan.Add(0, headSize);
+    bool ok = plan.Execute(reader, image);
+
+    // Web fonts: the directory is in the first read; needed tables are planned as they are known
+    const ByteSpan head = image.Slice(0, headSize);
+    if (ok && Woff::Detect(head) != Woff::Container::None) {
+        const auto prefetch = [&plan](uint64_t offset, uint64_t length) { plan.Add(offset, length); };
+        const auto fetch = [&plan, &reader, &image](uint64_t offset, size_t length) {
+            if (!image.Covers(offset, length)) {
+                plan.Add(offset, length);
+                if (!plan.Execute(reader, image)) return ByteSpan();
+            }
+            return image.Slice(offset, length);
+        };
+        ok = ParseWebFont(fetch, prefetch, faces, single);
+        if (stats) *stats = reader.Stats();
+        return ok;
+    }
 
-    for (uint32_t i = 0; i < numFonts; i++) {
-        uint8_t offsetData[OFFSET_SIZE];
-        if (!file.read(reinterpret_cast<char*>(offsetData), OFFSET_SIZE)) break;
+    // Face directory offsets: 0 for a single font, from the header for a collection
+    const bool isCollection = OpenType::IsCollection(head);
+    single.isCollection = isCollection;
+    std::vector<uint32_t> offsets{0};
+    if (ok && isCollection && !OpenType::ReadCollectionOffsets(head, MAX_FONTS_IN_COLLECTION, offsets)) {
+        offsets.clear();  // Collection without usable faces
+    }
 
-        uint32_t fontOffset = ReadUInt32BE(offsetData);
-        // Validate offset is within file bounds
-        if (fontOffset >= static_cast<uint32_t>(fileSize)) continue;
+    // Directories outside the first read: probe the sfnt header and the start of its directory,
+    // then fetch any directory still incomplete
+    const auto directorySize = [&image](uint32_t offset) {
+        const ByteSpan header = image.Slice(offset, OpenType::SfntHeader::SIZE);
+        const uint16_t numTables = std::min(OpenType::SfntHeader::NumTables::Get(header, MAX_FONT_TABLES), MAX_FONT_TABLES);
+        return OpenType::SfntHeader::SIZE + static_cast<size_t>(numTables) * OpenType::TableDirectoryEntry::SIZE;
+    };
+    for (uint32_t offset : offsets) {
+        if (!image.Covers(offset, OpenType::SfntHeader::SIZE)) plan.Add(offset, PLANNED_DIRECTORY_PROBE);
+    }
+    ok = ok && plan.Execute(reader, image);
+    for (uint32_t offset : offsets) {
+        if (!image.Covers(offset, directorySize(offset))) plan.Add(offset, directorySize(offset));
+    }
+    ok = ok && plan.Execute(reader, image);
+
+    // Decode every directory, then read the tables all faces need in one plan
+    std::vector<OpenTypeFace> directories(offsets.size());
+    for (size_t i = 0; ok && i < offsets.size(); i++) {
+        if (!directories[i].Parse(image.Slice(offsets[i], directorySize(offsets[i])), 0)) continue;
+        for (uint32_t tag : {OpenType::TAG_OS2, OpenType::TAG_HEAD, OpenType::TAG_NAME}) {
+            const OpenType::TableRecord* record = directories[i].Find(tag);
+            if (record && record->length <= MAX_NAME_TABLE_SIZE) plan.Add(record->offset, record->length);
+        }
+    }
+    ok = ok && plan.Execute(reader, image);
+    if (stats) *stats = reader.Stats();
+    if (!ok) return false;
+
+    // Table offsets are file-absolute, so tables are sliced from the image directly
+    const auto tableAt = [&image](const OpenType::TableRecord* record) {
+        return record ? image.Slice(record->offset, record->length) : ByteSpan();
+    };
+    BuildFaces(directories, isCollection, tableAt, faces, single);
+    return true;
+}
 
-        std::string name = ParseFontAtOffset(file, fontOffset);
+// Helper: ParseFaces over a forward-only stream read through a fixed window, so memory does
+// not grow with the input. Ranges are visited in file order - face directories, then the
+// tables they reference; a table lying before a range already passed is treated as missing.
+static bool ParseFacesStreamed(FontIO::StreamReader& reader, std::vector<FontMetadata>& faces, FontMetadata& single) {
+    namespace CollectionHeader = OpenType::CollectionHeader;
+    FontIO::StreamWindow window(reader, STREAM_WINDOW_SIZE);
+
+    // Face directory offsets: 0 for a single font, from the header for a collection
+    const ByteSpan start = window.Fetch(0, OpenType::SfntHeader::SIZE);
+    if (start.empty()) return false;  // Input too short to be a font
+    if (Woff::Detect(start) != Woff::Container::None) {
+        const auto fetch = [&window](uint64_t offset, size_t length) { return window.Fetch(offset, length); };
+        return ParseWebFont(fetch, NoPrefetch, faces, single);
+    }
+    const bool isCollection = OpenType::IsCollection(start);
+    single.isCollection = isCollection;
+    std::vector<uint32_t> offsets{0};
+    if (isCollection) {
+        const uint32_t numFonts = std::min(CollectionHeader::NumFonts::Get(start), MAX_FONTS_IN_COLLECTION);
+        const ByteSpan header = window.Fetch(0, CollectionHeader::OFFSETS_START + numFonts * CollectionHeader::OFFSET_SIZE);
+        if (!OpenType::ReadCollectionOffsets(header.empty() ? start : header, MAX_FONTS_IN_COLLECTION, offsets)) {
+            return true;  // Collection without usable faces
+        }
+    }
+
+    // Pending ranges, visited by ascending offset
+    enum class RangeKind : uint8_t { Directory, Table, NameTable };
+    struct PendingRange {
+        uint64_t offset;
+        uint32_t length;
+        RangeKind kind;
+        uint32_t index;  // Face for directories, name table entry for name tables
+    };
+    const auto later = [](const PendingRange& a, const PendingRange& b) { return a.offset > b.offset; };
+    std::priority_queue<PendingRange, std::vector<PendingRange>, decltype(later)> pending(later);
+    for (uint32_t i = 0; i < offsets.size(); i++) {
+        pending.push(PendingRange{offsets[i], static_cast<uint32_t>(OpenType::SfntHeader::SIZE), RangeKind::Directory, i});
+    }
 
-        if (!name.empty()) {
-            names.push_back(name);
+    // OS/2 and head tables are kept (they are small); name tables are decoded as they pass
+    struct SavedTable {
+        uint32_t offset;
+        uint32_t length;
+        std::vector<uint8_t> bytes;
+    };
+    std::vector<SavedTable> savedTables;
+    std::vector<DecodedNames> nameTables;
+    std::vector<OpenTypeFace> directories(offsets.size());
+
+    while (!pending.empty()) {
+        const PendingRange range = pending.top();
+        pending.pop();
+        const ByteSpan bytes = window.Fetch(range.offset, range.length);
+        if (bytes.empty()) continue;  // Passed, larger than the window, or past the end
+
+        if (range.kind == RangeKind::Directory) {
+            // The sfnt header gives the directory size; fetch header and directory together
+            const uint16_t numTables = std::min(OpenType::SfntHeader::NumTables::Get(bytes), MAX_FONT_TABLES);
+            const size_t directorySize = OpenType::SfntHeader::SIZE + static_cast<size_t>(numTables) * OpenType::TableDirectoryEntry::SIZE;
+            OpenTypeFace& face = directories[range.index];
+            if (!face.Parse(window.Fetch(range.offset, directorySize), 0)) continue;
+
+            for (uint32_t tag : {OpenType::TAG_OS2, OpenType::TAG_HEAD}) {
+                const OpenType::TableRecord* record = face.Find(tag);
+                if (record) pending.push(PendingRange{record->offset, record->length, RangeKind::Table, 0});
+            }
+            const OpenType::TableRecord* name = face.Find(OpenType::TAG_NAME);
+            if (!IsUsableNameTable(name)) continue;
+            DecodedNames entry;
+            entry.offset = name->offset;
+            entry.length = name->length;
+            const auto known = [&entry](const DecodedNames& other) { return SameNameRange(other, entry); };
+            if (std::find_if(nameTables.begin(), nameTables.end(), known) != nameTables.end()) continue;
+            pending.push(PendingRange{name->offset, name->length, RangeKind::NameTable, static_cast<uint32_t>(nameTables.size())});
+            nameTables.push_back(std::move(entry));
+        } else if (range.kind == RangeKind::Table) {
+            const uint32_t offset = static_cast<uint32_t>(range.offset);
+            const auto known = [&range, offset](const SavedTable& saved) { return saved.offset == offset && saved.length == range.length; };
+            if (std::find_if(savedTables.begin(), savedTables.end(), known) != savedTables.end()) continue;
+            savedTables.push_back(SavedTable{offset, range.length, std::vector<uint8_t>(bytes.data(), bytes.data() + bytes.size())});
+        } else {
+            DecodedNames& entry = nameTables[range.index];
+            entry.ok = ExtractNamesFromTable(bytes, entry.names);
         }
+    }
+
+    std::sort(nameTables.begin(), nameTables.end(), NameRangeLess);
+    const auto tableAt = [&savedTables](const OpenType::TableRecord* record) {
+        if (!record) return ByteSpan();
+        for (const auto& saved : savedTables) {
+            if (saved.offset == record->offset && saved.length == record->length) {
+                return ByteSpan(saved.bytes.data(), saved.bytes.size());
+            }
+        }
+        return ByteSpan();
+    };
+    AssembleFaces(directories, isCollection, nameTables, tableAt, faces, single);
+    return true;
+}
 
-        // Return to offset table for next font
-        // Check for overflow: i + 1 must not exceed UINT32_MAX / OFFSET_SIZE
-        if (i + 1 > UINT32_MAX / OFFSET_SIZE) break;
-        file.seekg(FONT_HEADER_SIZE + (i + 1) * OFFSET_SIZE);
-        if (!file.good()) break;  // Seek failed, stop processing
+// Helper: Parse a font file (or standard input) with the requested I/O mode.
+// Returns false if the input cannot be read or is not a font.
+static bool ParsePath(const char* fontPath, IoMode mode, std::vector<FontMetadata>& faces, FontMetadata& single,
+                      FontIO::IoStats* stats) {
+    if (stats) *stats = FontIO::IoStats{};
+    if (!fontPath) return false;
+
+    const bool isStdin = strcmp(fontPath, FontIO::STDIN_PATH) == 0;
+    if (mode == IoMode::Auto) {
+        if (isStdin) mode = IoMode::Streamed;
+        else mode = FontIO::IsRemotePath(fontPath) ? IoMode::Planned : IoMode::Mapped;
     }
 
+    if (mode == IoMode::Mapped) {
+        FontIO::MappedFile file(fontPath);
+        if (!file.IsOpen()) return false;
+        // Files over the in-memory limit are streamed instead of rejected
+        if (file.Bytes().size() <= MAX_FONT_FILE_SIZE) {
+            if (stats) stats->bytesMapped = file.Bytes().size();
+            return ParseFaces(file.Bytes(), faces, single);
+        }
+        mode = IoMode::Streamed;
+    }
+
+    if (mode == IoMode::Planned) {
+        return ParseFacesPlanned(fontPath, faces, single, stats);
+    }
+
+    FontIO::StreamReader reader;
+    if (!reader.Open(fontPath)) return false;
+    const bool ok = ParseFacesStreamed(reader, faces, single);
+    if (stats) *stats = reader.Stats();
+    return ok;
+}
+
+std::vector<FontMetadata> GetFontMetadata(const uint8_t* data, size_t size) {
+    std::vector<FontMetadata> faces;
+    FontMetadata single;
+    ParseFaces(ByteSpan(data, size), faces, single);
+    return faces;
+}
+
+std::vector<FontMetadata> GetFontMetadata(const char* fontPath, FontIO::IoStats* stats, IoMode mode) {
+    std::vector<FontMetadata> faces;
+    FontMetadata single;
+    if (!ParsePath(fontPath, mode, faces, single, stats)) return {};
+
+    // Single fonts without a usable family name fall back to the filename (not for stdin)
+    if (faces.empty() && !single.isCollection && strcmp(fontPath, FontIO::STDIN_PATH) != 0) {
+        single.familyName = ExtractFilenameWithoutExtension(fontPath);
+        faces.push_back(std::move(single));
+    }
+    return faces;
+}
+
+std::string GetFontName(const uint8_t* data, size_t size) {
+    if (IsCollection(data, size)) return "";
+    std::vector<FontMetadata> faces = GetFontMetadata(data, size);
+    return faces.empty() ? "" : faces.front().familyName;
+}
+
+std::string GetFontName(const char* fontPath) {
+    std::vector<FontMetadata> faces;
+    FontMetadata single;
+    if (!ParsePath(fontPath, IoMode::Auto, faces, single, nullptr)) return "";
+
+    // Collections and single fonts without a family name are named after the file
+    if (single.isCollection || faces.empty()) {
+        return ExtractFilenameWithoutExtension(fontPath);
+    }
+    return faces.front().familyName;
+}
+
+std::vector<std::string> GetFontsInCollection(const uint8_t* data, size_t size) {
+    std::vector<std::string> names;
+    if (!IsCollection(data, size)) return names; // Not a TrueType Collection
+
+    std::vector<FontMetadata> faces = GetFontMetadata(data, size);
+    names.reserve(faces.size());
+    for (auto& face : faces) {
+        names.push_back(std::move(face.familyName));
+    }
+    return names;
+}
+
+std::vector<std::string> GetFontsInCollection(const char* fontPath) {
+    std::vector<FontMetadata> faces;
+    FontMetadata single;
+    std::vector<std::string> names;
+    if (!ParsePath(fontPath, IoMode::Auto, faces, single, nullptr) || !single.isCollection) return names;
+
+    names.reserve(faces.size());
+    for (auto& face : faces) {
+        names.push_back(std::move(face.familyName));
+    }
     return names;
 }
 
+std::vector<FaceCoverage> GetFontCoverage(const char* fontPath) {
+    FontIO::MappedFile mapped(fontPath);
+    const ByteSpan file = mapped.Bytes();
+    if (file.size() < MIN_FONT_FILE_SIZE || Woff::Detect(file) != Woff::Container::None) return {};
+
+    const bool isCollection = OpenType::IsCollection(file);
+    std::vector<uint32_t> offsets{0};
+    if (isCollection && !OpenType::ReadCollectionOffsets(file, MAX_FONTS_IN_COLLECTION, offsets)) return {};
+
+    std::vector<OpenTypeFace> directories(offsets.size());
+    for (size_t i = 0; i < offsets.size(); i++) {
+        directories[i].Parse(file, offsets[i]);
+    }
+
+    // Names come from the same single pass as GetFontMetadata
+    const auto tableAt = [file](const OpenType::TableRecord* record) {
+        return record ? file.Subspan(record->offset, record->length) : ByteSpan();
+    };
+    std::vector<FontMetadata> faces;
+    FontMetadata single;
+    BuildFaces(directories, isCollection, tableAt, faces, single);
+
+    std::vector<FaceCoverage> coverage;
+    auto named = faces.begin();
+    for (uint32_t i = 0; i < directories.size(); i++) {
+        if (directories[i].SfntVersion() == 0) continue;  // Directory not decoded
+        FaceCoverage face;
+        face.collectionIndex = isCollection ? i : 0;
+        if (named != faces.end() && named->collectionIndex == face.collectionIndex) {
+            face.familyName = std::move(named->familyName);
+            ++named;
+        } else if (!isCollection) {
+            face.familyName = ExtractFilenameWithoutExtension(fontPath);
+        }
+        Coverage::ReadCmap(directories[i].Table(OpenType::TAG_CMAP), face.ranges);
+        coverage.push_back(std::move(face));
+    }
+    return coverage;
+}
+
+// Helper: Format a 32-bit value as 0xXXXXXXXX
+static std::string Hex32(uint32_t value) {
+    char text[11];
+    snprintf(text, sizeof(text), "0x%08X", value);
+    return text;
+}
+
+// Helper: Check one face's tables: bounds, overlaps, checksums and head fields.
+// Tables whose (offset, length) are in `checked` were verified for an earlier face.
+static void VerifyFace(const OpenTypeFace& face, const std::string& prefix,
+                       std::vector<std::pair<uint32_t, uint32_t>>& checked, VerifyReport& report) {
+    const ByteSpan file = face.File();
+    std::vector<OpenType::TableRecord> byOffset = face.Tables();
+    std::sort(byOffset.begin(), byOffset.end(), [](const OpenType::TableRecord& a, const OpenType::TableRecord& b) {
+        return a.offset != b.offset ? a.offset < b.offset : a.length < b.length;
+    });
+
+    const uint64_t directoryEnd = static_cast<uint64_t>(face.FaceOffset()) + OpenType::SfntHeader::SIZE +
+                                  static_cast<uint64_t>(face.Tables().size()) * OpenType::TableDirectoryEntry::SIZE;
+    const OpenType::TableRecord* previous = nullptr;
+    for (const auto& table : byOffset) {
+        const std::string tag = "'" + OpenType::TagName(table.tag) + "'";
+        const uint64_t end = static_cast<uint64_t>(table.offset) + table.length;
+
+        // Bounds: the table must lie inside the file and outside this face's directory
+        if (end > file.size()) {
+            report.issues.push_back(prefix + tag + " extends past end of file (offset " + std::to_string(table.offset) +
+                                    ", length " + std::to_string(table.length) + ", file size " + std::to_string(file.size()) + ")");
+            continue;
+        }
+        if (table.length > 0 && table.offset < directoryEnd && end > face.FaceOffset()) {
+            report.issues.push_back(prefix + tag + " overlaps the table directory");
+        }
+        if (previous && table.length > 0 && table.offset < static_cast<uint64_t>(previous->offset) + previous->length) {
+            report.issues.push_back(prefix + tag + " overlaps '" + OpenType::TagName(previous->tag) + "'");
+        }
+        if (table.length > 0) previous = &table;
+
+        // Checksums: shared collection tables are summed once
+        const std::pair<uint32_t, uint32_t> range{table.offset, table.length};
+        if (std::find(checked.begin(), checked.end(), range) != checked.end()) continue;
+        checked.push_back(range);
+        report.tableCount++;
+
+        const ByteSpan bytes = file.Subspan(table.offset, table.length);
+        uint32_t sum = Checksum::SumBE32(bytes.data(), bytes.size());
+        if (table.tag == OpenType::TAG_HEAD) {
+            // head is summed with checkSumAdjustment taken as zero
+            sum -= OpenType::Head::CheckSumAdjustment::Get(bytes);
+            if (OpenType::Head::MagicNumber::Get(bytes) != OpenType::Head::MAGIC_NUMBER) {
+                report.issues.push_back(prefix + "'head' magic number is " + Hex32(OpenType::Head::MagicNumber::Get(bytes)) +
+                                        ", expected " + Hex32(OpenType::Head::MAGIC_NUMBER));
+            }
+        }
+        if (sum != table.checksum) {
+            report.issues.push_back(prefix + tag + " checksum mismatch: directory " + Hex32(table.checksum) + ", computed " + Hex32(sum));
+        }
+    }
+}
+
+// Helper: Check a WOFF/WOFF2 file: header length, and that table data decompresses to the
+// declared sizes. WOFF tables are checked against their stored sfnt checksums; WOFF2 stores
+// none, so its stream is checked as a whole (when this build can decode it).
+static void VerifyWebFont(const ByteSpan file, VerifyReport& report) {
+    Woff::WoffDirectory directory;
+    if (!directory.Parse(file.Subspan(0, std::min(file.size(), WOFF_DIRECTORY_READ)))) {
+        report.issues.push_back("invalid WOFF header or table directory");
+        return;
+    }
+    report.faceCount = static_cast<uint32_t>(directory.Faces().size());
+    if (directory.Length() != file.size()) {
+        report.issues.push_back("WOFF length field is " + std::to_string(directory.Length()) +
+                                ", file size is " + std::to_string(file.size()));
+    }
+
+    if (directory.Kind() == Woff::Container::Woff2) {
+        report.tableCount = static_cast<uint32_t>(directory.Tables().size());
+        if (!Woff::CanDecodeWoff2()) return;
+        Woff::Woff2Stream stream;
+        const ByteSpan data = file.Subspan(directory.DataOffset(), directory.CompressedSize());
+        if (data.empty() || !stream.Feed(data) || !stream.Finished()) {
+            report.issues.push_back("compressed table data is truncated or malformed");
+        } else if (stream.Produced() != directory.StreamSize()) {
+            report.issues.push_back("table data decompresses to " + std::to_string(stream.Produced()) +
+                                    " bytes, directory declares " + std::to_string(directory.StreamSize()));
+        }
+        return;
+    }
+
+    std::vector<uint8_t> table;
+    for (const Woff::WoffTable& entry : directory.Tables()) {
+        const std::string tag = "'" + OpenType::TagName(entry.tag) + "'";
+        const ByteSpan stored = file.Subspan(entry.offset, entry.storedLength);
+        if (stored.size() != entry.storedLength) {
+            report.issues.push_back(tag + " extends past end of file");
+            continue;
+        }
+        if (entry.origLength > MAX_FONT_FILE_SIZE) {
+            report.issues.push_back(tag + " is too large to check (" + std::to_string(entry.origLength) + " bytes)");
+            continue;
+        }
+        table.resize(entry.origLength);
+        if (!Woff::DecompressTable(entry, stored, table.data())) {
+            report.issues.push_back(tag + " does not decompress to " + std::to_string(entry.origLength) + " bytes");
+            continue;
+        }
+        report.tableCount++;
+
+        uint32_t sum = Checksum::SumBE32(table.data(), table.size());
+        if (entry.tag == OpenType::TAG_HEAD) {
+            sum -= OpenType::Head::CheckSumAdjustment::Get(ByteSpan(table.data(), table.size()));
+        }
+        if (sum != entry.checksum) {
+            report.issues.push_back(tag + " checksum mismatch: directory " + Hex32(entry.checksum) + ", computed " + Hex32(sum));
+        }
+    }
+}
+
+VerifyReport VerifyChecksums(const uint8_t* data, size_t size) {
+    VerifyReport report;
+    const ByteSpan file(data, size);
+    if (file.size() < OpenType::SfntHeader::SIZE) {
+        report.issues.push_back("File too small to be a font (" + std::to_string(file.size()) + " bytes)");
+        return report;
+    }
+    report.readable = true;
+    if (Woff::Detect(file) != Woff::Container::None) {
+        VerifyWebFont(file, report);
+        return report;
+    }
+
+    const bool isCollection = OpenType::IsCollection(file);
+    std::vector<uint32_t> offsets{0};
+    if (isCollection && !OpenType::ReadCollectionOffsets(file, MAX_FONTS_IN_COLLECTION, offsets)) {
+        report.issues.push_back("Invalid collection header");
+        return report;
+    }
+
+    std::vector<std::pair<uint32_t, uint32_t>> checked;
+    OpenTypeFace face;
+    for (uint32_t i = 0; i < offsets.size(); i++) {
+        const std::string prefix = isCollection ? "face " + std::to_string(i) + ": " : "";
+        if (!face.Parse(file, offsets[i])) {
+            report.issues.push_back(prefix + "invalid sfnt header or truncated table directory");
+            continue;
+        }
+        report.faceCount++;
+        VerifyFace(face, prefix, checked, report);
+
+        // checkSumAdjustment covers the whole file, which only identifies a single font
+        const OpenType::TableRecord* head = face.Find(OpenType::TAG_HEAD);
+        const ByteSpan headTable = face.Table(OpenType::TAG_HEAD);
+        if (isCollection || !head || headTable.size() < OpenType::Head::CheckSumAdjustment::END) continue;
+
+        const size_t fieldOffset = head->offset + OpenType::Head::CheckSumAdjustment::OFFSET;
+        const uint32_t stored = OpenType::Head::CheckSumAdjustment::Get(headTable);
+        const uint32_t fileSum = Checksum::SumBE32(file.data(), file.size()) -
+                                 Checksum::BytesContribution(file.data() + fieldOffset, sizeof(uint32_t), fieldOffset);
+        const uint32_t expected = Checksum::CHECKSUM_MAGIC - fileSum;
+        if (stored != expected) {
+            report.issues.push_back("head.checkSumAdjustment mismatch: stored " + Hex32(stored) + ", computed " + Hex32(expected));
+        }
+    }
+    return report;
+}
+
+VerifyReport VerifyChecksums(const char* fontPath) {
+    FontIO::MappedFile file(fontPath);
+    if (!file.IsOpen()) {
+        VerifyReport report;
+        report.issues.push_back("Cannot read file");
+        return report;
+    }
+    return VerifyChecksums(file.Bytes().data(), file.Bytes().size());
+}
+
 } // namespace FontParser
@@ -1,25 +1,125 @@
 // this_file: src/font_parser.h
 // Font file parser for fontlift-win-cli
 // Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
-// Parses TTF, OTF, TTC, and OTC font files to extract font family names
+// Parses TTF, OTF, TTC, OTC, WOFF, and WOFF2 font files to extract font family names
 
 #ifndef FONT_PARSER_H
 #define FONT_PARSER_H
 
+#include "coverage.h"
+#include "font_io.h"
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace FontParser {
+    // Outline format of a single face, from its sfnt version tag
+    enum class FontFormat : uint8_t {
+        Unknown,
+        TrueType,      // 0x00010000 (glyf outlines)
+        OpenTypeCFF    // 'OTTO' (CFF/CFF2 outlines)
+    };
+
+    // File wrapper around the sfnt data
+    enum class FontContainer : uint8_t {
+        Sfnt,   // Plain TTF/OTF/TTC/OTC
+        Woff,   // WOFF 1.0 web font (zlib-compressed tables)
+        Woff2   // WOFF 2.0 web font (Brotli-compressed tables)
+    };
+
+    // Metadata for one face, gathered in a single pass over its tables.
+    // Missing names are empty; missing OS/2 or head fields are zero.
+    struct FontMetadata {
+        std::string familyName;            // nameID 1
+        std::string subfamilyName;         // nameID 2
+        std::string fullName;              // nameID 4
+        std::string postScriptName;        // nameID 6
+        std::string typographicFamily;     // nameID 16
+        std::string typographicSubfamily;  // nameID 17
+        uint16_t weightClass = 0;          // OS/2 usWeightClass
+        uint16_t widthClass = 0;           // OS/2 usWidthClass
+        uint16_t fsType = 0;               // OS/2 fsType (embedding permissions)
+        uint32_t fontRevision = 0;         // head fontRevision (16.16 fixed)
+        FontFormat format = FontFormat::Unknown;
+        FontContainer container = FontContainer::Sfnt;
+        bool isCollection = false;         // Face belongs to a TTC/OTC
+        uint32_t collectionIndex = 0;      // Face index within the collection
+    };
+
+    // How a path-based parse reads the file
+    enum class IoMode : uint8_t {
+        Auto,     // Planned for remote paths, mapped otherwise
+        Mapped,   // Memory-map the whole file and parse in place
+        Planned,  // Positional reads of only the header, directories, and needed tables
+        Streamed  // Forward-only reads through a fixed window (pipes, files over the mapping limit)
+    };
+
+    // Path-based entry points memory-map the file once and parse it in place; files over 50 MB
+    // are streamed and the path "-" streams standard input. Remote paths use planned reads.
+    // Buffer overloads parse caller-owned bytes without copying them.
+    // WOFF/WOFF2 web fonts decompress only their name, OS/2, and head tables; WOFF2 names
+    // need a build with Brotli (FONTLIFT_HAVE_BROTLI), otherwise only the format is known.
+
+    // Parse every face of a TTF/OTF/TTC/OTC/WOFF/WOFF2 file in one pass
+    // Faces without a family name are skipped; single fonts fall back to the filename
+    // Returns empty vector if the file cannot be read or is not a font
+    // If stats is given, it receives the I/O performed for this file
+    [[nodiscard]] std::vector<FontMetadata> GetFontMetadata(const char* fontPath,
+                                                            FontIO::IoStats* stats = nullptr,
+                                                            IoMode mode = IoMode::Auto);
+    // Buffer variant: no filename fallback
+    [[nodiscard]] std::vector<FontMetadata> GetFontMetadata(const uint8_t* data, size_t size);
+
     // Extract font family name from TTF/OTF file
     // Returns empty string if parsing fails
     [[nodiscard]] std::string GetFontName(const char* fontPath);
+    // Buffer variant: returns empty string if parsing fails (no filename fallback)
+    [[nodiscard]] std::string GetFontName(const uint8_t* data, size_t size);
 
     // Extract all font names from TTC/OTC collection
     // Returns empty vector if parsing fails
     [[nodiscard]] std::vector<std::string> GetFontsInCollection(const char* fontPath);
+    [[nodiscard]] std::vector<std::string> GetFontsInCollection(const uint8_t* data, size_t size);
+
+    // Unicode coverage of one face, from its cmap
+    struct FaceCoverage {
+        uint32_t collectionIndex = 0;                  // Face index within a TTC/OTC
+        std::string familyName;                        // Single fonts fall back to the filename
+        std::vector<Coverage::CodepointRange> ranges;  // Empty if the face has no usable cmap
+    };
+
+    // Read the family name and cmap of every face of a TTF/OTF/TTC/OTC (memory-mapped, any
+    // size). Web fonts are not read: they cannot be installed.
+    // Returns empty vector if the file cannot be read or is not a font
+    [[nodiscard]] std::vector<FaceCoverage> GetFontCoverage(const char* fontPath);
+
+    // Result of VerifyChecksums for one file
+    struct VerifyReport {
+        bool readable = false;            // File was read and has a font header
+        uint32_t faceCount = 0;
+        uint32_t tableCount = 0;          // Distinct tables checked (shared collection tables count once)
+        std::vector<std::string> issues;  // One line per problem; empty when the file passed
+        [[nodiscard]] bool Passed() const noexcept { return readable && issues.empty(); }
+    };
+
+    // Validate every face: table bounds, overlaps between tables and with the directory,
+    // table checksums, head magic number, and (for single fonts) head.checkSumAdjustment.
+    // Web fonts: every WOFF table must decompress to its length and match its stored checksum;
+    // the WOFF2 stream must decompress to the directory's total (Brotli builds only).
+    // Reads the whole file; there is no size limit.
+    [[nodiscard]] VerifyReport VerifyChecksums(const char* fontPath);
+    [[nodiscard]] VerifyReport VerifyChecksums(const uint8_t* data, size_t size);
+
+    // Check the first four bytes for a signature the parser accepts (sfnt 0x00010000, 'OTTO',
+    // 'ttcf', 'wOFF', 'wOF2'); the path variant reads only those bytes and rejects files too
+    // small to be fonts. Nothing past the signature is validated.
+    [[nodiscard]] bool HasFontSignature(const char* fontPath);
+    [[nodiscard]] bool HasFontSignature(const uint8_t* data, size_t size);
 
-    // Check if file is a font collection (TTC/OTC)
+    // Check if file is a font collection (TTC/OTC, or a WOFF2 collection)
     [[nodiscard]] bool IsCollection(const char* fontPath);
+    [[nodiscard]] bool IsCollection(const uint8_t* data, size_t size);
 }
 
 #endif // FONT_PARSER_H
@@ -0,0 +1,255 @@
+// this_file: src/font_registry.cpp
+// Font registry decisions implementation
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+
+#include "font_registry.h"
+#include "content_store.h"
+#include "scheduler.h"
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <utility>
+
+namespace FontRegistry {
+
+std::string PathKey(const std::string& path) {
+    std::string key(path);
+    for (auto& c : key) {
+        if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+    }
+    return key;
+}
+
+std::string FullPath(const std::string& fontFile, const std::string& fontsDir) {
+    const bool isAbsolute = fontFile.length() > 1 && fontFile[1] == ':';
+    return isAbsolute ? fontFile : fontsDir + "\\" + fontFile;
+}
+
+bool IsValidFontPath(const std::string& path, const std::string& systemFontsDir) {
+    if (path.empty()) return false;
+    if (path.find("..\\") != std::string::npos || path.find("../") != std::string::npos) return false;
+    if (path.length() <= 1 || path[1] != ':') return true;  // Not drive-absolute: a name in the fonts directory
+    if (!systemFontsDir.empty() && PathKey(path).find(PathKey(systemFontsDir)) == 0) return true;
+    return ContentStore::IsObject(path);
+}
+
+bool MatchesWildcard(const char* name, const char* pattern) noexcept {
+    const auto lower = [](char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; };
+    const char* star = nullptr;    // Last '*' seen in the pattern
+    const char* resume = nullptr;  // Name position that '*' currently extends to
+    while (*name) {
+        if (*pattern == '*') {
+            star = pattern++;
+            resume = name;
+        } else if (*pattern == '?' || (*pattern && lower(*pattern) == lower(*name))) {
+            pattern++;
+            name++;
+        } else if (star) {
+            pattern = star + 1;  // Let the last '*' absorb one more character
+            name = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (*pattern == '*') pattern++;
+    return *pattern == '\0';
+}
+
+std::vector<std::string> BuildVariants(const char* fontName) {
+    return {
+        std::string(fontName) + FONT_SUFFIX_TRUETYPE,
+        std::string(fontName) + FONT_SUFFIX_OPENTYPE,
+        std::string(fontName)
+    };
+}
+
+std::string StripSuffix(const std::string& regName) {
+    for (const char* suffix : {FONT_SUFFIX_TRUETYPE, FONT_SUFFIX_OPENTYPE}) {
+        const size_t length = strlen(suffix);
+        if (regName.size() > length && regName.compare(regName.size() - length, length, suffix) == 0) {
+            return regName.substr(0, regName.size() - length);
+        }
+    }
+    return regName;
+}
+
+bool FindVariant(const FontStore::Key& key, const char* fontName, bool perUser, FontMatch& match) {
+    for (const auto& variant : BuildVariants(fontName)) {
+        std::string fontFile;
+        if (key.Read(variant.c_str(), fontFile)) {
+            match.file = fontFile;
+            match.regName = variant;
+            match.perUser = perUser;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Helper: Check if string is empty or contains only whitespace characters
+static bool IsEmptyOrWhitespace(const char* str) noexcept {
+    if (!str || *str == '\0') return true;
+    for (const char* p = str; *p; ++p) {
+        if (*p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') return false;
+    }
+    return true;
+}
+
+bool CompileNamePatterns(const std::vector<std::string>& names, bool useRegex, std::vector<NamePattern>& patterns) {
+    for (const auto& name : names) {
+        if (IsEmptyOrWhitespace(name.c_str())) {
+            std::cerr << "Error: Font name cannot be empty\n";
+            return false;
+        }
+        NamePattern pattern;
+        pattern.text = name;
+        pattern.key = PathKey(name);
+        pattern.isRegex = useRegex;
+        pattern.isGlob = !useRegex && name.find_first_of("*?") != std::string::npos;
+        if (useRegex) {
+            // std::regex reports a malformed expression only by throwing
+            try {
+                pattern.regex = std::regex(name, std::regex::ECMAScript | std::regex::icase | std::regex::optimize);
+            } catch (const std::regex_error& e) {
+                std::cerr << "Error: Invalid regular expression '" << name << "': " << e.what() << "\n";
+                return false;
+            }
+        }
+        patterns.push_back(std::move(pattern));
+    }
+    return true;
+}
+
+bool MatchesNamePattern(const NamePattern& pattern, const std::string& regName, const std::string& fontName) {
+    if (pattern.isRegex) return std::regex_match(fontName, pattern.regex) || std::regex_match(regName, pattern.regex);
+    if (pattern.isGlob) return MatchesWildcard(fontName.c_str(), pattern.text.c_str()) || MatchesWildcard(regName.c_str(), pattern.text.c_str());
+    return PathKey(fontName) == pattern.key || PathKey(regName) == pattern.key;
+}
+
+std::vector<RemovalTarget> SelectByName(FontStore::Store& store, FontStore::Key* const* keys,
+                                        std::vector<NamePattern>& patterns, bool includeSystem, size_t& heldBack) {
+    // Exact names are looked up by key, so a long list of names costs one lookup per entry;
+    // only wildcards and regular expressions are tried one by one
+    std::unordered_map<std::string, std::vector<size_t>> exact;
+    std::vector<size_t> others;
+    for (size_t p = 0; p < patterns.size(); p++) {
+        if (patterns[p].isGlob || patterns[p].isRegex) others.push_back(p);
+        else exact[patterns[p].key].push_back(p);
+    }
+    std::vector<RemovalTarget> targets;
+    for (const bool perUser : {true, false}) {
+        std::unique_ptr<FontStore::Key> readKey;
+        const FontStore::Key* key = keys[perUser];
+        if (!key) {
+            readKey = store.Open(perUser, false);
+            key = readKey.get();
+        }
+        std::vector<std::pair<std::string, std::string>> entries;
+        if (!key || !key->Enumerate(entries)) continue;
+        for (const auto& entry : entries) {
+            const std::string fontName = StripSuffix(entry.first);
+            bool selected = false;
+            bool held = false;
+            for (const std::string& nameKey : {PathKey(fontName), PathKey(entry.first)}) {
+                const auto found = exact.find(nameKey);
+                if (found == exact.end()) continue;
+                for (const size_t p : found->second) patterns[p].matched = true;
+                selected = true;
+            }
+            for (const size_t p : others) {
+                NamePattern& pattern = patterns[p];
+                if (!MatchesNamePattern(pattern, entry.first, fontName)) continue;
+                pattern.matched = true;
+                // A pattern selects system fonts, Windows' own among them, only with includeSystem
+                if (!perUser && !includeSystem) held = true;
+                else selected = true;
+            }
+            if (selected) targets.push_back({{entry.second, entry.first, perUser}, fontName});
+            else if (held) heldBack++;
+        }
+    }
+    return targets;
+}
+
+std::vector<FontMatch> FindExistingEntries(const std::string& name, const std::string& familyName,
+                                           const std::string& destPath, FontStore::Key* const* keys,
+                                           const bool* writable, const std::string* fontsDirs,
+                                           std::vector<Notice>& notices) {
+    const bool byFamily = !familyName.empty() && PathKey(familyName) != PathKey(name);
+    std::vector<FontMatch> entries;
+    for (const bool perUser : {true, false}) {
+        FontStore::Key* key = keys[perUser];
+        if (!key) continue;
+        for (const bool family : {false, true}) {
+            if (family && !byFamily) continue;
+            const std::string& entryName = family ? familyName : name;
+            for (const auto& variant : BuildVariants(entryName.c_str())) {
+                std::string fontFile;
+                if (!key->Read(variant.c_str(), fontFile)) continue;
+                if (family && PathKey(FullPath(fontFile, fontsDirs[perUser])) != PathKey(destPath)) continue;  // Another font of the family
+                if (!writable[perUser]) {
+                    notices.push_back({true, "Found older font '" + entryName + "' but cannot remove it without admin privileges."});
+                    continue;
+                }
+                if (!perUser && !IsValidFontPath(fontFile, fontsDirs[false])) {  // User entries: files are kept anyway
+                    notices.push_back({true, "Found invalid registry path for '" + entryName + "', skipping automatic uninstall."});
+                    continue;
+                }
+                entries.push_back({fontFile, variant, perUser});
+            }
+        }
+    }
+    return entries;
+}
+
+bool RemoveExistingEntries(const std::vector<FontMatch>& entries, FontStore::Key* const* keys,
+                           const std::string* fontsDirs, std::vector<std::string>& unregistered,
+                           std::vector<Notice>& notices) {
+    bool removed = false;
+    for (const auto& entry : entries) {
+        const std::string entryName = StripSuffix(entry.regName);
+        if (!keys[entry.perUser]->Delete(entry.regName.c_str())) {
+            notices.push_back({true, "Failed to remove existing font '" + entryName + "' before installation."});
+            continue;
+        }
+        notices.push_back({false, "Automatically uninstalled older version of: " + entryName});
+        unregistered.push_back(FullPath(entry.file, fontsDirs[entry.perUser]));
+        removed = true;
+    }
+    return removed;
+}
+
+bool FindBrokenEntries(FontStore::Store& store, bool perUser, const std::function<bool(const std::string&)>& fileExists,
+                       std::vector<BrokenEntry>& broken) {
+    std::vector<std::pair<std::string, std::string>> entries;
+    {
+        const std::unique_ptr<FontStore::Key> key = store.Open(perUser, false);
+        if (!key || !key->Enumerate(entries)) return false;
+    }
+    const std::string baseDir = store.FontsDirectory(perUser);
+
+    // Full path of each entry ("" = skipped) and whether it is missing
+    std::vector<std::string> fullPaths(entries.size());
+    std::vector<char> missing(entries.size(), 0);
+    Scheduler::ParallelFor(Scheduler::IoPool(), entries.size(), [&entries, &baseDir, &fullPaths, &missing, &fileExists](size_t i) {
+        const std::string& file = entries[i].second;
+        if (file.empty()) return;
+        const bool isAbsolute = (file.size() > 1 && file[1] == ':') || file[0] == '\\' || file[0] == '/';
+        if (!isAbsolute && baseDir.empty()) return;
+        fullPaths[i] = isAbsolute ? file : baseDir + "\\" + file;
+        missing[i] = !fileExists(fullPaths[i]);
+    });
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (fullPaths[i].empty()) {
+            if (!entries[i].second.empty()) {
+                std::cerr << "    Warning: Skipping registry entry '" << entries[i].first << "' (unknown base directory).\n";
+            }
+            continue;
+        }
+        if (missing[i]) broken.push_back({entries[i].first, fullPaths[i]});
+    }
+    return true;
+}
+
+} // namespace FontRegistry
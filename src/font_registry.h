@@ -0,0 +1,120 @@
+// this_file: src/font_registry.h
+// Font registry decisions for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Which registrations install, uninstall/remove by name and cleanup touch, over any FontStore::Store (no Win32)
+
+#ifndef FONT_REGISTRY_H
+#define FONT_REGISTRY_H
+
+#include "font_store.h"
+#include <cstddef>
+#include <functional>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace FontRegistry {
+    // Value name suffixes (per Windows font registry naming convention)
+    constexpr const char* FONT_SUFFIX_TRUETYPE = " (TrueType)";
+    constexpr const char* FONT_SUFFIX_OPENTYPE = " (OpenType)";
+
+    // One registry entry (perUser: false = system, true = current user)
+    struct FontMatch {
+        std::string file;          // As registered: a file name in the fonts directory, or an absolute path
+        std::string regName;
+        bool perUser;
+    };
+
+    // One registry entry selected for removal
+    struct RemovalTarget {
+        FontMatch match;
+        std::string fontName;      // Value name without the type suffix
+    };
+
+    // One name or pattern of an uninstall/remove batch
+    struct NamePattern {
+        std::string text;
+        std::string key;           // PathKey(text), for exact names
+        bool isGlob = false;       // Contains '*' or '?'
+        bool isRegex = false;
+        std::regex regex;
+        bool matched = false;
+    };
+
+    // One registry entry whose file is missing
+    struct BrokenEntry {
+        std::string regName;
+        std::string fullPath;
+    };
+
+    // A message from a registry decision, printed by the caller
+    struct Notice {
+        bool warning;              // "Warning:" on stderr rather than "Note:" on stdout
+        std::string text;          // Without the prefix
+    };
+
+    // Case-insensitive key for a Windows path or value name (ASCII lowercase)
+    [[nodiscard]] std::string PathKey(const std::string& path);
+
+    // Full path of a registered file: drive-absolute paths as they are, names in fontsDir
+    [[nodiscard]] std::string FullPath(const std::string& fontFile, const std::string& fontsDir);
+
+    // Whether a registered file may be unloaded or deleted: no ".." components, and a bare name,
+    // a path in the system fonts directory or a content store object
+    [[nodiscard]] bool IsValidFontPath(const std::string& path, const std::string& systemFontsDir);
+
+    // ASCII case-insensitive wildcard match: '*' matches any run, '?' one character
+    [[nodiscard]] bool MatchesWildcard(const char* name, const char* pattern) noexcept;
+
+    // Value names a font name may be registered under: with " (TrueType)", " (OpenType)", bare
+    [[nodiscard]] std::vector<std::string> BuildVariants(const char* fontName);
+
+    // Value name without the " (TrueType)" or " (OpenType)" suffix
+    [[nodiscard]] std::string StripSuffix(const std::string& regName);
+
+    // The first variant of fontName registered in key; false if none is
+    bool FindVariant(const FontStore::Key& key, const char* fontName, bool perUser, FontMatch& match);
+
+    // Turn names into patterns: with useRegex every name is an ECMAScript regular expression,
+    // otherwise names with '*' or '?' are wildcards and the rest exact names (all
+    // case-insensitive). Reports an empty name or a malformed expression and returns false.
+    bool CompileNamePatterns(const std::vector<std::string>& names, bool useRegex, std::vector<NamePattern>& patterns);
+
+    // Whether a pattern selects a registry entry. Exact names match the value name with or
+    // without its type suffix, as BuildVariants does; patterns must match the whole name, with
+    // or without the suffix.
+    [[nodiscard]] bool MatchesNamePattern(const NamePattern& pattern, const std::string& regName, const std::string& fontName);
+
+    // Uninstall/remove by name: the entries of both scopes the patterns select, user entries
+    // first. Each scope is enumerated once, through keys[perUser] or, if that is null, a
+    // read-only key of the store. System entries matched only by a wildcard or regular
+    // expression are counted in heldBack instead unless includeSystem. Sets matched on every
+    // pattern that matched an entry.
+    std::vector<RemovalTarget> SelectByName(FontStore::Store& store, FontStore::Key* const* keys,
+                                            std::vector<NamePattern>& patterns, bool includeSystem, size_t& heldBack);
+
+    // Install: the earlier installs of a font name to unregister from the keys (indexed by
+    // perUser; null keys are skipped). Entries under the family name (as older installs named
+    // them) count too, but only when they point at destPath. System entries need writable[false]
+    // and a valid path; a warning is appended to notices for each one left.
+    std::vector<FontMatch> FindExistingEntries(const std::string& name, const std::string& familyName,
+                                               const std::string& destPath, FontStore::Key* const* keys,
+                                               const bool* writable, const std::string* fontsDirs,
+                                               std::vector<Notice>& notices);
+
+    // Install: unregister the entries FindExistingEntries found, files kept. The full paths of the
+    // unregistered files are appended to unregistered, to be unloaded, and a notice for each entry
+    // to notices. Returns true if an entry was removed.
+    bool RemoveExistingEntries(const std::vector<FontMatch>& entries, FontStore::Key* const* keys,
+                               const std::string* fontsDirs, std::vector<std::string>& unregistered,
+                               std::vector<Notice>& notices);
+
+    // Cleanup: the entries of one scope whose file is missing, in registry order. fileExists is
+    // called on the I/O pool, as a font on a network share or sleeping drive can block each
+    // check. Entries relative to an unknown fonts directory are skipped with a warning. False if
+    // the scope cannot be enumerated.
+    bool FindBrokenEntries(FontStore::Store& store, bool perUser, const std::function<bool(const std::string&)>& fileExists,
+                           std::vector<BrokenEntry>& broken);
+}
+
+#endif // FONT_REGISTRY_H
@@ -0,0 +1,259 @@
+// this_file: src/font_store.cpp
+// Font registration backends implementation
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+
+#include "font_store.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <thread>
+
+namespace FontStore {
+
+// Longest registry value name (Windows limit: 16,383 characters)
+constexpr size_t MAX_VALUE_NAME_LENGTH = 16383;
+
+// Helper: Lowercase ASCII letters (registry value names are case-insensitive)
+static std::string LowerName(const std::string& name) {
+    std::string lower = name;
+    for (char& c : lower) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return lower;
+}
+
+// Helper: Validate value name length, as the registry does
+static bool IsValidValueName(const char* valueName) noexcept {
+    return valueName && std::strlen(valueName) <= MAX_VALUE_NAME_LENGTH;
+}
+
+// Key of one scope of a MemoryStore; writes need a writable key
+class MemoryStore::MemoryKey : public Key {
+public:
+    MemoryKey(MemoryStore& store, bool perUser, bool writable) noexcept
+        : store_(store), perUser_(perUser), writable_(writable) {}
+
+    bool Read(const char* valueName, std::string& fontFile) const override {
+        store_.Wait(1);
+        store_.reads_.fetch_add(1, std::memory_order_relaxed);
+        if (!IsValidValueName(valueName)) return false;
+        std::lock_guard<std::mutex> lock(store_.mutex_);
+        const Entries& entries = store_.entries_[perUser_];
+        const auto found = entries.find(LowerName(valueName));
+        if (found == entries.end()) return false;
+        fontFile = found->second.second;
+        return true;
+    }
+
+    bool Write(const char* valueName, const char* fontFile) override {
+        store_.Wait(1);
+        store_.writes_.fetch_add(1, std::memory_order_relaxed);
+        if (!writable_ || !IsValidValueName(valueName) || !fontFile) return false;
+        std::lock_guard<std::mutex> lock(store_.mutex_);
+        if (!store_.Persist(perUser_, valueName, fontFile)) return false;
+        store_.Put(perUser_, valueName, fontFile);
+        return true;
+    }
+
+    bool Delete(const char* valueName) override {
+        store_.Wait(1);
+        store_.deletes_.fetch_add(1, std::memory_order_relaxed);
+        if (!writable_ || !IsValidValueName(valueName)) return false;
+        std::lock_guard<std::mutex> lock(store_.mutex_);
+        const Entries& entries = store_.entries_[perUser_];
+        const auto found = entries.find(LowerName(valueName));
+        if (found == entries.end()) return false;  // As RegDeleteValueA: nothing to delete is an error
+        if (!store_.Persist(perUser_, found->second.first, nullptr)) return false;
+        store_.Erase(perUser_, valueName);
+        return true;
+    }
+
+    bool Enumerate(std::vector<std::pair<std::string, std::string>>& entries) const override {
+        store_.Wait(1);
+        size_t count = 0;
+        {
+            std::lock_guard<std::mutex> lock(store_.mutex_);
+            const Entries& scope = store_.entries_[perUser_];
+            entries.reserve(entries.size() + scope.size());
+            for (const auto& entry : scope) entries.push_back(entry.second);
+            count = scope.size();
+        }
+        store_.Wait(count);
+        store_.enumerated_.fetch_add(count, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    MemoryStore& store_;
+    bool perUser_;
+    bool writable_;
+};
+
+MemoryStore::MemoryStore(MemoryOptions options) : options_(std::move(options)) {}
+
+void MemoryStore::Wait(uint64_t calls) const {
+    if (options_.latency.count() > 0 && calls > 0) {
+        std::this_thread::sleep_for(options_.latency * static_cast<int64_t>(calls));
+    }
+}
+
+std::unique_ptr<Key> MemoryStore::Open(bool perUser, bool writable) {
+    Wait(1);
+    opens_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!available_) return nullptr;
+    }
+    if (!perUser && writable && !options_.systemWritable) return nullptr;
+    return std::make_unique<MemoryKey>(*this, perUser, writable);
+}
+
+std::string MemoryStore::FontsDirectory(bool perUser) {
+    return options_.fontsDirs[perUser];
+}
+
+size_t MemoryStore::Size(bool perUser) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_[perUser].size();
+}
+
+Stats MemoryStore::GetStats() const noexcept {
+    Stats stats;
+    stats.opens = opens_.load(std::memory_order_relaxed);
+    stats.reads = reads_.load(std::memory_order_relaxed);
+    stats.writes = writes_.load(std::memory_order_relaxed);
+    stats.deletes = deletes_.load(std::memory_order_relaxed);
+    stats.enumerated = enumerated_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool MemoryStore::Persist(bool, const std::string&, const char*) {
+    return true;  // Nothing outlives the process
+}
+
+void MemoryStore::Put(bool perUser, const std::string& valueName, const std::string& fontFile) {
+    entries_[perUser][LowerName(valueName)] = {valueName, fontFile};
+}
+
+void MemoryStore::Erase(bool perUser, const std::string& valueName) {
+    entries_[perUser].erase(LowerName(valueName));
+}
+
+// Helper: True if text can be stored on one line of a FileStore
+static bool FitsOnLine(const char* text) noexcept {
+    return std::strpbrk(text, "\t\r\n") == nullptr;
+}
+
+FileStore::FileStore(const std::string& path, MemoryOptions options) : MemoryStore(std::move(options)), path_(path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    available_ = Load();
+    if (!available_) return;
+    log_ = std::fopen(path_.c_str(), "ab");
+    if (!log_ || (torn_ && !CompactLocked())) {
+        error_ = "Cannot open " + path_ + " for writing";
+        available_ = false;
+    }
+}
+
+FileStore::~FileStore() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t entries = entries_[false].size() + entries_[true].size();
+    if (log_ && lines_ > 2 * entries) CompactLocked();
+    if (log_) std::fclose(log_);
+}
+
+bool FileStore::IsLoaded(std::string* error) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error) *error = error_;
+    return available_;
+}
+
+bool FileStore::Compact() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return log_ && CompactLocked();
+}
+
+// Helper (lock held): Replay the file's lines; a missing file is an empty store. A last line
+// without its line break is a change whose append was cut short: it is dropped, and the file is
+// rewritten before anything is appended to it.
+bool FileStore::Load() {
+    std::error_code ec;
+    if (!std::filesystem::exists(path_, ec)) return !ec;
+    std::ifstream in(path_, std::ios::binary);
+    if (!in) {
+        error_ = "Cannot read " + path_;
+        return false;
+    }
+    std::string line;
+    size_t number = 0;
+    while (std::getline(in, line)) {
+        number++;
+        if (in.eof()) {
+            torn_ = true;
+            break;
+        }
+        const bool scoped = line.size() >= 3 && (line[1] == 'S' || line[1] == 'U') && line[2] == '\t';
+        const size_t tab = scoped ? line.find('\t', 3) : std::string::npos;
+        const bool perUser = scoped && line[1] == 'U';
+        if (scoped && line[0] == '+' && tab != std::string::npos) {
+            Put(perUser, line.substr(3, tab - 3), line.substr(tab + 1));
+        } else if (scoped && line[0] == '-' && line.find('\t', 3) == std::string::npos) {
+            Erase(perUser, line.substr(3));
+        } else {
+            error_ = "Malformed line " + std::to_string(number) + " in " + path_;
+            return false;
+        }
+        lines_++;
+    }
+    return true;
+}
+
+bool FileStore::Persist(bool perUser, const std::string& valueName, const char* fontFile) {
+    if (!log_ || !FitsOnLine(valueName.c_str()) || (fontFile && !FitsOnLine(fontFile))) return false;
+    std::string line;
+    line += fontFile ? '+' : '-';
+    line += perUser ? 'U' : 'S';
+    line += '\t';
+    line += valueName;
+    if (fontFile) {
+        line += '\t';
+        line += fontFile;
+    }
+    line += '\n';
+    if (std::fwrite(line.data(), 1, line.size(), log_) != line.size() || std::fflush(log_) != 0) return false;
+    lines_++;
+    return true;
+}
+
+// Helper (lock held): Write every entry to a temporary file and rename it over the file
+bool FileStore::CompactLocked() {
+    const std::string tempPath = path_ + ".tmp";
+    std::FILE* out = std::fopen(tempPath.c_str(), "wb");
+    if (!out) return false;
+    bool ok = true;
+    size_t lines = 0;
+    for (const bool perUser : {false, true}) {
+        for (const auto& entry : entries_[perUser]) {
+            const std::string line = std::string("+") + (perUser ? 'U' : 'S') + '\t' + entry.second.first + '\t' +
+                                     entry.second.second + '\n';
+            ok = ok && std::fwrite(line.data(), 1, line.size(), out) == line.size();
+            lines++;
+        }
+    }
+    if (std::fclose(out) != 0) ok = false;
+    if (!ok) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    std::fclose(log_);
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path_, ec);
+    if (ec) std::remove(tempPath.c_str());
+    else lines_ = lines;
+    log_ = std::fopen(path_.c_str(), "ab");
+    if (!log_) available_ = false;
+    return !ec && log_;
+}
+
+} // namespace FontStore
@@ -0,0 +1,138 @@
+// this_file: src/font_store.h
+// Font registration backends for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Where font registrations live: the Windows registry (SysUtils::RegistryStore) or an in-memory or file-backed stand-in
+
+#ifndef FONT_STORE_H
+#define FONT_STORE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace FontStore {
+    // The registrations of one scope, as under ...\CurrentVersion\Fonts: value name -> font file
+    // (a file name in the scope's fonts directory, or an absolute path). Opened once per batch.
+    // Value names are UTF-8, like the font names they are made from; files are in the ANSI code
+    // page of the file APIs.
+    class Key {
+    public:
+        virtual ~Key() = default;
+        virtual bool Read(const char* valueName, std::string& fontFile) const = 0;
+        virtual bool Write(const char* valueName, const char* fontFile) = 0;
+        virtual bool Delete(const char* valueName) = 0;
+
+        // Every entry (value name, file) in one pass, so entries can then be deleted without
+        // disturbing the enumeration
+        virtual bool Enumerate(std::vector<std::pair<std::string, std::string>>& entries) const = 0;
+    };
+
+    // Both scopes' registrations and fonts directories (perUser: false = system, true = current user)
+    class Store {
+    public:
+        virtual ~Store() = default;
+
+        // Key of a scope, or nullptr if it cannot be opened; writable: for writes too (the
+        // per-user scope is created if missing)
+        [[nodiscard]] virtual std::unique_ptr<Key> Open(bool perUser, bool writable) = 0;
+
+        // Fonts directory of a scope, without a trailing separator; empty if unknown
+        [[nodiscard]] virtual std::string FontsDirectory(bool perUser) = 0;
+    };
+
+    // Calls made on a stand-in store, for benchmarks
+    struct Stats {
+        uint64_t opens = 0;
+        uint64_t reads = 0;
+        uint64_t writes = 0;
+        uint64_t deletes = 0;
+        uint64_t enumerated = 0;   // Entries returned by Enumerate
+    };
+
+    struct MemoryOptions {
+        std::string fontsDirs[2];                    // Indexed by perUser
+        // Added to every call, and to every entry an enumeration returns (RegEnumValueW is one
+        // call per value), to model a loaded or remote registry
+        std::chrono::microseconds latency{0};
+        bool systemWritable = true;                  // false: opening the system scope for writing fails, as without admin rights
+    };
+
+    // Registrations held in memory. Value names compare ASCII case-insensitively, as registry
+    // value names do, and keep the case they were written with. Safe to use from several threads.
+    class MemoryStore : public Store {
+    public:
+        explicit MemoryStore(MemoryOptions options = {});
+        ~MemoryStore() override = default;
+
+        MemoryStore(const MemoryStore&) = delete;
+        MemoryStore& operator=(const MemoryStore&) = delete;
+
+        [[nodiscard]] std::unique_ptr<Key> Open(bool perUser, bool writable) override;
+        [[nodiscard]] std::string FontsDirectory(bool perUser) override;
+
+        [[nodiscard]] size_t Size(bool perUser) const;
+        [[nodiscard]] Stats GetStats() const noexcept;
+
+    protected:
+        // Called with the lock held before an entry is set (fontFile non-null) or deleted;
+        // false refuses the change
+        virtual bool Persist(bool perUser, const std::string& valueName, const char* fontFile);
+
+        // Set or delete an entry without latency, stats or Persist (loading initial state);
+        // the lock must be held
+        void Put(bool perUser, const std::string& valueName, const std::string& fontFile);
+        void Erase(bool perUser, const std::string& valueName);
+
+        // Entry: (value name as written, font file), keyed by the lowercased value name
+        using Entries = std::map<std::string, std::pair<std::string, std::string>>;
+        mutable std::mutex mutex_;
+        Entries entries_[2];            // Indexed by perUser
+        bool available_ = true;         // false: every Open fails
+
+    private:
+        class MemoryKey;
+        void Wait(uint64_t calls) const;
+
+        MemoryOptions options_;
+        mutable std::atomic<uint64_t> opens_{0}, reads_{0}, writes_{0}, deletes_{0}, enumerated_{0};
+    };
+
+    // MemoryStore kept in a text file: read when constructed, every change appended as one line
+    // and flushed, and the file rewritten without superseded lines by Compact() and on
+    // destruction once they outnumber the entries. Lines are "+<scope>\t<name>\t<file>" and
+    // "-<scope>\t<name>", scope 'S' (system) or 'U' (user). Names and files cannot hold tabs or
+    // line breaks.
+    class FileStore : public MemoryStore {
+    public:
+        FileStore(const std::string& path, MemoryOptions options = {});
+        ~FileStore() override;
+
+        // False if the file existed but could not be read; every Open then fails. error says why.
+        [[nodiscard]] bool IsLoaded(std::string* error = nullptr) const;
+
+        // Rewrite the file with one line per entry; false if it cannot be written
+        bool Compact();
+
+    protected:
+        bool Persist(bool perUser, const std::string& valueName, const char* fontFile) override;
+
+    private:
+        bool Load();
+        bool CompactLocked();
+
+        std::string path_;
+        std::string error_;
+        std::FILE* log_ = nullptr;      // Open for appending
+        size_t lines_ = 0;              // Lines in the file
+        bool torn_ = false;             // The file ends in an incomplete line
+    };
+}
+
+#endif // FONT_STORE_H
@@ -0,0 +1,347 @@
+// this_file: src/inflate.cpp
+// DEFLATE decoder implementation
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+
+#include "inflate.h"
+#include "byte_order.h"
+#include <cstring>
+
+namespace Inflate {
+// Canonical Huffman decoding: codes up to FAST_BITS long resolve with one table lookup, longer
+// codes walk the canonical code space a bit at a time (as in zlib's reference decoder, puff.c).
+// Back-references read from the output buffer itself, so no separate window is kept.
+
+constexpr int MAX_BITS = 15;                         // Longest DEFLATE code (bits)
+constexpr int MAX_LITERAL_CODES = 288;               // Literal/length alphabet, incl. two unused fixed codes
+constexpr int MAX_DISTANCE_CODES = 30;               // Distance alphabet
+constexpr int CODE_LENGTH_CODES = 19;                // Code length alphabet of dynamic blocks
+constexpr int FAST_BITS = 9;                         // Codes up to this length decode with one lookup
+constexpr uint64_t FAST_MASK = (1u << FAST_BITS) - 1;
+constexpr int FAST_SYMBOL_BITS = 9;                  // Fast entry: (length << FAST_SYMBOL_BITS) | symbol
+constexpr uint16_t FAST_SYMBOL_MASK = (1u << FAST_SYMBOL_BITS) - 1;
+constexpr uint32_t ADLER_MODULUS = 65521;            // Largest prime below 2^16
+constexpr size_t ADLER_BLOCK = 5552;                 // Bytes summed before the 32-bit sums must be reduced
+
+// Length and distance symbol bases and extra bits (per RFC 1951, section 3.2.5)
+constexpr uint16_t LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                      35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                      3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr uint16_t DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr uint8_t DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+constexpr uint8_t CODE_LENGTH_ORDER[CODE_LENGTH_CODES] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// Decoding tables for one canonical Huffman code
+struct Huffman {
+    uint16_t count[MAX_BITS + 1];            // Number of codes of each length
+    uint16_t symbol[MAX_LITERAL_CODES];      // Symbols in canonical code order
+    uint16_t fast[1u << FAST_BITS];          // Fast entry for codes up to FAST_BITS, 0 if none
+};
+
+// Helper: Build decoding tables from per-symbol code lengths. Returns 0 for a complete code,
+// a positive value for an incomplete one, and a negative value for an over-subscribed one.
+static int BuildHuffman(Huffman& h, const uint8_t* lengths, int n) noexcept {
+    memset(h.count, 0, sizeof(h.count));
+    memset(h.fast, 0, sizeof(h.fast));
+    for (int s = 0; s < n; s++) h.count[lengths[s]]++;
+    if (h.count[0] == n) return 0;  // No codes: complete, but decoding any symbol fails
+
+    int left = 1;
+    for (int len = 1; len <= MAX_BITS; len++) {
+        left <<= 1;
+        left -= h.count[len];
+        if (left < 0) return left;
+    }
+
+    uint16_t offsets[MAX_BITS + 1];
+    offsets[1] = 0;
+    for (int len = 1; len < MAX_BITS; len++) offsets[len + 1] = offsets[len] + h.count[len];
+    for (int s = 0; s < n; s++) {
+        if (lengths[s] != 0) h.symbol[offsets[lengths[s]]++] = static_cast<uint16_t>(s);
+    }
+
+    // DEFLATE sends codes most-significant bit first, so table indices are bit-reversed codes
+    uint32_t code = 0;
+    int index = 0;
+    for (int len = 1; len <= FAST_BITS; len++) {
+        for (int k = 0; k < h.count[len]; k++, index++, code++) {
+            uint32_t reversed = 0;
+            for (int b = 0; b < len; b++) reversed |= ((code >> b) & 1u) << (len - 1 - b);
+            const uint16_t entry = static_cast<uint16_t>((len << FAST_SYMBOL_BITS) | h.symbol[index]);
+            for (uint32_t r = reversed; r < (1u << FAST_BITS); r += 1u << len) h.fast[r] = entry;
+        }
+        code <<= 1;
+    }
+    return left;
+}
+
+// Fixed literal/length and distance codes (per RFC 1951, section 3.2.6), built once
+struct FixedCodes {
+    Huffman literal;
+    Huffman distance;
+    FixedCodes() noexcept {
+        uint8_t lengths[MAX_LITERAL_CODES];
+        int s = 0;
+        for (; s < 144; s++) lengths[s] = 8;
+        for (; s < 256; s++) lengths[s] = 9;
+        for (; s < 280; s++) lengths[s] = 7;
+        for (; s < MAX_LITERAL_CODES; s++) lengths[s] = 8;
+        BuildHuffman(literal, lengths, MAX_LITERAL_CODES);
+        for (s = 0; s < MAX_DISTANCE_CODES; s++) lengths[s] = 5;
+        BuildHuffman(distance, lengths, MAX_DISTANCE_CODES);
+    }
+};
+
+static const FixedCodes& Fixed() noexcept {
+    static const FixedCodes codes;
+    return codes;
+}
+
+// Bounded decoder state: input position, bit buffer, and output position
+class Decoder {
+public:
+    Decoder(const uint8_t* src, size_t srcLength, uint8_t* dst, size_t dstLength) noexcept
+        : src_(src), srcLength_(srcLength), dst_(dst), dstLength_(dstLength) {}
+
+    Result Run() noexcept {
+        for (;;) {
+            uint32_t last = 0;
+            uint32_t type = 0;
+            if (!Bits(1, last) || !Bits(2, type)) return Result::Malformed;
+
+            Result block = Result::Malformed;
+            if (type == 0) {
+                block = Stored();
+            } else if (type == 1) {
+                block = Codes(Fixed().literal, Fixed().distance);
+            } else if (type == 2) {
+                block = Dynamic();
+            }
+            if (block != Result::Complete) return block;
+            if (last) return Result::Complete;
+        }
+    }
+
+    [[nodiscard]] size_t Produced() const noexcept { return out_; }
+    // Input bytes used, including the partially used last byte
+    [[nodiscard]] size_t Consumed() const noexcept { return in_ - bitCount_ / 8; }
+
+private:
+    void Refill() noexcept {
+        while (bitCount_ <= 56 && in_ < srcLength_) {
+            bitBuffer_ |= static_cast<uint64_t>(src_[in_++]) << bitCount_;
+            bitCount_ += 8;
+        }
+    }
+
+    uint32_t Take(int n) noexcept {
+        const uint32_t value = static_cast<uint32_t>(bitBuffer_ & ((1ull << n) - 1));
+        bitBuffer_ >>= n;
+        bitCount_ -= n;
+        return value;
+    }
+
+    bool Bits(int n, uint32_t& value) noexcept {
+        if (bitCount_ < n) Refill();
+        if (bitCount_ < n) return false;  // Truncated input
+        value = Take(n);
+        return true;
+    }
+
+    // Next symbol of code h, or -1 for an invalid code or truncated input
+    int Decode(const Huffman& h) noexcept {
+        if (bitCount_ < MAX_BITS) Refill();
+        const uint16_t entry = h.fast[bitBuffer_ & FAST_MASK];
+        const int length = entry >> FAST_SYMBOL_BITS;
+        if (entry != 0 && length <= bitCount_) {
+            Take(length);
+            return entry & FAST_SYMBOL_MASK;
+        }
+
+        int code = 0;   // Bits read so far
+        int first = 0;  // First code of the current length
+        int index = 0;  // Symbol index of the first code of the current length
+        for (int len = 1; len <= MAX_BITS; len++) {
+            if (bitCount_ == 0) return -1;
+            code |= static_cast<int>(Take(1));
+            const int count = h.count[len];
+            if (code - count < first) return h.symbol[index + (code - first)];
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+    Result Stored() noexcept {
+        // Skip to the byte boundary and hand buffered whole bytes back to the input
+        Take(bitCount_ % 8);
+        in_ -= bitCount_ / 8;
+        bitBuffer_ = 0;
+        bitCount_ = 0;
+
+        if (srcLength_ - in_ < 4) return Result::Malformed;
+        const uint32_t length = src_[in_] | (src_[in_ + 1] << 8);
+        const uint32_t complement = src_[in_ + 2] | (src_[in_ + 3] << 8);
+        in_ += 4;
+        if (length != (~complement & 0xFFFF)) return Result::Malformed;
+
+        const size_t count = length < dstLength_ - out_ ? length : dstLength_ - out_;
+        if (srcLength_ - in_ < count) return Result::Malformed;
+        memcpy(dst_ + out_, src_ + in_, count);
+        in_ += count;
+        out_ += count;
+        return count < length ? Result::OutputFull : Result::Complete;
+    }
+
+    Result Codes(const Huffman& literal, const Huffman& distance) noexcept {
+        for (;;) {
+            int symbol = Decode(literal);
+            if (symbol < 0) return Result::Malformed;
+            if (symbol < 256) {
+                if (out_ == dstLength_) return Result::OutputFull;
+                dst_[out_++] = static_cast<uint8_t>(symbol);
+                continue;
+            }
+            if (symbol == 256) return Result::Complete;  // End of block
+
+            symbol -= 257;
+            if (symbol >= 29) return Result::Malformed;
+            uint32_t extra = 0;
+            if (!Bits(LENGTH_EXTRA[symbol], extra)) return Result::Malformed;
+            const size_t length = LENGTH_BASE[symbol] + extra;
+
+            symbol = Decode(distance);
+            if (symbol < 0 || symbol >= MAX_DISTANCE_CODES) return Result::Malformed;
+            if (!Bits(DISTANCE_EXTRA[symbol], extra)) return Result::Malformed;
+            const size_t dist = DISTANCE_BASE[symbol] + extra;
+            if (dist > out_) return Result::Malformed;  // Reference before the start of the output
+
+            // Byte-wise copy: the source may overlap the bytes being written
+            const size_t count = length < dstLength_ - out_ ? length : dstLength_ - out_;
+            const uint8_t* from = dst_ + out_ - dist;
+            for (size_t i = 0; i < count; i++) dst_[out_ + i] = from[i];
+            out_ += count;
+            if (count < length) return Result::OutputFull;
+        }
+    }
+
+    Result Dynamic() noexcept {
+        uint32_t literalCount = 0;
+        uint32_t distanceCount = 0;
+        uint32_t codeLengthCount = 0;
+        if (!Bits(5, literalCount) || !Bits(5, distanceCount) || !Bits(4, codeLengthCount)) return Result::Malformed;
+        literalCount += 257;
+        distanceCount += 1;
+        codeLengthCount += 4;
+        if (literalCount > 286 || distanceCount > MAX_DISTANCE_CODES) return Result::Malformed;
+
+        uint8_t lengths[MAX_LITERAL_CODES + MAX_DISTANCE_CODES] = {};
+        for (uint32_t i = 0; i < codeLengthCount; i++) {
+            uint32_t length = 0;
+            if (!Bits(3, length)) return Result::Malformed;
+            lengths[CODE_LENGTH_ORDER[i]] = static_cast<uint8_t>(length);
+        }
+        Huffman lengthCode;
+        if (BuildHuffman(lengthCode, lengths, CODE_LENGTH_CODES) != 0) return Result::Malformed;
+
+        // Literal/length and distance code lengths, run-length coded
+        const uint32_t total = literalCount + distanceCount;
+        for (uint32_t index = 0; index < total;) {
+            const int symbol = Decode(lengthCode);
+            if (symbol < 0) return Result::Malformed;
+            if (symbol < 16) {
+                lengths[index++] = static_cast<uint8_t>(symbol);
+                continue;
+            }
+            uint8_t length = 0;
+            uint32_t repeat = 0;
+            if (symbol == 16) {
+                if (index == 0) return Result::Malformed;  // Nothing to repeat
+                length = lengths[index - 1];
+                if (!Bits(2, repeat)) return Result::Malformed;
+                repeat += 3;
+            } else if (symbol == 17) {
+                if (!Bits(3, repeat)) return Result::Malformed;
+                repeat += 3;
+            } else {
+                if (!Bits(7, repeat)) return Result::Malformed;
+                repeat += 11;
+            }
+            if (index + repeat > total) return Result::Malformed;
+            while (repeat--) lengths[index++] = length;
+        }
+        if (lengths[256] == 0) return Result::Malformed;  // No end-of-block code
+
+        // Incomplete codes are only allowed for a single code of one bit
+        Huffman literal;
+        int err = BuildHuffman(literal, lengths, static_cast<int>(literalCount));
+        if (err < 0 || (err > 0 && literalCount - literal.count[0] != 1)) return Result::Malformed;
+        Huffman distance;
+        err = BuildHuffman(distance, lengths + literalCount, static_cast<int>(distanceCount));
+        if (err < 0 || (err > 0 && distanceCount - distance.count[0] != 1)) return Result::Malformed;
+
+        return Codes(literal, distance);
+    }
+
+    const uint8_t* src_;
+    size_t srcLength_;
+    size_t in_ = 0;
+    uint8_t* dst_;
+    size_t dstLength_;
+    size_t out_ = 0;
+    uint64_t bitBuffer_ = 0;
+    int bitCount_ = 0;
+};
+
+// Helper: Adler-32 of data (per RFC 1950)
+static uint32_t Adler32(const uint8_t* data, size_t length) noexcept {
+    uint32_t a = 1;
+    uint32_t b = 0;
+    while (length > 0) {
+        const size_t block = length < ADLER_BLOCK ? length : ADLER_BLOCK;
+        for (size_t i = 0; i < block; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= ADLER_MODULUS;
+        b %= ADLER_MODULUS;
+        data += block;
+        length -= block;
+    }
+    return (b << 16) | a;
+}
+
+Result Raw(const uint8_t* src, size_t srcLength, uint8_t* dst, size_t dstLength, size_t& produced) noexcept {
+    Decoder decoder(src, srcLength, dst, dstLength);
+    const Result result = decoder.Run();
+    produced = decoder.Produced();
+    return result;
+}
+
+Result Zlib(const uint8_t* src, size_t srcLength, uint8_t* dst, size_t dstLength, size_t& produced) noexcept {
+    produced = 0;
+    constexpr size_t HEADER_SIZE = 2;
+    constexpr size_t TRAILER_SIZE = 4;
+    if (!src || srcLength < HEADER_SIZE) return Result::Malformed;
+
+    // CMF/FLG: deflate method, window up to 32 KB, header check, no preset dictionary
+    const uint8_t cmf = src[0];
+    const uint8_t flg = src[1];
+    if ((cmf & 0x0F) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20) != 0) {
+        return Result::Malformed;
+    }
+
+    Decoder decoder(src + HEADER_SIZE, srcLength - HEADER_SIZE, dst, dstLength);
+    const Result result = decoder.Run();
+    produced = decoder.Produced();
+    if (result != Result::Complete) return result;
+
+    const size_t trailer = HEADER_SIZE + decoder.Consumed();
+    if (srcLength - trailer < TRAILER_SIZE) return Result::Malformed;
+    return ByteOrder::LoadBE<uint32_t>(src + trailer) == Adler32(dst, produced) ? Result::Complete : Result::Malformed;
+}
+
+} // namespace Inflate
@@ -0,0 +1,28 @@
+// this_file: src/inflate.h
+// DEFLATE decoder for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Bounded raw DEFLATE (RFC 1951) and zlib (RFC 1950) decompression into caller-owned buffers
+
+#ifndef INFLATE_H
+#define INFLATE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Inflate {
+    // Outcome of a bounded decode
+    enum class Result : uint8_t {
+        Complete,    // The stream ended (zlib: Adler-32 verified)
+        OutputFull,  // dst filled before the end of the stream; decoding stopped there
+        Malformed    // Invalid or truncated stream
+    };
+
+    // Decompress a raw DEFLATE stream into dst. The output buffer is also the history window,
+    // so memory never exceeds dstLength; produced receives the bytes written.
+    [[nodiscard]] Result Raw(const uint8_t* src, size_t srcLength, uint8_t* dst, size_t dstLength, size_t& produced) noexcept;
+
+    // Decompress a zlib-wrapped stream (as stored in WOFF tables) into dst
+    [[nodiscard]] Result Zlib(const uint8_t* src, size_t srcLength, uint8_t* dst, size_t dstLength, size_t& produced) noexcept;
+}
+
+#endif // INFLATE_H
@@ -0,0 +1,266 @@
+// this_file: src/journal.cpp
+// Write-ahead journal implementation
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+
+#include "journal.h"
+#include "byte_order.h"
+#include "checksum.h"
+#include <atomic>
+#include <filesystem>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Journal {
+
+// Record layout (big-endian): uint32 payload length, uint32 check (low half of the payload's
+// Checksum::Hash64), payload. Payloads start with a type byte.
+constexpr uint32_t JOURNAL_MAGIC = 0x464C4A31;       // "FLJ1"
+constexpr uint8_t RECORD_BATCH = 1;                  // magic, op, flags, item count, items (flags, two strings,
+                                                     // then size and write time if FLAG_EXISTED)
+constexpr uint8_t RECORD_DONE = 2;                   // item index
+constexpr uint8_t RECORD_STARTED = 3;                // item index, registry value name, then optionally an
+                                                     // entry count and entries (flags, value name, file)
+constexpr uint8_t FLAG_PER_USER = 0x01;
+constexpr uint8_t FLAG_EXISTED = 0x02;               // Item flag
+constexpr uint8_t FLAG_SYSTEM_ONLY = 0x02;           // Batch flag
+constexpr size_t RECORD_HEADER_SIZE = 8;
+constexpr uint32_t MAX_RECORD_SIZE = 256 * 1024 * 1024;
+
+template <typename T>
+static void Append(std::vector<uint8_t>& out, T value) {
+    uint8_t bytes[sizeof(T)];
+    ByteOrder::StoreBE(bytes, value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+static void AppendString(std::vector<uint8_t>& out, const std::string& text) {
+    Append(out, static_cast<uint32_t>(text.size()));
+    out.insert(out.end(), text.begin(), text.end());
+}
+
+// Helper: Frame a payload as a record
+static std::vector<uint8_t> MakeRecord(const std::vector<uint8_t>& payload) {
+    std::vector<uint8_t> record;
+    record.reserve(RECORD_HEADER_SIZE + payload.size());
+    Append(record, static_cast<uint32_t>(payload.size()));
+    Append(record, static_cast<uint32_t>(Checksum::Hash64(payload.data(), payload.size())));
+    record.insert(record.end(), payload.begin(), payload.end());
+    return record;
+}
+
+// Helper: Push written data through the OS cache to the disk
+static bool SyncToDisk(std::FILE* file) {
+    if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Helper: Temporary name next to the journal, unique per process and call, so two batches
+// started at once never write into the same file before one of them is refused
+static std::string TempPath(const std::string& journalPath) {
+    static std::atomic<uint32_t> counter{0};
+#ifdef _WIN32
+    const unsigned long pid = static_cast<unsigned long>(_getpid());
+#else
+    const unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+    char suffix[48];
+    std::snprintf(suffix, sizeof(suffix), ".%lu-%u.tmp", pid, static_cast<unsigned>(counter++));
+    return journalPath + suffix;
+}
+
+Writer::~Writer() {
+    if (file_) std::fclose(file_);
+}
+
+bool Writer::Begin(const std::string& journalPath, const Batch& batch) {
+    std::vector<uint8_t> payload;
+    payload.push_back(RECORD_BATCH);
+    Append(payload, JOURNAL_MAGIC);
+    payload.push_back(static_cast<uint8_t>(batch.op));
+    payload.push_back(batch.systemOnly ? FLAG_SYSTEM_ONLY : 0);
+    Append(payload, static_cast<uint32_t>(batch.items.size()));
+    for (const auto& item : batch.items) {
+        payload.push_back((item.perUser ? FLAG_PER_USER : 0) | (item.existed ? FLAG_EXISTED : 0));
+        AppendString(payload, item.first);
+        AppendString(payload, item.second);
+        if (item.existed) {
+            Append(payload, item.size);
+            Append(payload, item.modified);
+        }
+    }
+    const std::vector<uint8_t> record = MakeRecord(payload);
+
+    // A journal replaced in place could be lost halfway; the rename swaps in a complete one
+    const std::string tempPath = TempPath(journalPath);
+    std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) return false;
+    const bool written = std::fwrite(record.data(), 1, record.size(), file) == record.size() && SyncToDisk(file);
+    if (std::fclose(file) != 0 || !written) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, journalPath, ec);
+    if (ec) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_ = std::fopen(journalPath.c_str(), "ab");
+    path_ = journalPath;
+    return file_ != nullptr;
+}
+
+bool Writer::Reopen(const std::string& journalPath) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_) std::fclose(file_);
+    file_ = std::fopen(journalPath.c_str(), "ab");
+    path_ = journalPath;
+    return file_ != nullptr;
+}
+
+void Writer::AppendRecord(const std::vector<uint8_t>& payload) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) return;
+    const std::vector<uint8_t> record = MakeRecord(payload);
+    std::fwrite(record.data(), 1, record.size(), file_);
+    std::fflush(file_);  // Into the OS cache: survives the process being killed
+}
+
+void Writer::Started(size_t index, const std::string& valueName, const std::vector<RegistryEntry>& replaced) {
+    std::vector<uint8_t> payload;
+    payload.push_back(RECORD_STARTED);
+    Append(payload, static_cast<uint32_t>(index));
+    AppendString(payload, valueName);
+    if (!replaced.empty()) {
+        Append(payload, static_cast<uint32_t>(replaced.size()));
+        for (const auto& entry : replaced) {
+            payload.push_back(entry.perUser ? FLAG_PER_USER : 0);
+            AppendString(payload, entry.valueName);
+            AppendString(payload, entry.file);
+        }
+    }
+    AppendRecord(payload);
+}
+
+void Writer::Done(size_t index) {
+    std::vector<uint8_t> payload;
+    payload.push_back(RECORD_DONE);
+    Append(payload, static_cast<uint32_t>(index));
+    AppendRecord(payload);
+}
+
+void Writer::Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_) std::fclose(file_);
+    file_ = nullptr;
+}
+
+void Writer::Finish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) return;
+    std::fclose(file_);
+    file_ = nullptr;
+    std::remove(path_.c_str());
+}
+
+// Helper: Bounds-checked reader over one payload
+struct PayloadReader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+
+    template <typename T>
+    bool Read(T& value) {
+        if (size - pos < sizeof(T)) return false;
+        value = ByteOrder::LoadBE<T>(data + pos);
+        pos += sizeof(T);
+        return true;
+    }
+
+    bool ReadString(std::string& text) {
+        uint32_t length = 0;
+        if (!Read(length) || size - pos < length) return false;
+        text.assign(reinterpret_cast<const char*>(data + pos), length);
+        pos += length;
+        return true;
+    }
+};
+
+bool Read(const std::string& journalPath, Batch& batch) {
+    std::FILE* file = std::fopen(journalPath.c_str(), "rb");
+    if (!file) return false;
+    bool haveBatch = false;
+    std::vector<uint8_t> payload;
+    for (;;) {
+        uint8_t header[RECORD_HEADER_SIZE];
+        if (std::fread(header, 1, sizeof(header), file) != sizeof(header)) break;
+        const uint32_t length = ByteOrder::LoadBE<uint32_t>(header);
+        const uint32_t check = ByteOrder::LoadBE<uint32_t>(header + 4);
+        if (length == 0 || length > MAX_RECORD_SIZE) break;
+        payload.resize(length);
+        if (std::fread(payload.data(), 1, length, file) != length) break;
+        if (static_cast<uint32_t>(Checksum::Hash64(payload.data(), payload.size())) != check) break;  // Torn record
+
+        PayloadReader reader{payload.data(), payload.size()};
+        uint8_t type = 0;
+        reader.Read(type);
+        if (!haveBatch) {
+            uint32_t magic = 0, count = 0;
+            uint8_t op = 0, flags = 0;
+            if (type != RECORD_BATCH || !reader.Read(magic) || magic != JOURNAL_MAGIC || !reader.Read(op) ||
+                op < static_cast<uint8_t>(Operation::Install) || op > static_cast<uint8_t>(Operation::Remove) ||
+                !reader.Read(flags) || !reader.Read(count)) {
+                break;
+            }
+            batch = Batch();
+            batch.op = static_cast<Operation>(op);
+            batch.systemOnly = (flags & FLAG_SYSTEM_ONLY) != 0;
+            for (uint32_t i = 0; i < count; i++) {
+                Item item;
+                uint8_t itemFlags = 0;
+                if (!reader.Read(itemFlags) || !reader.ReadString(item.first) || !reader.ReadString(item.second)) break;
+                item.perUser = (itemFlags & FLAG_PER_USER) != 0;
+                item.existed = (itemFlags & FLAG_EXISTED) != 0;
+                if (item.existed && (!reader.Read(item.size) || !reader.Read(item.modified))) break;
+                batch.items.push_back(std::move(item));
+            }
+            if (batch.items.size() != count) break;
+            haveBatch = true;
+            continue;
+        }
+        uint32_t index = 0;
+        if ((type != RECORD_DONE && type != RECORD_STARTED) || !reader.Read(index) || index >= batch.items.size()) break;
+        Item& item = batch.items[index];
+        if (type == RECORD_DONE) {
+            item.done = true;
+            continue;
+        }
+        if (!reader.ReadString(item.valueName)) break;
+        item.started = true;
+        // Entries the item replaced; a start record without them ends after the value name
+        uint32_t count = 0;
+        if (reader.pos == reader.size || !reader.Read(count)) continue;
+        for (uint32_t i = 0; i < count; i++) {
+            RegistryEntry entry;
+            uint8_t entryFlags = 0;
+            if (!reader.Read(entryFlags) || !reader.ReadString(entry.valueName) || !reader.ReadString(entry.file)) break;
+            entry.perUser = (entryFlags & FLAG_PER_USER) != 0;
+            item.replaced.push_back(std::move(entry));
+        }
+    }
+    std::fclose(file);
+    return haveBatch;
+}
+
+} // namespace Journal
@@ -0,0 +1,99 @@
+// this_file: src/journal.h
+// Write-ahead journal for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Intent and completion records of a batch install or removal, so an interrupted batch can be resumed
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Journal {
+    enum class Operation : uint8_t {
+        Install = 1,     // Items: source file, destination in the fonts folder
+        Uninstall = 2,   // Items: registry value name, font file (kept)
+        Remove = 3       // Items: registry value name, font file (deleted)
+    };
+
+    // A registry entry an install item replaced
+    struct RegistryEntry {
+        std::string valueName;
+        std::string file;      // As registered: a file name in the fonts directory, or an absolute path
+        bool perUser = false;
+    };
+
+    struct Item {
+        std::string first;
+        std::string second;
+        bool perUser = false;  // Scope of the registry entry
+        // Install: the destination existed before the batch, with this size and last write time
+        // (file clock ticks); rollback never deletes it
+        bool existed = false;
+        uint64_t size = 0;
+        int64_t modified = 0;
+        bool started = false;  // A start record was found: the item may have changed something
+        std::string valueName{};  // Install: registry value name, from the start record
+        std::vector<RegistryEntry> replaced{};  // Install: earlier entries unregistered, from start records
+        bool done = false;     // A completion record was found
+    };
+
+    struct Batch {
+        Operation op = Operation::Install;
+        bool systemOnly = false;   // Install --admin: per-user entries were left alone
+        std::vector<Item> items;
+    };
+
+    // The journal holds one batch: a header record with every item's intent, written to a
+    // temporary file, flushed to disk and renamed into place before the batch changes anything,
+    // then, for installs, a start record before an item touches anything, and a completion record
+    // once it finished. Start and completion records are flushed to the OS, which keeps them if
+    // the process is killed, but not synced to disk one by one. After a power loss some may be
+    // missing: a lost start record leaves that item's changes in place on rollback, and a lost
+    // completion record makes resume redo the item or rollback undo it. Records carry a length
+    // and a hash, so a record torn by a crash ends the journal. Safe to use from several threads.
+    class Writer {
+    public:
+        Writer() = default;
+        ~Writer();
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        // Durably record the batch's intent; false if the journal cannot be written
+        bool Begin(const std::string& journalPath, const Batch& batch);
+
+        // Continue an existing journal (resume), appending completion records to it
+        bool Reopen(const std::string& journalPath);
+
+        // Record that an install item is about to copy and register (under valueName), or, with
+        // replaced, that it is about to unregister those earlier entries
+        void Started(size_t index, const std::string& valueName, const std::vector<RegistryEntry>& replaced = {});
+
+        // Record that an item finished (applied, or failed and undone)
+        void Done(size_t index);
+
+        // The batch is over: delete the journal
+        void Finish();
+
+        // Stop writing but keep the journal (another writer takes it over)
+        void Close();
+
+        [[nodiscard]] bool IsOpen() const noexcept { return file_ != nullptr; }
+
+    private:
+        void AppendRecord(const std::vector<uint8_t>& payload);
+
+        std::mutex mutex_;              // Start and completion records come from different stages
+        std::FILE* file_ = nullptr;
+        std::string path_;
+    };
+
+    // Read a journal; false if there is none or its header record is damaged
+    bool Read(const std::string& journalPath, Batch& batch);
+}
+
+#endif // JOURNAL_H
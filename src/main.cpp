@@ -6,10 +6,15 @@
 
 #include "exit_codes.h"
 #include "font_ops.h"
+#include "scheduler.h"
 #include "sys_utils.h"
 #include <windows.h>
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <string>
 #include <vector>
 
 #pragma comment(lib, "version.lib")
@@ -18,6 +23,9 @@ void ShowUsage(const char* programName) {
     std::cout << "fontlift-win - Windows Font Management CLI\n\n";
     std::cout << "Usage:\n";
     std::cout << "  " << programName << " <command> [options]\n\n";
+    std::cout << "Global options:\n";
+    std::cout << "  --jobs, -j <n>       Worker threads for every command (default: FONTLIFT_JOBS,\n";
+    std::cout << "                       else one per CPU; file I/O uses twice as many)\n\n";
     std::cout << "Commands:\n";
     std::cout << "  list, l              List installed fonts\n";
     std::cout << "    -p                 Show paths (default, sorted)\n";
@@ -25,22 +33,59 @@ void ShowUsage(const char* programName) {
     std::cout << "    -n -p              Show both (path::name format, sorted)\n";
     std::cout << "                       Path-only output removes duplicate paths\n";
     std::cout << "    -s                 (Optional) Kept for compatibility; output is always sorted\n\n";
-    std::cout << "  install, i <path>    Install font from filepath\n";
-    std::cout << "    -p <filepath>      Specify font file path\n";
-    std::cout << "    --admin, -a        Force system-level installation (requires admin)\n\n";
+    std::cout << "  install, i <paths>   Install fonts from files, directories or wildcards (*.otf)\n";
+    std::cout << "                       .zip archives: their font entries are installed without extracting\n";
+    std::cout << "                       Parse, copy and register overlap; one font change notification\n";
+    std::cout << "    -p <filepath>      Specify font file path (may be repeated)\n";
+    std::cout << "    --admin, -a        Force system-level installation (requires admin)\n";
+    std::cout << "    --store <dir>      Install into a content store (default: FONTLIFT_STORE); identical\n";
+    std::cout << "                       contents are neither copied nor registered again\n";
+    std::cout << "    --copy <method>    auto (default: clone, then a hard link for store objects (per user),\n";
+    std::cout << "                       then system copy, then buffered), clone, hardlink (per user),\n";
+    std::cout << "                       system or buffered\n";
+    std::cout << "    --in-place         Register the files where they are, for the current user, without copying\n\n";
     std::cout << "  uninstall, u         Uninstall font (keep file)\n";
     std::cout << "    -p <filepath>      Uninstall by path\n";
-    std::cout << "    -n <fontname>      Uninstall by internal name\n";
-    std::cout << "    --admin, -a        Include system-level uninstallation (requires admin)\n\n";
+    std::cout << "    -n <names...>      Uninstall by internal name; wildcards (\"Foo*\") allowed\n";
+    std::cout << "    --from-file <f>    Read names from a file, one per line (\"-\" reads stdin)\n";
+    std::cout << "    --regex, -r        Treat names as regular expressions\n";
+    std::cout << "    --admin, -a        Include system-level uninstallation (requires admin)\n";
+    std::cout << "    --system           Let wildcards and regular expressions match system fonts\n";
+    std::cout << "    --dry-run          List the matching entries without changing anything\n\n";
     std::cout << "  remove, rm           Uninstall font (delete file)\n";
     std::cout << "    -p <filepath>      Remove by path\n";
-    std::cout << "    -n <fontname>      Remove by internal name\n";
-    std::cout << "    --admin, -a        Include system-level removal (requires admin)\n\n";
+    std::cout << "    -n <names...>      Remove by internal name; wildcards (\"Foo*\") allowed\n";
+    std::cout << "    --from-file <f>    Read names from a file, one per line (\"-\" reads stdin)\n";
+    std::cout << "    --regex, -r        Treat names as regular expressions\n";
+    std::cout << "    --admin, -a        Include system-level removal (requires admin)\n";
+    std::cout << "    --system           Let wildcards and regular expressions match system fonts\n";
+    std::cout << "    --dry-run          List the matching entries without changing anything\n\n";
+    std::cout << "  sync <manifest>      Install, upgrade and uninstall fonts to match a JSON manifest\n";
+    std::cout << "    --dry-run          Print the plan without changing anything\n\n";
+    std::cout << "  resume               Finish an install/uninstall/remove batch that was interrupted\n";
+    std::cout << "    --rollback         Undo its unfinished items instead\n\n";
     std::cout << "  cleanup, c           Cleanup registry entries and font caches\n";
     std::cout << "    --admin, -a        Include system-wide cleanup (requires admin)\n";
     std::cout << "                      - Removes registry entries pointing to missing files\n";
     std::cout << "                      - Clears user and third-party font caches\n";
     std::cout << "                      - With --admin: clears system font caches\n\n";
+    std::cout << "  info <path>          Show metadata of every face in a font file (\"-\" reads stdin)\n";
+    std::cout << "    --io               Also show bytes read and read calls\n";
+    std::cout << "    --planned          Force planned reads (default for network paths)\n\n";
+    std::cout << "  verify <paths...>    Check table bounds, overlaps and checksums\n";
+    std::cout << "                       Paths may be font files or directories\n";
+    std::cout << "    --quiet, -q        Print failures only\n\n";
+    std::cout << "  scan <dirs...>       Print one tab-separated record per face of every font under dirs\n";
+    std::cout << "                       Recursive; files are recognized by signature, not extension\n";
+    std::cout << "    --no-cache         Parse every font instead of using the metadata cache\n\n";
+    std::cout << "  dupes [paths...]     List groups of identical font files (default: installed fonts)\n";
+    std::cout << "                       Paths may be font files or directories (recursive)\n";
+    std::cout << "    --installed        Also include installed fonts when paths are given\n\n";
+    std::cout << "  coverage <cps...>    List installed fonts that map every given codepoint\n";
+    std::cout << "                       Codepoints: U+0041, 0041, or ranges such as U+4E00-9FFF\n";
+    std::cout << "    --text, -t <text>  Also require every character of the text\n";
+    std::cout << "    --any              List fonts covering at least one codepoint, best first\n";
+    std::cout << "    --rebuild          Reread every font instead of reusing the coverage index\n\n";
     std::cout << "made by FontLab https://www.fontlab.com/\n";
 }
 
@@ -90,60 +135,112 @@ static int HandleListCommand(int argc, char* argv[]) {
 }
 
 static int HandleInstallCommand(int argc, char* argv[], const char* progName) {
-    const char* filepath = nullptr;
-    bool forceAdmin = false;
+    std::vector<std::string> paths;
+    FontOps::InstallOptions options;
 
     // Parse flags
     for (int i = 2; i < argc; i++) {
         if (strcmp(argv[i], "--admin") == 0 || strcmp(argv[i], "-a") == 0) {
-            forceAdmin = true;
+            options.forceAdmin = true;
+        } else if (strcmp(argv[i], "--store") == 0 && i + 1 < argc) {
+            options.storeDir = argv[++i];
+        } else if (strcmp(argv[i], "--copy") == 0 && i + 1 < argc) {
+            if (!SysUtils::ParseCopyMethod(argv[++i], options.copyMethod)) {
+                std::cerr << "Error: Unknown copy method: " << argv[i] << " (use auto, clone, hardlink, system or buffered)\n";
+                return EXIT_ERROR;
+            }
+        } else if (strcmp(argv[i], "--in-place") == 0) {
+            options.inPlace = true;
         } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
-            filepath = argv[i + 1];
+            paths.push_back(argv[i + 1]);
             i++; // Skip the next argument as it's the filepath
         } else if (argv[i][0] != '-') {
-            filepath = argv[i];
+            paths.push_back(argv[i]);
         }
     }
 
-    if (!filepath || filepath[0] == '\0') {
+    paths.erase(std::remove_if(paths.begin(), paths.end(), [](const std::string& p) { return p.empty(); }), paths.end());
+    if (paths.empty()) {
         std::cerr << "Error: No font file specified\n";
         ShowUsage(progName);
         return EXIT_ERROR;
     }
-    return FontOps::InstallFont(filepath, forceAdmin);
+    return FontOps::InstallFonts(paths, options);
+}
+
+// Helper: Append the names listed in a UTF-8 file, one per line ("-" reads stdin); blank lines
+// and lines starting with '#' are skipped, and so is a byte order mark
+static bool ReadNameList(const char* listPath, std::vector<std::string>& names) {
+    std::ifstream file;
+    if (strcmp(listPath, "-") != 0) {
+        file.open(listPath);
+        if (!file) {
+            std::cerr << "Error: Cannot open name list: " << listPath << "\n";
+            return false;
+        }
+    }
+    std::istream& in = file.is_open() ? static_cast<std::istream&>(file) : std::cin;
+    std::string line;
+    bool firstLine = true;
+    while (std::getline(in, line)) {
+        if (firstLine && line.compare(0, 3, "\xEF\xBB\xBF") == 0) line.erase(0, 3);
+        firstLine = false;
+        const size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+        const size_t last = line.find_last_not_of(" \t\r");
+        names.push_back(line.substr(first, last - first + 1));
+    }
+    return true;
 }
 
 static int HandleUninstallOrRemove(int argc, char* argv[], const char* progName, bool deleteFile) {
     const char* filepath = nullptr;
-    const char* fontname = nullptr;
+    std::vector<std::string> fontnames;
     bool forceAdmin = false;
+    bool useRegex = false;
+    bool includeSystem = false;
+    bool dryRun = false;
 
     // Parse flags
     for (int i = 2; i < argc; i++) {
         if (strcmp(argv[i], "--admin") == 0 || strcmp(argv[i], "-a") == 0) {
             forceAdmin = true;
+        } else if (strcmp(argv[i], "--regex") == 0 || strcmp(argv[i], "-r") == 0) {
+            useRegex = true;
+        } else if (strcmp(argv[i], "--system") == 0) {
+            includeSystem = true;
+        } else if (strcmp(argv[i], "--dry-run") == 0) {
+            dryRun = true;
         } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
             filepath = argv[i + 1];
             i++; // Skip the next argument
         } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
-            fontname = argv[i + 1];
+            if (argv[i + 1][0] != '\0') fontnames.push_back(SysUtils::AnsiToUtf8(argv[i + 1]));
+            i++; // Skip the next argument
+        } else if (strcmp(argv[i], "--from-file") == 0 && i + 1 < argc) {
+            if (!ReadNameList(argv[i + 1], fontnames)) return EXIT_ERROR;
             i++; // Skip the next argument
+        } else if (argv[i][0] != '-' && !fontnames.empty()) {
+            fontnames.push_back(SysUtils::AnsiToUtf8(argv[i]));  // Further names after -n
         }
     }
 
     // Validate arguments are non-empty
     if (filepath && filepath[0] == '\0') filepath = nullptr;
-    if (fontname && fontname[0] == '\0') fontname = nullptr;
 
-    if (!filepath && !fontname) {
-        std::cerr << "Error: Must specify -p <path> or -n <name>\n";
+    if (!filepath && fontnames.empty()) {
+        std::cerr << "Error: Must specify -p <path>, -n <name> or --from-file <file>\n";
         ShowUsage(progName);
         return EXIT_ERROR;
     }
+    if (filepath && (dryRun || includeSystem)) {
+        std::cerr << "Error: --dry-run and --system apply to names (-n, --from-file), not to -p\n";
+        return EXIT_ERROR;
+    }
     if (filepath) {
         return deleteFile ? FontOps::RemoveFontByPath(filepath, forceAdmin) : FontOps::UninstallFontByPath(filepath, forceAdmin);
     } else {
-        return deleteFile ? FontOps::RemoveFontByName(fontname, forceAdmin) : FontOps::UninstallFontByName(fontname, forceAdmin);
+        return FontOps::RemoveFontsByName(fontnames, deleteFile, forceAdmin, useRegex, includeSystem, dryRun);
     }
 }
 
@@ -171,7 +268,182 @@ static int HandleCleanupCommand(int argc, char* argv[]) {
     return result;
 }
 
+static int HandleInfoCommand(int argc, char* argv[], const char* progName) {
+    const char* filepath = nullptr;
+    bool showIo = false, planned = false;
+
+    // Parse flags
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--io") == 0) {
+            showIo = true;
+        } else if (strcmp(argv[i], "--planned") == 0) {
+            planned = true;
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            filepath = argv[i + 1];
+            i++; // Skip the next argument as it's the filepath
+        } else if (argv[i][0] != '-' || strcmp(argv[i], "-") == 0) {
+            filepath = argv[i];  // "-" reads the font from standard input
+        }
+    }
+
+    if (!filepath || filepath[0] == '\0') {
+        std::cerr << "Error: No font file specified\n";
+        ShowUsage(progName);
+        return EXIT_ERROR;
+    }
+    return FontOps::ShowFontInfo(filepath, showIo, planned);
+}
+
+static int HandleSyncCommand(int argc, char* argv[], const char* progName) {
+    const char* manifestPath = nullptr;
+    bool dryRun = false;
+
+    // Parse flags
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--dry-run") == 0) {
+            dryRun = true;
+        } else if (argv[i][0] != '-') {
+            manifestPath = argv[i];
+        }
+    }
+
+    if (!manifestPath || manifestPath[0] == '\0') {
+        std::cerr << "Error: No manifest specified\n";
+        ShowUsage(progName);
+        return EXIT_ERROR;
+    }
+    return FontOps::SyncFonts(manifestPath, dryRun);
+}
+
+static int HandleResumeCommand(int argc, char* argv[]) {
+    bool rollback = false;
+
+    // Parse flags
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--rollback") == 0) {
+            rollback = true;
+        }
+    }
+    return FontOps::ResumeBatch(rollback);
+}
+
+static int HandleVerifyCommand(int argc, char* argv[], const char* progName) {
+    std::vector<std::string> paths;
+    bool quiet = false;
+
+    // Parse flags
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--quiet") == 0 || strcmp(argv[i], "-q") == 0) {
+            quiet = true;
+        } else if (argv[i][0] != '-') {
+            paths.push_back(argv[i]);
+        } else {
+            std::cerr << "Warning: Unknown option for verify command: " << argv[i] << "\n";
+        }
+    }
+
+    if (paths.empty()) {
+        std::cerr << "Error: No font files specified\n";
+        ShowUsage(progName);
+        return EXIT_ERROR;
+    }
+    return FontOps::VerifyFonts(paths, quiet);
+}
+
+static int HandleDupesCommand(int argc, char* argv[]) {
+    std::vector<std::string> paths;
+    bool includeInstalled = false;
+
+    // Parse flags
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--installed") == 0) {
+            includeInstalled = true;
+        } else if (argv[i][0] != '-') {
+            paths.push_back(argv[i]);
+        } else {
+            std::cerr << "Warning: Unknown option for dupes command: " << argv[i] << "\n";
+        }
+    }
+    return FontOps::FindDuplicates(paths, includeInstalled || paths.empty());
+}
+
+static int HandleScanCommand(int argc, char* argv[], const char* progName) {
+    std::vector<std::string> paths;
+    bool useCache = true;
+
+    // Parse flags
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--no-cache") == 0) {
+            useCache = false;
+        } else if (argv[i][0] != '-') {
+            paths.push_back(argv[i]);
+        } else {
+            std::cerr << "Warning: Unknown option for scan command: " << argv[i] << "\n";
+        }
+    }
+
+    if (paths.empty()) {
+        std::cerr << "Error: No directory specified\n";
+        ShowUsage(progName);
+        return EXIT_ERROR;
+    }
+    return FontOps::ScanFonts(paths, useCache);
+}
+
+static int HandleCoverageCommand(int argc, char* argv[], const char* progName) {
+    std::vector<std::string> codepoints;
+    std::string text;
+    bool any = false, rebuild = false;
+
+    // Parse flags
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--any") == 0) {
+            any = true;
+        } else if (strcmp(argv[i], "--rebuild") == 0) {
+            rebuild = true;
+        } else if ((strcmp(argv[i], "--text") == 0 || strcmp(argv[i], "-t") == 0) && i + 1 < argc) {
+            text += argv[i + 1];
+            i++; // Skip the next argument as it's the text
+        } else if (argv[i][0] != '-') {
+            codepoints.push_back(argv[i]);
+        } else {
+            std::cerr << "Warning: Unknown option for coverage command: " << argv[i] << "\n";
+        }
+    }
+
+    if (codepoints.empty() && text.empty()) {
+        std::cerr << "Error: No codepoints specified\n";
+        ShowUsage(progName);
+        return EXIT_ERROR;
+    }
+    return FontOps::ShowCoverage(codepoints, text, any, rebuild);
+}
+
+// Helper: Apply and drop the global --jobs/-j option, wherever it appears, so the command
+// handlers never see it. Returns false if its value is missing.
+static bool TakeJobsOption(int& argc, char* argv[]) {
+    int kept = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--jobs") == 0 || strcmp(argv[i], "-j") == 0) {
+            unsigned jobs = 0;
+            if (i + 1 >= argc || !Scheduler::ParseJobs(argv[i + 1], jobs)) return false;
+            Scheduler::SetDefaultJobs(jobs);
+            i++; // Skip the next argument as it's the job count
+            continue;
+        }
+        argv[kept++] = argv[i];
+    }
+    argc = kept;
+    argv[argc] = nullptr;
+    return true;
+}
+
 int main(int argc, char* argv[]) {
+    if (!TakeJobsOption(argc, argv)) {
+        std::cerr << "Error: --jobs requires a number of threads from 1 to " << Scheduler::MAX_JOBS << "\n";
+        ShowUsage(argv[0]);
+        return EXIT_ERROR;
+    }
     if (argc < 2) {
         ShowUsage(argv[0]);
         return EXIT_ERROR;
@@ -200,10 +472,38 @@ int main(int argc, char* argv[]) {
         return HandleUninstallOrRemove(argc, argv, argv[0], true);
     }
 
+    if (strcmp(command, "sync") == 0) {
+        return HandleSyncCommand(argc, argv, argv[0]);
+    }
+
+    if (strcmp(command, "resume") == 0) {
+        return HandleResumeCommand(argc, argv);
+    }
+
     if (strcmp(command, "cleanup") == 0 || strcmp(command, "c") == 0) {
         return HandleCleanupCommand(argc, argv);
     }
 
+    if (strcmp(command, "info") == 0) {
+        return HandleInfoCommand(argc, argv, argv[0]);
+    }
+
+    if (strcmp(command, "verify") == 0) {
+        return HandleVerifyCommand(argc, argv, argv[0]);
+    }
+
+    if (strcmp(command, "scan") == 0) {
+        return HandleScanCommand(argc, argv, argv[0]);
+    }
+
+    if (strcmp(command, "dupes") == 0) {
+        return HandleDupesCommand(argc, argv);
+    }
+
+    if (strcmp(command, "coverage") == 0) {
+        return HandleCoverageCommand(argc, argv, argv[0]);
+    }
+
     std::cerr << "Error: Unknown command '" << command << "'\n";
     ShowUsage(argv[0]);
     return EXIT_ERROR;
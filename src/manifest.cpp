@@ -0,0 +1,363 @@
+// this_file: src/manifest.cpp
+// Font manifest reader implementation
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+
+#include "manifest.h"
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace Manifest {
+
+constexpr size_t MAX_MANIFEST_SIZE = 16 * 1024 * 1024;  // Far more than any font list needs
+constexpr unsigned MAX_NESTING = 64;
+
+// Parsed JSON value; numbers are kept as their text since a manifest has none to interpret
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+    Type type = Type::Null;
+    bool boolean = false;
+    std::string text;                                     // String contents or number text
+    std::vector<JsonValue> items;                         // Array elements
+    std::vector<std::pair<std::string, JsonValue>> members;  // Object members in file order
+
+    [[nodiscard]] const JsonValue* Find(const char* name) const {
+        for (const auto& member : members) {
+            if (member.first == name) return &member.second;
+        }
+        return nullptr;
+    }
+};
+
+// Recursive-descent reader for RFC 8259 JSON
+class JsonReader {
+public:
+    explicit JsonReader(const std::string& input) : input_(input) {}
+
+    bool ReadDocument(JsonValue& value) {
+        SkipSpace();
+        if (!ReadValue(value, 0)) return false;
+        SkipSpace();
+        if (pos_ != input_.size()) return Fail("unexpected text after the top-level value");
+        return true;
+    }
+
+    [[nodiscard]] const std::string& Error() const noexcept { return error_; }
+
+private:
+    bool Fail(const char* message) {
+        if (error_.empty()) error_ = std::string(message) + " at line " + std::to_string(Line());
+        return false;
+    }
+
+    [[nodiscard]] size_t Line() const noexcept {
+        size_t line = 1;
+        for (size_t i = 0; i < pos_ && i < input_.size(); i++) {
+            if (input_[i] == '\n') line++;
+        }
+        return line;
+    }
+
+    void SkipSpace() noexcept {
+        while (pos_ < input_.size() && (input_[pos_] == ' ' || input_[pos_] == '\t' || input_[pos_] == '\n' || input_[pos_] == '\r')) pos_++;
+    }
+
+    bool Consume(const char* literal) {
+        const size_t length = std::char_traits<char>::length(literal);
+        if (input_.compare(pos_, length, literal) != 0) return false;
+        pos_ += length;
+        return true;
+    }
+
+    bool ReadValue(JsonValue& value, unsigned depth) {
+        if (depth > MAX_NESTING) return Fail("nesting too deep");
+        if (pos_ >= input_.size()) return Fail("unexpected end of file");
+        const char c = input_[pos_];
+        if (c == '{') return ReadObject(value, depth);
+        if (c == '[') return ReadArray(value, depth);
+        if (c == '"') {
+            value.type = JsonValue::Type::String;
+            return ReadString(value.text);
+        }
+        if (Consume("true")) {
+            value.type = JsonValue::Type::Bool;
+            value.boolean = true;
+            return true;
+        }
+        if (Consume("false")) {
+            value.type = JsonValue::Type::Bool;
+            return true;
+        }
+        if (Consume("null")) {
+            value.type = JsonValue::Type::Null;
+            return true;
+        }
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            const size_t start = pos_;
+            while (pos_ < input_.size() && std::string("+-.eE0123456789").find(input_[pos_]) != std::string::npos) pos_++;
+            value.type = JsonValue::Type::Number;
+            value.text = input_.substr(start, pos_ - start);
+            return true;
+        }
+        return Fail("unexpected character");
+    }
+
+    bool ReadObject(JsonValue& value, unsigned depth) {
+        value.type = JsonValue::Type::Object;
+        pos_++;  // '{'
+        SkipSpace();
+        if (pos_ < input_.size() && input_[pos_] == '}') {
+            pos_++;
+            return true;
+        }
+        for (;;) {
+            SkipSpace();
+            if (pos_ >= input_.size() || input_[pos_] != '"') return Fail("expected a member name");
+            std::pair<std::string, JsonValue> member;
+            if (!ReadString(member.first)) return false;
+            SkipSpace();
+            if (pos_ >= input_.size() || input_[pos_] != ':') return Fail("expected ':'");
+            pos_++;
+            SkipSpace();
+            if (!ReadValue(member.second, depth + 1)) return false;
+            value.members.push_back(std::move(member));
+            SkipSpace();
+            if (pos_ < input_.size() && input_[pos_] == ',') {
+                pos_++;
+                continue;
+            }
+            if (pos_ < input_.size() && input_[pos_] == '}') {
+                pos_++;
+                return true;
+            }
+            return Fail("expected ',' or '}'");
+        }
+    }
+
+    bool ReadArray(JsonValue& value, unsigned depth) {
+        value.type = JsonValue::Type::Array;
+        pos_++;  // '['
+        SkipSpace();
+        if (pos_ < input_.size() && input_[pos_] == ']') {
+            pos_++;
+            return true;
+        }
+        for (;;) {
+            SkipSpace();
+            value.items.emplace_back();
+            if (!ReadValue(value.items.back(), depth + 1)) return false;
+            SkipSpace();
+            if (pos_ < input_.size() && input_[pos_] == ',') {
+                pos_++;
+                continue;
+            }
+            if (pos_ < input_.size() && input_[pos_] == ']') {
+                pos_++;
+                return true;
+            }
+            return Fail("expected ',' or ']'");
+        }
+    }
+
+    // Helper: Four hex digits of a \u escape
+    bool ReadHex4(uint32_t& unit) {
+        if (pos_ + 4 > input_.size()) return Fail("truncated \\u escape");
+        unit = 0;
+        for (int i = 0; i < 4; i++) {
+            const char h = input_[pos_++];
+            unit <<= 4;
+            if (h >= '0' && h <= '9') unit |= static_cast<uint32_t>(h - '0');
+            else if (h >= 'a' && h <= 'f') unit |= static_cast<uint32_t>(h - 'a' + 10);
+            else if (h >= 'A' && h <= 'F') unit |= static_cast<uint32_t>(h - 'A' + 10);
+            else return Fail("invalid \\u escape");
+        }
+        return true;
+    }
+
+    static void AppendUtf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool ReadString(std::string& out) {
+        pos_++;  // Opening quote
+        out.clear();
+        while (pos_ < input_.size()) {
+            const char c = input_[pos_++];
+            if (c == '"') return true;
+            if (static_cast<unsigned char>(c) < 0x20) return Fail("control character in string");
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= input_.size()) break;
+            const char e = input_[pos_++];
+            switch (e) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    uint32_t cp = 0;
+                    if (!ReadHex4(cp)) return false;
+                    if (cp >= 0xD800 && cp <= 0xDBFF) {
+                        uint32_t low = 0;
+                        if (!Consume("\\u") || !ReadHex4(low) || low < 0xDC00 || low > 0xDFFF) {
+                            return Fail("unpaired surrogate in \\u escape");
+                        }
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                        return Fail("unpaired surrogate in \\u escape");
+                    }
+                    AppendUtf8(out, cp);
+                    break;
+                }
+                default:
+                    return Fail("invalid escape in string");
+            }
+        }
+        return Fail("unterminated string");
+    }
+
+    const std::string& input_;
+    size_t pos_ = 0;
+    std::string error_;
+};
+
+// Helper: UTF-8 manifest text in the ANSI code page the file APIs are called with; false if a
+// character has no equivalent there
+static bool ToAnsi(const std::string& utf8, std::string& ansi) {
+#ifdef _WIN32
+    if (utf8.empty()) {
+        ansi.clear();
+        return true;
+    }
+    const int utf8Length = static_cast<int>(utf8.size());
+    const int wideLength = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, utf8.data(), utf8Length, NULL, 0);
+    if (wideLength <= 0) return false;
+    std::wstring wide(static_cast<size_t>(wideLength), L'\0');
+    MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, utf8.data(), utf8Length, &wide[0], wideLength);
+    BOOL usedDefault = FALSE;
+    const int length = WideCharToMultiByte(CP_ACP, WC_NO_BEST_FIT_CHARS, wide.data(), wideLength, NULL, 0, NULL, &usedDefault);
+    if (length <= 0 || usedDefault) return false;
+    ansi.resize(static_cast<size_t>(length));
+    WideCharToMultiByte(CP_ACP, WC_NO_BEST_FIT_CHARS, wide.data(), wideLength, &ansi[0], length, NULL, NULL);
+    return true;
+#else
+    ansi = utf8;
+    return true;
+#endif
+}
+
+// Helper: A path from the manifest, relative paths taken from the manifest's directory
+static std::string ResolveManifestPath(const std::string& path, const std::string& baseDir) {
+    const bool isAbsolute = (!path.empty() && (path[0] == '\\' || path[0] == '/')) || (path.size() > 1 && path[1] == ':');
+    if (isAbsolute || baseDir.empty()) return path;
+    return baseDir + "\\" + path;
+}
+
+// Helper: Strings of a "manage" or "fonts" array. Paths (fonts) may also be {"path": "..."}
+// objects and are converted to the ANSI code page; names (manage) stay UTF-8.
+static bool ReadStringList(const JsonValue& list, const char* member, bool paths, std::vector<std::string>& out,
+                           std::string& error) {
+    if (list.type != JsonValue::Type::Array) {
+        error = std::string("\"") + member + "\" must be an array";
+        return false;
+    }
+    for (const auto& item : list.items) {
+        const JsonValue* text = &item;
+        if (paths && item.type == JsonValue::Type::Object) text = item.Find("path");
+        if (!text || text->type != JsonValue::Type::String || text->text.empty()) {
+            error = std::string("\"") + member + "\" entries must be non-empty strings" +
+                    (paths ? " or {\"path\": \"...\"} objects" : "");
+            return false;
+        }
+        if (!paths) {
+            out.push_back(text->text);
+            continue;
+        }
+        std::string ansi;
+        if (!ToAnsi(text->text, ansi)) {
+            error = std::string("\"") + member + "\" entry cannot be represented in the system code page: " + text->text;
+            return false;
+        }
+        out.push_back(std::move(ansi));
+    }
+    return true;
+}
+
+bool Load(const char* manifestPath, FontManifest& manifest, std::string& error) {
+    std::ifstream file(manifestPath, std::ios::binary);
+    if (!file) {
+        error = "cannot open the manifest";
+        return false;
+    }
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (text.size() > MAX_MANIFEST_SIZE) {
+        error = "manifest is too large";
+        return false;
+    }
+    if (text.compare(0, 3, "\xEF\xBB\xBF") == 0) text.erase(0, 3);  // UTF-8 byte order mark
+
+    JsonValue root;
+    JsonReader reader(text);
+    if (!reader.ReadDocument(root)) {
+        error = reader.Error();
+        return false;
+    }
+    if (root.type != JsonValue::Type::Object) {
+        error = "manifest must be a JSON object";
+        return false;
+    }
+
+    manifest = FontManifest();
+    if (const JsonValue* scope = root.Find("scope")) {
+        if (scope->type == JsonValue::Type::String && scope->text == "user") manifest.scope = Scope::User;
+        else if (scope->type == JsonValue::Type::String && scope->text == "system") manifest.scope = Scope::System;
+        else if (scope->type == JsonValue::Type::String && scope->text == "auto") manifest.scope = Scope::Auto;
+        else {
+            error = "\"scope\" must be \"user\", \"system\" or \"auto\"";
+            return false;
+        }
+    }
+
+    const JsonValue* fonts = root.Find("fonts");
+    if (!fonts) {
+        error = "manifest has no \"fonts\" array";
+        return false;
+    }
+    if (!ReadStringList(*fonts, "fonts", true, manifest.fonts, error)) return false;
+    if (const JsonValue* manage = root.Find("manage")) {
+        if (!ReadStringList(*manage, "manage", false, manifest.manage, error)) return false;
+    }
+
+    const std::string path(manifestPath);
+    const size_t slash = path.find_last_of("\\/");
+    const std::string baseDir = slash == std::string::npos ? std::string() : path.substr(0, slash);
+    for (auto& font : manifest.fonts) font = ResolveManifestPath(font, baseDir);
+    return true;
+}
+
+} // namespace Manifest
@@ -0,0 +1,40 @@
+// this_file: src/manifest.h
+// Font manifest for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// JSON description of the fonts a machine should have, read by the sync command
+
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include <string>
+#include <vector>
+
+namespace Manifest {
+    // Registry scope a manifest is applied to
+    enum class Scope {
+        Auto,      // System with admin rights, else the current user (as install does)
+        User,
+        System
+    };
+
+    // A manifest is a JSON object:
+    //   {
+    //     "scope": "user",                          optional: "user", "system" or "auto"
+    //     "fonts": ["Fonts\\Acme-Regular.otf",      files, directories or wildcards; relative
+    //               {"path": "D:\\Shared\\*.ttf"}],  paths are relative to the manifest
+    //     "manage": ["Acme *"]                      optional: registry names sync may uninstall
+    //   }
+    // Without "manage", sync installs and upgrades but never uninstalls anything.
+    struct FontManifest {
+        Scope scope = Scope::Auto;
+        std::vector<std::string> fonts;     // Resolved paths, patterns kept as written
+        std::vector<std::string> manage;    // Wildcard patterns over registry names (UTF-8)
+    };
+
+    // Read and validate a manifest file (UTF-8; paths are converted to the ANSI code page the
+    // file APIs use, while "manage" patterns stay UTF-8 like registry names). error describes
+    // the first problem and where it is.
+    bool Load(const char* manifestPath, FontManifest& manifest, std::string& error);
+}
+
+#endif // MANIFEST_H
@@ -0,0 +1,435 @@
+// this_file: src/metadata_cache.cpp
+// Persistent font metadata cache implementation
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+
+#include "metadata_cache.h"
+#include "byte_order.h"
+#include "checksum.h"
+#include "opentype.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace MetadataCache {
+
+using FontIO::ByteSpan;
+using FontParser::FontMetadata;
+using OpenType::Field;
+
+// Cache file layout (big-endian, like the coverage index): header, entry records sorted by
+// path, face records, then the string pool the records point into
+constexpr uint32_t CACHE_MAGIC = ByteOrder::MakeTag("FLMD");
+constexpr uint16_t CACHE_VERSION = 1;
+namespace CacheHeader {
+    using Magic = Field<uint32_t, 0>;
+    using Version = Field<uint16_t, 4>;
+    using EntryCount = Field<uint32_t, 8>;
+    using FaceCount = Field<uint32_t, 12>;
+    using StringsSize = Field<uint32_t, 16>;
+    constexpr size_t SIZE = 24;
+}
+namespace EntryRecord {
+    using PathOffset = Field<uint32_t, 0>;
+    using PathLength = Field<uint32_t, 4>;
+    using FileSize = Field<uint64_t, 8>;
+    using Modified = Field<uint64_t, 16>;
+    using ContentHash = Field<uint64_t, 24>;
+    using FirstFace = Field<uint32_t, 32>;
+    using FaceCount = Field<uint32_t, 36>;
+    constexpr size_t SIZE = 40;
+}
+namespace FaceRecord {
+    constexpr size_t STRINGS = 0;              // Six (offset, length) uint32 pairs, in NAME_FIELDS order
+    constexpr size_t STRING_REF_SIZE = 8;
+    using FontRevision = Field<uint32_t, 48>;
+    using CollectionIndex = Field<uint32_t, 52>;
+    using WeightClass = Field<uint16_t, 56>;
+    using WidthClass = Field<uint16_t, 58>;
+    using FsType = Field<uint16_t, 60>;
+    using Format = Field<uint8_t, 62>;
+    using Flags = Field<uint8_t, 63>;          // Bits 0-3: container; bit 7: collection face
+    constexpr uint8_t FLAG_COLLECTION = 0x80;
+    constexpr uint8_t CONTAINER_MASK = 0x0F;
+    constexpr size_t SIZE = 64;
+}
+
+// Name fields of a face, in face record order
+static std::string FontMetadata::* const NAME_FIELDS[] = {
+    &FontMetadata::familyName, &FontMetadata::subfamilyName, &FontMetadata::fullName,
+    &FontMetadata::postScriptName, &FontMetadata::typographicFamily, &FontMetadata::typographicSubfamily
+};
+constexpr size_t NAME_FIELD_COUNT = sizeof(NAME_FIELDS) / sizeof(NAME_FIELDS[0]);
+
+std::string NormalizePath(const char* path) {
+    std::string full;
+#ifdef _WIN32
+    char buffer[MAX_PATH];
+    const DWORD length = GetFullPathNameA(path, MAX_PATH, buffer, NULL);
+    if (length > 0 && length < MAX_PATH) full.assign(buffer, length);
+    else full = path;  // Too long to resolve: keyed as given
+#else
+    std::error_code ec;
+    const std::filesystem::path absolute = std::filesystem::absolute(path, ec);
+    full = ec ? std::string(path) : absolute.lexically_normal().string();
+#endif
+    for (auto& c : full) {
+        if (c == '/') c = '\\';
+        else if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+    }
+    return full;
+}
+
+bool StatFile(const char* path, FileKey& key) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const uint64_t size = fs::file_size(path, ec);
+    if (ec) return false;
+    const auto modified = fs::last_write_time(path, ec);
+    if (ec) return false;
+    key.path = NormalizePath(path);
+    key.size = size;
+    key.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+    key.contentHash = 0;
+    return true;
+}
+
+// Helper: Same file contents; a hash only decides when both keys carry one
+static bool SameContents(const FileKey& a, uint64_t size, int64_t modified, uint64_t contentHash) noexcept {
+    if (a.size != size || a.modified != modified) return false;
+    return a.contentHash == 0 || contentHash == 0 || a.contentHash == contentHash;
+}
+
+// Helper: String from the pool; false if the reference lies outside it
+static bool ReadString(ByteSpan strings, uint32_t offset, uint32_t length, std::string& out) {
+    const ByteSpan bytes = strings.Subspan(offset, length);
+    if (bytes.size() != length) return false;
+    out.assign(reinterpret_cast<const char*>(bytes.data()), length);
+    return true;
+}
+
+bool Cache::Open(const char* cachePath) {
+    path_ = cachePath;
+    file_.Close();
+    entries_ = faces_ = strings_ = ByteSpan();
+    entryCount_ = faceCount_ = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.clear();
+    }
+    if (!file_.Open(cachePath)) return true;  // No cache yet
+
+    const ByteSpan data = file_.Bytes();
+    if (data.size() < CacheHeader::SIZE || CacheHeader::Magic::Get(data) != CACHE_MAGIC ||
+        CacheHeader::Version::Get(data) != CACHE_VERSION) {
+        file_.Close();
+        return false;
+    }
+    // Regions must tile the file exactly (64-bit sums cannot overflow from 32-bit counts)
+    const uint64_t entryBytes = uint64_t{CacheHeader::EntryCount::Get(data)} * EntryRecord::SIZE;
+    const uint64_t faceBytes = uint64_t{CacheHeader::FaceCount::Get(data)} * FaceRecord::SIZE;
+    const uint64_t stringBytes = CacheHeader::StringsSize::Get(data);
+    if (CacheHeader::SIZE + entryBytes + faceBytes + stringBytes != data.size()) {
+        file_.Close();
+        return false;
+    }
+    entries_ = data.Subspan(CacheHeader::SIZE, static_cast<size_t>(entryBytes));
+    faces_ = data.Subspan(CacheHeader::SIZE + static_cast<size_t>(entryBytes), static_cast<size_t>(faceBytes));
+    strings_ = data.Subspan(CacheHeader::SIZE + static_cast<size_t>(entryBytes + faceBytes), static_cast<size_t>(stringBytes));
+    entryCount_ = CacheHeader::EntryCount::Get(data);
+    faceCount_ = CacheHeader::FaceCount::Get(data);
+    return true;
+}
+
+// Helper: Binary search of the mapped entries by path bytes
+bool Cache::FindMapped(const std::string& path, size_t& index) const {
+    size_t low = 0, high = entryCount_;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const ByteSpan record = entries_.Subspan(mid * EntryRecord::SIZE, EntryRecord::SIZE);
+        const uint32_t length = EntryRecord::PathLength::Get(record);
+        const ByteSpan name = strings_.Subspan(EntryRecord::PathOffset::Get(record), length);
+        if (name.size() != length) return false;  // Damaged record
+        const int order = std::memcmp(name.data(), path.data(), std::min<size_t>(length, path.size()));
+        if (order == 0 && length == path.size()) {
+            index = mid;
+            return true;
+        }
+        if (order < 0 || (order == 0 && length < path.size())) low = mid + 1;
+        else high = mid;
+    }
+    return false;
+}
+
+// Helper: Faces of a mapped entry; false if any record or string lies outside the file
+bool Cache::DecodeMapped(size_t index, std::vector<FontMetadata>& faces) const {
+    const ByteSpan record = entries_.Subspan(index * EntryRecord::SIZE, EntryRecord::SIZE);
+    const uint32_t first = EntryRecord::FirstFace::Get(record);
+    const uint32_t count = EntryRecord::FaceCount::Get(record);
+    if (first > faceCount_ || count > faceCount_ - first) return false;
+
+    faces.assign(count, FontMetadata{});
+    for (uint32_t i = 0; i < count; i++) {
+        const ByteSpan face = faces_.Subspan((size_t{first} + i) * FaceRecord::SIZE, FaceRecord::SIZE);
+        FontMetadata& meta = faces[i];
+        for (size_t f = 0; f < NAME_FIELD_COUNT; f++) {
+            const size_t ref = FaceRecord::STRINGS + f * FaceRecord::STRING_REF_SIZE;
+            uint32_t offset = 0, length = 0;
+            if (!face.Read(ref, offset) || !face.Read(ref + 4, length) || !ReadString(strings_, offset, length, meta.*NAME_FIELDS[f])) {
+                faces.clear();
+                return false;
+            }
+        }
+        meta.fontRevision = FaceRecord::FontRevision::Get(face);
+        meta.collectionIndex = FaceRecord::CollectionIndex::Get(face);
+        meta.weightClass = FaceRecord::WeightClass::Get(face);
+        meta.widthClass = FaceRecord::WidthClass::Get(face);
+        meta.fsType = FaceRecord::FsType::Get(face);
+        meta.format = static_cast<FontParser::FontFormat>(FaceRecord::Format::Get(face));
+        const uint8_t flags = FaceRecord::Flags::Get(face);
+        meta.container = static_cast<FontParser::FontContainer>(flags & FaceRecord::CONTAINER_MASK);
+        meta.isCollection = (flags & FaceRecord::FLAG_COLLECTION) != 0;
+    }
+    return true;
+}
+
+bool Cache::Lookup(const FileKey& key, std::vector<FontMetadata>& faces, uint64_t* contentHash) const {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto pending = pending_.find(key.path);
+        if (pending != pending_.end()) {
+            const Pending& entry = pending->second;
+            if (entry.removed || !SameContents(key, entry.key.size, entry.key.modified, entry.key.contentHash)) return false;
+            faces = entry.faces;
+            if (contentHash) *contentHash = entry.key.contentHash;
+            return true;
+        }
+    }
+
+    // The mapping is only replaced by Save(), so it is read without the lock
+    size_t index = 0;
+    if (!FindMapped(key.path, index)) return false;
+    const ByteSpan record = entries_.Subspan(index * EntryRecord::SIZE, EntryRecord::SIZE);
+    if (!SameContents(key, EntryRecord::FileSize::Get(record), static_cast<int64_t>(EntryRecord::Modified::Get(record)),
+                      EntryRecord::ContentHash::Get(record))) {
+        return false;
+    }
+    if (contentHash) *contentHash = EntryRecord::ContentHash::Get(record);
+    return DecodeMapped(index, faces);
+}
+
+void Cache::Store(const FileKey& key, const std::vector<FontMetadata>& faces) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Pending& entry = pending_[key.path];
+    entry.key = key;
+    entry.faces = faces;
+    entry.removed = false;
+}
+
+void Cache::Remove(const char* fontPath) {
+    const std::string path = NormalizePath(fontPath);
+    size_t index = 0;
+    const bool mapped = FindMapped(path, index);
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto pending = pending_.find(path);
+    if (pending != pending_.end()) {
+        pending->second.removed = true;
+        pending->second.faces.clear();
+    } else if (mapped) {
+        Pending& entry = pending_[path];
+        entry.key.path = path;
+        entry.removed = true;
+    }
+}
+
+bool Cache::IsDirty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !pending_.empty();
+}
+
+// Helper: Append a big-endian integer to a byte buffer
+template <typename T>
+static void Append(std::vector<uint8_t>& out, T value) {
+    const size_t at = out.size();
+    out.resize(at + sizeof(T));
+    ByteOrder::StoreBE(out.data() + at, value);
+}
+
+// Builds the string pool; repeated strings (family names shared by faces) are stored once
+class StringPool {
+public:
+    // Offset of s in the pool; false once the pool would pass 4 GB
+    bool Add(const std::string& s, uint32_t& offset) {
+        const auto known = offsets_.find(s);
+        if (known != offsets_.end()) {
+            offset = known->second;
+            return true;
+        }
+        if (bytes_.size() + s.size() > UINT32_MAX) return false;
+        offset = static_cast<uint32_t>(bytes_.size());
+        bytes_.insert(bytes_.end(), s.begin(), s.end());
+        offsets_.emplace(s, offset);
+        return true;
+    }
+    [[nodiscard]] const std::vector<uint8_t>& Bytes() const noexcept { return bytes_; }
+
+private:
+    std::vector<uint8_t> bytes_;
+    std::unordered_map<std::string, uint32_t> offsets_;
+};
+
+// Helper: Temporary name next to the cache file, unique per process and call, so processes
+// saving at the same time never interleave their writes in one file
+static std::string TempPath(const std::string& path) {
+    static std::atomic<uint32_t> counter{0};
+#ifdef _WIN32
+    const unsigned long pid = static_cast<unsigned long>(GetCurrentProcessId());
+#else
+    const unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+    char suffix[48];
+    std::snprintf(suffix, sizeof(suffix), ".%lu-%u.tmp", pid, static_cast<unsigned>(counter++));
+    return path + suffix;
+}
+
+bool Cache::Save() {
+    if (path_.empty()) return false;
+
+    // Merge the mapped entries with the pending changes (pending wins), in path order
+    std::map<std::string, Pending> merged;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        merged = pending_;
+    }
+    for (size_t i = 0; i < entryCount_; i++) {
+        const ByteSpan record = entries_.Subspan(i * EntryRecord::SIZE, EntryRecord::SIZE);
+        Pending entry;
+        if (!ReadString(strings_, EntryRecord::PathOffset::Get(record), EntryRecord::PathLength::Get(record), entry.key.path)) continue;
+        if (merged.count(entry.key.path) != 0 || !DecodeMapped(i, entry.faces)) continue;  // Replaced, removed, or damaged
+        entry.key.size = EntryRecord::FileSize::Get(record);
+        entry.key.modified = static_cast<int64_t>(EntryRecord::Modified::Get(record));
+        entry.key.contentHash = EntryRecord::ContentHash::Get(record);
+        const std::string path = entry.key.path;
+        merged.emplace(path, std::move(entry));
+    }
+
+    std::vector<uint8_t> entries, faces;
+    StringPool strings;
+    uint32_t entryCount = 0, faceCount = 0;
+    for (const auto& item : merged) {
+        const Pending& entry = item.second;
+        if (entry.removed) continue;
+        uint32_t pathOffset = 0;
+        if (!strings.Add(entry.key.path, pathOffset)) return false;
+        Append(entries, pathOffset);
+        Append(entries, static_cast<uint32_t>(entry.key.path.size()));
+        Append(entries, entry.key.size);
+        Append(entries, static_cast<uint64_t>(entry.key.modified));
+        Append(entries, entry.key.contentHash);
+        Append(entries, faceCount);
+        Append(entries, static_cast<uint32_t>(entry.faces.size()));
+        entryCount++;
+
+        for (const FontMetadata& meta : entry.faces) {
+            for (size_t f = 0; f < NAME_FIELD_COUNT; f++) {
+                const std::string& value = meta.*NAME_FIELDS[f];
+                uint32_t offset = 0;
+                if (!strings.Add(value, offset)) return false;
+                Append(faces, offset);
+                Append(faces, static_cast<uint32_t>(value.size()));
+            }
+            Append(faces, meta.fontRevision);
+            Append(faces, meta.collectionIndex);
+            Append(faces, meta.weightClass);
+            Append(faces, meta.widthClass);
+            Append(faces, meta.fsType);
+            Append(faces, static_cast<uint8_t>(meta.format));
+            Append(faces, static_cast<uint8_t>(static_cast<uint8_t>(meta.container) |
+                                               (meta.isCollection ? FaceRecord::FLAG_COLLECTION : 0)));
+            faceCount++;
+        }
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(CacheHeader::SIZE + entries.size() + faces.size() + strings.Bytes().size());
+    Append(out, CACHE_MAGIC);
+    Append(out, CACHE_VERSION);
+    Append(out, static_cast<uint16_t>(0));  // Reserved
+    Append(out, entryCount);
+    Append(out, faceCount);
+    Append(out, static_cast<uint32_t>(strings.Bytes().size()));
+    Append(out, static_cast<uint32_t>(0));  // Reserved
+    out.insert(out.end(), entries.begin(), entries.end());
+    out.insert(out.end(), faces.begin(), faces.end());
+    out.insert(out.end(), strings.Bytes().begin(), strings.Bytes().end());
+
+    const std::string tempPath = TempPath(path_);
+    std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) return false;
+    const bool written = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    if (std::fclose(file) != 0 || !written) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    // A mapped file cannot be replaced on Windows: release the mapping before the rename
+    file_.Close();
+    entries_ = faces_ = strings_ = ByteSpan();
+    entryCount_ = faceCount_ = 0;
+    const std::string path = path_;  // Open() reassigns path_
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::remove(tempPath.c_str());
+        Open(path.c_str());  // Keep serving the old file
+        return false;
+    }
+    return Open(path.c_str());
+}
+
+std::vector<FontMetadata> GetFontMetadata(Cache& cache, const char* fontPath, bool* hit) {
+    if (hit) *hit = false;
+    std::vector<FontMetadata> faces;
+    FileKey key;
+    if (!StatFile(fontPath, key)) return FontParser::GetFontMetadata(fontPath);  // Stdin, or a parse error to report
+    if (cache.Lookup(key, faces)) {
+        if (hit) *hit = true;
+        return faces;
+    }
+    faces = FontParser::GetFontMetadata(fontPath);
+    if (!faces.empty()) cache.Store(key, faces);
+    return faces;
+}
+
+bool GetContentHash(Cache& cache, const char* fontPath, uint64_t& hash) {
+    FileKey key;
+    if (!StatFile(fontPath, key)) return false;
+    std::vector<FontMetadata> faces;
+    uint64_t stored = 0;
+    const bool cached = cache.Lookup(key, faces, &stored);
+    if (cached && stored != 0) {
+        hash = stored;
+        return true;
+    }
+    FontIO::MappedFile file(fontPath);
+    if (!file.IsOpen()) return false;
+    const FontIO::ByteSpan bytes = file.Bytes();
+    hash = Checksum::Hash64(bytes.data(), bytes.size());
+    if (!cached) faces = FontParser::GetFontMetadata(fontPath);
+    if (!faces.empty()) {
+        key.contentHash = hash;
+        cache.Store(key, faces);
+    }
+    return true;
+}
+
+} // namespace MetadataCache
@@ -0,0 +1,99 @@
+// this_file: src/metadata_cache.h
+// Persistent font metadata cache for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Memory-mapped binary cache of parsed FontMetadata keyed by normalized path, size, and write time
+
+#ifndef METADATA_CACHE_H
+#define METADATA_CACHE_H
+
+#include "font_io.h"
+#include "font_parser.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace MetadataCache {
+    // Identity of a file's contents as far as the cache is concerned
+    struct FileKey {
+        std::string path;          // NormalizePath() form
+        uint64_t size = 0;
+        int64_t modified = 0;      // Last write time in file clock ticks
+        uint64_t contentHash = 0;  // 0 = not known; when both sides know it, it must match too
+    };
+
+    // Absolute path with forward slashes turned into backslashes and ASCII letters lowercased
+    // (Windows paths are case-insensitive), so one file has one key however it was named
+    [[nodiscard]] std::string NormalizePath(const char* path);
+
+    // Key of a file from its size and write time (no read); false if it does not exist
+    bool StatFile(const char* path, FileKey& key);
+
+    // The cache file is mapped read-only and looked up in place: a binary search over
+    // fixed-size entry records sorted by path, decoding only the faces of the entry found.
+    // Stores and removals collect in memory until Save() writes a new file and renames it
+    // over the old one. Lookup() and Store() may be called from several threads.
+    class Cache {
+    public:
+        Cache() = default;
+        Cache(const Cache&) = delete;
+        Cache& operator=(const Cache&) = delete;
+
+        // Map the cache file. A missing file is an empty cache; a damaged file or one written
+        // by another cache version is ignored (returns false) and replaced by the next Save().
+        bool Open(const char* cachePath);
+
+        // Faces recorded for the file, if its entry matches key (size, write time, and hash)
+        // contentHash (optional): the hash recorded with the entry (0 if none was)
+        [[nodiscard]] bool Lookup(const FileKey& key, std::vector<FontParser::FontMetadata>& faces,
+                                  uint64_t* contentHash = nullptr) const;
+
+        // Record (or replace) the faces of a file
+        void Store(const FileKey& key, const std::vector<FontParser::FontMetadata>& faces);
+
+        // Drop the entry of a file (any form of its path)
+        void Remove(const char* fontPath);
+
+        // True if Store() or Remove() changed something since Open()
+        [[nodiscard]] bool IsDirty() const;
+
+        // Write mapped and pending entries to a temporary file and rename it over the cache,
+        // then map the new file. Returns false if the cache was not opened or cannot be written.
+        bool Save();
+
+    private:
+        struct Pending {
+            FileKey key;
+            std::vector<FontParser::FontMetadata> faces;
+            bool removed = false;
+        };
+
+        [[nodiscard]] bool FindMapped(const std::string& path, size_t& index) const;
+        [[nodiscard]] bool DecodeMapped(size_t index, std::vector<FontParser::FontMetadata>& faces) const;
+
+        std::string path_;
+        FontIO::MappedFile file_;
+        FontIO::ByteSpan entries_;   // Entry records, sorted by path bytes
+        FontIO::ByteSpan faces_;     // Face records
+        FontIO::ByteSpan strings_;   // Paths and names, referenced by offset and length
+        size_t entryCount_ = 0;
+        size_t faceCount_ = 0;
+        mutable std::mutex mutex_;   // Guards pending_
+        std::map<std::string, Pending> pending_;  // By normalized path
+    };
+
+    // Metadata of a font file through the cache: a current entry is returned without opening
+    // the file; otherwise the file is parsed and, if it yields faces, stored.
+    // hit (optional) tells which of the two happened.
+    [[nodiscard]] std::vector<FontParser::FontMetadata> GetFontMetadata(Cache& cache, const char* fontPath,
+                                                                        bool* hit = nullptr);
+
+    // Checksum::Hash64 of a font file through the cache: a current entry that recorded a hash
+    // answers without reading the file; otherwise the file is hashed and the hash is stored
+    // with its faces. Returns false if the file cannot be read.
+    bool GetContentHash(Cache& cache, const char* fontPath, uint64_t& hash);
+}
+
+#endif // METADATA_CACHE_H
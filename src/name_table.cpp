@@ -0,0 +1,265 @@
+// this_file: src/name_table.cpp
+// OpenType name table kernels implementation
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+
+#include "name_table.h"
+#include "byte_order.h"
+#include "simd.h"
+#include <cstring>
+
+namespace NameTable {
+// Name-record scanning and name string transcoding shared by the font parser
+
+// Name record layout constants (per OpenType spec)
+constexpr size_t NAME_RECORD_SIZE = 12;              // Size of name table record (bytes)
+constexpr size_t NAME_NAME_ID_OFFSET = 6;            // nameID field offset
+constexpr size_t RECORDS_PER_BLOCK = 8;              // Records tested per vector block (96 bytes)
+
+// Unicode constants
+constexpr uint32_t REPLACEMENT_CHARACTER = 0xFFFD;   // Substitute for unpaired surrogates
+constexpr size_t MAX_UTF8_PER_UTF16_UNIT = 3;        // Worst-case UTF-8 bytes per UTF-16 code unit
+constexpr size_t MAX_UTF8_PER_MAC_BYTE = 3;          // Worst-case UTF-8 bytes per Mac Roman byte
+
+// Mac OS Roman code points for bytes 0x80-0xFF (bytes below 0x80 are ASCII)
+constexpr uint16_t MAC_ROMAN_HIGH[128] = {
+    0x00C4, 0x00C5, 0x00C7, 0x00C9, 0x00D1, 0x00D6, 0x00DC, 0x00E1, 0x00E0, 0x00E2, 0x00E4, 0x00E3, 0x00E5, 0x00E7, 0x00E9, 0x00E8,
+    0x00EA, 0x00EB, 0x00ED, 0x00EC, 0x00EE, 0x00EF, 0x00F1, 0x00F3, 0x00F2, 0x00F4, 0x00F6, 0x00F5, 0x00FA, 0x00F9, 0x00FB, 0x00FC,
+    0x2020, 0x00B0, 0x00A2, 0x00A3, 0x00A7, 0x2022, 0x00B6, 0x00DF, 0x00AE, 0x00A9, 0x2122, 0x00B4, 0x00A8, 0x2260, 0x00C6, 0x00D8,
+    0x221E, 0x00B1, 0x2264, 0x2265, 0x00A5, 0x00B5, 0x2202, 0x2211, 0x220F, 0x03C0, 0x222B, 0x00AA, 0x00BA, 0x03A9, 0x00E6, 0x00F8,
+    0x00BF, 0x00A1, 0x00AC, 0x221A, 0x0192, 0x2248, 0x2206, 0x00AB, 0x00BB, 0x2026, 0x00A0, 0x00C0, 0x00C3, 0x00D5, 0x0152, 0x0153,
+    0x2013, 0x2014, 0x201C, 0x201D, 0x2018, 0x2019, 0x00F7, 0x25CA, 0x00FF, 0x0178, 0x2044, 0x20AC, 0x2039, 0x203A, 0xFB01, 0xFB02,
+    0x2021, 0x00B7, 0x201A, 0x201E, 0x2030, 0x00C2, 0x00CA, 0x00C1, 0x00CB, 0x00C8, 0x00CD, 0x00CE, 0x00CF, 0x00CC, 0x00D3, 0x00D4,
+    0xF8FF, 0x00D2, 0x00DA, 0x00DB, 0x00D9, 0x0131, 0x02C6, 0x02DC, 0x00AF, 0x02D8, 0x02D9, 0x02DA, 0x00B8, 0x02DD, 0x02DB, 0x02C7,
+};
+
+// Helper: Append one code point as UTF-8; returns bytes written
+static inline size_t EncodeUtf8(uint32_t cp, char* dst) noexcept {
+    if (cp < 0x80) {
+        dst[0] = static_cast<char>(cp);
+        return 1;
+    }
+    if (cp < 0x800) {
+        dst[0] = static_cast<char>(0xC0 | (cp >> 6));
+        dst[1] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        dst[0] = static_cast<char>(0xE0 | (cp >> 12));
+        dst[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        dst[2] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    dst[0] = static_cast<char>(0xF0 | (cp >> 18));
+    dst[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    dst[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    dst[3] = static_cast<char>(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+// Name-record candidate masks: bit r is set when record r of an 8-record block has a
+// nameID below 32. Records are 12 bytes, so the nameID of record r is the big-endian
+// 16-bit lane 6r+3 of the 96-byte block. Loaded little-endian, a big-endian value below 32
+// has (lane & 0xE0FF) == 0 (high byte zero, low byte < 32).
+#if defined(FONTLIFT_SIMD_AVX2)
+
+static inline uint32_t CandidateMask8(const uint8_t* block) noexcept {
+    const __m256i keep = _mm256_set1_epi16(static_cast<short>(0xE0FF));
+    const __m256i zero = _mm256_setzero_si256();
+    uint32_t lanes[3];
+    for (int j = 0; j < 3; j++) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32 * j));
+        lanes[j] = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(v, keep), zero)));
+    }
+    uint32_t mask = 0;
+    for (uint32_t r = 0; r < RECORDS_PER_BLOCK; r++) {
+        const uint32_t lane = 6 * r + 3;
+        mask |= ((lanes[lane >> 4] >> (2 * (lane & 15))) & 1u) << r;
+    }
+    return mask;
+}
+
+#elif defined(FONTLIFT_SIMD_SSE2)
+
+static inline uint32_t CandidateMask8(const uint8_t* block) noexcept {
+    const __m128i keep = _mm_set1_epi16(static_cast<short>(0xE0FF));
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t lanes[6];
+    for (int j = 0; j < 6; j++) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * j));
+        lanes[j] = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, keep), zero)));
+    }
+    uint32_t mask = 0;
+    for (uint32_t r = 0; r < RECORDS_PER_BLOCK; r++) {
+        const uint32_t lane = 6 * r + 3;
+        mask |= ((lanes[lane >> 3] >> (2 * (lane & 7))) & 1u) << r;
+    }
+    return mask;
+}
+
+#elif defined(FONTLIFT_SIMD_NEON)
+
+static inline uint32_t CandidateMask8(const uint8_t* block) noexcept {
+    const uint16x8_t keep = vdupq_n_u16(0xE0FF);
+    uint16x8_t hit[6];
+    for (int j = 0; j < 6; j++) {
+        const uint16x8_t v = vreinterpretq_u16_u8(vld1q_u8(block + 16 * j));
+        hit[j] = vceqq_u16(vandq_u16(v, keep), vdupq_n_u16(0));
+    }
+    // Lanes 3, 9, 15, 21, 27, 33, 39, 45 hold the nameIDs of records 0..7
+    return (vgetq_lane_u16(hit[0], 3) & 1u) | ((vgetq_lane_u16(hit[1], 1) & 1u) << 1) |
+           ((vgetq_lane_u16(hit[1], 7) & 1u) << 2) | ((vgetq_lane_u16(hit[2], 5) & 1u) << 3) |
+           ((vgetq_lane_u16(hit[3], 3) & 1u) << 4) | ((vgetq_lane_u16(hit[4], 1) & 1u) << 5) |
+           ((vgetq_lane_u16(hit[4], 7) & 1u) << 6) | ((vgetq_lane_u16(hit[5], 5) & 1u) << 7);
+}
+
+#endif
+
+size_t FindRecords(const uint8_t* records, size_t count, uint32_t nameIdMask, uint16_t* outIndices) noexcept {
+    size_t matches = 0;
+    size_t i = 0;
+#if defined(FONTLIFT_SIMD_AVX2) || defined(FONTLIFT_SIMD_SSE2) || defined(FONTLIFT_SIMD_NEON)
+    for (; i + RECORDS_PER_BLOCK <= count; i += RECORDS_PER_BLOCK) {
+        const uint32_t candidates = CandidateMask8(records + i * NAME_RECORD_SIZE);
+        if (candidates == 0) continue;
+        for (uint32_t r = 0; r < RECORDS_PER_BLOCK; r++) {
+            if (!((candidates >> r) & 1u)) continue;
+            const uint16_t nameID = ByteOrder::LoadBE<uint16_t>(records + (i + r) * NAME_RECORD_SIZE + NAME_NAME_ID_OFFSET);
+            if ((nameIdMask >> nameID) & 1u) outIndices[matches++] = static_cast<uint16_t>(i + r);
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        const uint16_t nameID = ByteOrder::LoadBE<uint16_t>(records + i * NAME_RECORD_SIZE + NAME_NAME_ID_OFFSET);
+        if (nameID < 32 && ((nameIdMask >> nameID) & 1u)) outIndices[matches++] = static_cast<uint16_t>(i);
+    }
+    return matches;
+}
+
+// Helper: Copy a run of ASCII UTF-16BE code units starting at unit i as bytes.
+// Stops at the first vector containing a non-ASCII unit; returns the new unit index.
+static inline size_t CopyAsciiUnits(const uint8_t* data, size_t units, size_t i, char*& dst) noexcept {
+#if defined(FONTLIFT_SIMD_AVX2)
+    const __m256i keep256 = _mm256_set1_epi16(static_cast<short>(0x80FF));
+    for (; i + 16 <= units; i += 16) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 2 * i));
+        const __m256i ascii = _mm256_cmpeq_epi16(_mm256_and_si256(v, keep256), _mm256_setzero_si256());
+        if (static_cast<uint32_t>(_mm256_movemask_epi8(ascii)) != 0xFFFFFFFFu) break;
+        const __m256i packed = _mm256_packus_epi16(_mm256_srli_epi16(v, 8), _mm256_setzero_si256());
+        const __m256i ordered = _mm256_permute4x64_epi64(packed, 0x08);  // Gather qwords 0 and 2
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm256_castsi256_si128(ordered));
+        dst += 16;
+    }
+#endif
+#if defined(FONTLIFT_SIMD_AVX2) || defined(FONTLIFT_SIMD_SSE2)
+    const __m128i keep = _mm_set1_epi16(static_cast<short>(0x80FF));
+    for (; i + 8 <= units; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 2 * i));
+        const __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(v, keep), _mm_setzero_si128());
+        if (_mm_movemask_epi8(ascii) != 0xFFFF) break;
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(_mm_srli_epi16(v, 8), _mm_setzero_si128()));
+        dst += 8;
+    }
+#elif defined(FONTLIFT_SIMD_NEON)
+    for (; i + 8 <= units; i += 8) {
+        const uint8x8x2_t v = vld2_u8(data + 2 * i);  // val[0] = high bytes, val[1] = low bytes
+        const uint8x8_t nonAscii = vorr_u8(v.val[0], vand_u8(v.val[1], vdup_n_u8(0x80)));
+        if (vget_lane_u64(vreinterpret_u64_u8(nonAscii), 0) != 0) break;
+        vst1_u8(reinterpret_cast<uint8_t*>(dst), v.val[1]);
+        dst += 8;
+    }
+#endif
+    for (; i < units; i++) {
+        const uint16_t cu = ByteOrder::LoadBE<uint16_t>(data + 2 * i);
+        if (cu >= 0x80) break;
+        *dst++ = static_cast<char>(cu);
+    }
+    return i;
+}
+
+std::string Utf16BEToUtf8(const uint8_t* data, size_t length) {
+    std::string result;
+    const size_t units = length / 2;
+    if (!data || units == 0) return result;
+
+    result.resize(units * MAX_UTF8_PER_UTF16_UNIT);
+    char* const begin = &result[0];
+    char* dst = begin;
+
+    size_t i = 0;
+    while (i < units) {
+        i = CopyAsciiUnits(data, units, i, dst);
+
+        // Decode a short non-ASCII stretch before retrying the fast path
+        const size_t stop = (units - i < 8) ? units : i + 8;
+        while (i < stop) {
+            const uint16_t cu = ByteOrder::LoadBE<uint16_t>(data + 2 * i++);
+            uint32_t cp = cu;
+            if (cu >= 0xD800 && cu <= 0xDBFF) {
+                const uint16_t next = (i < units) ? ByteOrder::LoadBE<uint16_t>(data + 2 * i) : 0;
+                if (next >= 0xDC00 && next <= 0xDFFF) {
+                    cp = 0x10000 + ((static_cast<uint32_t>(cu) - 0xD800) << 10) + (next - 0xDC00);
+                    i++;
+                } else {
+                    cp = REPLACEMENT_CHARACTER;
+                }
+            } else if (cu >= 0xDC00 && cu <= 0xDFFF) {
+                cp = REPLACEMENT_CHARACTER;
+            }
+            dst += EncodeUtf8(cp, dst);
+        }
+    }
+
+    result.resize(static_cast<size_t>(dst - begin));
+    return result;
+}
+
+// Helper: Length of the leading 7-bit ASCII run
+static inline size_t AsciiPrefixLength(const uint8_t* data, size_t length) noexcept {
+    size_t i = 0;
+#if defined(FONTLIFT_SIMD_AVX2)
+    for (; i + 32 <= length; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        if (_mm256_movemask_epi8(v) != 0) break;
+    }
+#endif
+#if defined(FONTLIFT_SIMD_AVX2) || defined(FONTLIFT_SIMD_SSE2)
+    for (; i + 16 <= length; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        if (_mm_movemask_epi8(v) != 0) break;
+    }
+#elif defined(FONTLIFT_SIMD_NEON)
+    for (; i + 16 <= length; i += 16) {
+        const uint8x16_t high = vandq_u8(vld1q_u8(data + i), vdupq_n_u8(0x80));
+        const uint8x8_t folded = vorr_u8(vget_low_u8(high), vget_high_u8(high));
+        if (vget_lane_u64(vreinterpret_u64_u8(folded), 0) != 0) break;
+    }
+#endif
+    while (i < length && data[i] < 0x80) i++;
+    return i;
+}
+
+bool IsAscii(const uint8_t* data, size_t length) noexcept {
+    return !data || AsciiPrefixLength(data, length) == length;
+}
+
+std::string MacRomanToUtf8(const uint8_t* data, size_t length) {
+    std::string result;
+    if (!data || length == 0) return result;
+
+    const size_t prefix = AsciiPrefixLength(data, length);
+    if (prefix == length) return std::string(reinterpret_cast<const char*>(data), length);
+
+    result.resize(prefix + (length - prefix) * MAX_UTF8_PER_MAC_BYTE);
+    char* const begin = &result[0];
+    std::memcpy(begin, data, prefix);
+    char* dst = begin + prefix;
+    for (size_t i = prefix; i < length; i++) {
+        const uint8_t b = data[i];
+        dst += (b < 0x80) ? EncodeUtf8(b, dst) : EncodeUtf8(MAC_ROMAN_HIGH[b - 0x80], dst);
+    }
+
+    result.resize(static_cast<size_t>(dst - begin));
+    return result;
+}
+
+} // namespace NameTable
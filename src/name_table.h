@@ -0,0 +1,30 @@
+// this_file: src/name_table.h
+// OpenType name table kernels for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Vectorized name-record scanning and UTF-16BE / Mac Roman to UTF-8 transcoding
+
+#ifndef NAME_TABLE_H
+#define NAME_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace NameTable {
+    // Scan `count` consecutive 12-byte name records and write the indices of records whose
+    // nameID is below 32 and has its bit set in nameIdMask (bit n = nameID n).
+    // outIndices must have room for `count` entries; returns the number of matches.
+    size_t FindRecords(const uint8_t* records, size_t count, uint32_t nameIdMask, uint16_t* outIndices) noexcept;
+
+    // Transcode UTF-16BE to UTF-8. Surrogate pairs are combined; unpaired surrogates
+    // become U+FFFD. A trailing odd byte is ignored.
+    [[nodiscard]] std::string Utf16BEToUtf8(const uint8_t* data, size_t length);
+
+    // Transcode Mac OS Roman (Mac platform, encoding 0) to UTF-8
+    [[nodiscard]] std::string MacRomanToUtf8(const uint8_t* data, size_t length);
+
+    // True if every byte is 7-bit ASCII
+    [[nodiscard]] bool IsAscii(const uint8_t* data, size_t length) noexcept;
+}
+
+#endif // NAME_TABLE_H
@@ -0,0 +1,119 @@
+// this_file: src/opentype.cpp
+// OpenType structure views implementation
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+
+#include "opentype.h"
+#include <algorithm>
+#include <utility>
+
+namespace OpenType {
+// Table directory decoding and collection header access
+
+constexpr uint16_t MAX_FONT_TABLES = 1000;           // Maximum number of tables in font file
+
+bool OpenTypeFace::Parse(ByteSpan file, uint32_t faceOffset) {
+    file_ = file;
+    faceOffset_ = faceOffset;
+    sfntVersion_ = 0;
+    tables_.clear();
+
+    const ByteSpan header = file.Subspan(faceOffset, SfntHeader::SIZE);
+    if (header.empty()) return false;  // Offset beyond file size
+
+    // Validate font signature (TrueType or OpenType)
+    const uint32_t version = SfntHeader::SfntVersion::Get(header);
+    if (version != SFNT_VERSION_TRUETYPE && version != SFNT_VERSION_CFF) return false;
+
+    // Validate numTables is reasonable (prevent excessive iteration with corrupted files)
+    const uint16_t numTables = SfntHeader::NumTables::Get(header);
+    if (numTables > MAX_FONT_TABLES) return false;
+
+    const ByteSpan directory = file.Subspan(static_cast<size_t>(faceOffset) + SfntHeader::SIZE,
+                                            static_cast<size_t>(numTables) * TableDirectoryEntry::SIZE);
+    if (numTables > 0 && directory.empty()) return false;  // Truncated table directory
+
+    tables_.resize(numTables);
+    for (uint16_t i = 0; i < numTables; i++) {
+        const ByteSpan entry = directory.Subspan(static_cast<size_t>(i) * TableDirectoryEntry::SIZE, TableDirectoryEntry::SIZE);
+        tables_[i] = TableRecord{
+            TableDirectoryEntry::Tag::Get(entry),
+            TableDirectoryEntry::Checksum::Get(entry),
+            TableDirectoryEntry::Offset::Get(entry),
+            TableDirectoryEntry::Length::Get(entry)};
+    }
+
+    SortByTag();
+    sfntVersion_ = version;
+    return true;
+}
+
+bool OpenTypeFace::Assign(uint32_t sfntVersion, std::vector<TableRecord> tables) {
+    file_ = ByteSpan();
+    faceOffset_ = 0;
+    sfntVersion_ = 0;
+    tables_.clear();
+    if (sfntVersion != SFNT_VERSION_TRUETYPE && sfntVersion != SFNT_VERSION_CFF) return false;
+    if (tables.size() > MAX_FONT_TABLES) return false;
+
+    tables_ = std::move(tables);
+    SortByTag();
+    sfntVersion_ = sfntVersion;
+    return true;
+}
+
+void OpenTypeFace::SortByTag() {
+    // The spec requires tag order; only sort directories that violate it.
+    // stable_sort keeps directory order among duplicate tags.
+    const auto byTag = [](const TableRecord& a, const TableRecord& b) { return a.tag < b.tag; };
+    if (!std::is_sorted(tables_.begin(), tables_.end(), byTag)) {
+        std::stable_sort(tables_.begin(), tables_.end(), byTag);
+    }
+}
+
+const TableRecord* OpenTypeFace::Find(uint32_t tag) const noexcept {
+    const auto it = std::lower_bound(tables_.begin(), tables_.end(), tag,
+                                     [](const TableRecord& record, uint32_t value) { return record.tag < value; });
+    return (it != tables_.end() && it->tag == tag) ? &*it : nullptr;
+}
+
+ByteSpan OpenTypeFace::Table(uint32_t tag) const noexcept {
+    const TableRecord* record = Find(tag);
+    return record ? file_.Subspan(record->offset, record->length) : ByteSpan();
+}
+
+std::string TagName(uint32_t tag) {
+    std::string name(4, '?');
+    for (int i = 0; i < 4; i++) {
+        const char c = static_cast<char>((tag >> (24 - 8 * i)) & 0xFF);
+        if (c >= 0x20 && c < 0x7F) name[i] = c;
+    }
+    return name;
+}
+
+bool IsCollection(ByteSpan file) noexcept {
+    uint32_t tag = 0;
+    return file.Read(CollectionHeader::Tag::OFFSET, tag) && tag == TAG_TTCF;
+}
+
+bool ReadCollectionOffsets(ByteSpan file, uint32_t maxFaces, std::vector<uint32_t>& offsets) {
+    offsets.clear();
+    if (!IsCollection(file)) return false;
+
+    // Validate numFonts is reasonable (0 or suspiciously large values indicate corruption)
+    const uint32_t numFonts = CollectionHeader::NumFonts::Get(file);
+    if (numFonts == 0 || numFonts > maxFaces) return false;
+
+    // A truncated offset array yields only the faces whose offsets are present
+    const size_t available = file.size() > CollectionHeader::OFFSETS_START
+        ? (file.size() - CollectionHeader::OFFSETS_START) / CollectionHeader::OFFSET_SIZE : 0;
+    const size_t count = numFonts < available ? numFonts : available;
+    if (count == 0) return false;
+
+    offsets.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        file.Read(CollectionHeader::OFFSETS_START + i * CollectionHeader::OFFSET_SIZE, offsets[i]);
+    }
+    return true;
+}
+
+} // namespace OpenType
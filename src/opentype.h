@@ -0,0 +1,179 @@
+// this_file: src/opentype.h
+// OpenType structure views for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Typed table fields, indexed table directory, and TTC/OTC header access over byte views
+
+#ifndef OPENTYPE_H
+#define OPENTYPE_H
+
+#include "byte_order.h"
+#include "font_io.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace OpenType {
+    using FontIO::ByteSpan;
+    using ByteOrder::MakeTag;
+
+    // sfnt version and collection tags (per OpenType spec)
+    constexpr uint32_t SFNT_VERSION_TRUETYPE = 0x00010000;  // TrueType outlines
+    constexpr uint32_t SFNT_VERSION_CFF = MakeTag("OTTO");  // CFF/CFF2 outlines
+    constexpr uint32_t TAG_TTCF = MakeTag("ttcf");          // TrueType/OpenType Collection header
+
+    // Table tags (per OpenType spec)
+    constexpr uint32_t TAG_CMAP = MakeTag("cmap");
+    constexpr uint32_t TAG_FVAR = MakeTag("fvar");
+    constexpr uint32_t TAG_HEAD = MakeTag("head");
+    constexpr uint32_t TAG_NAME = MakeTag("name");
+    constexpr uint32_t TAG_OS2 = MakeTag("OS/2");
+
+    // Typed big-endian field at a fixed offset within a table or record.
+    // Get() returns the fallback when the field lies outside the view.
+    template <typename T, size_t Offset>
+    struct Field {
+        using Type = T;
+        static constexpr size_t OFFSET = Offset;
+        static constexpr size_t END = Offset + sizeof(T);
+        static T Get(const ByteSpan bytes, T fallback = T{}) noexcept {
+            bytes.Read(Offset, fallback);
+            return fallback;
+        }
+    };
+
+    // Offset table (sfnt header) and table directory record layouts
+    namespace SfntHeader {
+        using SfntVersion = Field<uint32_t, 0>;
+        using NumTables = Field<uint16_t, 4>;
+        constexpr size_t SIZE = 12;
+    }
+    namespace TableDirectoryEntry {
+        using Tag = Field<uint32_t, 0>;
+        using Checksum = Field<uint32_t, 4>;
+        using Offset = Field<uint32_t, 8>;
+        using Length = Field<uint32_t, 12>;
+        constexpr size_t SIZE = 16;
+    }
+
+    // TTC/OTC header layout
+    namespace CollectionHeader {
+        using Tag = Field<uint32_t, 0>;
+        using NumFonts = Field<uint32_t, 8>;
+        constexpr size_t OFFSETS_START = 12;   // First entry of tableDirectoryOffsets[]
+        constexpr size_t OFFSET_SIZE = 4;
+    }
+
+    // 'head' table fields
+    namespace Head {
+        using FontRevision = Field<uint32_t, 4>;        // 16.16 fixed
+        using CheckSumAdjustment = Field<uint32_t, 8>;
+        using MagicNumber = Field<uint32_t, 12>;       // MAGIC_NUMBER
+        using UnitsPerEm = Field<uint16_t, 18>;
+        constexpr uint32_t MAGIC_NUMBER = 0x5F0F3CF5;
+    }
+
+    // 'OS/2' table fields
+    namespace Os2 {
+        using WeightClass = Field<uint16_t, 4>;
+        using WidthClass = Field<uint16_t, 6>;
+        using FsType = Field<uint16_t, 8>;
+    }
+
+    // 'name' table header and record layouts
+    namespace Name {
+        using Count = Field<uint16_t, 2>;
+        using StringOffset = Field<uint16_t, 4>;
+        constexpr size_t HEADER_SIZE = 6;
+        namespace Record {
+            using PlatformID = Field<uint16_t, 0>;
+            using EncodingID = Field<uint16_t, 2>;
+            using LanguageID = Field<uint16_t, 4>;
+            using NameID = Field<uint16_t, 6>;
+            using Length = Field<uint16_t, 8>;
+            using StringOffset = Field<uint16_t, 10>;
+            constexpr size_t SIZE = 12;
+        }
+    }
+
+    // 'cmap' table header, encoding record, and Unicode subtable layouts
+    namespace Cmap {
+        using NumTables = Field<uint16_t, 2>;
+        constexpr size_t HEADER_SIZE = 4;
+        namespace EncodingRecord {
+            using PlatformID = Field<uint16_t, 0>;
+            using EncodingID = Field<uint16_t, 2>;
+            using SubtableOffset = Field<uint32_t, 4>;
+            constexpr size_t SIZE = 8;
+        }
+        using SubtableFormat = Field<uint16_t, 0>;
+        namespace Format4 {
+            using SegCountX2 = Field<uint16_t, 6>;
+            constexpr size_t END_CODES = 14;   // endCode[], reservedPad, startCode[], idDelta[], idRangeOffset[]
+        }
+        namespace Format12 {
+            using NumGroups = Field<uint32_t, 12>;
+            constexpr size_t GROUPS = 16;
+            namespace Group {
+                using StartCharCode = Field<uint32_t, 0>;
+                using EndCharCode = Field<uint32_t, 4>;
+                using StartGlyphID = Field<uint32_t, 8>;
+                constexpr size_t SIZE = 12;
+            }
+        }
+    }
+
+    // One decoded table directory entry
+    struct TableRecord {
+        uint32_t tag;
+        uint32_t checksum;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    // View over one face of an sfnt file. The table directory is decoded once into an array
+    // sorted by tag, so lookups are binary searches. The view does not own the file bytes.
+    class OpenTypeFace {
+    public:
+        // Decode the sfnt header and table directory at faceOffset.
+        // Returns false for an unknown sfnt version or a truncated/oversized directory.
+        bool Parse(ByteSpan file, uint32_t faceOffset);
+
+        // Adopt a directory decoded from another container (WOFF/WOFF2). The view has no file
+        // bytes, so record offsets refer to the caller's storage and Table() is empty.
+        // Returns false (leaving the view empty) for an unknown sfnt version.
+        bool Assign(uint32_t sfntVersion, std::vector<TableRecord> tables);
+
+        [[nodiscard]] uint32_t SfntVersion() const noexcept { return sfntVersion_; }
+        [[nodiscard]] uint32_t FaceOffset() const noexcept { return faceOffset_; }
+        [[nodiscard]] ByteSpan File() const noexcept { return file_; }
+        [[nodiscard]] const std::vector<TableRecord>& Tables() const noexcept { return tables_; }
+
+        // Directory entry for tag, or nullptr (first entry in directory order on duplicates)
+        [[nodiscard]] const TableRecord* Find(uint32_t tag) const noexcept;
+
+        // Table bytes for tag; empty if the table is absent or extends past the file
+        [[nodiscard]] ByteSpan Table(uint32_t tag) const noexcept;
+
+    private:
+        void SortByTag();
+
+        ByteSpan file_;
+        uint32_t faceOffset_ = 0;
+        uint32_t sfntVersion_ = 0;
+        std::vector<TableRecord> tables_;
+    };
+
+    // Printable four-character form of a tag (non-printable bytes become '?')
+    [[nodiscard]] std::string TagName(uint32_t tag);
+
+    // True if the data starts with a 'ttcf' collection header
+    [[nodiscard]] bool IsCollection(ByteSpan file) noexcept;
+
+    // Read the face offsets of a TTC/OTC (at most maxFaces). Returns false if the header is
+    // missing or declares zero or more than maxFaces faces; a truncated offset array yields
+    // only the offsets that are present.
+    bool ReadCollectionOffsets(ByteSpan file, uint32_t maxFaces, std::vector<uint32_t>& offsets);
+}
+
+#endif // OPENTYPE_H
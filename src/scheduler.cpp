@@ -0,0 +1,179 @@
+// this_file: src/scheduler.cpp
+// Task scheduler implementation
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+
+#include "scheduler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+namespace Scheduler {
+
+// Environment variable with the default worker count
+constexpr const char* JOBS_ENVIRONMENT_VARIABLE = "FONTLIFT_JOBS";
+constexpr unsigned MAX_IO_THREADS = 64;
+
+static std::atomic<unsigned> g_defaultJobs{0};   // Set by --jobs; 0 = not set
+
+// Pool and worker index of the running thread, so Submit() from a task targets its own deque
+static thread_local WorkStealingPool* t_pool = nullptr;
+static thread_local size_t t_worker = 0;
+
+void SetDefaultJobs(unsigned jobs) {
+    g_defaultJobs = jobs;
+}
+
+bool ParseJobs(const char* text, unsigned& jobs) noexcept {
+    if (!text || *text == '\0') return false;
+    unsigned long value = 0;
+    for (const char* p = text; *p; p++) {
+        if (*p < '0' || *p > '9') return false;
+        value = value * 10 + static_cast<unsigned long>(*p - '0');
+        if (value > MAX_JOBS) return false;
+    }
+    if (value == 0) return false;
+    jobs = static_cast<unsigned>(value);
+    return true;
+}
+
+unsigned DefaultJobs() {
+    if (g_defaultJobs > 0) return g_defaultJobs;
+    unsigned jobs = 0;
+    if (ParseJobs(std::getenv(JOBS_ENVIRONMENT_VARIABLE), jobs)) return jobs;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+WorkStealingPool::WorkStealingPool(unsigned threads) {
+    if (threads == 0) threads = DefaultJobs();
+    queues_.reserve(threads);
+    for (unsigned i = 0; i < threads; i++) queues_.push_back(std::make_unique<Queue>());
+    threads_.reserve(threads);
+    for (size_t t = 0; t < threads; t++) {
+        threads_.emplace_back([this, t]() { WorkerLoop(t); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) thread.join();
+}
+
+void WorkStealingPool::Submit(Task task) {
+    const size_t target = t_pool == this ? t_worker : nextQueue_++ % queues_.size();
+    {
+        std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+        queues_[target]->tasks.push_back(std::move(task));
+    }
+    queued_++;
+    // A sleeper checks queued_ after announcing itself, so either it sees this task or we see it
+    if (sleepers_ > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        wake_.notify_one();
+    }
+}
+
+// Helper: Newest task of the worker's own deque (depth first, data still in cache)
+bool WorkStealingPool::TryPop(size_t self, Task& task) {
+    Queue& queue = *queues_[self];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    queued_--;
+    return true;
+}
+
+// Helper: Oldest task of another worker's deque (usually the largest remaining subtree)
+bool WorkStealingPool::TrySteal(size_t self, Task& task) {
+    for (size_t i = 1; i < queues_.size(); i++) {
+        Queue& queue = *queues_[(self + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        queued_--;
+        return true;
+    }
+    return false;
+}
+
+bool WorkStealingPool::RunOne() {
+    // Threads from outside the pool start at deque 0 and steal from the others
+    const size_t self = t_pool == this ? t_worker : 0;
+    Task task;
+    if (!TryPop(self, task) && !TrySteal(self, task)) return false;
+    task();
+    return true;
+}
+
+void WorkStealingPool::WorkerLoop(size_t self) {
+    t_pool = this;
+    t_worker = self;
+    for (;;) {
+        if (RunOne()) continue;
+        // Nothing to run: sleep until a task is queued or the pool stops
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        if (stopping_ && queued_ == 0) break;
+        sleepers_++;
+        wake_.wait(lock, [this] { return queued_ > 0 || stopping_; });
+        sleepers_--;
+    }
+    t_pool = nullptr;
+}
+
+// The shared pools are never destroyed: their idle workers end with the process, and a task
+// still running at exit cannot make the exit wait for it
+WorkStealingPool& CpuPool() {
+    static WorkStealingPool* pool = new WorkStealingPool(DefaultJobs());
+    return *pool;
+}
+
+WorkStealingPool& IoPool() {
+    static WorkStealingPool* pool = new WorkStealingPool(std::min(MAX_IO_THREADS, 2 * DefaultJobs()));
+    return *pool;
+}
+
+void TaskGroup::Run(WorkStealingPool& pool, Task task) {
+    pending_++;
+    pool.Submit([this, task = std::move(task)]() {
+        if (!cancelled_) task();
+        // Decrement under the lock: Wait() takes it last, so the group outlives this notify
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--pending_ == 0) done_.notify_all();
+    });
+}
+
+void TaskGroup::Wait() {
+    // A worker keeps its pool going; the group's tasks may be queued behind this one
+    if (WorkStealingPool* pool = t_pool) {
+        while (pending_ > 0) {
+            if (pool->RunOne()) continue;
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait_for(lock, std::chrono::milliseconds(1), [this] { return pending_ == 0; });
+        }
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return pending_ == 0; });
+}
+
+void ParallelFor(TaskGroup& group, WorkStealingPool& pool, size_t count, const std::function<void(size_t)>& body) {
+    std::atomic<size_t> next{0};
+    const size_t tasks = std::min<size_t>(pool.ThreadCount(), count);
+    for (size_t t = 0; t < tasks; t++) {
+        group.Run(pool, [&group, &next, &body, count]() {
+            for (size_t i = next++; i < count && !group.IsCancelled(); i = next++) body(i);
+        });
+    }
+    group.Wait();
+}
+
+void ParallelFor(WorkStealingPool& pool, size_t count, const std::function<void(size_t)>& body) {
+    TaskGroup group;
+    ParallelFor(group, pool, count, body);
+}
+
+} // namespace Scheduler
@@ -0,0 +1,220 @@
+// this_file: src/scheduler.h
+// Task scheduler for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Shared work-stealing pools for CPU-bound and blocking I/O tasks, task groups with cancellation,
+// and bounded lock-free queues between pipeline stages. Standard C++ only (no Windows headers).
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Scheduler {
+    using Task = std::function<void()>;
+
+    // Worker count of the shared pools: the value set by the global --jobs option, else the
+    // FONTLIFT_JOBS environment variable, else one per CPU. Set it before the first CpuPool() or
+    // IoPool() call; the pools keep the size they were created with. 0 restores the default.
+    void SetDefaultJobs(unsigned jobs);
+    [[nodiscard]] unsigned DefaultJobs();
+
+    // Largest worker count accepted from --jobs or FONTLIFT_JOBS
+    constexpr unsigned MAX_JOBS = 1024;
+
+    // Parse a worker count: decimal digits only, 1 to MAX_JOBS. False (jobs untouched) otherwise.
+    [[nodiscard]] bool ParseJobs(const char* text, unsigned& jobs) noexcept;
+
+    // Worker threads for tasks that spawn more tasks (e.g. a directory task submits one task per
+    // subdirectory and file). A task submitted from a worker goes to that worker's own deque, so
+    // related work stays on one core until another worker runs dry and steals it. Workers live
+    // as long as the pool and sleep while there is nothing to run.
+    class WorkStealingPool {
+    public:
+        // threads: worker threads (0 = DefaultJobs())
+        explicit WorkStealingPool(unsigned threads = 0);
+        // Runs the tasks still queued, then stops the workers
+        ~WorkStealingPool();
+
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+        // Queue a task; may be called from any thread, including from a running task
+        void Submit(Task task);
+
+        // Run one queued task on the calling thread; false if none was queued
+        bool RunOne();
+
+        [[nodiscard]] unsigned ThreadCount() const noexcept { return static_cast<unsigned>(queues_.size()); }
+
+    private:
+        struct alignas(64) Queue {  // One cache line each, so owners do not contend on their locks
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        bool TryPop(size_t self, Task& task);
+        bool TrySteal(size_t self, Task& task);
+        void WorkerLoop(size_t self);
+
+        std::vector<std::unique_ptr<Queue>> queues_;
+        std::vector<std::thread> threads_;
+        std::atomic<size_t> queued_{0};      // Waiting in a deque
+        std::atomic<size_t> sleepers_{0};    // Workers blocked in wake_
+        std::atomic<size_t> nextQueue_{0};   // Round-robin target for submissions from outside
+        bool stopping_ = false;              // Guarded by sleepMutex_
+        std::mutex sleepMutex_;
+        std::condition_variable wake_;
+    };
+
+    // Shared pool for CPU-bound work (parsing, hashing, checksums): DefaultJobs() workers
+    [[nodiscard]] WorkStealingPool& CpuPool();
+
+    // Shared pool for work that mostly waits on the file system (copies, directory listings,
+    // existence checks on slow drives): twice DefaultJobs() workers, so blocked tasks do not
+    // hold back parsing. A task that waits on another stage belongs here, not on CpuPool().
+    [[nodiscard]] WorkStealingPool& IoPool();
+
+    // Tasks that are waited for together, possibly on several pools. Cancel() skips the tasks
+    // that have not started yet; running tasks may poll IsCancelled() to stop early.
+    class TaskGroup {
+    public:
+        TaskGroup() = default;
+        ~TaskGroup() { Wait(); }
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        // Queue a task on a pool as part of this group; may be called from the group's tasks
+        void Run(WorkStealingPool& pool, Task task);
+
+        // Return once every task of the group has finished or been skipped. A worker thread
+        // runs other queued tasks of its pool meanwhile, so nested groups cannot starve the pool.
+        void Wait();
+
+        void Cancel() noexcept { cancelled_ = true; }
+        [[nodiscard]] bool IsCancelled() const noexcept { return cancelled_; }
+
+    private:
+        std::atomic<size_t> pending_{0};
+        std::atomic<bool> cancelled_{false};
+        std::mutex mutex_;
+        std::condition_variable done_;
+    };
+
+    // Call body(i) for every i in [0, count) on the pool as part of group, then Wait() for the
+    // group. Items are claimed through a shared index by at most one task per worker; once the
+    // group is cancelled no further items are started.
+    void ParallelFor(TaskGroup& group, WorkStealingPool& pool, size_t count, const std::function<void(size_t)>& body);
+    void ParallelFor(WorkStealingPool& pool, size_t count, const std::function<void(size_t)>& body);
+
+    // Fixed-capacity multi-producer multi-consumer queue between pipeline stages. Each slot
+    // carries a sequence number that tells whether it is free for the producer or filled for
+    // the consumer at a given position, so push and pop each take one compare-and-swap and no
+    // lock. A full queue makes producers wait (backpressure); Close() ends the stream.
+    template <typename T>
+    class BoundedQueue {
+    public:
+        // capacity is rounded up to a power of two
+        explicit BoundedQueue(size_t capacity) {
+            size_t size = 2;
+            while (size < capacity) size <<= 1;
+            mask_ = size - 1;
+            cells_ = std::make_unique<Cell[]>(size);
+            for (size_t i = 0; i < size; i++) cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        // Append unless the queue is full; value is left untouched on failure
+        bool TryPush(T&& value) {
+            size_t pos = tail_.load(std::memory_order_relaxed);
+            Cell* cell;
+            for (;;) {
+                cell = &cells_[pos & mask_];
+                const size_t seq = cell->sequence.load(std::memory_order_acquire);
+                const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0) {
+                    if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else if (diff < 0) {
+                    return false;  // Slot still holds the value from one lap ago
+                } else {
+                    pos = tail_.load(std::memory_order_relaxed);
+                }
+            }
+            cell->value = std::move(value);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Take the oldest value unless the queue is empty
+        bool TryPop(T& value) {
+            size_t pos = head_.load(std::memory_order_relaxed);
+            Cell* cell;
+            for (;;) {
+                cell = &cells_[pos & mask_];
+                const size_t seq = cell->sequence.load(std::memory_order_acquire);
+                const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                if (diff == 0) {
+                    if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else if (diff < 0) {
+                    return false;  // Slot not filled yet
+                } else {
+                    pos = head_.load(std::memory_order_relaxed);
+                }
+            }
+            value = std::move(cell->value);
+            cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Append, waiting while the queue is full
+        void Push(T value) {
+            for (unsigned spins = 0; !TryPush(std::move(value)); spins++) Backoff(spins);
+        }
+
+        // Take the oldest value, waiting while the queue is empty; false once it is closed and drained
+        bool Pop(T& value) {
+            for (unsigned spins = 0;; spins++) {
+                if (TryPop(value)) return true;
+                // Values pushed before Close() are visible once closed_ is
+                if (closed_.load(std::memory_order_acquire)) return TryPop(value);
+                Backoff(spins);
+            }
+        }
+
+        // No more values will be pushed (call after the last producer's last Push)
+        void Close() { closed_.store(true, std::memory_order_release); }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence{0};
+            T value{};
+        };
+
+        // Helper: Stages usually wait on I/O, so yield briefly and then sleep instead of spinning
+        static void Backoff(unsigned spins) {
+            if (spins < 64) std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+
+        std::unique_ptr<Cell[]> cells_;
+        size_t mask_ = 0;
+        alignas(64) std::atomic<size_t> tail_{0};  // Next position to push (own cache line)
+        alignas(64) std::atomic<size_t> head_{0};  // Next position to pop
+        alignas(64) std::atomic<bool> closed_{false};
+    };
+}
+
+#endif // SCHEDULER_H
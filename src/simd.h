@@ -0,0 +1,32 @@
+// this_file: src/simd.h
+// SIMD feature selection for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Compile-time selection of AVX2, SSE2 or NEON kernels with a scalar fallback
+
+#ifndef SIMD_H
+#define SIMD_H
+
+// Kernels are chosen at compile time from the target ISA; nothing is dispatched at runtime.
+// MSVC x64 always provides SSE2; AVX2 kernels require /arch:AVX2 (or -mavx2).
+// Define FONTLIFT_NO_SIMD to force the scalar paths (useful when comparing results).
+#if !defined(FONTLIFT_NO_SIMD)
+#if defined(__AVX2__)
+#define FONTLIFT_SIMD_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FONTLIFT_SIMD_SSE2 1
+#endif
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define FONTLIFT_SIMD_NEON 1
+#endif
+#endif
+
+#if defined(FONTLIFT_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(FONTLIFT_SIMD_SSE2)
+#include <emmintrin.h>
+#elif defined(FONTLIFT_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+#endif // SIMD_H
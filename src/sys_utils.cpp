@@ -3,10 +3,19 @@
 // Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
 
 #include "sys_utils.h"
+#include "font_registry.h"
+#include "scheduler.h"
+#include "content_store.h"
+#include "checksum.h"
 #include <windows.h>
+#include <winioctl.h>
 #include <winsvc.h>
 #include <shlwapi.h>
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
+#include <functional>
+#include <mutex>
 #include <system_error>
 #include <iostream>
 #include <string>
@@ -203,7 +212,7 @@ bool ClearAdobeCachesIn(const fs::path& root) {
 }
 } // namespace
 
-// Registry buffer size constant (Windows registry value limit)
+// Registry buffer size constant, in characters (Windows registry value limit)
 constexpr size_t REGISTRY_BUFFER_SIZE = 512;
 
 namespace SysUtils {
@@ -249,45 +258,219 @@ bool IsAdmin() {
 }
 
 std::string GetFontsDirectory() {
-    char winDir[MAX_PATH];
-    UINT result = GetWindowsDirectoryA(winDir, MAX_PATH);
-    if (result == 0 || result >= MAX_PATH) {
-        return "";  // Failed or path truncated
-    }
-    std::string fontsDir = winDir;
-    fontsDir += "\\Fonts";
-    return fontsDir;
+    return GetFontStore().FontsDirectory(false);
 }
 
 std::string GetUserFontsDirectory() {
-    char localAppData[MAX_PATH];
-    DWORD result = GetEnvironmentVariableA("LOCALAPPDATA", localAppData, MAX_PATH);
-    if (result == 0 || result >= MAX_PATH) {
-        return "";  // Failed or path truncated
+    return GetFontStore().FontsDirectory(true);
+}
+
+std::string GetDataDirectory() {
+    const std::string localAppData = GetEnvVariable("LOCALAPPDATA");
+    if (localAppData.empty()) return "";
+    std::string dataDir = localAppData + "\\fontlift";
+    if (CreateDirectoryA(dataDir.c_str(), NULL) == 0 && GetLastError() != ERROR_ALREADY_EXISTS) {
+        return "";
     }
-    std::string fontsDir = localAppData;
-    fontsDir += "\\Microsoft\\Windows\\Fonts";
-    return fontsDir;
+    return dataDir;
 }
 
-bool CopyToFontsFolder(const char* sourcePath, std::string& destPath, bool perUser) {
+// Helper: Fonts directory of the scope, creating the user one if needed; empty on failure
+static std::string PrepareFontsFolder(bool perUser) {
     std::string fontsDir = perUser ? GetUserFontsDirectory() : GetFontsDirectory();
-    if (fontsDir.empty()) return false;
+    if (fontsDir.empty()) return "";
 
     // Ensure the user fonts directory exists
     if (perUser) {
         if (!PathFileExistsA(fontsDir.c_str())) {
             if (CreateDirectoryA(fontsDir.c_str(), NULL) == 0) {
                 // Failed to create directory (could be permissions issue)
-                return false;
+                return "";
             }
         }
     }
+    return fontsDir;
+}
+
+// Largest region of one block clone request (a multiple of every cluster size)
+constexpr uint64_t CLONE_CHUNK_SIZE = 1ull << 30;
+constexpr DWORD COPY_BUFFER_SIZE = 1024 * 1024;
+
+const char* CopyMethodName(CopyMethod method) noexcept {
+    switch (method) {
+        case CopyMethod::Clone: return "clone";
+        case CopyMethod::Hardlink: return "hardlink";
+        case CopyMethod::System: return "system";
+        case CopyMethod::Buffered: return "buffered";
+        default: return "auto";
+    }
+}
+
+bool ParseCopyMethod(const char* name, CopyMethod& method) noexcept {
+    for (const CopyMethod candidate : {CopyMethod::Auto, CopyMethod::Clone, CopyMethod::Hardlink, CopyMethod::System,
+                                       CopyMethod::Buffered}) {
+        if (name && strcmp(name, CopyMethodName(candidate)) == 0) {
+            method = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Helper: Clone every cluster of source into dest, which is sized to match first. Clone
+// regions must be whole clusters; the last one may reach past the end of the file.
+static bool CloneExtents(HANDLE source, HANDLE dest, const char* destPath, uint64_t size) {
+    char volume[MAX_PATH];
+    DWORD sectorsPerCluster = 0, bytesPerSector = 0, freeClusters = 0, totalClusters = 0;
+    if (!GetVolumePathNameA(destPath, volume, MAX_PATH) ||
+        !GetDiskFreeSpaceA(volume, &sectorsPerCluster, &bytesPerSector, &freeClusters, &totalClusters)) {
+        return false;
+    }
+    const uint64_t clusterSize = static_cast<uint64_t>(sectorsPerCluster) * bytesPerSector;
+    FILE_END_OF_FILE_INFO endOfFile = {};
+    endOfFile.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+    if (clusterSize == 0 || !SetFileInformationByHandle(dest, FileEndOfFileInfo, &endOfFile, sizeof(endOfFile))) return false;
+    for (uint64_t offset = 0; offset < size; offset += CLONE_CHUNK_SIZE) {
+        const uint64_t length = std::min(CLONE_CHUNK_SIZE, size - offset);
+        DUPLICATE_EXTENTS_DATA extents = {};
+        extents.FileHandle = source;
+        extents.SourceFileOffset.QuadPart = static_cast<LONGLONG>(offset);
+        extents.TargetFileOffset.QuadPart = static_cast<LONGLONG>(offset);
+        extents.ByteCount.QuadPart = static_cast<LONGLONG>((length + clusterSize - 1) / clusterSize * clusterSize);
+        DWORD returned = 0;
+        if (!DeviceIoControl(dest, FSCTL_DUPLICATE_EXTENTS_TO_FILE, &extents, sizeof(extents), NULL, 0, &returned, NULL)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Helper: Block clone of a whole file. Only volumes with block reference counting can, and
+// only within one volume; sparse sources are left to the other methods.
+static bool CloneFile(const char* sourcePath, const char* destPath) {
+    HANDLE source = CreateFileA(sourcePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (source == INVALID_HANDLE_VALUE) return false;
+    BY_HANDLE_FILE_INFORMATION sourceInfo;
+    DWORD fileSystemFlags = 0;
+    bool ok = false;
+    if (GetFileInformationByHandle(source, &sourceInfo) && !(sourceInfo.dwFileAttributes & FILE_ATTRIBUTE_SPARSE_FILE) &&
+        GetVolumeInformationByHandleW(source, NULL, 0, NULL, NULL, &fileSystemFlags, NULL, 0) &&
+        (fileSystemFlags & FILE_SUPPORTS_BLOCK_REFCOUNTING)) {
+        HANDLE dest = CreateFileA(destPath, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (dest != INVALID_HANDLE_VALUE) {
+            BY_HANDLE_FILE_INFORMATION destInfo;
+            const uint64_t size = (static_cast<uint64_t>(sourceInfo.nFileSizeHigh) << 32) | sourceInfo.nFileSizeLow;
+            ok = GetFileInformationByHandle(dest, &destInfo) && destInfo.dwVolumeSerialNumber == sourceInfo.dwVolumeSerialNumber &&
+                 CloneExtents(source, dest, destPath, size);
+            // Keep the source's write time, as CopyFileA does
+            if (ok) SetFileTime(dest, NULL, NULL, &sourceInfo.ftLastWriteTime);
+            CloseHandle(dest);
+            if (!ok) DeleteFileA(destPath);
+        }
+    }
+    CloseHandle(source);
+    return ok;
+}
+
+// Helper: Hard link in place of any existing destination
+static bool LinkFile(const char* sourcePath, const char* destPath) {
+    if (PathFileExistsA(destPath) && DeleteFileA(destPath) == 0) return false;
+    return CreateHardLinkA(destPath, sourcePath, NULL) != 0;
+}
+
+// Helper: Copy through a buffer in this process, for sources CopyFileA refuses
+static bool BufferedCopy(const char* sourcePath, const char* destPath) {
+    HANDLE source = CreateFileA(sourcePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (source == INVALID_HANDLE_VALUE) return false;
+    HANDLE dest = CreateFileA(destPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (dest == INVALID_HANDLE_VALUE) {
+        CloseHandle(source);
+        return false;
+    }
+    std::vector<char> buffer(COPY_BUFFER_SIZE);
+    bool ok = true;
+    for (;;) {
+        DWORD read = 0;
+        if (!ReadFile(source, buffer.data(), COPY_BUFFER_SIZE, &read, NULL)) ok = false;
+        if (!ok || read == 0) break;
+        DWORD written = 0;
+        if (!WriteFile(dest, buffer.data(), read, &written, NULL) || written != read) ok = false;
+    }
+    FILETIME writeTime;
+    if (ok && GetFileTime(source, NULL, NULL, &writeTime)) SetFileTime(dest, NULL, NULL, &writeTime);
+    if (CloseHandle(dest) == 0) ok = false;
+    const DWORD error = GetLastError();
+    CloseHandle(source);
+    if (!ok) {
+        DeleteFileA(destPath);
+        SetLastError(error);
+    }
+    return ok;
+}
+
+bool CopyFontFile(const char* sourcePath, const char* destPath, CopyMethod method, bool allowHardlink, CopyMethod* used) {
+    const auto attempt = [&](CopyMethod candidate) {
+        bool ok = false;
+        switch (candidate) {
+            case CopyMethod::Clone: ok = CloneFile(sourcePath, destPath); break;
+            case CopyMethod::Hardlink: ok = LinkFile(sourcePath, destPath); break;
+            case CopyMethod::System: ok = CopyFileA(sourcePath, destPath, FALSE) != 0; break;
+            case CopyMethod::Buffered: ok = BufferedCopy(sourcePath, destPath); break;
+            default: break;
+        }
+        if (ok && used) *used = candidate;
+        return ok;
+    };
+    if (method != CopyMethod::Auto) return attempt(method);
+    // A failed attempt leaves no destination behind, so the next one starts clean
+    if (attempt(CopyMethod::Clone)) return true;
+    if (allowHardlink && ContentStore::IsObject(sourcePath) && attempt(CopyMethod::Hardlink)) return true;
+    if (attempt(CopyMethod::System)) return true;
+    const DWORD error = GetLastError();
+    if (attempt(CopyMethod::Buffered)) return true;
+    SetLastError(error);  // Report why the system copy failed
+    return false;
+}
+
+bool CopyToFontsFolder(const char* sourcePath, std::string& destPath, bool perUser, CopyMethod method, CopyMethod* used) {
+    const std::string fontsDir = PrepareFontsFolder(perUser);
+    if (fontsDir.empty()) return false;
 
     std::string filename = GetFileName(sourcePath);
     destPath = fontsDir + "\\" + filename;
 
-    return CopyFileA(sourcePath, destPath.c_str(), FALSE) != 0;
+    return CopyFontFile(sourcePath, destPath.c_str(), method, perUser, used);
+}
+
+bool WriteFontFile(const char* destPath, const uint8_t* data, size_t size, Checksum::ContentHasher* hasher) {
+    // Replaces an existing file, as CopyFileA does
+    HANDLE file = CreateFileA(destPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    bool ok = true;
+    while (ok && size > 0) {
+        // Each chunk is hashed while it is still in the CPU cache, just before it is written
+        const DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, COPY_BUFFER_SIZE));
+        if (hasher) hasher->Update(data, chunk);
+        DWORD written = 0;
+        ok = WriteFile(file, data, chunk, &written, NULL) != 0 && written == chunk;
+        data += chunk;
+        size -= chunk;
+    }
+    if (CloseHandle(file) == 0) ok = false;
+    if (!ok) {
+        const DWORD error = GetLastError();
+        DeleteFileA(destPath);
+        SetLastError(error);  // Callers report the write error, not the cleanup
+    }
+    return ok;
+}
+
+bool WriteToFontsFolder(const char* fileName, const uint8_t* data, size_t size, std::string& destPath, bool perUser,
+                        Checksum::ContentHasher* hasher) {
+    const std::string fontsDir = PrepareFontsFolder(perUser);
+    if (fontsDir.empty()) return false;
+    destPath = fontsDir + "\\" + fileName;
+    return WriteFontFile(destPath.c_str(), data, size, hasher);
 }
 
 bool DeleteFromFontsFolder(const char* filename) {
@@ -308,161 +491,254 @@ std::string GetFileName(const char* path) {
     return filename ? std::string(filename) : "";
 }
 
-// Helper: Check for path traversal attempts (../ or ..\)
-static bool HasPathTraversal(const std::string& const path) noexcept {
-    return path.find("..\\") != std::string::npos || path.find("../") != std::string::npos;
+bool IsValidFontPath(const char* path) {
+    return path && FontRegistry::IsValidFontPath(path, GetFontsDirectory());
 }
 
-// Helper: Validate absolute paths are within fonts directory
-static bool IsAbsolutePathInFontsDir(const std::string& const pathStr) noexcept {
-    if (pathStr.length() <= 1 || pathStr[1] != ':') return true;
+// Fonts registry key path (same under HKEY_LOCAL_MACHINE and HKEY_CURRENT_USER)
+constexpr const char* FONTS_REGISTRY_PATH = "SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion\\Fonts";
 
-    std::string fontsDir = GetFontsDirectory();
-    if (fontsDir.empty()) return false;
+// Helper: Validate value name length (Windows limit: 16,383 characters)
+static bool IsValidValueName(const char* valueName) noexcept {
+    return valueName && strlen(valueName) <= 16383;
+}
 
-    std::string lowerPath = pathStr;
-    std::string lowerFonts = fontsDir;
-    // Locale-independent ASCII lowercase conversion
-    for (auto& c : lowerPath) {
-        if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
-    }
-    for (auto& c : lowerFonts) {
-        if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
-    }
+// Helper: Text in a code page (CP_UTF8 or CP_ACP) as UTF-16; false if it is not valid there
+static bool Widen(const char* text, UINT codePage, std::wstring& wide) {
+    wide.clear();
+    const int length = static_cast<int>(strlen(text));
+    if (length == 0) return true;
+    const int wideLength = MultiByteToWideChar(codePage, MB_ERR_INVALID_CHARS, text, length, NULL, 0);
+    if (wideLength <= 0) return false;
+    wide.resize(static_cast<size_t>(wideLength));
+    MultiByteToWideChar(codePage, MB_ERR_INVALID_CHARS, text, length, &wide[0], wideLength);
+    return true;
+}
 
-    return lowerPath.find(lowerFonts) == 0;
+// Helper: UTF-16 text in a code page (CP_UTF8 or CP_ACP); false if a character has no
+// equivalent there
+static bool Narrow(const wchar_t* wide, size_t wideLength, UINT codePage, std::string& text) {
+    text.clear();
+    if (wideLength == 0) return true;
+    const bool utf8 = codePage == CP_UTF8;  // Takes neither best-fit flags nor a default character
+    const DWORD flags = utf8 ? 0 : WC_NO_BEST_FIT_CHARS;
+    const int length16 = static_cast<int>(wideLength);
+    BOOL usedDefault = FALSE;
+    const int length = WideCharToMultiByte(codePage, flags, wide, length16, NULL, 0, NULL, utf8 ? NULL : &usedDefault);
+    if (length <= 0 || usedDefault) return false;
+    text.resize(static_cast<size_t>(length));
+    WideCharToMultiByte(codePage, flags, wide, length16, &text[0], length, NULL, NULL);
+    return true;
 }
 
-bool IsValidFontPath(const char* path) {
-    if (!path || strlen(path) == 0) return false;
-    std::string pathStr(path);
-    if (HasPathTraversal(pathStr)) return false;
-    return IsAbsolutePathInFontsDir(pathStr);
+// Helper: A REG_SZ value as a file path in the ANSI code page; empty if a character has no
+// equivalent there (no file API of this tool could open it, and cleanup skips empty entries)
+static std::string RegistryPath(const BYTE* data, DWORD dataSize) {
+    const wchar_t* wide = reinterpret_cast<const wchar_t*>(data);
+    size_t length = dataSize / sizeof(wchar_t);
+    while (length > 0 && wide[length - 1] == L'\0') length--;  // The terminator, when it was stored
+    std::string path;
+    if (!Narrow(wide, length, CP_ACP, path)) path.clear();
+    return path;
 }
 
-bool RegReadFontEntry(const char* valueName, std::string& fontFile, bool perUser) {
-    // Validate value name length (Windows limit: 16,383 characters)
-    if (!valueName || strlen(valueName) > 16383) {
-        return false;
-    }
+// Fonts key of one registry hive (closed on destruction). Value names are UTF-8 here, as font
+// names are everywhere else, and file paths are in the ANSI code page of the file APIs; both are
+// converted to UTF-16 for the registry, so names outside the code page are stored as they are.
+class RegistryKey : public FontStore::Key {
+public:
+    explicit RegistryKey(HKEY key) noexcept : key_(key) {}
+    ~RegistryKey() override { RegCloseKey(key_); }
 
-    HKEY hKey;
-    const char* regPath = "SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion\\Fonts";
-    HKEY rootKey = perUser ? HKEY_CURRENT_USER : HKEY_LOCAL_MACHINE;
+    RegistryKey(const RegistryKey&) = delete;
+    RegistryKey& operator=(const RegistryKey&) = delete;
 
-    if (RegOpenKeyExA(rootKey, regPath, 0, KEY_READ, &hKey) != ERROR_SUCCESS) {
-        return false;
-    }
+    bool Read(const char* valueName, std::string& fontFile) const override {
+        std::wstring name;
+        if (!IsValidValueName(valueName) || !Widen(valueName, CP_UTF8, name)) return false;
 
-    char buffer[REGISTRY_BUFFER_SIZE];
-    DWORD bufferSize = sizeof(buffer);
-    DWORD type;
+        BYTE buffer[REGISTRY_BUFFER_SIZE * sizeof(wchar_t)];
+        DWORD bufferSize = sizeof(buffer);
+        DWORD type;
 
-    LONG result = RegQueryValueExA(hKey, valueName, NULL, &type, reinterpret_cast<LPBYTE>(buffer), &bufferSize);
-    RegCloseKey(hKey);
+        LONG result = RegQueryValueExW(key_, name.c_str(), NULL, &type, buffer, &bufferSize);
+        if (result != ERROR_SUCCESS || type != REG_SZ) return false;
+        fontFile = RegistryPath(buffer, bufferSize);
+        return true;
+    }
 
-    if (result == ERROR_SUCCESS && type == REG_SZ) {
-        // Ensure buffer is null-terminated to prevent overflow
-        if (bufferSize > 0 && bufferSize < sizeof(buffer)) {
-            buffer[bufferSize] = '\0';
-        } else {
-            buffer[sizeof(buffer) - 1] = '\0';
+    bool Write(const char* valueName, const char* fontFile) override {
+        std::wstring name, path;
+        if (!IsValidValueName(valueName) || !Widen(valueName, CP_UTF8, name) || !Widen(fontFile, CP_ACP, path)) {
+            return false;
         }
-        fontFile = buffer;
-        return true;
+        // Validate length doesn't overflow DWORD (extremely unlikely but defensive)
+        if (path.size() >= MAXDWORD / sizeof(wchar_t)) return false;
+
+        LONG result = RegSetValueExW(key_, name.c_str(), 0, REG_SZ,
+            reinterpret_cast<const BYTE*>(path.c_str()), static_cast<DWORD>((path.size() + 1) * sizeof(wchar_t)));
+        return result == ERROR_SUCCESS;
     }
-    return false;
-}
 
-bool RegWriteFontEntry(const char* valueName, const char* fontFile, bool perUser) {
-    // Validate value name length (Windows limit: 16,383 characters)
-    if (!valueName || strlen(valueName) > 16383) {
-        return false;
+    bool Delete(const char* valueName) override {
+        std::wstring name;
+        if (!IsValidValueName(valueName) || !Widen(valueName, CP_UTF8, name)) return false;
+        return RegDeleteValueW(key_, name.c_str()) == ERROR_SUCCESS;
     }
 
-    HKEY hKey;
-    const char* regPath = "SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion\\Fonts";
-    HKEY rootKey = perUser ? HKEY_CURRENT_USER : HKEY_LOCAL_MACHINE;
+    bool Enumerate(std::vector<std::pair<std::string, std::string>>& entries) const override {
+        wchar_t valueName[REGISTRY_BUFFER_SIZE];
+        BYTE valueData[REGISTRY_BUFFER_SIZE * sizeof(wchar_t)];
+        DWORD index = 0;
 
-    // For per-user installation, create the registry key if it doesn't exist
-    DWORD disposition;
-    LONG openResult = perUser
-        ? RegCreateKeyExA(rootKey, regPath, 0, NULL, 0, KEY_WRITE, NULL, &hKey, &disposition)
-        : RegOpenKeyExA(rootKey, regPath, 0, KEY_WRITE, &hKey);
+        while (true) {
+            DWORD nameSize = REGISTRY_BUFFER_SIZE;  // Characters
+            DWORD dataSize = sizeof(valueData);     // Bytes
+            DWORD type;
 
-    if (openResult != ERROR_SUCCESS) {
-        return false;
-    }
+            LONG result = RegEnumValueW(key_, index++, valueName, &nameSize,
+                NULL, &type, valueData, &dataSize);
 
-    size_t pathLen = strlen(fontFile);
-    // Validate length doesn't overflow DWORD (extremely unlikely but defensive)
-    if (pathLen >= MAXDWORD) {
-        RegCloseKey(hKey);
-        return false;
+            if (result == ERROR_NO_MORE_ITEMS) break;
+            if (result != ERROR_SUCCESS) continue;
+            if (type != REG_SZ) continue;
+
+            std::string name;
+            if (!Narrow(valueName, nameSize, CP_UTF8, name)) continue;
+            entries.emplace_back(std::move(name), RegistryPath(valueData, dataSize));
+        }
+        return true;
     }
 
-    LONG result = RegSetValueExA(hKey, valueName, 0, REG_SZ,
-        reinterpret_cast<const BYTE*>(fontFile), static_cast<DWORD>(pathLen + 1));
+private:
+    HKEY key_;
+};
 
-    RegCloseKey(hKey);
-    return result == ERROR_SUCCESS;
+std::string AnsiToUtf8(const std::string& text) {
+    std::wstring wide;
+    std::string utf8;
+    if (!Widen(text.c_str(), CP_ACP, wide) || !Narrow(wide.data(), wide.size(), CP_UTF8, utf8)) return text;
+    return utf8;
 }
 
-bool RegDeleteFontEntry(const char* valueName, bool perUser) {
-    // Validate value name length (Windows limit: 16,383 characters)
-    if (!valueName || strlen(valueName) > 16383) {
-        return false;
+std::unique_ptr<FontStore::Key> RegistryStore::Open(bool perUser, bool writable) {
+    HKEY rootKey = perUser ? HKEY_CURRENT_USER : HKEY_LOCAL_MACHINE;
+    HKEY hKey = NULL;
+    LONG openResult;
+    if (!writable) {
+        openResult = RegOpenKeyExA(rootKey, FONTS_REGISTRY_PATH, 0, KEY_READ, &hKey);
+    } else if (perUser) {
+        // For per-user installation, create the registry key if it doesn't exist
+        DWORD disposition;
+        openResult = RegCreateKeyExA(rootKey, FONTS_REGISTRY_PATH, 0, NULL, 0, KEY_READ | KEY_WRITE, NULL, &hKey, &disposition);
+    } else {
+        openResult = RegOpenKeyExA(rootKey, FONTS_REGISTRY_PATH, 0, KEY_READ | KEY_WRITE, &hKey);
     }
+    if (openResult != ERROR_SUCCESS) return nullptr;
+    return std::make_unique<RegistryKey>(hKey);
+}
 
-    HKEY hKey;
-    const char* regPath = "SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion\\Fonts";
-    HKEY rootKey = perUser ? HKEY_CURRENT_USER : HKEY_LOCAL_MACHINE;
+std::string RegistryStore::FontsDirectory(bool perUser) {
+    if (perUser) {
+        char localAppData[MAX_PATH];
+        DWORD result = GetEnvironmentVariableA("LOCALAPPDATA", localAppData, MAX_PATH);
+        if (result == 0 || result >= MAX_PATH) {
+            return "";  // Failed or path truncated
+        }
+        std::string fontsDir = localAppData;
+        fontsDir += "\\Microsoft\\Windows\\Fonts";
+        return fontsDir;
+    }
+    char winDir[MAX_PATH];
+    UINT result = GetWindowsDirectoryA(winDir, MAX_PATH);
+    if (result == 0 || result >= MAX_PATH) {
+        return "";  // Failed or path truncated
+    }
+    std::string fontsDir = winDir;
+    fontsDir += "\\Fonts";
+    return fontsDir;
+}
 
-    if (RegOpenKeyExA(rootKey, regPath, 0, KEY_WRITE, &hKey) != ERROR_SUCCESS) {
-        return false;
+// Helper: Store named by FONTLIFT_REGISTRY, with its fonts directories next to it, or the registry
+static std::unique_ptr<FontStore::Store> MakeDefaultFontStore() {
+    const std::string file = GetEnvVariable(REGISTRY_ENVIRONMENT_VARIABLE);
+    if (file.empty()) return std::make_unique<RegistryStore>();
+    std::error_code ec;
+    const std::string path = fs::absolute(file, ec).string();
+    FontStore::MemoryOptions options;
+    options.fontsDirs[false] = path + ".fonts\\system";
+    options.fontsDirs[true] = path + ".fonts\\user";
+    for (const auto& dir : options.fontsDirs) fs::create_directories(dir, ec);
+    auto store = std::make_unique<FontStore::FileStore>(path, options);
+    std::string error;
+    if (!store->IsLoaded(&error)) {
+        std::cerr << "Error: " << error << "\n";
+        std::cerr << "Solution: Fix or delete the file, or unset " << REGISTRY_ENVIRONMENT_VARIABLE << "\n";
+    } else {
+        std::cerr << "Note: Using font registrations in " << path << " (" << REGISTRY_ENVIRONMENT_VARIABLE << ")\n";
     }
+    return store;
+}
+
+static std::mutex g_fontStoreMutex;
+static std::unique_ptr<FontStore::Store> g_fontStore;
 
-    LONG result = RegDeleteValueA(hKey, valueName);
-    RegCloseKey(hKey);
-    return result == ERROR_SUCCESS;
+FontStore::Store& GetFontStore() {
+    std::lock_guard<std::mutex> lock(g_fontStoreMutex);
+    if (!g_fontStore) g_fontStore = MakeDefaultFontStore();
+    return *g_fontStore;
 }
 
-bool RegEnumerateFonts(void (*callback)(const char* name, const char* file, bool perUser), bool perUser) {
-    HKEY hKey;
-    const char* regPath = "SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion\\Fonts";
-    HKEY rootKey = perUser ? HKEY_CURRENT_USER : HKEY_LOCAL_MACHINE;
+void SetFontStore(std::unique_ptr<FontStore::Store> store) {
+    std::lock_guard<std::mutex> lock(g_fontStoreMutex);
+    g_fontStore = std::move(store);
+}
 
-    if (RegOpenKeyExA(rootKey, regPath, 0, KEY_READ, &hKey) != ERROR_SUCCESS) {
-        return false;
-    }
+bool FontRegistryKey::Open(bool perUser, bool writable) noexcept {
+    key_ = GetFontStore().Open(perUser, writable);
+    return key_ != nullptr;
+}
 
-    char valueName[REGISTRY_BUFFER_SIZE];
-    BYTE valueData[REGISTRY_BUFFER_SIZE];
-    DWORD index = 0;
+void FontRegistryKey::Close() noexcept {
+    key_.reset();
+}
 
-    while (true) {
-        DWORD nameSize = sizeof(valueName);
-        DWORD dataSize = sizeof(valueData);
-        DWORD type;
+bool FontRegistryKey::Read(const char* valueName, std::string& fontFile) const {
+    return key_ && key_->Read(valueName, fontFile);
+}
 
-        LONG result = RegEnumValueA(hKey, index++, valueName, &nameSize,
-            NULL, &type, valueData, &dataSize);
+bool FontRegistryKey::Write(const char* valueName, const char* fontFile) {
+    return key_ && key_->Write(valueName, fontFile);
+}
 
-        if (result == ERROR_NO_MORE_ITEMS) break;
-        if (result != ERROR_SUCCESS) continue;
-        if (type != REG_SZ) continue;
+bool FontRegistryKey::Delete(const char* valueName) {
+    return key_ && key_->Delete(valueName);
+}
 
-        // Ensure null-termination for safety
-        if (dataSize > 0 && dataSize < sizeof(valueData)) {
-            valueData[dataSize] = '\0';
-        } else {
-            valueData[sizeof(valueData) - 1] = '\0';
-        }
+bool FontRegistryKey::Enumerate(std::vector<std::pair<std::string, std::string>>& entries) const {
+    return key_ && key_->Enumerate(entries);
+}
 
-        callback(valueName, reinterpret_cast<const char*>(valueData), perUser);
-    }
+bool RegReadFontEntry(const char* valueName, std::string& fontFile, bool perUser) {
+    FontRegistryKey key;
+    return key.Open(perUser, false) && key.Read(valueName, fontFile);
+}
 
-    RegCloseKey(hKey);
+bool RegWriteFontEntry(const char* valueName, const char* fontFile, bool perUser) {
+    FontRegistryKey key;
+    return key.Open(perUser, true) && key.Write(valueName, fontFile);
+}
+
+bool RegDeleteFontEntry(const char* valueName, bool perUser) {
+    FontRegistryKey key;
+    return key.Open(perUser, true) && key.Delete(valueName);
+}
+
+bool RegEnumerateFonts(void (*callback)(const char* name, const char* file, bool perUser), bool perUser) {
+    FontRegistryKey key;
+    std::vector<std::pair<std::string, std::string>> entries;
+    if (!key.Open(perUser, false) || !key.Enumerate(entries)) return false;
+    for (const auto& entry : entries) callback(entry.first.c_str(), entry.second.c_str(), perUser);
     return true;
 }
 
@@ -473,16 +749,23 @@ void NotifyFontChange() {
 }
 
 bool ClearUserFontCaches() {
-    bool success = true;
+    // The cache locations are independent: they are cleared at once on the I/O pool
+    std::atomic<bool> success{true};
+    Scheduler::TaskGroup group;
+    const auto clear = [&group, &success](std::function<bool()> job) {
+        group.Run(Scheduler::IoPool(), [&success, job = std::move(job)]() {
+            if (!job()) success = false;
+        });
+    };
 
     std::string localAppData = GetEnvVariable("LOCALAPPDATA");
     if (!localAppData.empty()) {
         fs::path local(localAppData);
         std::cout << "  - Clearing Windows user font cache directories...\n";
-        if (!DeleteDirectoryTree(local / "FontCache", "user font cache directory")) success = false;
-        if (!DeleteDirectoryTree(local / "Microsoft" / "Windows" / "FontCache", "user Microsoft font cache directory")) success = false;
+        clear([local]() { return DeleteDirectoryTree(local / "FontCache", "user font cache directory"); });
+        clear([local]() { return DeleteDirectoryTree(local / "Microsoft" / "Windows" / "FontCache", "user Microsoft font cache directory"); });
         std::cout << "  - Removing Adobe cache files (LocalAppData)...\n";
-        if (!ClearAdobeCachesIn(local / "Adobe")) success = false;
+        clear([local]() { return ClearAdobeCachesIn(local / "Adobe"); });
     } else {
         std::cerr << "    Warning: LOCALAPPDATA environment variable not set; skipping user font cache directories.\n";
     }
@@ -490,11 +773,12 @@ bool ClearUserFontCaches() {
     std::string roamingAppData = GetEnvVariable("APPDATA");
     if (!roamingAppData.empty()) {
         std::cout << "  - Removing Adobe cache files (AppData)...\n";
-        if (!ClearAdobeCachesIn(fs::path(roamingAppData) / "Adobe")) success = false;
+        clear([roaming = fs::path(roamingAppData)]() { return ClearAdobeCachesIn(roaming / "Adobe"); });
     } else {
         std::cerr << "    Warning: APPDATA environment variable not set; skipping roaming Adobe caches.\n";
     }
 
+    group.Wait();
     return success;
 }
 
@@ -6,7 +6,15 @@
 #ifndef SYS_UTILS_H
 #define SYS_UTILS_H
 
+#include "font_store.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
+
+namespace Checksum { class ContentHasher; }
 
 namespace SysUtils {
     // Get Windows error message from GetLastError()
@@ -15,14 +23,70 @@ namespace SysUtils {
     // Check if running with administrator privileges
     [[nodiscard]] bool IsAdmin();
 
-    // Get Windows fonts directory path (system)
+    // Font registrations in the Windows registry (...\CurrentVersion\Fonts under
+    // HKEY_LOCAL_MACHINE and HKEY_CURRENT_USER) and the Windows and per-user fonts directories
+    class RegistryStore : public FontStore::Store {
+    public:
+        [[nodiscard]] std::unique_ptr<FontStore::Key> Open(bool perUser, bool writable) override;
+        [[nodiscard]] std::string FontsDirectory(bool perUser) override;
+    };
+
+    // Environment variable naming a FontStore::FileStore to use instead of the registry; its
+    // fonts directories are <file>.fonts\system and <file>.fonts\user
+    constexpr const char* REGISTRY_ENVIRONMENT_VARIABLE = "FONTLIFT_REGISTRY";
+
+    // Store behind FontRegistryKey, the Reg* functions and the fonts directories: the registry,
+    // or the FileStore FONTLIFT_REGISTRY names; created on first use
+    [[nodiscard]] FontStore::Store& GetFontStore();
+
+    // Use another store from now on (e.g. a FontStore::MemoryStore in a harness); keys and
+    // references from the previous one must be gone
+    void SetFontStore(std::unique_ptr<FontStore::Store> store);
+
+    // Get fonts directory path of the font store (system: the Windows fonts directory)
     [[nodiscard]] std::string GetFontsDirectory();
 
-    // Get user fonts directory path
+    // Get user fonts directory path of the font store
     [[nodiscard]] std::string GetUserFontsDirectory();
 
-    // Copy file to fonts directory (system or user)
-    bool CopyToFontsFolder(const char* sourcePath, std::string& destPath, bool perUser = false);
+    // Get the fontlift data directory (%LOCALAPPDATA%\fontlift), creating it if missing
+    // Returns empty string if LOCALAPPDATA is unset or the directory cannot be created
+    [[nodiscard]] std::string GetDataDirectory();
+
+    // How a font file is copied, fastest first
+    enum class CopyMethod : uint8_t {
+        Auto,       // The first of the methods below that works (hard links only where safe)
+        Clone,      // Block clone (FSCTL_DUPLICATE_EXTENTS_TO_FILE): shares clusters with the
+                    // source until either is written; ReFS and Dev Drive, same volume only
+        Hardlink,   // Hard link: the copy is the source file, so it follows later edits and
+                    // shares its permissions; same volume only
+        System,     // CopyFileA: kernel-side copy, offloaded to the server on SMB shares
+        Buffered    // ReadFile/WriteFile through a buffer in this process
+    };
+
+    // Name of a method as --copy takes it ("auto", "clone", "hardlink", "system", "buffered")
+    [[nodiscard]] const char* CopyMethodName(CopyMethod method) noexcept;
+    bool ParseCopyMethod(const char* name, CopyMethod& method) noexcept;
+
+    // Copy sourcePath to destPath (replaced if present) with one method, or with Auto the first
+    // that works; allowHardlink lets Auto link sources that never change (content store objects).
+    // used receives the method that made the copy. A partial destination is deleted on failure.
+    bool CopyFontFile(const char* sourcePath, const char* destPath, CopyMethod method, bool allowHardlink,
+                      CopyMethod* used = nullptr);
+
+    // Copy file to fonts directory (system or user); Auto links content store objects into
+    // the user fonts directory only (a system font must not share a user's file permissions)
+    bool CopyToFontsFolder(const char* sourcePath, std::string& destPath, bool perUser = false,
+                           CopyMethod method = CopyMethod::Auto, CopyMethod* used = nullptr);
+
+    // Write an in-memory font to destPath (replaced if present) in 1 MB chunks; hasher, if
+    // given, takes each chunk as it is written. A partial file is deleted on failure.
+    bool WriteFontFile(const char* destPath, const uint8_t* data, size_t size,
+                       Checksum::ContentHasher* hasher = nullptr);
+
+    // Write an in-memory font to fonts directory (system or user) as fileName (WriteFontFile)
+    bool WriteToFontsFolder(const char* fileName, const uint8_t* data, size_t size, std::string& destPath,
+                            bool perUser = false, Checksum::ContentHasher* hasher = nullptr);
 
     // Delete file from fonts directory
     bool DeleteFromFontsFolder(const char* filename);
@@ -33,10 +97,45 @@ namespace SysUtils {
     // Get filename from full path
     [[nodiscard]] std::string GetFileName(const char* path);
 
-    // Validate font file path (no path traversal, must be in fonts dir if absolute)
+    // Text in the ANSI code page (command-line arguments) as UTF-8, the encoding of font and
+    // registry value names; unchanged if it is not valid ANSI text
+    [[nodiscard]] std::string AnsiToUtf8(const std::string& text);
+
+    // Validate font file path (no path traversal, must be in fonts dir or a content store
+    // (content_store.h) if absolute)
     bool IsValidFontPath(const char* path);
 
+    // Fonts key of the font store (GetFontStore) held open for a batch of reads, writes and
+    // deletes (closed on destruction)
+    // perUser: false = HKEY_LOCAL_MACHINE, true = HKEY_CURRENT_USER
+    class FontRegistryKey {
+    public:
+        FontRegistryKey() noexcept = default;
+        ~FontRegistryKey() { Close(); }
+
+        FontRegistryKey(const FontRegistryKey&) = delete;
+        FontRegistryKey& operator=(const FontRegistryKey&) = delete;
+
+        // writable: open for writing too (the per-user key is created if missing)
+        bool Open(bool perUser, bool writable) noexcept;
+        void Close() noexcept;
+
+        [[nodiscard]] bool IsOpen() const noexcept { return key_ != nullptr; }
+        [[nodiscard]] FontStore::Key* Get() const noexcept { return key_.get(); }  // nullptr if not open
+        bool Read(const char* valueName, std::string& fontFile) const;
+        bool Write(const char* valueName, const char* fontFile);
+        bool Delete(const char* valueName);
+
+        // Every font entry (value name, file) in one pass over the key, so entries can then be
+        // deleted without disturbing the enumeration
+        bool Enumerate(std::vector<std::pair<std::string, std::string>>& entries) const;
+
+    private:
+        std::unique_ptr<FontStore::Key> key_;
+    };
+
     // Registry operations (perUser: false = HKEY_LOCAL_MACHINE, true = HKEY_CURRENT_USER)
+    // Each call opens and closes the key; use FontRegistryKey for batches
     bool RegReadFontEntry(const char* valueName, std::string& fontFile, bool perUser = false);
     bool RegWriteFontEntry(const char* valueName, const char* fontFile, bool perUser = false);
     bool RegDeleteFontEntry(const char* valueName, bool perUser = false);
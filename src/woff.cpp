@@ -0,0 +1,289 @@
+// this_file: src/woff.cpp
+// WOFF/WOFF2 container access implementation
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+
+#include "woff.h"
+#include "inflate.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(FONTLIFT_HAVE_BROTLI)
+#include <brotli/decode.h>
+#endif
+
+namespace Woff {
+// Web font directories are decoded up front; table data is only touched for the tables a
+// caller asks for (WOFF 1.0 tables are compressed individually, WOFF2 tables share one stream)
+
+constexpr uint16_t MAX_FONT_TABLES = 1000;           // Maximum number of tables in font file
+constexpr size_t WOFF2_OUTPUT_CHUNK = 64 * 1024;     // Decompressed bytes produced per decoder call
+
+// WOFF2 table directory flags (per WOFF 2.0 spec, section 5.2)
+constexpr uint8_t WOFF2_TAG_INDEX_MASK = 0x3F;       // Index into KNOWN_TAGS
+constexpr uint8_t WOFF2_ARBITRARY_TAG = 0x3F;        // Tag follows as a uint32
+constexpr uint8_t WOFF2_TRANSFORM_SHIFT = 6;         // Transform version in the top two bits
+constexpr uint8_t WOFF2_NULL_TRANSFORM_GLYF = 3;     // glyf/loca: version 3 is the null transform
+
+// 255UInt16 codes (per WOFF 2.0 spec, section 4.1)
+constexpr uint8_t ONE_MORE_BYTE_CODE1 = 255;         // value = 253 + next byte
+constexpr uint8_t ONE_MORE_BYTE_CODE2 = 254;         // value = 506 + next byte
+constexpr uint8_t WORD_CODE = 253;                   // value = next uint16
+constexpr uint16_t LOWEST_U_CODE = 253;
+
+// Tags encoded by index in the WOFF2 table directory
+constexpr uint32_t KNOWN_TAGS[63] = {
+    MakeTag("cmap"), MakeTag("head"), MakeTag("hhea"), MakeTag("hmtx"), MakeTag("maxp"), MakeTag("name"),
+    MakeTag("OS/2"), MakeTag("post"), MakeTag("cvt "), MakeTag("fpgm"), MakeTag("glyf"), MakeTag("loca"),
+    MakeTag("prep"), MakeTag("CFF "), MakeTag("VORG"), MakeTag("EBDT"), MakeTag("EBLC"), MakeTag("gasp"),
+    MakeTag("hdmx"), MakeTag("kern"), MakeTag("LTSH"), MakeTag("PCLT"), MakeTag("VDMX"), MakeTag("vhea"),
+    MakeTag("vmtx"), MakeTag("BASE"), MakeTag("GDEF"), MakeTag("GPOS"), MakeTag("GSUB"), MakeTag("EBSC"),
+    MakeTag("JSTF"), MakeTag("MATH"), MakeTag("CBDT"), MakeTag("CBLC"), MakeTag("COLR"), MakeTag("CPAL"),
+    MakeTag("SVG "), MakeTag("sbix"), MakeTag("acnt"), MakeTag("avar"), MakeTag("bdat"), MakeTag("bloc"),
+    MakeTag("bsln"), MakeTag("cvar"), MakeTag("fdsc"), MakeTag("feat"), MakeTag("fmtx"), MakeTag("fvar"),
+    MakeTag("gvar"), MakeTag("hsty"), MakeTag("just"), MakeTag("lcar"), MakeTag("mort"), MakeTag("morx"),
+    MakeTag("opbd"), MakeTag("prop"), MakeTag("trak"), MakeTag("Zapf"), MakeTag("Silf"), MakeTag("Glat"),
+    MakeTag("Gloc"), MakeTag("Feat"), MakeTag("Sill")};
+constexpr uint32_t TAG_GLYF = MakeTag("glyf");
+constexpr uint32_t TAG_LOCA = MakeTag("loca");
+
+Container Detect(ByteSpan file) noexcept {
+    const uint32_t signature = Header::Signature::Get(file);
+    if (signature == SIGNATURE_WOFF) return Container::Woff;
+    if (signature == SIGNATURE_WOFF2) return Container::Woff2;
+    return Container::None;
+}
+
+bool CanDecodeWoff2() noexcept {
+#if defined(FONTLIFT_HAVE_BROTLI)
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Helper: Read a UIntBase128 (1-5 bytes, no leading zeros, must fit in 32 bits)
+static bool ReadBase128(ByteSpan data, size_t& pos, uint32_t& value) noexcept {
+    uint32_t result = 0;
+    for (int i = 0; i < 5; i++) {
+        uint8_t byte = 0;
+        if (!data.Read(pos++, byte)) return false;
+        if (i == 0 && byte == 0x80) return false;       // Leading zero
+        if (result & 0xFE000000u) return false;         // Would overflow
+        result = (result << 7) | (byte & 0x7F);
+        if ((byte & 0x80) == 0) {
+            value = result;
+            return true;
+        }
+    }
+    return false;  // More than five bytes
+}
+
+// Helper: Read a 255UInt16
+static bool Read255UShort(ByteSpan data, size_t& pos, uint16_t& value) noexcept {
+    uint8_t code = 0;
+    if (!data.Read(pos++, code)) return false;
+    if (code == WORD_CODE) {
+        if (!data.Read(pos, value)) return false;
+        pos += sizeof(uint16_t);
+        return true;
+    }
+    if (code == ONE_MORE_BYTE_CODE1 || code == ONE_MORE_BYTE_CODE2) {
+        uint8_t next = 0;
+        if (!data.Read(pos++, next)) return false;
+        value = static_cast<uint16_t>(next + (code == ONE_MORE_BYTE_CODE1 ? LOWEST_U_CODE : LOWEST_U_CODE * 2));
+        return true;
+    }
+    value = code;
+    return true;
+}
+
+bool WoffDirectory::Parse(ByteSpan prefix) {
+    kind_ = Detect(prefix);
+    flavor_ = Header::Flavor::Get(prefix);
+    length_ = Header::Length::Get(prefix);
+    dataOffset_ = 0;
+    compressedSize_ = 0;
+    streamSize_ = 0;
+    tables_.clear();
+    faces_.clear();
+
+    const bool ok = kind_ == Container::Woff ? ParseWoff(prefix) : kind_ == Container::Woff2 && ParseWoff2(prefix);
+    if (!ok) {
+        kind_ = Container::None;
+        tables_.clear();
+        faces_.clear();
+    }
+    return ok;
+}
+
+bool WoffDirectory::ParseWoff(ByteSpan prefix) {
+    if (!prefix.Contains(0, Header::SIZE)) return false;
+    const uint16_t numTables = Header::NumTables::Get(prefix);
+    if (numTables > MAX_FONT_TABLES) return false;
+    const ByteSpan directory = prefix.Subspan(Header::SIZE, static_cast<size_t>(numTables) * DirectoryEntry::SIZE);
+    if (numTables > 0 && directory.empty()) return false;  // Truncated table directory
+
+    WoffFace face{flavor_, {}};
+    tables_.resize(numTables);
+    face.tables.resize(numTables);
+    for (uint16_t i = 0; i < numTables; i++) {
+        const ByteSpan entry = directory.Subspan(static_cast<size_t>(i) * DirectoryEntry::SIZE, DirectoryEntry::SIZE);
+        WoffTable& table = tables_[i];
+        table.tag = DirectoryEntry::Tag::Get(entry);
+        table.checksum = DirectoryEntry::OrigChecksum::Get(entry);
+        table.offset = DirectoryEntry::Offset::Get(entry);
+        table.storedLength = DirectoryEntry::CompLength::Get(entry);
+        table.origLength = DirectoryEntry::OrigLength::Get(entry);
+        table.transformed = false;
+        face.tables[i] = i;
+
+        // Compressed data never exceeds the table and must lie inside the file
+        if (table.storedLength > table.origLength) return false;
+        if (static_cast<uint64_t>(table.offset) + table.storedLength > length_) return false;
+    }
+    faces_.push_back(std::move(face));
+    return true;
+}
+
+bool WoffDirectory::ParseWoff2(ByteSpan prefix) {
+    if (!prefix.Contains(0, Header2::SIZE)) return false;
+    const uint16_t numTables = Header::NumTables::Get(prefix);
+    if (numTables == 0 || numTables > MAX_FONT_TABLES) return false;
+    compressedSize_ = Header2::TotalCompressedSize::Get(prefix);
+
+    size_t pos = Header2::SIZE;
+    tables_.resize(numTables);
+    for (uint16_t i = 0; i < numTables; i++) {
+        WoffTable& table = tables_[i];
+        uint8_t flags = 0;
+        if (!prefix.Read(pos++, flags)) return false;
+        const uint8_t tagIndex = flags & WOFF2_TAG_INDEX_MASK;
+        if (tagIndex == WOFF2_ARBITRARY_TAG) {
+            if (!prefix.Read(pos, table.tag)) return false;
+            pos += sizeof(uint32_t);
+        } else {
+            table.tag = KNOWN_TAGS[tagIndex];
+        }
+        if (!ReadBase128(prefix, pos, table.origLength)) return false;
+
+        // glyf/loca are transformed unless version 3; other tables unless version 0
+        const uint8_t version = flags >> WOFF2_TRANSFORM_SHIFT;
+        const bool glyfOrLoca = table.tag == TAG_GLYF || table.tag == TAG_LOCA;
+        table.transformed = glyfOrLoca ? version != WOFF2_NULL_TRANSFORM_GLYF : version != 0;
+        table.storedLength = table.origLength;
+        if (table.transformed && !ReadBase128(prefix, pos, table.storedLength)) return false;
+
+        // Tables follow each other in the decompressed stream without padding
+        table.checksum = 0;
+        table.offset = static_cast<uint32_t>(streamSize_);
+        streamSize_ += table.storedLength;
+        if (streamSize_ > UINT32_MAX) return false;
+    }
+
+    if (IsCollection()) {
+        uint32_t version = 0;
+        uint16_t numFonts = 0;
+        if (!prefix.Read(pos, version)) return false;
+        pos += sizeof(uint32_t);
+        if (!Read255UShort(prefix, pos, numFonts) || numFonts == 0) return false;
+        faces_.resize(numFonts);
+        for (WoffFace& face : faces_) {
+            uint16_t faceTables = 0;
+            if (!Read255UShort(prefix, pos, faceTables) || !prefix.Read(pos, face.flavor)) return false;
+            pos += sizeof(uint32_t);
+            face.tables.resize(faceTables);
+            for (uint16_t& index : face.tables) {
+                if (!Read255UShort(prefix, pos, index) || index >= numTables) return false;
+            }
+        }
+    } else {
+        WoffFace face{flavor_, std::vector<uint16_t>(numTables)};
+        for (uint16_t i = 0; i < numTables; i++) face.tables[i] = i;
+        faces_.push_back(std::move(face));
+    }
+
+    // The compressed stream starts right after the directories
+    dataOffset_ = static_cast<uint32_t>(pos);
+    return static_cast<uint64_t>(dataOffset_) + compressedSize_ <= length_;
+}
+
+bool DecompressTable(const WoffTable& table, ByteSpan stored, uint8_t* dst) noexcept {
+    if (stored.size() != table.storedLength || table.transformed) return false;
+    if (table.storedLength == table.origLength) {
+        if (table.origLength != 0) memcpy(dst, stored.data(), table.origLength);
+        return true;
+    }
+    size_t produced = 0;
+    const Inflate::Result result = Inflate::Zlib(stored.data(), stored.size(), dst, table.origLength, produced);
+    return result == Inflate::Result::Complete && produced == table.origLength;
+}
+
+Woff2Stream::Woff2Stream() {
+#if defined(FONTLIFT_HAVE_BROTLI)
+    state_ = BrotliDecoderCreateInstance(nullptr, nullptr, nullptr);
+    chunk_.resize(WOFF2_OUTPUT_CHUNK);
+#endif
+}
+
+Woff2Stream::~Woff2Stream() {
+#if defined(FONTLIFT_HAVE_BROTLI)
+    if (state_) BrotliDecoderDestroyInstance(static_cast<BrotliDecoderState*>(state_));
+#endif
+}
+
+void Woff2Stream::Want(uint64_t offset, uint32_t length, uint8_t* dst) {
+    ranges_.push_back(Range{offset, length, dst});
+    wantedEnd_ = std::max(wantedEnd_, offset + length);
+}
+
+bool Woff2Stream::Complete(size_t index) const noexcept {
+    return index < ranges_.size() && ranges_[index].offset + ranges_[index].length <= produced_;
+}
+
+void Woff2Stream::Deliver(const uint8_t* data, size_t length) {
+    const uint64_t begin = produced_;
+    const uint64_t end = produced_ + length;
+    for (const Range& range : ranges_) {
+        const uint64_t from = std::max(begin, range.offset);
+        const uint64_t to = std::min(end, range.offset + range.length);
+        if (from < to) {
+            memcpy(range.dst + (from - range.offset), data + (from - begin), static_cast<size_t>(to - from));
+        }
+    }
+    produced_ = end;
+}
+
+bool Woff2Stream::Feed(ByteSpan input) {
+#if defined(FONTLIFT_HAVE_BROTLI)
+    if (!state_ || failed_) return false;
+    if (finished_) return true;  // Bytes after the end of the stream are ignored
+
+    BrotliDecoderState* state = static_cast<BrotliDecoderState*>(state_);
+    size_t availableIn = input.size();
+    const uint8_t* nextIn = input.data();
+    for (;;) {
+        size_t availableOut = chunk_.size();
+        uint8_t* nextOut = chunk_.data();
+        const BrotliDecoderResult result = BrotliDecoderDecompressStream(state, &availableIn, &nextIn, &availableOut, &nextOut, nullptr);
+        Deliver(chunk_.data(), chunk_.size() - availableOut);
+
+        if (result == BROTLI_DECODER_RESULT_SUCCESS) {
+            finished_ = true;
+            return true;
+        }
+        if (result == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT) return true;
+        if (result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT) {
+            if (Done()) return true;  // Everything requested is in; the rest is never decoded
+            continue;
+        }
+        failed_ = true;
+        return false;
+    }
+#else
+    (void)input;
+    failed_ = true;
+    return false;
+#endif
+}
+
+} // namespace Woff
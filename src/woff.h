@@ -0,0 +1,157 @@
+// this_file: src/woff.h
+// WOFF/WOFF2 container access for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Web font headers and table directories, and selective table decompression into caller buffers
+
+#ifndef WOFF_H
+#define WOFF_H
+
+#include "byte_order.h"
+#include "font_io.h"
+#include "opentype.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Woff {
+    using FontIO::ByteSpan;
+    using ByteOrder::MakeTag;
+    using OpenType::Field;
+
+    // Container signatures (per WOFF 1.0 and WOFF 2.0 specs)
+    constexpr uint32_t SIGNATURE_WOFF = MakeTag("wOFF");
+    constexpr uint32_t SIGNATURE_WOFF2 = MakeTag("wOF2");
+
+    // WOFF 1.0 header and table directory entry layouts
+    namespace Header {
+        using Signature = Field<uint32_t, 0>;
+        using Flavor = Field<uint32_t, 4>;     // sfnt version of the wrapped font
+        using Length = Field<uint32_t, 8>;     // Total size of the WOFF file
+        using NumTables = Field<uint16_t, 12>;
+        constexpr size_t SIZE = 44;
+    }
+    namespace DirectoryEntry {
+        using Tag = Field<uint32_t, 0>;
+        using Offset = Field<uint32_t, 4>;
+        using CompLength = Field<uint32_t, 8>;
+        using OrigLength = Field<uint32_t, 12>;
+        using OrigChecksum = Field<uint32_t, 16>;
+        constexpr size_t SIZE = 20;
+    }
+
+    // WOFF 2.0 header layout (signature, flavor, length and numTables as in WOFF 1.0)
+    namespace Header2 {
+        using TotalCompressedSize = Field<uint32_t, 20>;
+        constexpr size_t SIZE = 48;
+    }
+
+    enum class Container : uint8_t {
+        None,   // Not a web font
+        Woff,   // WOFF 1.0: tables zlib-compressed one by one
+        Woff2   // WOFF 2.0: all tables in one Brotli stream
+    };
+
+    // Container of the file, from its signature
+    [[nodiscard]] Container Detect(ByteSpan file) noexcept;
+
+    // True if this build can decompress WOFF2 table data (Brotli available)
+    [[nodiscard]] bool CanDecodeWoff2() noexcept;
+
+    // One table of the web font directory
+    struct WoffTable {
+        uint32_t tag;
+        uint32_t checksum;      // WOFF: origChecksum; WOFF2 does not store checksums (0)
+        uint32_t offset;        // WOFF: file offset of the stored data; WOFF2: offset in the decompressed stream
+        uint32_t storedLength;  // WOFF: compLength; WOFF2: bytes in the decompressed stream
+        uint32_t origLength;    // Length of the table in the sfnt
+        bool transformed;       // WOFF2 glyf/loca/hmtx transform: stored bytes are not the sfnt table
+    };
+
+    // Face of a web font: sfnt version and the directory indices of its tables
+    struct WoffFace {
+        uint32_t flavor;
+        std::vector<uint16_t> tables;
+    };
+
+    // Decoded header and table directory of a WOFF or WOFF2 file
+    class WoffDirectory {
+    public:
+        // Decode from the start of the file; prefix must hold the whole directory (and, for
+        // WOFF2, the collection directory). Returns false for an unknown signature, an invalid
+        // or truncated directory, or tables outside the declared file length.
+        bool Parse(ByteSpan prefix);
+
+        [[nodiscard]] Container Kind() const noexcept { return kind_; }
+        [[nodiscard]] uint32_t Flavor() const noexcept { return flavor_; }
+        [[nodiscard]] uint32_t Length() const noexcept { return length_; }
+        [[nodiscard]] bool IsCollection() const noexcept { return flavor_ == OpenType::TAG_TTCF; }
+        [[nodiscard]] const std::vector<WoffTable>& Tables() const noexcept { return tables_; }
+        [[nodiscard]] const std::vector<WoffFace>& Faces() const noexcept { return faces_; }
+
+        // WOFF2 only: file offset and size of the compressed table stream
+        [[nodiscard]] uint32_t DataOffset() const noexcept { return dataOffset_; }
+        [[nodiscard]] uint32_t CompressedSize() const noexcept { return compressedSize_; }
+        // WOFF2 only: size of the decompressed table stream
+        [[nodiscard]] uint64_t StreamSize() const noexcept { return streamSize_; }
+
+    private:
+        bool ParseWoff(ByteSpan prefix);
+        bool ParseWoff2(ByteSpan prefix);
+
+        Container kind_ = Container::None;
+        uint32_t flavor_ = 0;
+        uint32_t length_ = 0;
+        uint32_t dataOffset_ = 0;
+        uint32_t compressedSize_ = 0;
+        uint64_t streamSize_ = 0;
+        std::vector<WoffTable> tables_;
+        std::vector<WoffFace> faces_;
+    };
+
+    // Decompress one WOFF 1.0 table (zlib, or stored as-is when compLength == origLength) into
+    // dst, which must hold origLength bytes. Returns false unless exactly origLength bytes result.
+    bool DecompressTable(const WoffTable& table, ByteSpan stored, uint8_t* dst) noexcept;
+
+    // Push decoder for the WOFF2 Brotli stream that keeps only requested ranges of the
+    // decompressed output. Output is produced in fixed chunks and discarded outside the
+    // requested ranges, so memory is the decoder window plus the caller's buffers.
+    class Woff2Stream {
+    public:
+        Woff2Stream();
+        ~Woff2Stream();
+
+        Woff2Stream(const Woff2Stream&) = delete;
+        Woff2Stream& operator=(const Woff2Stream&) = delete;
+
+        // Copy decompressed bytes [offset, offset + length) to dst as they are produced
+        void Want(uint64_t offset, uint32_t length, uint8_t* dst);
+
+        // Decode the next piece of compressed input; false on malformed data (or no decoder)
+        bool Feed(ByteSpan input);
+
+        // True once the stream has ended, or every requested range (if any) has been produced
+        [[nodiscard]] bool Done() const noexcept { return finished_ || (!ranges_.empty() && wantedEnd_ <= produced_); }
+        [[nodiscard]] bool Finished() const noexcept { return finished_; }
+        [[nodiscard]] uint64_t Produced() const noexcept { return produced_; }
+        // True if the range requested by the index-th Want() was fully produced
+        [[nodiscard]] bool Complete(size_t index) const noexcept;
+
+    private:
+        struct Range {
+            uint64_t offset;
+            uint32_t length;
+            uint8_t* dst;
+        };
+        void Deliver(const uint8_t* data, size_t length);
+
+        void* state_ = nullptr;  // BrotliDecoderState when Brotli is available
+        std::vector<uint8_t> chunk_;
+        std::vector<Range> ranges_;
+        uint64_t produced_ = 0;
+        uint64_t wantedEnd_ = 0;
+        bool finished_ = false;
+        bool failed_ = false;
+    };
+}
+
+#endif // WOFF_H
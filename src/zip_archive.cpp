@@ -0,0 +1,306 @@
+// this_file: src/zip_archive.cpp
+// ZIP archive access implementation
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+
+#include "zip_archive.h"
+#include "byte_order.h"
+#include "checksum.h"
+#include "inflate.h"
+#include <algorithm>
+#include <cstring>
+
+namespace ZipArchive {
+// Only the central directory at the end of the archive is decoded up front; local headers are
+// read when an entry is extracted. All multi-byte fields are little-endian (per APPNOTE 6.3).
+
+// Record signatures
+constexpr uint32_t SIGNATURE_LOCAL_HEADER = 0x04034B50;
+constexpr uint32_t SIGNATURE_CENTRAL_HEADER = 0x02014B50;
+constexpr uint32_t SIGNATURE_END = 0x06054B50;
+constexpr uint32_t SIGNATURE_ZIP64_END = 0x06064B50;
+constexpr uint32_t SIGNATURE_ZIP64_LOCATOR = 0x07064B50;
+
+// End of central directory record
+namespace EndRecord {
+    constexpr size_t DISK = 4;
+    constexpr size_t CENTRAL_DISK = 6;
+    constexpr size_t TOTAL_ENTRIES = 10;
+    constexpr size_t CENTRAL_SIZE = 12;
+    constexpr size_t CENTRAL_OFFSET = 16;
+    constexpr size_t COMMENT_LENGTH = 20;
+    constexpr size_t SIZE = 22;
+}
+// ZIP64 end of central directory locator (immediately before the end record) and record
+namespace Zip64Locator {
+    constexpr size_t END_OFFSET = 8;
+    constexpr size_t SIZE = 20;
+}
+namespace Zip64End {
+    constexpr size_t DISK = 16;
+    constexpr size_t CENTRAL_DISK = 20;
+    constexpr size_t TOTAL_ENTRIES = 32;
+    constexpr size_t CENTRAL_SIZE = 40;
+    constexpr size_t CENTRAL_OFFSET = 48;
+    constexpr size_t SIZE = 56;
+}
+// Central directory file header
+namespace CentralHeader {
+    constexpr size_t FLAGS = 8;
+    constexpr size_t METHOD = 10;
+    constexpr size_t CRC32 = 16;
+    constexpr size_t COMPRESSED_SIZE = 20;
+    constexpr size_t SIZE_FIELD = 24;
+    constexpr size_t NAME_LENGTH = 28;
+    constexpr size_t EXTRA_LENGTH = 30;
+    constexpr size_t COMMENT_LENGTH = 32;
+    constexpr size_t DISK_START = 34;
+    constexpr size_t LOCAL_OFFSET = 42;
+    constexpr size_t SIZE = 46;
+}
+// Local file header
+namespace LocalHeader {
+    constexpr size_t NAME_LENGTH = 26;
+    constexpr size_t EXTRA_LENGTH = 28;
+    constexpr size_t SIZE = 30;
+}
+
+constexpr uint16_t EXTRA_ZIP64 = 0x0001;            // Extra field with the 64-bit sizes and offset
+constexpr uint16_t FLAG_UTF8_NAME = 0x0800;         // Bit 11: name is UTF-8
+constexpr uint32_t ZIP64_MARKER32 = 0xFFFFFFFF;     // 32-bit field moved to the ZIP64 record
+constexpr uint16_t ZIP64_MARKER16 = 0xFFFF;
+constexpr size_t MAX_COMMENT_LENGTH = 0xFFFF;
+
+// Helper: Little-endian field at offset; false (out untouched) if it lies outside the span
+template <typename T>
+static bool ReadLE(FontIO::ByteSpan span, size_t offset, T& out) noexcept {
+    if (!span.Contains(offset, sizeof(T))) return false;
+    out = ByteOrder::LoadLE<T>(span.data() + offset);
+    return true;
+}
+
+// Helper: Replace the 32-bit fields marked 0xFFFFFFFF with their values from the ZIP64 extra
+// field, which lists only the marked fields, in this order
+static bool ApplyZip64Extra(FontIO::ByteSpan extra, Entry& entry, bool sizeMarked, bool compressedMarked, bool offsetMarked) {
+    for (size_t pos = 0; pos + 4 <= extra.size();) {
+        uint16_t id = 0, length = 0;
+        ReadLE(extra, pos, id);
+        ReadLE(extra, pos + 2, length);
+        const FontIO::ByteSpan field = extra.Subspan(pos + 4, length);
+        if (field.size() != length) return false;
+        if (id == EXTRA_ZIP64) {
+            size_t at = 0;
+            if (sizeMarked && !ReadLE(field, at, entry.size)) return false;
+            if (sizeMarked) at += 8;
+            if (compressedMarked && !ReadLE(field, at, entry.compressedSize)) return false;
+            if (compressedMarked) at += 8;
+            if (offsetMarked && !ReadLE(field, at, entry.localHeaderOffset)) return false;
+            return true;
+        }
+        pos += 4 + static_cast<size_t>(length);
+    }
+    return !sizeMarked && !compressedMarked && !offsetMarked;
+}
+
+bool Archive::Open(const char* path, std::string& error) {
+    entries_.clear();
+    byName_.clear();
+    if (!file_.Open(path)) {
+        error = "Cannot open archive";
+        return false;
+    }
+    const FontIO::ByteSpan bytes = file_.Bytes();
+
+    // The end record is the last 22 bytes unless the archive has a comment: search backwards
+    // for a signature whose comment length reaches exactly the end of the file
+    size_t end = SIZE_MAX;
+    if (bytes.size() >= EndRecord::SIZE) {
+        const size_t last = bytes.size() - EndRecord::SIZE;
+        const size_t first = last > MAX_COMMENT_LENGTH ? last - MAX_COMMENT_LENGTH : 0;
+        for (size_t pos = last + 1; pos-- > first;) {
+            uint32_t signature = 0;
+            uint16_t commentLength = 0;
+            ReadLE(bytes, pos, signature);
+            ReadLE(bytes, pos + EndRecord::COMMENT_LENGTH, commentLength);
+            if (signature == SIGNATURE_END && pos + EndRecord::SIZE + commentLength == bytes.size()) {
+                end = pos;
+                break;
+            }
+        }
+    }
+    if (end == SIZE_MAX) {
+        error = "Not a ZIP archive (no end of central directory)";
+        return false;
+    }
+
+    uint16_t disk = 0, centralDisk = 0, count16 = 0;
+    uint32_t centralSize32 = 0, centralOffset32 = 0;
+    ReadLE(bytes, end + EndRecord::DISK, disk);
+    ReadLE(bytes, end + EndRecord::CENTRAL_DISK, centralDisk);
+    ReadLE(bytes, end + EndRecord::TOTAL_ENTRIES, count16);
+    ReadLE(bytes, end + EndRecord::CENTRAL_SIZE, centralSize32);
+    ReadLE(bytes, end + EndRecord::CENTRAL_OFFSET, centralOffset32);
+    uint64_t count = count16, centralSize = centralSize32, centralOffset = centralOffset32;
+    bool split = disk != 0 || centralDisk != 0;
+    uint32_t locatorSignature = 0;
+    const bool zip64 = end >= Zip64Locator::SIZE && ReadLE(bytes, end - Zip64Locator::SIZE, locatorSignature) &&
+                       locatorSignature == SIGNATURE_ZIP64_LOCATOR;
+    if (zip64) {
+        uint64_t recordOffset = 0;
+        uint32_t signature = 0, disk64 = 0, centralDisk64 = 0;
+        ReadLE(bytes, end - Zip64Locator::SIZE + Zip64Locator::END_OFFSET, recordOffset);
+        const FontIO::ByteSpan record = recordOffset <= SIZE_MAX ? bytes.Subspan(static_cast<size_t>(recordOffset), Zip64End::SIZE) : FontIO::ByteSpan();
+        if (!ReadLE(record, 0, signature) || signature != SIGNATURE_ZIP64_END) {
+            error = "Damaged ZIP64 end of central directory";
+            return false;
+        }
+        ReadLE(record, Zip64End::DISK, disk64);
+        ReadLE(record, Zip64End::CENTRAL_DISK, centralDisk64);
+        ReadLE(record, Zip64End::TOTAL_ENTRIES, count);
+        ReadLE(record, Zip64End::CENTRAL_SIZE, centralSize);
+        ReadLE(record, Zip64End::CENTRAL_OFFSET, centralOffset);
+        split = disk64 != 0 || centralDisk64 != 0;
+    }
+    if (split) {
+        error = "Split (multi-volume) archives are not supported";
+        return false;
+    }
+
+    // Data prepended to the archive (a self-extractor stub) shifts every offset by the same
+    // amount; the central directory ends where the end records begin
+    const size_t directoryEnd = zip64 ? end - Zip64Locator::SIZE : end;
+    uint64_t shift = 0;
+    if (!zip64 && centralSize <= directoryEnd && directoryEnd - centralSize > centralOffset) {
+        shift = directoryEnd - centralSize - centralOffset;
+    }
+    if (centralOffset + shift > bytes.size() || centralSize > bytes.size() - (centralOffset + shift) ||
+        count > centralSize / CentralHeader::SIZE) {
+        error = "Damaged ZIP central directory";
+        return false;
+    }
+    const FontIO::ByteSpan directory = bytes.Subspan(static_cast<size_t>(centralOffset + shift), static_cast<size_t>(centralSize));
+
+    entries_.reserve(static_cast<size_t>(count));
+    size_t pos = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        uint32_t signature = 0, size32 = 0, compressed32 = 0, offset32 = 0;
+        uint16_t nameLength = 0, extraLength = 0, commentLength = 0, diskStart = 0;
+        Entry entry;
+        if (!ReadLE(directory, pos, signature) || signature != SIGNATURE_CENTRAL_HEADER ||
+            !ReadLE(directory, pos + CentralHeader::LOCAL_OFFSET, offset32)) {
+            error = "Damaged ZIP central directory";
+            return false;
+        }
+        ReadLE(directory, pos + CentralHeader::FLAGS, entry.flags);
+        ReadLE(directory, pos + CentralHeader::METHOD, entry.method);
+        ReadLE(directory, pos + CentralHeader::CRC32, entry.crc32);
+        ReadLE(directory, pos + CentralHeader::COMPRESSED_SIZE, compressed32);
+        ReadLE(directory, pos + CentralHeader::SIZE_FIELD, size32);
+        ReadLE(directory, pos + CentralHeader::NAME_LENGTH, nameLength);
+        ReadLE(directory, pos + CentralHeader::EXTRA_LENGTH, extraLength);
+        ReadLE(directory, pos + CentralHeader::COMMENT_LENGTH, commentLength);
+        ReadLE(directory, pos + CentralHeader::DISK_START, diskStart);
+        const FontIO::ByteSpan name = directory.Subspan(pos + CentralHeader::SIZE, nameLength);
+        const FontIO::ByteSpan extra = directory.Subspan(pos + CentralHeader::SIZE + nameLength, extraLength);
+        if (name.size() != nameLength || extra.size() != extraLength) {
+            error = "Damaged ZIP central directory";
+            return false;
+        }
+        entry.name.assign(reinterpret_cast<const char*>(name.data()), nameLength);
+        entry.utf8Name = (entry.flags & FLAG_UTF8_NAME) != 0;
+        entry.size = size32;
+        entry.compressedSize = compressed32;
+        entry.localHeaderOffset = offset32;
+        if (!ApplyZip64Extra(extra, entry, size32 == ZIP64_MARKER32, compressed32 == ZIP64_MARKER32, offset32 == ZIP64_MARKER32) ||
+            (diskStart != 0 && diskStart != ZIP64_MARKER16)) {
+            error = "Damaged ZIP central directory entry: " + entry.name;
+            return false;
+        }
+        entry.localHeaderOffset += shift;
+        byName_.emplace(entry.name, entries_.size());  // First of duplicate names wins
+        entries_.push_back(std::move(entry));
+        pos += CentralHeader::SIZE + nameLength + extraLength + commentLength;
+    }
+    return true;
+}
+
+const Entry* Archive::Find(const std::string& name) const {
+    const auto found = byName_.find(name);
+    return found == byName_.end() ? nullptr : &entries_[found->second];
+}
+
+bool Archive::Extract(const Entry& entry, std::vector<uint8_t>& out, size_t maxSize, std::string& error) const {
+    out.clear();
+    if (entry.IsEncrypted()) {
+        error = "Encrypted archive entries are not supported";
+        return false;
+    }
+    if (entry.method != METHOD_STORED && entry.method != METHOD_DEFLATE) {
+        error = "Unsupported compression method " + std::to_string(entry.method) + " (use stored or deflate)";
+        return false;
+    }
+    if (entry.size > maxSize) {
+        error = "Archive entry too large (" + std::to_string(entry.size) + " bytes)";
+        return false;
+    }
+
+    // The local header repeats the name and may carry a different extra field
+    const FontIO::ByteSpan bytes = file_.Bytes();
+    uint32_t signature = 0;
+    uint16_t nameLength = 0, extraLength = 0;
+    const size_t header = entry.localHeaderOffset <= SIZE_MAX ? static_cast<size_t>(entry.localHeaderOffset) : SIZE_MAX;
+    if (!ReadLE(bytes, header, signature) || signature != SIGNATURE_LOCAL_HEADER ||
+        !ReadLE(bytes, header + LocalHeader::NAME_LENGTH, nameLength) ||
+        !ReadLE(bytes, header + LocalHeader::EXTRA_LENGTH, extraLength)) {
+        error = "Damaged archive entry header";
+        return false;
+    }
+    const size_t dataOffset = header + LocalHeader::SIZE + nameLength + extraLength;
+    if (entry.compressedSize > bytes.size() || !bytes.Contains(dataOffset, static_cast<size_t>(entry.compressedSize))) {
+        error = "Archive entry extends past the end of the archive";
+        return false;
+    }
+    const uint8_t* data = bytes.data() + dataOffset;
+    const size_t size = static_cast<size_t>(entry.size);
+
+    out.resize(size);
+    if (entry.method == METHOD_STORED) {
+        if (entry.compressedSize != entry.size) {
+            error = "Damaged archive entry (stored size mismatch)";
+            return false;
+        }
+        if (size > 0) std::memcpy(out.data(), data, size);
+    } else if (size > 0) {
+        size_t produced = 0;
+        const Inflate::Result result = Inflate::Raw(data, static_cast<size_t>(entry.compressedSize), out.data(), size, produced);
+        if (result != Inflate::Result::Complete || produced != size) {
+            error = result == Inflate::Result::OutputFull ? "Archive entry is larger than recorded" : "Damaged compressed data in archive entry";
+            return false;
+        }
+    }
+    if (Checksum::Crc32(out.data(), out.size()) != entry.crc32) {
+        error = "Archive entry fails its CRC-32 check";
+        return false;
+    }
+    return true;
+}
+
+bool IsArchivePath(const char* path) noexcept {
+    const size_t length = path ? strlen(path) : 0;
+    if (length < 4) return false;
+    const char* ext = path + length - 4;
+    return ext[0] == '.' && (ext[1] | 0x20) == 'z' && (ext[2] | 0x20) == 'i' && (ext[3] | 0x20) == 'p';
+}
+
+std::string MemberPath(const std::string& archivePath, const std::string& entryName) {
+    return archivePath + MEMBER_SEPARATOR + entryName;
+}
+
+bool SplitMemberPath(const std::string& path, std::string& archivePath, std::string& entryName) {
+    const size_t separator = path.find(MEMBER_SEPARATOR);
+    if (separator == std::string::npos) return false;
+    archivePath = path.substr(0, separator);
+    entryName = path.substr(separator + 1);
+    return true;
+}
+
+} // namespace ZipArchive
@@ -0,0 +1,75 @@
+// this_file: src/zip_archive.h
+// ZIP archive access for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Central directory listing (ZIP64 included) and in-memory extraction of stored and deflated entries
+
+#ifndef ZIP_ARCHIVE_H
+#define ZIP_ARCHIVE_H
+
+#include "font_io.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ZipArchive {
+    // Compression methods this reader extracts (per APPNOTE 4.4.5)
+    constexpr uint16_t METHOD_STORED = 0;
+    constexpr uint16_t METHOD_DEFLATE = 8;
+
+    // Separates an archive path from an entry name in a member reference:
+    // "C:\Deliveries\Vendor.zip|fonts/Foo-Bold.otf" ('|' cannot appear in Windows paths)
+    constexpr char MEMBER_SEPARATOR = '|';
+
+    // One file of the central directory
+    struct Entry {
+        std::string name;              // As stored: '/'-separated, UTF-8 if utf8Name, else code page 437
+        uint16_t method = 0;
+        uint16_t flags = 0;            // General purpose bit flags
+        uint32_t crc32 = 0;
+        uint64_t compressedSize = 0;
+        uint64_t size = 0;             // Uncompressed
+        uint64_t localHeaderOffset = 0;
+        bool utf8Name = false;         // Flag bit 11
+
+        [[nodiscard]] bool IsDirectory() const noexcept { return !name.empty() && name.back() == '/'; }
+        [[nodiscard]] bool IsEncrypted() const noexcept { return (flags & 1) != 0; }
+    };
+
+    // A mapped archive whose central directory is decoded once. Entry data is only read by
+    // Extract(), which may run on several threads at once for different entries.
+    class Archive {
+    public:
+        Archive() = default;
+        Archive(const Archive&) = delete;
+        Archive& operator=(const Archive&) = delete;
+
+        // Map the archive and read its central directory; error says why not
+        bool Open(const char* path, std::string& error);
+
+        [[nodiscard]] const std::vector<Entry>& Entries() const noexcept { return entries_; }
+
+        // Entry with exactly this name, or nullptr
+        [[nodiscard]] const Entry* Find(const std::string& name) const;
+
+        // Decompress an entry into out (resized to its size) and check its size and CRC-32.
+        // Entries larger than maxSize are refused before anything is allocated.
+        bool Extract(const Entry& entry, std::vector<uint8_t>& out, size_t maxSize, std::string& error) const;
+
+    private:
+        FontIO::MappedFile file_;
+        std::vector<Entry> entries_;
+        std::unordered_map<std::string, size_t> byName_;
+    };
+
+    // True if the path names a .zip file (ASCII case-insensitive extension)
+    [[nodiscard]] bool IsArchivePath(const char* path) noexcept;
+
+    // Member reference of an entry, and its archive path and entry name again; Split returns
+    // false for an ordinary path
+    [[nodiscard]] std::string MemberPath(const std::string& archivePath, const std::string& entryName);
+    bool SplitMemberPath(const std::string& path, std::string& archivePath, std::string& entryName);
+}
+
+#endif // ZIP_ARCHIVE_H
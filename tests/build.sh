@@ -0,0 +1,28 @@
+#!/usr/bin/env bash
+# this_file: tests/build.sh
+# Builds and runs the scheduler tests (build/scheduler_test) on Linux or macOS with g++ or clang++
+# Usage: tests/build.sh   (CXX and CXXFLAGS are honoured; SANITIZE=thread or SANITIZE=address
+# builds with that sanitizer)
+
+set -euo pipefail
+
+root_dir="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+cd "$root_dir"
+
+cxx="${CXX:-g++}"
+flags="${CXXFLAGS:--O1 -g}"
+if [[ -n "${SANITIZE:-}" ]]; then
+  flags="$flags -fsanitize=${SANITIZE} -fno-omit-frame-pointer"
+fi
+
+# The scheduler is standard C++ only; the rest of the tool is Windows-specific
+sources=(
+  src/scheduler.cpp
+  tests/scheduler_test.cpp
+)
+
+mkdir -p build
+# shellcheck disable=SC2086
+"$cxx" -std=c++17 -Wall -Wextra $flags -Isrc "${sources[@]}" -pthread -o build/scheduler_test
+echo "Built build/scheduler_test"
+build/scheduler_test
@@ -0,0 +1,153 @@
+// this_file: tests/scheduler_test.cpp
+// Scheduler tests for fontlift-win-cli
+// Copyright 2025 by Fontlab Ltd. Licensed under Apache 2.0
+// Checks BoundedQueue with several producers and consumers, TaskGroup cancellation, nested
+// ParallelFor and --jobs parsing. Standard C++ only; tests/build.sh builds and runs it, with
+// SANITIZE=thread under ThreadSanitizer.
+
+#include "scheduler.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <utility>
+#include <vector>
+
+static int g_failures = 0;
+
+// Helper: Report a failed check with its line
+static void Check(bool condition, const char* what, int line) {
+    if (condition) return;
+    std::fprintf(stderr, "FAIL line %d: %s\n", line, what);
+    g_failures++;
+}
+
+#define CHECK(condition) Check((condition), #condition, __LINE__)
+
+// Every value pushed by several producers is popped exactly once by several consumers, through
+// a queue small enough that producers keep hitting backpressure
+static void TestBoundedQueueManyProducersAndConsumers() {
+    constexpr size_t PRODUCERS = 4;
+    constexpr size_t CONSUMERS = 4;
+    constexpr size_t PER_PRODUCER = 50000;
+    Scheduler::BoundedQueue<uint32_t> queue(8);
+    std::vector<std::atomic<uint32_t>> seen(PRODUCERS * PER_PRODUCER);
+    std::atomic<size_t> producersLeft{PRODUCERS};
+    std::atomic<size_t> popped{0};
+
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < PRODUCERS; p++) {
+        threads.emplace_back([&queue, &producersLeft, p]() {
+            for (size_t i = 0; i < PER_PRODUCER; i++) queue.Push(static_cast<uint32_t>(p * PER_PRODUCER + i));
+            if (--producersLeft == 0) queue.Close();
+        });
+    }
+    for (size_t c = 0; c < CONSUMERS; c++) {
+        threads.emplace_back([&queue, &seen, &popped]() {
+            uint32_t value = 0;
+            while (queue.Pop(value)) {
+                seen[value]++;
+                popped++;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    CHECK(popped == PRODUCERS * PER_PRODUCER);
+    size_t once = 0;
+    for (const auto& count : seen) once += count == 1 ? 1 : 0;
+    CHECK(once == seen.size());
+    uint32_t value = 0;
+    CHECK(!queue.TryPop(value));
+}
+
+// A closed, drained queue ends every consumer; TryPush refuses a full queue
+static void TestBoundedQueueCapacityAndClose() {
+    Scheduler::BoundedQueue<int> queue(3);  // Rounded up to 4
+    for (int i = 0; i < 4; i++) CHECK(queue.TryPush(int(i)));
+    int extra = 99;
+    CHECK(!queue.TryPush(std::move(extra)));
+    queue.Close();
+    int value = -1;
+    for (int i = 0; i < 4; i++) CHECK(queue.Pop(value) && value == i);
+    CHECK(!queue.Pop(value));
+}
+
+// Cancel() from a running task skips the tasks that have not started; Wait() still returns
+static void TestTaskGroupCancel() {
+    Scheduler::WorkStealingPool pool(2);
+    constexpr size_t TASKS = 10000;
+    std::atomic<size_t> ran{0};
+    {
+        Scheduler::TaskGroup group;
+        for (size_t i = 0; i < TASKS; i++) {
+            group.Run(pool, [&group, &ran, i]() {
+                ran++;
+                if (i == 10) group.Cancel();
+            });
+        }
+        group.Wait();
+        CHECK(group.IsCancelled());
+    }
+    CHECK(ran > 0);
+    CHECK(ran < TASKS);
+
+    // ParallelFor starts no further items once its group is cancelled
+    Scheduler::TaskGroup group;
+    std::atomic<size_t> items{0};
+    Scheduler::ParallelFor(group, pool, TASKS, [&group, &items](size_t i) {
+        items++;
+        if (i == 0) group.Cancel();
+    });
+    CHECK(items < TASKS);
+}
+
+// ParallelFor inside ParallelFor on the same pool: waiting workers run the inner items
+// themselves, so even a one-thread pool finishes
+static void TestNestedParallelFor() {
+    for (const unsigned threads : {1u, 4u}) {
+        Scheduler::WorkStealingPool pool(threads);
+        constexpr size_t OUTER = 64;
+        constexpr size_t INNER = 256;
+        std::vector<std::atomic<size_t>> sums(OUTER);
+        Scheduler::ParallelFor(pool, OUTER, [&pool, &sums](size_t o) {
+            Scheduler::ParallelFor(pool, INNER, [&sums, o](size_t i) { sums[o] += i; });
+        });
+        size_t correct = 0;
+        for (const auto& sum : sums) correct += sum == INNER * (INNER - 1) / 2 ? 1 : 0;
+        CHECK(correct == OUTER);
+    }
+
+    // Groups spanning both shared pools, as the install pipeline uses them
+    std::atomic<size_t> total{0};
+    Scheduler::ParallelFor(Scheduler::IoPool(), 16, [&total](size_t) {
+        Scheduler::ParallelFor(Scheduler::CpuPool(), 100, [&total](size_t) { total++; });
+    });
+    CHECK(total == 1600);
+}
+
+static void TestParseJobs() {
+    unsigned jobs = 7;
+    CHECK(Scheduler::ParseJobs("1", jobs) && jobs == 1);
+    CHECK(Scheduler::ParseJobs("1024", jobs) && jobs == 1024);
+    jobs = 7;
+    for (const char* bad : {"", "0", "1025", "-1", "+4", "4x", "x4", " 4", "99999999999999999999"}) {
+        CHECK(!Scheduler::ParseJobs(bad, jobs));
+    }
+    CHECK(!Scheduler::ParseJobs(nullptr, jobs));
+    CHECK(jobs == 7);
+}
+
+int main() {
+    TestBoundedQueueManyProducersAndConsumers();
+    TestBoundedQueueCapacityAndClose();
+    TestTaskGroupCancel();
+    TestNestedParallelFor();
+    TestParseJobs();
+    if (g_failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("scheduler_test: all checks passed\n");
+    return 0;
+}